@@ -7,6 +7,17 @@
 using namespace misere;
 using namespace chaudiere;
 
+// shared by every handler, so no two handlers - nor two generations of
+// one - ever use the same generation number
+static std::atomic<unsigned long> nextResponseCacheGeneration(1);
+
+//******************************************************************************
+
+AbstractHandler::AbstractHandler() :
+   m_responseCacheGeneration(
+      nextResponseCacheGeneration.fetch_add(1, std::memory_order_relaxed)) {
+}
+
 //******************************************************************************
 
 bool AbstractHandler::init(const std::string& path,
@@ -29,3 +40,17 @@ bool AbstractHandler::isAvailable() const {
 
 //******************************************************************************
 
+
+unsigned long AbstractHandler::responseCacheGeneration() const {
+   return m_responseCacheGeneration.load(std::memory_order_acquire);
+}
+
+//******************************************************************************
+
+void AbstractHandler::invalidateCachedResponses() {
+   m_responseCacheGeneration.store(
+      nextResponseCacheGeneration.fetch_add(1, std::memory_order_relaxed),
+      std::memory_order_release);
+}
+
+//******************************************************************************
@@ -4,6 +4,8 @@
 #ifndef MISERE_ABSTRACTHANDLER_H
 #define MISERE_ABSTRACTHANDLER_H
 
+#include <atomic>
+
 #include "HttpHandler.h"
 #include "KeyValuePairs.h"
 
@@ -13,11 +15,23 @@ namespace misere
 class AbstractHandler : public HttpHandler
 {
 public:
+   AbstractHandler();
+
    virtual bool init(const std::string& path,
                      const chaudiere::KeyValuePairs& kvpArguments);
    virtual void serviceRequest(const HttpRequest& request,
                                HttpResponse& response);
    virtual bool isAvailable() const;
+   virtual unsigned long responseCacheGeneration() const;
+
+   /**
+    * Stops the responses cached for this handler from being served, so
+    * the next request for each calls serviceRequest() again
+    */
+   void invalidateCachedResponses();
+
+private:
+   std::atomic<unsigned long> m_responseCacheGeneration;
 
 };
 
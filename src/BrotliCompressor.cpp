@@ -0,0 +1,77 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#if defined(MISERE_WITH_BROTLI)
+#include <brotli/encode.h>
+#endif
+
+#include "BrotliCompressor.h"
+
+using namespace misere;
+
+//******************************************************************************
+
+bool BrotliCompressor::isSupported() {
+#if defined(MISERE_WITH_BROTLI)
+   return true;
+#else
+   return false;
+#endif
+}
+
+//******************************************************************************
+
+BrotliCompressor::BrotliCompressor(int level) :
+   m_level(level) {
+}
+
+//******************************************************************************
+
+void BrotliCompressor::setLevel(int level) {
+   m_level = level;
+}
+
+//******************************************************************************
+
+#if defined(MISERE_WITH_BROTLI)
+
+bool BrotliCompressor::compress(const char* data,
+                                std::size_t length,
+                                std::string& output) {
+   output.clear();
+
+   const std::size_t bound = ::BrotliEncoderMaxCompressedSize(length);
+   if (bound == 0) {
+      return false;
+   }
+
+   output.resize(bound);
+   std::size_t compressedLength = bound;
+
+   if (!::BrotliEncoderCompress(m_level,
+                                BROTLI_DEFAULT_WINDOW,
+                                BROTLI_MODE_GENERIC,
+                                length,
+                                (const uint8_t*) data,
+                                &compressedLength,
+                                (uint8_t*) output.data())) {
+      output.clear();
+      return false;
+   }
+
+   output.resize(compressedLength);
+   return true;
+}
+
+//******************************************************************************
+
+#else
+
+bool BrotliCompressor::compress(const char*, std::size_t, std::string& output) {
+   output.clear();
+   return false;
+}
+
+//******************************************************************************
+
+#endif
@@ -0,0 +1,78 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef MISERE_BROTLICOMPRESSOR_H
+#define MISERE_BROTLICOMPRESSOR_H
+
+#include <cstddef>
+#include <string>
+
+
+namespace misere
+{
+
+/**
+ * BrotliCompressor produces Brotli (RFC 7932) encoded output. Brotli's
+ * encoder can't be reset and reused the way a zlib or zstd stream can,
+ * so each body is compressed in one shot; what a compressor keeps from
+ * one body to the next is its quality setting and the caller's output
+ * buffer. Not thread-safe - each thread compressing needs its own.
+ *
+ * Only available when misere is built with Brotli (MISERE_WITH_BROTLI
+ * - see isSupported()); otherwise compress() always fails.
+ */
+class BrotliCompressor
+{
+   public:
+      /**
+       * Default quality - well below Brotli's own default of 11, which
+       * is meant for compressing static assets ahead of time and is far
+       * too slow for a response being served
+       */
+      static const int DEFAULT_LEVEL = 4;
+
+      /**
+       * Range of valid qualities
+       */
+      static const int MIN_LEVEL = 0;
+      static const int MAX_LEVEL = 11;
+
+      /**
+       * Determines whether misere was built with Brotli support
+       * @return boolean indicating if Brotli compression is available
+       */
+      static bool isSupported();
+
+      /**
+       * Constructs a compressor
+       * @param level the Brotli quality (0-11)
+       */
+      explicit BrotliCompressor(int level=DEFAULT_LEVEL);
+
+      /**
+       * Compresses a buffer into Brotli format
+       * @param data the bytes to compress
+       * @param length the number of bytes to compress
+       * @param output receives the compressed bytes (replacing its
+       *        contents, but keeping its capacity)
+       * @return boolean indicating whether compression succeeded
+       */
+      bool compress(const char* data, std::size_t length, std::string& output);
+
+      /**
+       * Changes the quality for the inputs that follow
+       * @param level the Brotli quality (0-11)
+       */
+      void setLevel(int level);
+
+   private:
+      int m_level;
+
+      // disallow copies
+      BrotliCompressor(const BrotliCompressor&);
+      BrotliCompressor& operator=(const BrotliCompressor&);
+};
+
+}
+
+#endif
@@ -4,7 +4,12 @@
 #ifndef MISERE_BYTECONNECTION_H
 #define MISERE_BYTECONNECTION_H
 
+#include <errno.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <algorithm>
 #include <cstddef>
+#include <vector>
 
 namespace misere
 {
@@ -22,6 +27,21 @@ namespace misere
 class ByteConnection
 {
    public:
+      /**
+       * Size of the buffer the default sendFile() copies through
+       */
+      static const std::size_t FILE_COPY_BUFFER_SIZE = 64 * 1024;
+
+      /**
+       * Segment is one piece of a vectored write - a pointer and length,
+       * not owning the bytes
+       */
+      struct Segment
+      {
+         const char* data;
+         std::size_t length;
+      };
+
       virtual ~ByteConnection() {}
 
       /**
@@ -44,6 +64,84 @@ class ByteConnection
        */
       virtual bool write(const char* buffer, std::size_t length) = 0;
 
+      /**
+       * Writes the specified segments, in order, in their entirety - e.g.
+       * a response's header block and body without first copying them
+       * into one buffer. Implementations that can send several buffers
+       * at once (writev) or coalesce them (one TLS record) override this;
+       * the default simply writes each segment in turn.
+       * @param segments the segments to write
+       * @param count the number of segments
+       * @return boolean indicating whether the write succeeded
+       */
+      virtual bool writev(const Segment* segments, std::size_t count) {
+         for (std::size_t i = 0; i < count; ++i) {
+            if (!write(segments[i].data, segments[i].length)) {
+               return false;
+            }
+         }
+         return true;
+      }
+
+      /**
+       * Writes a range of a file's contents in its entirety, without
+       * using or moving the descriptor's own file offset. Implementations
+       * that can hand the copy to the kernel (sendfile) override this;
+       * the default reads the file a piece at a time into a buffer each
+       * thread reuses and writes each piece in turn (e.g. encrypting it,
+       * for TLS).
+       * @param fd the file descriptor to read from
+       * @param offset position in the file of the first byte to write
+       * @param length the number of bytes to write
+       * @return boolean indicating whether the write succeeded (false if
+       *         the file can't be read or ends before length bytes)
+       */
+      virtual bool sendFile(int fd, off_t offset, std::size_t length) {
+         static thread_local std::vector<char> buffer;
+         if (buffer.empty()) {
+            buffer.resize(FILE_COPY_BUFFER_SIZE);
+         }
+
+         while (length > 0) {
+            const ssize_t bytesRead =
+               ::pread(fd, buffer.data(), std::min(length, buffer.size()), offset);
+            if (bytesRead < 0) {
+               if (errno == EINTR) {
+                  continue;
+               }
+               return false;
+            }
+
+            if ((bytesRead == 0) || !write(buffer.data(), (std::size_t) bytesRead)) {
+               return false;
+            }
+
+            offset += bytesRead;
+            length -= (std::size_t) bytesRead;
+         }
+
+         return true;
+      }
+
+      /**
+       * Determines if each request is read in full before it's handed
+       * over (as by the event loop), so read() never has any more of it
+       * to give - a body a handler would stream is limited like any other
+       * @return boolean indicating whether requests arrive fully buffered
+       */
+      virtual bool buffersWholeRequests() const {
+         return false;
+      }
+
+      /**
+       * Retrieves the descriptor of the socket the connection is carried
+       * on, e.g. to find out who the peer is
+       * @return the socket's descriptor, or -1 if there's no socket
+       */
+      virtual int getSocketDescriptor() const {
+         return -1;
+      }
+
       /**
        * Closes the connection.
        */
@@ -0,0 +1,201 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include <algorithm>
+
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <sys/socket.h>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "CpuAffinity.h"
+#include "StrUtils.h"
+
+using namespace misere;
+using namespace chaudiere;
+
+static const std::string SYSFS_CPU_DIR = "/sys/devices/system/cpu/cpu";
+static const char* SYSFS_NODE_PREFIX = "node";
+
+//******************************************************************************
+
+static bool parseCpu(const std::string& text, int& cpu) {
+   // no CPU or node number needs more digits than this
+   if (text.empty() || (text.size() > 6)) {
+      return false;
+   }
+
+   for (char c : text) {
+      if ((c < '0') || (c > '9')) {
+         return false;
+      }
+   }
+
+   cpu = ::atoi(text.c_str());
+   return true;
+}
+
+//******************************************************************************
+
+bool CpuAffinity::parseCpuList(const std::string& list, std::vector<int>& cpus) {
+   cpus.clear();
+
+   for (const std::string& item : StrUtils::split(list, ",")) {
+      const std::string range = StrUtils::strip(item);
+      const std::string::size_type dash = range.find('-');
+
+      int first;
+      int last;
+
+      if (dash == std::string::npos) {
+         if (!parseCpu(range, first)) {
+            cpus.clear();
+            return false;
+         }
+         last = first;
+      } else if (!parseCpu(StrUtils::strip(range.substr(0, dash)), first) ||
+                 !parseCpu(StrUtils::strip(range.substr(dash + 1)), last) ||
+                 (last < first)) {
+         cpus.clear();
+         return false;
+      }
+
+      for (int cpu = first; cpu <= last; ++cpu) {
+         cpus.push_back(cpu);
+      }
+   }
+
+   return !cpus.empty();
+}
+
+//******************************************************************************
+
+bool CpuAffinity::allowedCpus(std::vector<int>& cpus) {
+   cpus.clear();
+
+#if defined(__linux__)
+   cpu_set_t cpuSet;
+   CPU_ZERO(&cpuSet);
+   if (::sched_getaffinity(0, sizeof(cpuSet), &cpuSet) != 0) {
+      return false;
+   }
+
+   for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+      if (CPU_ISSET(cpu, &cpuSet)) {
+         cpus.push_back(cpu);
+      }
+   }
+#endif
+
+   return !cpus.empty();
+}
+
+//******************************************************************************
+
+void CpuAffinity::keepAllowedCpus(std::vector<int>& cpus,
+                                  const std::vector<int>& allowed,
+                                  std::vector<int>& removed) {
+   removed.clear();
+   if (allowed.empty()) {
+      return;
+   }
+
+   std::vector<int> kept;
+   for (int cpu : cpus) {
+      if (std::find(allowed.begin(), allowed.end(), cpu) != allowed.end()) {
+         kept.push_back(cpu);
+      } else {
+         removed.push_back(cpu);
+      }
+   }
+
+   cpus.swap(kept);
+}
+
+//******************************************************************************
+
+bool CpuAffinity::pinCurrentThread(int cpu) {
+#if defined(__linux__)
+   if ((cpu < 0) || (cpu >= CPU_SETSIZE)) {
+      return false;
+   }
+
+   cpu_set_t cpuSet;
+   CPU_ZERO(&cpuSet);
+   CPU_SET(cpu, &cpuSet);
+   return ::pthread_setaffinity_np(::pthread_self(), sizeof(cpuSet), &cpuSet) == 0;
+#else
+   return false;
+#endif
+}
+
+//******************************************************************************
+
+int CpuAffinity::currentCpu() {
+#if defined(__linux__)
+   return ::sched_getcpu();
+#else
+   return -1;
+#endif
+}
+
+//******************************************************************************
+
+int CpuAffinity::nodeOfCpu(int cpu) {
+   if (cpu < 0) {
+      return -1;
+   }
+
+   // the CPU's sysfs directory has a "node<N>" link to its node
+   const std::string path = SYSFS_CPU_DIR + StrUtils::toString(cpu);
+   DIR* dir = ::opendir(path.c_str());
+   if (dir == nullptr) {
+      return -1;
+   }
+
+   const std::size_t prefixLength = ::strlen(SYSFS_NODE_PREFIX);
+   int node = -1;
+   struct dirent* entry;
+
+   while ((entry = ::readdir(dir)) != nullptr) {
+      if ((::strncmp(entry->d_name, SYSFS_NODE_PREFIX, prefixLength) == 0) &&
+          parseCpu(entry->d_name + prefixLength, node)) {
+         break;
+      }
+   }
+
+   ::closedir(dir);
+   return node;
+}
+
+//******************************************************************************
+
+int CpuAffinity::incomingCpu(int socketFD) {
+#if defined(SO_INCOMING_CPU)
+   int cpu = -1;
+   socklen_t length = sizeof(cpu);
+   if (::getsockopt(socketFD, SOL_SOCKET, SO_INCOMING_CPU, &cpu, &length) < 0) {
+      return -1;
+   }
+   return cpu;
+#else
+   return -1;
+#endif
+}
+
+//******************************************************************************
+
+bool CpuAffinity::setIncomingCpu(int socketFD, int cpu) {
+#if defined(SO_INCOMING_CPU)
+   return ::setsockopt(socketFD, SOL_SOCKET, SO_INCOMING_CPU, &cpu, sizeof(cpu)) == 0;
+#else
+   return false;
+#endif
+}
+
+//******************************************************************************
@@ -0,0 +1,100 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef MISERE_CPUAFFINITY_H
+#define MISERE_CPUAFFINITY_H
+
+#include <string>
+#include <vector>
+
+
+namespace misere
+{
+
+/**
+ * CpuAffinity holds the helpers for placing threads and connections on
+ * CPUs: parsing a configured CPU list, pinning a thread, finding the NUMA
+ * node a CPU belongs to, and the SO_INCOMING_CPU socket option.
+ *
+ * There's no NUMA allocation API here on purpose. Linux places a page on
+ * the node of the thread that first touches it, so a thread pinned
+ * before it allocates anything (its thread_local buffers, its connection
+ * arena, its malloc arena) gets memory local to its CPU without any
+ * libnuma calls.
+ *
+ * Linux only; elsewhere the lookups report nothing and pinning fails.
+ */
+class CpuAffinity
+{
+   public:
+      /**
+       * Parses a CPU list in the kernel's format (e.g., "0-3,8,10-11")
+       * @param list the CPU list
+       * @param cpus receives the CPUs, in the order listed
+       * @return boolean indicating whether the list is valid (and not empty)
+       */
+      static bool parseCpuList(const std::string& list, std::vector<int>& cpus);
+
+      /**
+       * Retrieves the CPUs this process is allowed to run on - its
+       * sched_getaffinity() mask, which a cpuset cgroup or taskset may
+       * make a small, not necessarily zero-based, part of the machine
+       * @param cpus receives the CPUs, in ascending order
+       * @return boolean indicating whether the CPUs are known
+       */
+      static bool allowedCpus(std::vector<int>& cpus);
+
+      /**
+       * Removes the CPUs that aren't in an allowed set from a CPU list
+       * @param cpus the CPU list, whose order is kept
+       * @param allowed the allowed CPUs (empty if not known, which keeps
+       * every CPU)
+       * @param removed receives the CPUs removed
+       */
+      static void keepAllowedCpus(std::vector<int>& cpus,
+                                  const std::vector<int>& allowed,
+                                  std::vector<int>& removed);
+
+      /**
+       * Pins the calling thread to a CPU
+       * @param cpu the CPU
+       * @return boolean indicating whether the thread was pinned
+       */
+      static bool pinCurrentThread(int cpu);
+
+      /**
+       * Retrieves the CPU the calling thread is running on
+       * @return the CPU, or -1 if not known
+       */
+      static int currentCpu();
+
+      /**
+       * Retrieves the NUMA node a CPU belongs to
+       * @param cpu the CPU
+       * @return the node, or -1 if not known (no NUMA information)
+       */
+      static int nodeOfCpu(int cpu);
+
+      /**
+       * Retrieves the CPU that last processed a socket's incoming packets
+       * (SO_INCOMING_CPU) - for an accepted connection, the CPU (and so
+       * the node) its network queue's interrupts are handled on
+       * @param socketFD the socket
+       * @return the CPU, or -1 if not known
+       */
+      static int incomingCpu(int socketFD);
+
+      /**
+       * Sets SO_INCOMING_CPU on a listening socket, so that of several
+       * SO_REUSEPORT listeners on a port the kernel prefers the one whose
+       * CPU processed the incoming connection
+       * @param socketFD the listening socket
+       * @param cpu the CPU
+       * @return boolean indicating whether the option was set
+       */
+      static bool setIncomingCpu(int socketFD, int cpu);
+};
+
+}
+
+#endif
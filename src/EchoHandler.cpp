@@ -43,7 +43,7 @@ void EchoHandler::serviceRequest(const HttpRequest& request,
 
    if (!headerKeys.empty()) {
       for (const auto& headerKey : headerKeys) {
-         const std::string& headerValue = request.getHeaderValue(headerKey);
+         const std::string_view headerValue = request.getHeaderValue(headerKey);
          body += headerKey;
          body += ": ";
          body += headerValue;
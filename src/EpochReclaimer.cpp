@@ -0,0 +1,177 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include <limits>
+#include <utility>
+
+#include "EpochReclaimer.h"
+
+using namespace misere;
+
+namespace {
+
+// a thread that reads published objects; records are never freed, but
+// one left by an exited thread is taken over by the next thread to read
+struct Reader
+{
+   Reader() :
+      epoch(0),
+      isInUse(true),
+      depth(0),
+      next(nullptr) {
+   }
+
+   std::atomic<std::uint64_t> epoch;   // 0 while not reading
+   std::atomic<bool> isInUse;
+   unsigned int depth;                 // only touched by its thread
+   Reader* next;
+};
+
+std::atomic<std::uint64_t> s_epoch(1);
+std::atomic<Reader*> s_readers(nullptr);
+
+Reader* acquireReader() {
+   for (Reader* reader = s_readers.load(); reader != nullptr; reader = reader->next) {
+      bool isInUse = false;
+      if (!reader->isInUse.load() &&
+          reader->isInUse.compare_exchange_strong(isInUse, true)) {
+         return reader;
+      }
+   }
+
+   Reader* reader = new Reader;
+   Reader* head = s_readers.load();
+   do {
+      reader->next = head;
+   } while (!s_readers.compare_exchange_weak(head, reader));
+
+   return reader;
+}
+
+// the calling thread's record, held until the thread exits
+class ThreadReader
+{
+   public:
+      ThreadReader() :
+         m_reader(acquireReader()) {
+      }
+
+      ~ThreadReader() {
+         m_reader->depth = 0;
+         m_reader->epoch.store(0);
+         m_reader->isInUse.store(false);
+      }
+
+      Reader& reader() {
+         return *m_reader;
+      }
+
+   private:
+      Reader* m_reader;
+};
+
+Reader& threadReader() {
+   static thread_local ThreadReader threadReader;
+   return threadReader.reader();
+}
+
+// the oldest epoch a thread is still reading in (the maximum if none is)
+std::uint64_t oldestReadEpoch() {
+   std::uint64_t oldest = std::numeric_limits<std::uint64_t>::max();
+   for (Reader* reader = s_readers.load(); reader != nullptr; reader = reader->next) {
+      const std::uint64_t epoch = reader->epoch.load();
+      if ((epoch != 0) && (epoch < oldest)) {
+         oldest = epoch;
+      }
+   }
+   return oldest;
+}
+
+}
+
+//******************************************************************************
+
+EpochReclaimer::ReadGuard::ReadGuard() {
+   Reader& reader = threadReader();
+   if (reader.depth++ == 0) {
+      // sequentially consistent, so the published pointer is loaded after
+      // the epoch is visible to a writer deciding what to free
+      reader.epoch.store(s_epoch.load());
+   }
+}
+
+//******************************************************************************
+
+EpochReclaimer::ReadGuard::~ReadGuard() {
+   Reader& reader = threadReader();
+   if (--reader.depth == 0) {
+      reader.epoch.store(0, std::memory_order_release);
+   }
+}
+
+//******************************************************************************
+
+EpochReclaimer::EpochReclaimer() {
+}
+
+//******************************************************************************
+
+EpochReclaimer::~EpochReclaimer() {
+   clear();
+}
+
+//******************************************************************************
+
+void EpochReclaimer::retire(std::shared_ptr<const void> object) {
+   std::lock_guard<std::mutex> lock(m_mutex);
+
+   // readers entering from here on can't find the object any more - only
+   // those that entered in this epoch or earlier might hold it
+   Retired retired;
+   retired.epoch = s_epoch.fetch_add(1);
+   retired.object = std::move(object);
+   m_retired.push_back(std::move(retired));
+
+   reclaimLocked();
+}
+
+//******************************************************************************
+
+void EpochReclaimer::reclaim() {
+   std::lock_guard<std::mutex> lock(m_mutex);
+   reclaimLocked();
+}
+
+//******************************************************************************
+
+void EpochReclaimer::reclaimLocked() {
+   const std::uint64_t oldest = oldestReadEpoch();
+
+   std::size_t kept = 0;
+   for (std::size_t i = 0; i < m_retired.size(); ++i) {
+      if (m_retired[i].epoch >= oldest) {
+         if (kept != i) {
+            m_retired[kept] = std::move(m_retired[i]);
+         }
+         ++kept;
+      }
+   }
+
+   m_retired.resize(kept);
+}
+
+//******************************************************************************
+
+void EpochReclaimer::clear() {
+   std::lock_guard<std::mutex> lock(m_mutex);
+   m_retired.clear();
+}
+
+//******************************************************************************
+
+std::size_t EpochReclaimer::getRetiredCount() const {
+   std::lock_guard<std::mutex> lock(m_mutex);
+   return m_retired.size();
+}
+
+//******************************************************************************
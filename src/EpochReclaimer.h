@@ -0,0 +1,107 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef MISERE_EPOCHRECLAIMER_H
+#define MISERE_EPOCHRECLAIMER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+
+namespace misere
+{
+
+/**
+ * EpochReclaimer defers freeing objects that readers may still be using
+ * after they've been unpublished (epoch-based reclamation). Readers mark
+ * the stretch in which they use published objects with a ReadGuard, which
+ * costs two stores to a record of the reading thread's own - no lock, no
+ * shared counter, nothing to wait for. A writer that replaces a published
+ * object hands the old one to retire(), and it's freed once every thread
+ * that was reading when it was retired has left its guard.
+ *
+ * A process-wide epoch counter is advanced by each retire(). A reader
+ * records the epoch it entered in; an object retired in epoch E can only
+ * be held by readers that entered in E or before it, so it's freed when
+ * no thread is still reading from such an epoch.
+ *
+ * Readers are shared by all reclaimers, so one guard covers objects
+ * published by any of them. Retired objects are freed as later retire()
+ * or reclaim() calls find them safe to free.
+ */
+class EpochReclaimer
+{
+   public:
+      /**
+       * ReadGuard marks the calling thread as reading published objects
+       * for its lifetime. Guards nest; only the outermost one counts.
+       */
+      class ReadGuard
+      {
+         public:
+            ReadGuard();
+            ~ReadGuard();
+
+         private:
+            // disallow copies
+            ReadGuard(const ReadGuard&);
+            ReadGuard& operator=(const ReadGuard&);
+      };
+
+      EpochReclaimer();
+
+      /**
+       * Destructor. Frees every retired object, whether or not it's safe -
+       * the owner must be sure nothing is reading them any more.
+       */
+      ~EpochReclaimer();
+
+      /**
+       * Hands over an object that has been unpublished (readers can no
+       * longer find it), to be freed once no reader can still hold it.
+       * Safe to call from several writers.
+       * @param object the object (freed by dropping the last reference)
+       */
+      void retire(std::shared_ptr<const void> object);
+
+      /**
+       * Frees the retired objects that no reader can still hold
+       */
+      void reclaim();
+
+      /**
+       * Frees every retired object, whether or not it's safe (see the
+       * destructor)
+       */
+      void clear();
+
+      /**
+       * Retrieves the number of retired objects not yet freed
+       * @return number of retired objects
+       */
+      std::size_t getRetiredCount() const;
+
+   private:
+      struct Retired
+      {
+         std::uint64_t epoch;
+         std::shared_ptr<const void> object;
+      };
+
+      void reclaimLocked();
+
+      mutable std::mutex m_mutex;
+      std::vector<Retired> m_retired;
+
+      // disallow copies
+      EpochReclaimer(const EpochReclaimer&);
+      EpochReclaimer& operator=(const EpochReclaimer&);
+};
+
+}
+
+#endif
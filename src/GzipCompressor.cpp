@@ -0,0 +1,93 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include <limits.h>
+#include <string.h>
+
+#include "GzipCompressor.h"
+
+using namespace misere;
+
+// 15 window bits, plus 16 for a gzip (rather than zlib) wrapper
+static const int GZIP_WINDOW_BITS = 15 + 16;
+static const int MEMORY_LEVEL     = 8;
+
+//******************************************************************************
+
+GzipCompressor::GzipCompressor(int level) :
+   m_level(level),
+   m_isInitialized(false) {
+   ::memset(&m_stream, 0, sizeof(m_stream));
+   m_isInitialized = (::deflateInit2(&m_stream,
+                                     level,
+                                     Z_DEFLATED,
+                                     GZIP_WINDOW_BITS,
+                                     MEMORY_LEVEL,
+                                     Z_DEFAULT_STRATEGY) == Z_OK);
+}
+
+//******************************************************************************
+
+GzipCompressor::~GzipCompressor() {
+   if (m_isInitialized) {
+      ::deflateEnd(&m_stream);
+   }
+}
+
+//******************************************************************************
+
+bool GzipCompressor::compress(const char* data,
+                              std::size_t length,
+                              std::string& output) {
+   output.clear();
+
+   if (!m_isInitialized || (length > (std::size_t) UINT_MAX)) {
+      return false;
+   }
+
+   // sized up front so a single deflate() call finishes the stream
+   const uLong bound = ::deflateBound(&m_stream, (uLong) length);
+   output.resize(bound);
+
+   m_stream.next_in = (Bytef*) data;
+   m_stream.avail_in = (uInt) length;
+   m_stream.next_out = (Bytef*) output.data();
+   m_stream.avail_out = (uInt) bound;
+
+   const int rc = ::deflate(&m_stream, Z_FINISH);
+   const std::size_t compressedLength = m_stream.total_out;
+
+   // ready for the next input, keeping zlib's allocated state
+   ::deflateReset(&m_stream);
+
+   if (rc != Z_STREAM_END) {
+      output.clear();
+      return false;
+   }
+
+   output.resize(compressedLength);
+   return true;
+}
+
+//******************************************************************************
+
+bool GzipCompressor::setLevel(int level) {
+   if (!m_isInitialized) {
+      return false;
+   }
+
+   if (level == m_level) {
+      return true;
+   }
+
+   // between inputs the stream holds no pending data, so the new level
+   // takes effect without flushing anything
+   if (::deflateParams(&m_stream, level, Z_DEFAULT_STRATEGY) != Z_OK) {
+      return false;
+   }
+
+   m_level = level;
+   return true;
+}
+
+//******************************************************************************
@@ -0,0 +1,78 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef MISERE_GZIPCOMPRESSOR_H
+#define MISERE_GZIPCOMPRESSOR_H
+
+#include <cstddef>
+#include <string>
+
+#include <zlib.h>
+
+
+namespace misere
+{
+
+/**
+ * GzipCompressor produces gzip (RFC 1952) encoded output with one zlib
+ * deflate stream that is set up once and then reset between inputs,
+ * rather than allocating and freeing zlib's internal state (a few
+ * hundred KB) for every body compressed. Not thread-safe - each thread
+ * compressing needs its own.
+ */
+class GzipCompressor
+{
+   public:
+      /**
+       * Default compression level - zlib's own default, a good balance
+       * of speed and ratio for text
+       */
+      static const int DEFAULT_LEVEL = 6;
+
+      /**
+       * Range of valid compression levels
+       */
+      static const int MIN_LEVEL = 1;
+      static const int MAX_LEVEL = 9;
+
+      /**
+       * Constructs a compressor
+       * @param level the deflate compression level (1-9)
+       */
+      explicit GzipCompressor(int level=DEFAULT_LEVEL);
+
+      /**
+       * Destructor
+       */
+      ~GzipCompressor();
+
+      /**
+       * Compresses a buffer into gzip format
+       * @param data the bytes to compress
+       * @param length the number of bytes to compress
+       * @param output receives the compressed bytes (replacing its
+       *        contents, but keeping its capacity)
+       * @return boolean indicating whether compression succeeded
+       */
+      bool compress(const char* data, std::size_t length, std::string& output);
+
+      /**
+       * Changes the compression level for the inputs that follow
+       * @param level the deflate compression level (1-9)
+       * @return boolean indicating whether the level was changed
+       */
+      bool setLevel(int level);
+
+   private:
+      z_stream m_stream;
+      int m_level;
+      bool m_isInitialized;
+
+      // disallow copies
+      GzipCompressor(const GzipCompressor&);
+      GzipCompressor& operator=(const GzipCompressor&);
+};
+
+}
+
+#endif
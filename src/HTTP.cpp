@@ -81,6 +81,12 @@ const std::string HTTP::HTTP_EXPIRES              = "Expires";
 const std::string HTTP::HTTP_LAST_MODIFIED        = "Last-Modified";
 
 
+// content codings
+const std::string HTTP::HTTP_CODING_BROTLI        = "br";
+const std::string HTTP::HTTP_CODING_GZIP          = "gzip";
+const std::string HTTP::HTTP_CODING_ZSTD          = "zstd";
+
+
 // Informational 1xx
 const std::string HTTP::HTTP_RESP_INFO_CONTINUE                        = "100 Continue";
 const std::string HTTP::HTTP_RESP_INFO_SWITCH_PROTOCOLS                = "101 Switching Protocols";
@@ -88,6 +88,12 @@ class HTTP
       static const std::string HTTP_LAST_MODIFIED;
 
 
+      // content codings
+      static const std::string HTTP_CODING_BROTLI;
+      static const std::string HTTP_CODING_GZIP;
+      static const std::string HTTP_CODING_ZSTD;
+
+
       // Informational 1xx
       static const std::string HTTP_RESP_INFO_CONTINUE;
       static const std::string HTTP_RESP_INFO_SWITCH_PROTOCOLS;
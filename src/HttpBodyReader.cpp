@@ -0,0 +1,373 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include <string.h>
+#include <limits.h>
+#include <algorithm>
+#include <utility>
+
+#include "HttpBodyReader.h"
+#include "ByteConnection.h"
+#include "HttpScan.h"
+
+using namespace misere;
+
+static const std::size_t READ_CHUNK_SIZE = 8192;
+static const std::size_t EOL_LENGTH = 2;
+
+// at most 15 hex digits, so a chunk size can't overflow
+static const std::size_t MAX_CHUNK_SIZE_DIGITS = 15;
+
+//******************************************************************************
+
+HttpBodyReader::HttpBodyReader(ByteConnection* connection,
+                               long contentLength,
+                               std::string buffered) :
+   m_connection(connection),
+   m_buffer(std::move(buffered)),
+   m_offset(0),
+   m_remaining(0),
+   m_bytesRead(0),
+   m_state(STATE_CHUNK_SIZE),
+   m_isChunked(contentLength == CHUNKED) {
+
+   if (!m_isChunked) {
+      if (contentLength > 0) {
+         m_remaining = contentLength;
+         m_state = STATE_DATA;
+      } else {
+         m_state = STATE_DONE;
+      }
+   }
+}
+
+//******************************************************************************
+
+bool HttpBodyReader::parseChunkSize(std::string_view line, std::uint64_t& size) {
+   // chunk-size [ BWS ] [ ";" chunk-ext ]
+   std::size_t digits = 0;
+   size = 0;
+
+   while (digits < line.size()) {
+      const char c = line[digits];
+      int value;
+      if ((c >= '0') && (c <= '9')) {
+         value = c - '0';
+      } else if ((c >= 'a') && (c <= 'f')) {
+         value = c - 'a' + 10;
+      } else if ((c >= 'A') && (c <= 'F')) {
+         value = c - 'A' + 10;
+      } else {
+         break;
+      }
+
+      if (++digits > MAX_CHUNK_SIZE_DIGITS) {
+         return false;
+      }
+      size = (size << 4) | value;
+   }
+
+   if (digits == 0) {
+      return false;
+   }
+
+   // extensions are ignored, but nothing else may follow the size
+   std::string_view rest = line.substr(digits);
+   while (!rest.empty() && ((rest[0] == ' ') || (rest[0] == '\t'))) {
+      rest.remove_prefix(1);
+   }
+
+   return rest.empty() || (rest[0] == ';');
+}
+
+//******************************************************************************
+
+long HttpBodyReader::getChunkedBodyLength(const char* data, std::size_t length) {
+   ChunkScan scan;
+   return getChunkedBodyLength(data, length, scan);
+}
+
+//******************************************************************************
+
+long HttpBodyReader::getChunkedBodyLength(const char* data,
+                                          std::size_t length,
+                                          ChunkScan& scan) {
+   const char* end = data + length;
+   const char* p = data + scan.offset;
+
+   while (!scan.inTrailer) {
+      const char* eol = HttpScan::findEol(p, end);
+      if (eol == end) {
+         return ((std::size_t) (end - p) > MAX_LINE_LENGTH) ? MALFORMED : INCOMPLETE;
+      }
+
+      std::uint64_t chunkSize;
+      if (!parseChunkSize(std::string_view(p, eol - p), chunkSize)) {
+         return MALFORMED;
+      }
+
+      if (chunkSize == 0) {
+         p = eol + EOL_LENGTH;
+         scan.offset = p - data;
+         scan.inTrailer = true;
+         break;
+      }
+
+      // the size line is scanned again once the whole chunk is in
+      const char* chunkData = eol + EOL_LENGTH;
+      if ((std::uint64_t) (end - chunkData) < chunkSize + EOL_LENGTH) {
+         return INCOMPLETE;
+      }
+      p = chunkData + chunkSize;
+
+      if ((p[0] != '\r') || (p[1] != '\n')) {
+         return MALFORMED;
+      }
+      p += EOL_LENGTH;
+      scan.offset = p - data;
+   }
+
+   // trailer fields, up to an empty line
+   for (;;) {
+      const char* eol = HttpScan::findEol(p, end);
+      if (eol == end) {
+         return ((std::size_t) (end - p) > MAX_LINE_LENGTH) ? MALFORMED : INCOMPLETE;
+      }
+
+      const bool isEmptyLine = (eol == p);
+      p = eol + EOL_LENGTH;
+      scan.offset = p - data;
+
+      if (isEmptyLine) {
+         return p - data;
+      }
+   }
+}
+
+//******************************************************************************
+
+bool HttpBodyReader::fill() {
+   if (nullptr == m_connection) {
+      return false;
+   }
+
+   // drop what's been consumed before growing the buffer
+   if (m_offset > 0) {
+      m_buffer.erase(0, m_offset);
+      m_offset = 0;
+   }
+
+   const std::size_t used = m_buffer.size();
+   m_buffer.resize(used + READ_CHUNK_SIZE);
+   const int bytesRead = m_connection->read(&m_buffer[used], READ_CHUNK_SIZE);
+
+   if (bytesRead <= 0) {
+      m_buffer.resize(used);
+      return false;
+   }
+
+   m_buffer.resize(used + bytesRead);
+   return true;
+}
+
+//******************************************************************************
+
+bool HttpBodyReader::readLine(std::string_view& line) {
+   for (;;) {
+      const char* begin = m_buffer.data() + m_offset;
+      const char* end = m_buffer.data() + m_buffer.size();
+      const char* eol = HttpScan::findEol(begin, end);
+
+      if (eol != end) {
+         line = std::string_view(begin, eol - begin);
+         m_offset += line.size() + EOL_LENGTH;
+         return true;
+      }
+
+      if ((std::size_t) (end - begin) > MAX_LINE_LENGTH) {
+         return false;
+      }
+
+      if (!fill()) {
+         return false;
+      }
+   }
+}
+
+//******************************************************************************
+
+int HttpBodyReader::fail() {
+   m_state = STATE_FAILED;
+   return -1;
+}
+
+//******************************************************************************
+
+int HttpBodyReader::read(char* buffer, int bufferSize) {
+   if (bufferSize <= 0) {
+      return (m_state == STATE_FAILED) ? -1 : 0;
+   }
+
+   std::string_view line;
+
+   for (;;) {
+      switch (m_state) {
+         case STATE_DONE:
+            return 0;
+
+         case STATE_FAILED:
+            return -1;
+
+         case STATE_CHUNK_SIZE:
+            if (!readLine(line) || !parseChunkSize(line, m_remaining)) {
+               return fail();
+            }
+            m_state = (m_remaining > 0) ? STATE_DATA : STATE_TRAILER;
+            break;
+
+         case STATE_DATA: {
+            const std::size_t wanted =
+               (std::size_t) std::min<std::uint64_t>(m_remaining, bufferSize);
+            const std::size_t available = m_buffer.size() - m_offset;
+            int count;
+
+            if (available > 0) {
+               count = (int) std::min(wanted, available);
+               ::memcpy(buffer, m_buffer.data() + m_offset, count);
+               m_offset += count;
+            } else {
+               // nothing buffered - read straight into the caller's buffer,
+               // never past the end of this chunk (or body)
+               if (nullptr == m_connection) {
+                  return fail();
+               }
+               count = m_connection->read(buffer, (int) wanted);
+               if (count <= 0) {
+                  return fail();
+               }
+            }
+
+            m_remaining -= count;
+            m_bytesRead += count;
+            if (m_remaining == 0) {
+               m_state = m_isChunked ? STATE_CHUNK_END : STATE_DONE;
+            }
+            return count;
+         }
+
+         case STATE_CHUNK_END:
+            if (!readLine(line) || !line.empty()) {
+               return fail();
+            }
+            m_state = STATE_CHUNK_SIZE;
+            break;
+
+         case STATE_TRAILER:
+            // trailer fields are read past, not kept
+            if (!readLine(line)) {
+               return fail();
+            }
+            if (line.empty()) {
+               m_state = STATE_DONE;
+            }
+            break;
+      }
+   }
+}
+
+//******************************************************************************
+
+int HttpBodyReader::read(std::span<char> buffer) {
+   const std::size_t bufferSize = std::min<std::size_t>(buffer.size(), INT_MAX);
+   return read(buffer.data(), (int) bufferSize);
+}
+
+//******************************************************************************
+
+bool HttpBodyReader::skipRemaining() {
+   char discard[READ_CHUNK_SIZE];
+
+   int bytesRead;
+   do {
+      bytesRead = read(discard, sizeof(discard));
+   } while (bytesRead > 0);
+
+   return bytesRead == 0;
+}
+
+//******************************************************************************
+
+bool HttpBodyReader::isBuffered() const {
+   const char* data = m_buffer.data() + m_offset;
+   std::size_t length = m_buffer.size() - m_offset;
+   ChunkScan scan;
+
+   if ((m_state == STATE_DONE) || (m_state == STATE_FAILED)) {
+      return true;
+   }
+
+   if (m_state == STATE_DATA) {
+      if (length < m_remaining) {
+         return false;
+      } else if (!m_isChunked) {
+         return true;
+      }
+
+      // the CRLF ending this chunk is next
+      data += m_remaining;
+      length -= m_remaining;
+   }
+
+   if ((m_state == STATE_DATA) || (m_state == STATE_CHUNK_END)) {
+      if (length < EOL_LENGTH) {
+         return false;
+      }
+      data += EOL_LENGTH;
+      length -= EOL_LENGTH;
+   } else if (m_state == STATE_TRAILER) {
+      scan.inTrailer = true;
+   }
+
+   return getChunkedBodyLength(data, length, scan) != INCOMPLETE;
+}
+
+//******************************************************************************
+
+bool HttpBodyReader::isComplete() const {
+   return m_state == STATE_DONE;
+}
+
+//******************************************************************************
+
+bool HttpBodyReader::hasFailed() const {
+   return m_state == STATE_FAILED;
+}
+
+//******************************************************************************
+
+bool HttpBodyReader::isChunked() const {
+   return m_isChunked;
+}
+
+//******************************************************************************
+
+std::uint64_t HttpBodyReader::getBytesRead() const {
+   return m_bytesRead;
+}
+
+//******************************************************************************
+
+std::string HttpBodyReader::takeUnconsumedBytes() {
+   std::string bytes;
+
+   if (m_state == STATE_DONE) {
+      bytes.assign(m_buffer, m_offset, std::string::npos);
+      m_buffer.clear();
+      m_offset = 0;
+   }
+
+   return bytes;
+}
+
+//******************************************************************************
+
@@ -0,0 +1,199 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef MISERE_HTTPBODYREADER_H
+#define MISERE_HTTPBODYREADER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+
+
+namespace misere
+{
+   class ByteConnection;
+
+/**
+ * HttpBodyReader hands a message body to its consumer a piece at a time,
+ * pulling from the connection only as the consumer asks for more, so a
+ * body of any size (or of unknown size) is never held in memory whole.
+ *
+ * It reads either a body of known length (Content-Length) or a chunked
+ * body (Transfer-Encoding: chunked), removing the chunk framing. Bytes
+ * that were already read from the connection along with the headers are
+ * passed in and consumed first. Once the body is complete, any bytes
+ * read past its end belong to the next message on the connection and
+ * are available from takeUnconsumedBytes().
+ */
+class HttpBodyReader
+{
+   public:
+      /**
+       * Content length that selects chunked decoding
+       */
+      static const long CHUNKED = -1;
+
+      /**
+       * getChunkedBodyLength() result when the body isn't all there yet
+       */
+      static const long INCOMPLETE = -1;
+
+      /**
+       * getChunkedBodyLength() result when the framing is invalid
+       */
+      static const long MALFORMED = -2;
+
+      /**
+       * Longest chunk size or trailer line accepted
+       */
+      static const std::size_t MAX_LINE_LENGTH = 4096;
+
+      /**
+       * How far getChunkedBodyLength() got through a body that wasn't all
+       * there yet, so a later call on the same (grown) buffer resumes
+       * from there instead of rescanning every chunk already seen
+       */
+      struct ChunkScan
+      {
+         std::size_t offset;   // start of the first line not yet scanned
+         bool inTrailer;       // the last (zero size) chunk has been seen
+
+         ChunkScan() :
+            offset(0),
+            inTrailer(false) {
+         }
+
+         void reset() {
+            offset = 0;
+            inTrailer = false;
+         }
+      };
+
+      /**
+       * Constructs a reader for the body that follows a header block
+       * @param connection the connection the rest of the body is read from
+       *        (may be nullptr if the whole body is already buffered)
+       * @param contentLength the length of the body, or CHUNKED
+       * @param buffered bytes already read past the end of the headers
+       */
+      HttpBodyReader(ByteConnection* connection, long contentLength, std::string buffered);
+
+      /**
+       * Measures a complete chunked body at the start of a buffer, without
+       * decoding it - used to tell whether a whole request has arrived
+       * @param data the bytes following the header block
+       * @param length number of bytes available
+       * @return the number of bytes making up the chunked body (including
+       *         its framing and trailers), INCOMPLETE, or MALFORMED
+       */
+      static long getChunkedBodyLength(const char* data, std::size_t length);
+
+      /**
+       * Measures a complete chunked body like the two-argument form, but
+       * resumes from (and records) where the previous call on the same
+       * buffer stopped. The buffer may only have grown since that call.
+       * @param data the bytes following the header block
+       * @param length number of bytes available
+       * @param scan progress through the body, reset for each new body
+       * @return the number of bytes making up the chunked body (including
+       *         its framing and trailers), INCOMPLETE, or MALFORMED
+       */
+      static long getChunkedBodyLength(const char* data,
+                                       std::size_t length,
+                                       ChunkScan& scan);
+
+      /**
+       * Reads the next piece of the body
+       * @param buffer the buffer to receive body bytes
+       * @param bufferSize the size of the buffer (the maximum to read)
+       * @return the number of bytes read, 0 at the end of the body, or -1
+       *         if the framing is invalid or the connection closed early
+       */
+      int read(char* buffer, int bufferSize);
+
+      /**
+       * Reads the next piece of the body
+       * @param buffer the buffer to receive body bytes
+       * @return the number of bytes read, 0 at the end of the body, or -1
+       *         if the framing is invalid or the connection closed early
+       */
+      int read(std::span<char> buffer);
+
+      /**
+       * Reads and discards the rest of the body
+       * @return boolean indicating whether the body ended cleanly
+       */
+      bool skipRemaining();
+
+      /**
+       * Determines if the rest of the body is already buffered, so
+       * reading it never reads from the connection
+       * @return boolean indicating if the rest of the body is buffered
+       *         (or malformed, or already read)
+       */
+      bool isBuffered() const;
+
+      /**
+       * Determines if the whole body has been read
+       * @return boolean indicating if the body is complete
+       */
+      bool isComplete() const;
+
+      /**
+       * Determines if reading the body failed
+       * @return boolean indicating if the body is malformed or truncated
+       */
+      bool hasFailed() const;
+
+      /**
+       * Determines if the body is chunked
+       * @return boolean indicating if the body is chunked
+       */
+      bool isChunked() const;
+
+      /**
+       * Retrieves the number of body bytes (excluding chunk framing) read
+       * so far
+       * @return number of body bytes read
+       */
+      std::uint64_t getBytesRead() const;
+
+      /**
+       * Retrieves and clears the bytes read past the end of the body. Only
+       * meaningful once the body is complete.
+       * @return the unconsumed bytes
+       */
+      std::string takeUnconsumedBytes();
+
+   private:
+      static const int STATE_CHUNK_SIZE = 0;
+      static const int STATE_DATA = 1;
+      static const int STATE_CHUNK_END = 2;
+      static const int STATE_TRAILER = 3;
+      static const int STATE_DONE = 4;
+      static const int STATE_FAILED = 5;
+
+      static bool parseChunkSize(std::string_view line, std::uint64_t& size);
+
+      bool fill();
+      bool readLine(std::string_view& line);
+      int fail();
+
+      ByteConnection* m_connection;
+      std::string m_buffer;
+      std::size_t m_offset;
+      std::uint64_t m_remaining;   // in the current chunk, or the body
+      std::uint64_t m_bytesRead;
+      int m_state;
+      bool m_isChunked;
+
+      // disallow copies
+      HttpBodyReader(const HttpBodyReader&);
+      HttpBodyReader& operator=(const HttpBodyReader&);
+};
+
+}
+
+#endif
@@ -0,0 +1,254 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "HttpConditional.h"
+#include "HttpRequest.h"
+#include "HTTP.h"
+
+using namespace misere;
+
+static const std::string WEAK_PREFIX = "W/";
+
+// the three date formats of RFC 9110, section 5.6.7
+static const char* HTTP_DATE_FORMATS[] = {
+   "%a, %d %b %Y %H:%M:%S GMT",   // IMF-fixdate
+   "%A, %d-%b-%y %H:%M:%S GMT",   // RFC 850
+   "%a %b %d %H:%M:%S %Y"         // asctime
+};
+
+static const std::uint64_t PRIME64_1 = 0x9E3779B185EBCA87ULL;
+static const std::uint64_t PRIME64_2 = 0xC2B2AE3D27D4EB4FULL;
+static const std::uint64_t PRIME64_3 = 0x165667B19E3779F9ULL;
+static const std::uint64_t PRIME64_4 = 0x85EBCA77C2B2AE63ULL;
+static const std::uint64_t PRIME64_5 = 0x27D4EB2F165667C5ULL;
+
+namespace {
+
+inline std::uint64_t rotateLeft(std::uint64_t value, int bits) {
+   return (value << bits) | (value >> (64 - bits));
+}
+
+inline std::uint64_t read64(const char* p) {
+   std::uint64_t value;
+   ::memcpy(&value, p, sizeof(value));
+   return value;
+}
+
+inline std::uint32_t read32(const char* p) {
+   std::uint32_t value;
+   ::memcpy(&value, p, sizeof(value));
+   return value;
+}
+
+inline std::uint64_t round(std::uint64_t accumulator, std::uint64_t input) {
+   accumulator += input * PRIME64_2;
+   accumulator = rotateLeft(accumulator, 31);
+   return accumulator * PRIME64_1;
+}
+
+inline std::uint64_t mergeRound(std::uint64_t accumulator, std::uint64_t value) {
+   accumulator ^= round(0, value);
+   return accumulator * PRIME64_1 + PRIME64_4;
+}
+
+// the opaque-tag of an entity tag - the quoted part, without any W/
+std::string_view opaqueTag(std::string_view etag) {
+   if (etag.compare(0, WEAK_PREFIX.size(), WEAK_PREFIX) == 0) {
+      etag.remove_prefix(WEAK_PREFIX.size());
+   }
+   return etag;
+}
+
+bool isWhitespace(char c) {
+   return (c == ' ') || (c == '\t');
+}
+
+}
+
+//******************************************************************************
+
+std::uint64_t HttpConditional::hash(const char* data,
+                                    std::size_t length,
+                                    std::uint64_t seed) {
+   const char* p = data;
+   const char* end = data + length;
+   std::uint64_t h;
+
+   if (length >= 32) {
+      std::uint64_t v1 = seed + PRIME64_1 + PRIME64_2;
+      std::uint64_t v2 = seed + PRIME64_2;
+      std::uint64_t v3 = seed;
+      std::uint64_t v4 = seed - PRIME64_1;
+
+      const char* limit = end - 32;
+      do {
+         v1 = round(v1, read64(p));
+         v2 = round(v2, read64(p + 8));
+         v3 = round(v3, read64(p + 16));
+         v4 = round(v4, read64(p + 24));
+         p += 32;
+      } while (p <= limit);
+
+      h = rotateLeft(v1, 1) + rotateLeft(v2, 7) +
+          rotateLeft(v3, 12) + rotateLeft(v4, 18);
+      h = mergeRound(h, v1);
+      h = mergeRound(h, v2);
+      h = mergeRound(h, v3);
+      h = mergeRound(h, v4);
+   } else {
+      h = seed + PRIME64_5;
+   }
+
+   h += (std::uint64_t) length;
+
+   while (p + 8 <= end) {
+      h ^= round(0, read64(p));
+      h = rotateLeft(h, 27) * PRIME64_1 + PRIME64_4;
+      p += 8;
+   }
+
+   if (p + 4 <= end) {
+      h ^= (std::uint64_t) read32(p) * PRIME64_1;
+      h = rotateLeft(h, 23) * PRIME64_2 + PRIME64_3;
+      p += 4;
+   }
+
+   while (p < end) {
+      h ^= (unsigned char) *p * PRIME64_5;
+      h = rotateLeft(h, 11) * PRIME64_1;
+      ++p;
+   }
+
+   h ^= h >> 33;
+   h *= PRIME64_2;
+   h ^= h >> 29;
+   h *= PRIME64_3;
+   h ^= h >> 32;
+   return h;
+}
+
+//******************************************************************************
+
+std::string HttpConditional::hashETag(const char* data, std::size_t length) {
+   char etag[24];
+   const int etagLength =
+      ::snprintf(etag, sizeof(etag), "\"%016llx\"",
+                 (unsigned long long) hash(data, length));
+   return std::string(etag, etagLength);
+}
+
+//******************************************************************************
+
+std::string HttpConditional::weakETag(std::string_view etag) {
+   std::string weak = WEAK_PREFIX;
+   weak.append(opaqueTag(etag));
+   return weak;
+}
+
+//******************************************************************************
+
+bool HttpConditional::matchesIfNoneMatch(std::string_view ifNoneMatch,
+                                         std::string_view etag) {
+   if (etag.empty()) {
+      return false;
+   }
+
+   const std::string_view tag = opaqueTag(etag);
+   std::size_t i = 0;
+
+   while (i < ifNoneMatch.size()) {
+      // skip the list separators
+      while ((i < ifNoneMatch.size()) &&
+             (isWhitespace(ifNoneMatch[i]) || (ifNoneMatch[i] == ','))) {
+         ++i;
+      }
+
+      if (i >= ifNoneMatch.size()) {
+         break;
+      }
+
+      if (ifNoneMatch[i] == '*') {
+         return true;
+      }
+
+      if (ifNoneMatch.compare(i, WEAK_PREFIX.size(), WEAK_PREFIX) == 0) {
+         i += WEAK_PREFIX.size();
+      }
+
+      // an opaque-tag is quoted and can't contain a quote, but may
+      // contain a comma
+      if ((i >= ifNoneMatch.size()) || (ifNoneMatch[i] != '"')) {
+         return false;
+      }
+
+      const std::size_t close = ifNoneMatch.find('"', i + 1);
+      if (close == std::string_view::npos) {
+         return false;
+      }
+
+      if (ifNoneMatch.substr(i, close - i + 1) == tag) {
+         return true;
+      }
+
+      i = close + 1;
+   }
+
+   return false;
+}
+
+//******************************************************************************
+
+bool HttpConditional::parseHttpDate(std::string_view date, time_t& time) {
+   char text[64];
+   if (date.empty() || (date.size() >= sizeof(text))) {
+      return false;
+   }
+
+   ::memcpy(text, date.data(), date.size());
+   text[date.size()] = '\0';
+
+   for (const char* format : HTTP_DATE_FORMATS) {
+      struct tm gmt;
+      ::memset(&gmt, 0, sizeof(gmt));
+      const char* end = ::strptime(text, format, &gmt);
+      if ((end != nullptr) && (*end == '\0')) {
+         time = ::timegm(&gmt);
+         return true;
+      }
+   }
+
+   return false;
+}
+
+//******************************************************************************
+
+bool HttpConditional::isNotModified(const HttpRequest& request,
+                                    std::string_view etag,
+                                    std::string_view lastModified) {
+   // If-Modified-Since is only consulted without If-None-Match, as the
+   // entity tag is the more precise of the two
+   if (request.hasHeaderValue(HTTP::HTTP_IF_NONE_MATCH)) {
+      return matchesIfNoneMatch(request.getHeaderValue(HTTP::HTTP_IF_NONE_MATCH),
+                                etag);
+   }
+
+   if (lastModified.empty() ||
+       !request.hasHeaderValue(HTTP::HTTP_IF_MODIFIED_SINCE)) {
+      return false;
+   }
+
+   time_t modified;
+   time_t since;
+   if (!parseHttpDate(lastModified, modified) ||
+       !parseHttpDate(request.getHeaderValue(HTTP::HTTP_IF_MODIFIED_SINCE), since)) {
+      return false;
+   }
+
+   return modified <= since;
+}
+
+//******************************************************************************
@@ -0,0 +1,93 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef MISERE_HTTPCONDITIONAL_H
+#define MISERE_HTTPCONDITIONAL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <string_view>
+
+
+namespace misere
+{
+   class HttpRequest;
+
+/**
+ * HttpConditional evaluates conditional GET requests (RFC 9110, section
+ * 13) against a response's validators - its ETag and Last-Modified - so
+ * the server can answer 304 Not Modified instead of sending a body the
+ * client already has. It also makes strong ETags from response bodies.
+ */
+class HttpConditional
+{
+   public:
+      /**
+       * Hashes bytes with XXH64 - 8 bytes at a time in four independent
+       * lanes, so several GB/s rather than a byte per cycle
+       * @param data the bytes to hash
+       * @param length the number of bytes
+       * @param seed the hash seed
+       * @return the 64-bit hash
+       */
+      static std::uint64_t hash(const char* data,
+                                std::size_t length,
+                                std::uint64_t seed=0);
+
+      /**
+       * Makes a strong ETag from a body's contents
+       * @param data the body bytes
+       * @param length the number of body bytes
+       * @return the quoted entity tag (e.g., "\"5d2b4e9c0a1f3b77\"")
+       */
+      static std::string hashETag(const char* data, std::size_t length);
+
+      /**
+       * Retrieves the weak form of an entity tag - the form used once
+       * the body is re-encoded (e.g., compressed), as it no longer
+       * matches byte for byte
+       * @param etag the entity tag (strong or weak)
+       * @return the weak entity tag (W/"...")
+       */
+      static std::string weakETag(std::string_view etag);
+
+      /**
+       * Determines whether an If-None-Match field value lists an entity
+       * tag, using the weak comparison (W/ is ignored)
+       * @param ifNoneMatch the If-None-Match field value ("*" or a list
+       *        of entity tags)
+       * @param etag the response's entity tag
+       * @return boolean indicating whether the entity tag is listed
+       */
+      static bool matchesIfNoneMatch(std::string_view ifNoneMatch,
+                                     std::string_view etag);
+
+      /**
+       * Parses an HTTP date in any of the three formats recipients must
+       * accept (IMF-fixdate, RFC 850 and asctime)
+       * @param date the date text
+       * @param time receives the parsed time
+       * @return boolean indicating whether the date could be parsed
+       */
+      static bool parseHttpDate(std::string_view date, time_t& time);
+
+      /**
+       * Determines whether the client's copy of a response is current:
+       * If-None-Match, if present, decides; otherwise If-Modified-Since
+       * is compared with Last-Modified
+       * @param request the request with the conditional headers
+       * @param etag the response's ETag (empty if it has none)
+       * @param lastModified the response's Last-Modified (empty if it
+       *        has none)
+       * @return boolean indicating whether 304 Not Modified may be sent
+       */
+      static bool isNotModified(const HttpRequest& request,
+                                std::string_view etag,
+                                std::string_view lastModified);
+};
+
+}
+
+#endif
@@ -0,0 +1,77 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include <utility>
+
+#include "HttpConnectionArena.h"
+
+using namespace misere;
+
+//******************************************************************************
+
+HttpConnectionArena::ResetGuard::ResetGuard(HttpConnectionArena& arena) :
+   m_arena(arena) {
+}
+
+//******************************************************************************
+
+HttpConnectionArena::ResetGuard::~ResetGuard() {
+   m_arena.reset();
+}
+
+//******************************************************************************
+
+HttpConnectionArena::HttpConnectionArena() :
+   m_initialBlock(new char[INITIAL_BLOCK_SIZE]),
+   m_resource(m_initialBlock.get(), INITIAL_BLOCK_SIZE) {
+}
+
+//******************************************************************************
+
+HttpConnectionArena::~HttpConnectionArena() {
+}
+
+//******************************************************************************
+
+std::pmr::memory_resource* HttpConnectionArena::getResource() {
+   return &m_resource;
+}
+
+//******************************************************************************
+
+void HttpConnectionArena::reset() {
+   // frees any blocks obtained beyond the initial one and starts handing
+   // out the initial block from its beginning again
+   m_resource.release();
+}
+
+//******************************************************************************
+
+std::string HttpConnectionArena::takeReadBuffer() {
+   std::string buffer;
+
+   if (m_spareBuffer.capacity() >= READ_BUFFER_SIZE) {
+      buffer.swap(m_spareBuffer);
+      buffer.clear();
+   } else {
+      buffer.reserve(READ_BUFFER_SIZE);
+   }
+
+   return buffer;
+}
+
+//******************************************************************************
+
+void HttpConnectionArena::returnReadBuffer(std::string&& buffer) {
+   // keep the bigger of the two, within limits
+   if ((buffer.capacity() > MAX_RETAINED_BUFFER_SIZE) ||
+       (buffer.capacity() <= m_spareBuffer.capacity())) {
+      return;
+   }
+
+   m_spareBuffer = std::move(buffer);
+   m_spareBuffer.clear();
+}
+
+//******************************************************************************
+
@@ -0,0 +1,112 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef MISERE_HTTPCONNECTIONARENA_H
+#define MISERE_HTTPCONNECTIONARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <string>
+
+
+namespace misere
+{
+
+/**
+ * HttpConnectionArena holds the memory that request-scoped objects on a
+ * connection allocate from, so serving a request mostly doesn't go to
+ * the global allocator.
+ *
+ * It has two parts: a monotonic memory resource backed by one block
+ * allocated when the arena is created (the parser's header field list
+ * and the request's and response's header names and values live here),
+ * and a spare read buffer - the header buffer of the
+ * previous request, kept with its capacity so the next request on the
+ * connection reads into it rather than into a new string.
+ *
+ * reset() is called between requests, once nothing allocated from the
+ * resource is still alive; it releases everything in one step and
+ * rewinds to the start of the initial block.
+ */
+class HttpConnectionArena
+{
+   public:
+      /**
+       * ResetGuard resets an arena when it goes out of scope, so a request
+       * that ends in an exception still gives back what it allocated.
+       * Declare it before the objects allocating from the arena, so that
+       * they're destroyed first.
+       */
+      class ResetGuard
+      {
+         public:
+            explicit ResetGuard(HttpConnectionArena& arena);
+            ~ResetGuard();
+
+         private:
+            HttpConnectionArena& m_arena;
+
+            // disallow copies
+            ResetGuard(const ResetGuard&);
+            ResetGuard& operator=(const ResetGuard&);
+      };
+
+      /**
+       * Size of the block backing the memory resource
+       */
+      static const std::size_t INITIAL_BLOCK_SIZE = 4096;
+
+      /**
+       * Capacity a new read buffer is created with
+       */
+      static const std::size_t READ_BUFFER_SIZE = 8192;
+
+      /**
+       * Largest read buffer kept for reuse - a buffer that grew past this
+       * for one unusually large request is freed rather than held
+       */
+      static const std::size_t MAX_RETAINED_BUFFER_SIZE = 65536;
+
+      HttpConnectionArena();
+      ~HttpConnectionArena();
+
+      /**
+       * Retrieves the memory resource for request-scoped allocations
+       * @return the memory resource (valid until the arena is destroyed;
+       *         what is allocated from it is valid until reset())
+       */
+      std::pmr::memory_resource* getResource();
+
+      /**
+       * Releases everything allocated from the memory resource since the
+       * last reset. The spare read buffer is kept.
+       */
+      void reset();
+
+      /**
+       * Takes a read buffer - the spare one if there is one, otherwise a
+       * new one with READ_BUFFER_SIZE capacity
+       * @return an empty buffer
+       */
+      std::string takeReadBuffer();
+
+      /**
+       * Hands a read buffer back for reuse by the next takeReadBuffer()
+       * @param buffer the buffer (its contents are discarded)
+       */
+      void returnReadBuffer(std::string&& buffer);
+
+   private:
+      std::unique_ptr<char[]> m_initialBlock;
+      std::pmr::monotonic_buffer_resource m_resource;
+      std::string m_spareBuffer;
+
+      // disallow copies
+      HttpConnectionArena(const HttpConnectionArena&);
+      HttpConnectionArena& operator=(const HttpConnectionArena&);
+};
+
+}
+
+#endif
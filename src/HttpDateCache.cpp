@@ -0,0 +1,168 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+
+#include "HttpDateCache.h"
+
+using namespace misere;
+
+static const char* WEEKDAY_NAME[7] = {
+   "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"
+};
+
+static const char* MONTH_NAME[12] = {
+   "Jan", "Feb", "Mar", "Apr", "May", "Jun",
+   "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"
+};
+
+//******************************************************************************
+
+HttpDateCache::HttpDateCache() :
+   m_current(nullptr),
+   m_nextSnapshot(0),
+   m_isRunning(false) {
+   refresh();
+}
+
+//******************************************************************************
+
+HttpDateCache::~HttpDateCache() {
+   stop();
+}
+
+//******************************************************************************
+
+void HttpDateCache::start() {
+   std::lock_guard<std::mutex> lock(m_runMutex);
+   if (m_isRunning) {
+      return;
+   }
+
+   m_isRunning = true;
+   m_thread = std::thread(&HttpDateCache::run, this);
+}
+
+//******************************************************************************
+
+void HttpDateCache::stop() {
+   {
+      std::lock_guard<std::mutex> lock(m_runMutex);
+      if (!m_isRunning) {
+         return;
+      }
+      m_isRunning = false;
+   }
+
+   m_runCondition.notify_all();
+   if (m_thread.joinable()) {
+      m_thread.join();
+   }
+}
+
+//******************************************************************************
+
+void HttpDateCache::run() {
+   std::unique_lock<std::mutex> lock(m_runMutex);
+
+   while (m_isRunning) {
+      refresh();
+
+      // wake just after the next second boundary
+      const auto now = std::chrono::system_clock::now();
+      const auto nextSecond =
+         std::chrono::time_point_cast<std::chrono::seconds>(now) +
+         std::chrono::seconds(1) + std::chrono::milliseconds(1);
+      m_runCondition.wait_until(lock, nextSecond, [this]() {
+         return !m_isRunning;
+      });
+   }
+}
+
+//******************************************************************************
+
+void HttpDateCache::refresh() const {
+   const time_t now = ::time(nullptr);
+
+   std::lock_guard<std::mutex> lock(m_refreshMutex);
+
+   const Snapshot* latest = m_current.load(std::memory_order_acquire);
+   if ((nullptr != latest) && (latest->second == now)) {
+      return;
+   }
+
+   Snapshot& snapshot = m_snapshots[m_nextSnapshot];
+   m_nextSnapshot = (m_nextSnapshot + 1) % SNAPSHOT_COUNT;
+
+   struct tm local;
+   ::localtime_r(&now, &local);
+
+   snapshot.second = now;
+   snapshot.httpDateLength = formatHttpDate(now, snapshot.httpDate);
+
+   const int length = ::snprintf(snapshot.localDateTime, sizeof(snapshot.localDateTime),
+                                 "%d-%02d-%02d %.2d:%.2d:%.2d",
+                                 1900 + local.tm_year,
+                                 local.tm_mon + 1,
+                                 local.tm_mday,
+                                 local.tm_hour,
+                                 local.tm_min,
+                                 local.tm_sec);
+   snapshot.localDateTimeLength = (length > 0) ? (std::size_t) length : 0;
+
+   m_current.store(&snapshot, std::memory_order_release);
+}
+
+//******************************************************************************
+
+std::size_t HttpDateCache::formatHttpDate(time_t time, char* buffer) {
+   struct tm gmt;
+   ::gmtime_r(&time, &gmt);
+
+   const int length = ::snprintf(buffer, HTTP_DATE_LENGTH + 1,
+                                 "%.3s, %02d %.3s %d %.2d:%.2d:%.2d GMT",
+                                 WEEKDAY_NAME[gmt.tm_wday],
+                                 gmt.tm_mday,
+                                 MONTH_NAME[gmt.tm_mon],
+                                 1900 + gmt.tm_year,
+                                 gmt.tm_hour,
+                                 gmt.tm_min,
+                                 gmt.tm_sec);
+   return (length > 0) ? (std::size_t) length : 0;
+}
+
+//******************************************************************************
+
+const HttpDateCache::Snapshot* HttpDateCache::current() const {
+   if (!m_isRunning.load(std::memory_order_relaxed)) {
+      refresh();
+   }
+
+   return m_current.load(std::memory_order_acquire);
+}
+
+//******************************************************************************
+
+std::string HttpDateCache::getHttpDate() const {
+   const Snapshot* snapshot = current();
+   return std::string(snapshot->httpDate, snapshot->httpDateLength);
+}
+
+//******************************************************************************
+
+std::size_t HttpDateCache::copyHttpDate(char* buffer) const {
+   const Snapshot* snapshot = current();
+   ::memcpy(buffer, snapshot->httpDate, snapshot->httpDateLength);
+   return snapshot->httpDateLength;
+}
+
+//******************************************************************************
+
+std::string HttpDateCache::getLocalDateTime() const {
+   const Snapshot* snapshot = current();
+   return std::string(snapshot->localDateTime, snapshot->localDateTimeLength);
+}
+
+//******************************************************************************
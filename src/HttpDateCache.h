@@ -0,0 +1,128 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef MISERE_HTTPDATECACHE_H
+#define MISERE_HTTPDATECACHE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <ctime>
+#include <mutex>
+#include <string>
+#include <thread>
+
+
+namespace misere
+{
+
+/**
+ * HttpDateCache keeps the current time pre-rendered in the two formats
+ * the server emits - the HTTP Date header ("Sun, 06 Nov 1994 08:49:37
+ * GMT") and the local date/time used in access log lines ("1994-11-06
+ * 03:49:37") - so the request path copies bytes instead of formatting.
+ *
+ * Once start() has been called, a background thread re-renders both
+ * strings at each second boundary into the next of a small ring of
+ * snapshots and then publishes it with an atomic pointer swap; readers
+ * only ever load that pointer and copy. A snapshot is not rewritten
+ * until the ring wraps, several seconds later, so a reader is never
+ * still copying one that's being overwritten.
+ *
+ * If the refresh thread isn't running (e.g. a server that was
+ * constructed but never run), readers refresh the cache themselves
+ * when the second has changed.
+ */
+class HttpDateCache
+{
+   public:
+      /**
+       * Length of a rendered HTTP date ("Sun, 06 Nov 1994 08:49:37 GMT")
+       */
+      static const std::size_t HTTP_DATE_LENGTH = 29;
+
+      HttpDateCache();
+
+      /**
+       * Destructor. Stops the refresh thread if it is running.
+       */
+      ~HttpDateCache();
+
+      /**
+       * Starts the background thread that refreshes the cache every
+       * second. Calling it again while it's running has no effect.
+       */
+      void start();
+
+      /**
+       * Stops the refresh thread, if running
+       */
+      void stop();
+
+      /**
+       * Re-renders the cached strings if the current second differs from
+       * the cached one
+       */
+      void refresh() const;
+
+      /**
+       * Retrieves the current time formatted for the HTTP Date header
+       * @return the current time in GMT (RFC 7231 IMF-fixdate format)
+       */
+      std::string getHttpDate() const;
+
+      /**
+       * Copies the current HTTP date into a caller-supplied buffer
+       * @param buffer destination of at least HTTP_DATE_LENGTH bytes (not
+       *        null-terminated)
+       * @return number of bytes copied
+       */
+      std::size_t copyHttpDate(char* buffer) const;
+
+      /**
+       * Renders a time in the HTTP date format (RFC 7231 IMF-fixdate)
+       * @param time the time to render
+       * @param buffer destination of at least HTTP_DATE_LENGTH + 1 bytes
+       *        (null-terminated)
+       * @return number of bytes rendered (not counting the terminator)
+       */
+      static std::size_t formatHttpDate(time_t time, char* buffer);
+
+      /**
+       * Retrieves the current local date/time as used in access logs
+       * @return the local date/time ("YYYY-MM-DD HH:MM:SS")
+       */
+      std::string getLocalDateTime() const;
+
+   private:
+      struct Snapshot
+      {
+         time_t second;
+         char httpDate[HTTP_DATE_LENGTH + 1];
+         std::size_t httpDateLength;
+         char localDateTime[32];
+         std::size_t localDateTimeLength;
+      };
+
+      static const int SNAPSHOT_COUNT = 4;
+
+      const Snapshot* current() const;
+      void run();
+
+      mutable Snapshot m_snapshots[SNAPSHOT_COUNT];
+      mutable std::atomic<const Snapshot*> m_current;
+      mutable int m_nextSnapshot;
+      mutable std::mutex m_refreshMutex;
+      std::thread m_thread;
+      std::mutex m_runMutex;
+      std::condition_variable m_runCondition;
+      std::atomic<bool> m_isRunning;
+
+      // disallow copies
+      HttpDateCache(const HttpDateCache&);
+      HttpDateCache& operator=(const HttpDateCache&);
+};
+
+}
+
+#endif
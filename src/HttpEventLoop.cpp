@@ -0,0 +1,818 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include <string.h>
+#include <time.h>
+
+#include <string>
+#include <utility>
+
+#if defined(__linux__)
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#endif
+
+#include "HttpEventLoop.h"
+#include "HttpServer.h"
+#include "HttpRequest.h"
+#include "HttpRequestHandler.h"
+#include "HttpConnectionArena.h"
+#include "HttpHeaderParser.h"
+#include "HttpBodyReader.h"
+#include "ByteConnection.h"
+#include "Runnable.h"
+#include "ThreadPoolDispatcher.h"
+#include "BasicException.h"
+#include "Logger.h"
+#include "StrUtils.h"
+
+static const int MAX_EVENTS                 = 256;
+static const int LOOP_TICK_MILLIS           = 1000;
+static const int READ_CHUNK_SIZE            = 8192;
+
+// how long a freshly accepted connection may sit idle before sending its
+// first request (follow-up requests use keep_alive_timeout instead)
+static const int FIRST_REQUEST_TIMEOUT_SECS = 30;
+
+// a response that has produced this much unsent output (a streamed body)
+// is written out by the worker itself, waiting for the socket to drain,
+// rather than accumulating for the loop thread to send
+static const std::size_t OUTPUT_HIGH_WATER  = 256 * 1024;
+
+// how long that worker waits for a peer that has stopped reading
+static const int OUTPUT_WAIT_MILLIS         = 30 * 1000;
+
+// epoll_event.data.ptr values identifying the two non-connection fds
+static int LISTENER_TAG;
+static int WAKEUP_TAG;
+
+using namespace misere;
+using namespace chaudiere;
+
+namespace misere
+{
+
+/**
+ * HttpEventConnection is the loop's per-connection state. It is also the
+ * ByteConnection the HTTP layer sees while servicing the connection:
+ * requests are only ever parsed once they're completely buffered, so
+ * read() has nothing to offer, and write() appends to the output buffer
+ * that the loop thread later drains to the non-blocking socket.
+ */
+class HttpEventConnection : public ByteConnection
+{
+   public:
+      explicit HttpEventConnection(int fd) :
+         m_fd(fd),
+         outputOffset(0),
+         requestCount(0),
+         closeAfterWrite(false),
+         lastActivity(0) {
+      }
+
+      virtual ~HttpEventConnection() {
+#if defined(__linux__)
+         if (m_fd > -1) {
+            ::close(m_fd);
+         }
+#endif
+      }
+
+      virtual int read(char*, int) {
+         return 0;
+      }
+
+      virtual bool buffersWholeRequests() const {
+         return true;
+      }
+
+      virtual int getSocketDescriptor() const {
+         return m_fd;
+      }
+
+      virtual bool write(const char* buffer, std::size_t length) {
+         output.append(buffer, length);
+         return (output.size() - outputOffset <= OUTPUT_HIGH_WATER) ||
+                drainOutput();
+      }
+
+      // grow the output buffer once for the whole response
+      virtual bool writev(const Segment* segments, std::size_t count) {
+         std::size_t length = output.size();
+         for (std::size_t i = 0; i < count; ++i) {
+            length += segments[i].length;
+         }
+         output.reserve(length);
+
+         for (std::size_t i = 0; i < count; ++i) {
+            output.append(segments[i].data, segments[i].length);
+         }
+         return (output.size() - outputOffset <= OUTPUT_HIGH_WATER) ||
+                drainOutput();
+      }
+
+      // Sends all pending output from the servicing thread, waiting for
+      // the socket to become writable as needed. Safe because the
+      // connection isn't armed in epoll while a request is serviced.
+      bool drainOutput() {
+#if defined(__linux__)
+         while (hasPendingOutput()) {
+            const ssize_t bytesWritten =
+               ::send(m_fd,
+                      output.data() + outputOffset,
+                      output.size() - outputOffset,
+                      MSG_NOSIGNAL);
+
+            if (bytesWritten > 0) {
+               outputOffset += bytesWritten;
+            } else if ((bytesWritten < 0) && (errno == EINTR)) {
+               continue;
+            } else if ((bytesWritten < 0) &&
+                       ((errno == EAGAIN) || (errno == EWOULDBLOCK))) {
+               struct pollfd pfd;
+               pfd.fd = m_fd;
+               pfd.events = POLLOUT;
+               pfd.revents = 0;
+               const int ready = ::poll(&pfd, 1, OUTPUT_WAIT_MILLIS);
+               if ((ready == 0) || ((ready < 0) && (errno != EINTR))) {
+                  return false;
+               }
+            } else {
+               return false;
+            }
+         }
+
+         output.clear();
+         outputOffset = 0;
+#endif
+         return true;
+      }
+
+      virtual void close() {
+         closeAfterWrite = true;
+      }
+
+      int fd() const {
+         return m_fd;
+      }
+
+      bool hasPendingOutput() const {
+         return outputOffset < output.size();
+      }
+
+   private:
+      int m_fd;
+
+   public:
+      std::string input;
+      HttpHeaderParser framer;   // scans input for the next request's headers
+      HttpBodyReader::ChunkScan chunkScan;   // and through its chunked body
+      std::string output;
+      std::size_t outputOffset;
+      int requestCount;
+      bool closeAfterWrite;
+      time_t lastActivity;
+
+   private:
+      // disallow copies
+      HttpEventConnection(const HttpEventConnection&);
+      HttpEventConnection& operator=(const HttpEventConnection&);
+};
+
+}
+
+namespace
+{
+
+/**
+ * Runnable handed to the thread pool for a connection with at least one
+ * complete request buffered.
+ */
+class HttpEventRequest : public Runnable
+{
+   public:
+      HttpEventRequest(HttpEventLoop& loop, HttpEventConnection* connection) :
+         m_loop(loop),
+         m_connection(connection) {
+      }
+
+      virtual void run() {
+         m_loop.serviceConnection(m_connection);
+         m_loop.requestComplete(m_connection);
+      }
+
+   private:
+      HttpEventLoop& m_loop;
+      HttpEventConnection* m_connection;
+};
+
+/**
+ * Determines whether the connection's input holds at least one complete
+ * request. The connection's framer and chunk scan are resumed from where
+ * the previous call stopped, so bytes are scanned for the end of the
+ * headers or of a chunked body only once no matter how many reads the
+ * request arrives in. A request whose
+ * body is over the server's limit is dispatched as soon as its headers
+ * are in, to be refused rather than buffered.
+ */
+bool haveCompleteRequest(HttpEventConnection* connection, long maxBodySize) {
+   return HttpRequestHandler::haveCompleteRequest(connection->input,
+                                                  connection->framer,
+                                                  connection->chunkScan,
+                                                  maxBodySize);
+}
+
+}
+
+//******************************************************************************
+
+bool HttpEventLoop::isSupportedPlatform() {
+#if defined(__linux__)
+   return true;
+#else
+   return false;
+#endif
+}
+
+//******************************************************************************
+
+HttpEventLoop::HttpEventLoop(HttpServer& server,
+                             ThreadPoolDispatcher* dispatcher) :
+   m_server(server),
+   m_dispatcher(dispatcher),
+   m_epollFD(-1),
+   m_wakeupFD(-1),
+   m_isDone(false),
+   m_isDraining(false),
+   m_busyCount(0) {
+   LOG_INSTANCE_CREATE("HttpEventLoop")
+}
+
+//******************************************************************************
+
+HttpEventLoop::~HttpEventLoop() {
+   LOG_INSTANCE_DESTROY("HttpEventLoop")
+
+   for (HttpEventConnection* connection : m_connections) {
+      delete connection;
+   }
+
+#if defined(__linux__)
+   if (m_wakeupFD > -1) {
+      ::close(m_wakeupFD);
+   }
+
+   if (m_epollFD > -1) {
+      ::close(m_epollFD);
+   }
+#endif
+}
+
+//******************************************************************************
+
+#if defined(__linux__)
+
+bool HttpEventLoop::init(int port, bool reusePort, int listenerFD) {
+   m_epollFD = ::epoll_create1(EPOLL_CLOEXEC);
+   if (m_epollFD < 0) {
+      LOG_CRITICAL("event loop: unable to create epoll instance")
+      return false;
+   }
+
+   m_wakeupFD = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+   if (m_wakeupFD < 0) {
+      LOG_CRITICAL("event loop: unable to create wakeup eventfd")
+      return false;
+   }
+
+   if (listenerFD > -1) {
+      m_listener.adopt(listenerFD, true);
+   } else if (!m_listener.open(port, reusePort, true)) {
+      return false;
+   }
+
+   // the listener stays level-triggered - acceptConnections() drains the
+   // backlog on every wakeup regardless
+   struct epoll_event ev;
+   ::memset(&ev, 0, sizeof(ev));
+   ev.events = EPOLLIN;
+   ev.data.ptr = &LISTENER_TAG;
+   if (::epoll_ctl(m_epollFD, EPOLL_CTL_ADD, m_listener.getFileDescriptor(), &ev) < 0) {
+      LOG_CRITICAL("event loop: unable to register listening socket")
+      return false;
+   }
+
+   ev.events = EPOLLIN;
+   ev.data.ptr = &WAKEUP_TAG;
+   if (::epoll_ctl(m_epollFD, EPOLL_CTL_ADD, m_wakeupFD, &ev) < 0) {
+      LOG_CRITICAL("event loop: unable to register wakeup eventfd")
+      return false;
+   }
+
+   return true;
+}
+
+//******************************************************************************
+
+int HttpEventLoop::run() {
+   if ((m_epollFD < 0) || (m_listener.getFileDescriptor() < 0)) {
+      LOG_CRITICAL("event loop run called before successful init")
+      return 1;
+   }
+
+   struct epoll_event events[MAX_EVENTS];
+   time_t lastSweep = ::time(nullptr);
+   time_t drainDeadline = 0;
+
+   // once stopped, keep going only until every connection out with a
+   // pool worker has been handed back - the workers still reference them
+   while (!m_isDone || (m_busyCount > 0)) {
+      const int eventCount =
+         ::epoll_wait(m_epollFD, events, MAX_EVENTS, LOOP_TICK_MILLIS);
+
+      if (eventCount < 0) {
+         if (errno == EINTR) {
+            continue;
+         }
+         LOG_CRITICAL("event loop: epoll_wait failed")
+         return 1;
+      }
+
+      for (int i = 0; i < eventCount; ++i) {
+         void* tag = events[i].data.ptr;
+
+         if (tag == &LISTENER_TAG) {
+            if (!m_isDone) {
+               acceptConnections();
+            }
+         } else if (tag == &WAKEUP_TAG) {
+            eventfd_t value;
+            ::eventfd_read(m_wakeupFD, &value);
+            processCompletions();
+         } else {
+            handleEvent(static_cast<HttpEventConnection*>(tag),
+                        events[i].events);
+         }
+      }
+
+      const time_t now = ::time(nullptr);
+      if (now != lastSweep) {
+         sweepIdleConnections();
+         lastSweep = now;
+      }
+
+      if (!m_isDraining && m_server.isDraining()) {
+         drainDeadline = now + m_server.shutdownTimeoutSecs();
+         beginDrain();
+      }
+
+      if (m_isDraining && (m_connections.empty() || (now >= drainDeadline))) {
+         m_isDone = true;
+      }
+   }
+
+   return 0;
+}
+
+//******************************************************************************
+
+void HttpEventLoop::stop() {
+   m_isDone = true;
+   if (m_wakeupFD > -1) {
+      ::eventfd_write(m_wakeupFD, 1);
+   }
+}
+
+//******************************************************************************
+
+void HttpEventLoop::acceptConnections() {
+   const int sendBufferSize = m_server.getSocketSendBufferSize();
+   const int receiveBufferSize = m_server.getSocketReceiveBufferSize();
+
+   for (;;) {
+      const int fd = ::accept4(m_listener.getFileDescriptor(),
+                               nullptr,
+                               nullptr,
+                               SOCK_NONBLOCK | SOCK_CLOEXEC);
+      if (fd < 0) {
+         if ((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR)) {
+            LOG_ERROR("event loop: accept failed: " + std::string(::strerror(errno)))
+         }
+         return;
+      }
+
+      int enable = 1;
+      ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+      ::setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &sendBufferSize, sizeof(sendBufferSize));
+      ::setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &receiveBufferSize, sizeof(receiveBufferSize));
+
+      HttpEventConnection* connection = new HttpEventConnection(fd);
+      connection->lastActivity = ::time(nullptr);
+
+      struct epoll_event ev;
+      ::memset(&ev, 0, sizeof(ev));
+      ev.events = EPOLLIN | EPOLLRDHUP | EPOLLET | EPOLLONESHOT;
+      ev.data.ptr = connection;
+
+      if (::epoll_ctl(m_epollFD, EPOLL_CTL_ADD, fd, &ev) < 0) {
+         LOG_ERROR("event loop: unable to register connection")
+         delete connection;
+         continue;
+      }
+
+      m_connections.insert(connection);
+      m_idleConnections.insert(connection);
+   }
+}
+
+//******************************************************************************
+
+void HttpEventLoop::beginDrain() {
+   m_isDraining = true;
+
+   // the listener stays open (another process may have taken it over),
+   // it just isn't accepted from any more
+   ::epoll_ctl(m_epollFD, EPOLL_CTL_DEL, m_listener.getFileDescriptor(), nullptr);
+
+   // a connection that has had its responses and is waiting for a next
+   // request can go now; one that's still to send its first is answered
+   std::vector<HttpEventConnection*> waiting;
+   for (HttpEventConnection* connection : m_idleConnections) {
+      if ((connection->requestCount > 0) && connection->input.empty()) {
+         waiting.push_back(connection);
+      }
+   }
+
+   for (HttpEventConnection* connection : waiting) {
+      closeConnection(connection);
+   }
+}
+
+//******************************************************************************
+
+void HttpEventLoop::handleEvent(HttpEventConnection* connection,
+                                unsigned int events) {
+   m_idleConnections.erase(connection);
+   m_writingConnections.erase(connection);
+
+   if (events & EPOLLOUT) {
+      if (!flushOutput(connection)) {
+         closeConnection(connection);
+         return;
+      }
+
+      if (connection->hasPendingOutput()) {
+         waitToWrite(connection);
+         return;
+      }
+
+      if (connection->closeAfterWrite) {
+         closeConnection(connection);
+         return;
+      }
+   }
+
+   if (events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+      // edge-triggered: drain everything available now, reading straight
+      // into the tail of the connection's buffer
+      bool peerOpen = true;
+
+      for (;;) {
+         const std::size_t used = connection->input.size();
+         connection->input.resize(used + READ_CHUNK_SIZE);
+         const ssize_t bytesRead = ::read(connection->fd(),
+                                          &connection->input[used],
+                                          READ_CHUNK_SIZE);
+
+         if (bytesRead > 0) {
+            connection->input.resize(used + bytesRead);
+            continue;
+         }
+
+         connection->input.resize(used);
+
+         if ((bytesRead < 0) && (errno == EINTR)) {
+            continue;
+         }
+
+         if ((bytesRead < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK))) {
+            break;
+         }
+
+         // orderly close (0) or hard error
+         peerOpen = false;
+         break;
+      }
+
+      if (!peerOpen) {
+         if (!haveCompleteRequest(connection, m_server.maxRequestBodySize())) {
+            closeConnection(connection);
+            return;
+         }
+
+         // answer what was sent before the peer's half-close, then close
+         connection->closeAfterWrite = true;
+      }
+
+      connection->lastActivity = ::time(nullptr);
+   }
+
+   serviceOrWait(connection);
+}
+
+//******************************************************************************
+
+void HttpEventLoop::serviceOrWait(HttpEventConnection* connection) {
+   if (haveCompleteRequest(connection, m_server.maxRequestBodySize())) {
+      dispatch(connection);
+      return;
+   }
+
+   // while draining, a connection isn't kept for a next request
+   if (connection->closeAfterWrite ||
+       (m_isDraining &&
+        (connection->requestCount > 0) &&
+        connection->input.empty())) {
+      closeConnection(connection);
+      return;
+   }
+
+   if ((connection->input.size() > HttpHeaderParser::MAX_HEADER_LENGTH) &&
+       !connection->framer.isComplete()) {
+      LOG_WARNING("event loop: request headers too large, closing connection")
+      closeConnection(connection);
+      return;
+   }
+
+   if (!arm(connection, EPOLLIN)) {
+      closeConnection(connection);
+      return;
+   }
+
+   m_idleConnections.insert(connection);
+}
+
+//******************************************************************************
+
+void HttpEventLoop::dispatch(HttpEventConnection* connection) {
+   if (nullptr != m_dispatcher) {
+      HttpEventRequest* request = new HttpEventRequest(*this, connection);
+      request->setAutoDelete();
+      ++m_busyCount;
+
+      if (m_dispatcher->addRequest(request)) {
+         return;
+      }
+
+      --m_busyCount;
+      delete request;
+      LOG_WARNING("event loop: unable to add request to thread pool, servicing inline")
+   }
+
+   serviceConnection(connection);
+   afterService(connection);
+}
+
+//******************************************************************************
+
+void HttpEventLoop::afterService(HttpEventConnection* connection) {
+   if (!flushOutput(connection)) {
+      closeConnection(connection);
+      return;
+   }
+
+   if (connection->hasPendingOutput()) {
+      // the socket's send buffer is full - finish writing before reading
+      // (and therefore servicing) anything else on this connection
+      waitToWrite(connection);
+      return;
+   }
+
+   if (connection->closeAfterWrite) {
+      closeConnection(connection);
+      return;
+   }
+
+   connection->lastActivity = ::time(nullptr);
+   serviceOrWait(connection);
+}
+
+//******************************************************************************
+
+void HttpEventLoop::requestComplete(HttpEventConnection* connection) {
+   {
+      std::lock_guard<std::mutex> lock(m_completedMutex);
+      m_completed.push_back(connection);
+   }
+
+   ::eventfd_write(m_wakeupFD, 1);
+}
+
+//******************************************************************************
+
+void HttpEventLoop::processCompletions() {
+   std::vector<HttpEventConnection*> completed;
+
+   {
+      std::lock_guard<std::mutex> lock(m_completedMutex);
+      completed.swap(m_completed);
+   }
+
+   for (HttpEventConnection* connection : completed) {
+      --m_busyCount;
+      afterService(connection);
+   }
+}
+
+//******************************************************************************
+
+void HttpEventLoop::sweepIdleConnections() {
+   const time_t now = ::time(nullptr);
+   const int keepAliveTimeoutSecs = m_server.keepAliveTimeoutSecs();
+   std::vector<HttpEventConnection*> expired;
+
+   for (HttpEventConnection* connection : m_idleConnections) {
+      const int timeoutSecs = (connection->requestCount == 0) ?
+         FIRST_REQUEST_TIMEOUT_SECS : keepAliveTimeoutSecs;
+
+      if ((now - connection->lastActivity) >= timeoutSecs) {
+         expired.push_back(connection);
+      }
+   }
+
+   // a peer that has stopped reading would otherwise hold its fd and
+   // its unsent output for good
+   for (HttpEventConnection* connection : m_writingConnections) {
+      if ((now - connection->lastActivity) >= keepAliveTimeoutSecs) {
+         expired.push_back(connection);
+      }
+   }
+
+   for (HttpEventConnection* connection : expired) {
+      closeConnection(connection);
+   }
+}
+
+//******************************************************************************
+
+bool HttpEventLoop::flushOutput(HttpEventConnection* connection) {
+   while (connection->hasPendingOutput()) {
+      const ssize_t bytesWritten =
+         ::send(connection->fd(),
+                connection->output.data() + connection->outputOffset,
+                connection->output.size() - connection->outputOffset,
+                MSG_NOSIGNAL);
+
+      if (bytesWritten > 0) {
+         connection->outputOffset += bytesWritten;
+         connection->lastActivity = ::time(nullptr);
+      } else if ((bytesWritten < 0) && (errno == EINTR)) {
+         continue;
+      } else if ((bytesWritten < 0) &&
+                 ((errno == EAGAIN) || (errno == EWOULDBLOCK))) {
+         return true;
+      } else {
+         return false;
+      }
+   }
+
+   connection->output.clear();
+   connection->outputOffset = 0;
+   return true;
+}
+
+//******************************************************************************
+
+void HttpEventLoop::waitToWrite(HttpEventConnection* connection) {
+   if (!arm(connection, EPOLLOUT)) {
+      closeConnection(connection);
+      return;
+   }
+
+   m_writingConnections.insert(connection);
+}
+
+//******************************************************************************
+
+bool HttpEventLoop::arm(HttpEventConnection* connection, unsigned int events) {
+   struct epoll_event ev;
+   ::memset(&ev, 0, sizeof(ev));
+   ev.events = events | EPOLLRDHUP | EPOLLET | EPOLLONESHOT;
+   ev.data.ptr = connection;
+   return ::epoll_ctl(m_epollFD, EPOLL_CTL_MOD, connection->fd(), &ev) == 0;
+}
+
+//******************************************************************************
+
+#else
+
+bool HttpEventLoop::init(int, bool, int) {
+   LOG_CRITICAL("event loop is not supported on this platform")
+   return false;
+}
+
+int HttpEventLoop::run() {
+   return 1;
+}
+
+void HttpEventLoop::stop() {
+   m_isDone = true;
+}
+
+void HttpEventLoop::requestComplete(HttpEventConnection*) {
+}
+
+#endif
+
+//******************************************************************************
+
+int HttpEventLoop::getListenerFileDescriptor() const {
+   return m_listener.getFileDescriptor();
+}
+
+//******************************************************************************
+
+void HttpEventLoop::serviceConnection(HttpEventConnection* connection) {
+   // a request is served start to finish on one worker thread, so the
+   // arena belongs to the thread rather than to each (possibly idle)
+   // connection
+   static thread_local HttpConnectionArena arena;
+
+   while (!connection->closeAfterWrite &&
+          haveCompleteRequest(connection, m_server.maxRequestBodySize())) {
+      ++connection->requestCount;
+
+      try {
+         // the whole request is already buffered, so constructing it
+         // never calls read() on the connection - anything past this
+         // request is handed straight back for the next iteration
+         {
+            // nothing allocated from the arena outlives this block, even
+            // if the request throws
+            HttpConnectionArena::ResetGuard arenaReset(arena);
+            HttpRequest request(connection, false,
+                                std::move(connection->input), &arena);
+
+            if (!request.isInitialized() ||
+                !HttpRequestHandler::processRequest(m_server,
+                                                    request,
+                                                    *connection,
+                                                    connection->requestCount)) {
+               connection->closeAfterWrite = true;
+            }
+
+            // the body is already buffered in full, so skipping what the
+            // handler left of it never reads - unless it was too large to
+            // wait for, which fails here and closes the connection
+            if (!request.finishBody()) {
+               connection->closeAfterWrite = true;
+            }
+
+            connection->input = request.takeUnconsumedBytes();
+            connection->framer.reset();
+            connection->chunkScan.reset();
+         }
+
+         // the request handed its buffer to the arena - give it back to
+         // the connection to read the next request into
+         if (connection->input.empty()) {
+            connection->input = arena.takeReadBuffer();
+         }
+      } catch (const BasicException& be) {
+         if (connection->requestCount == 1) {
+            LOG_ERROR("exception parsing request: " + be.whatString())
+         }
+         connection->closeAfterWrite = true;
+      } catch (const std::exception& e) {
+         if (connection->requestCount == 1) {
+            LOG_ERROR(std::string("exception parsing request: ") + e.what())
+         }
+         connection->closeAfterWrite = true;
+      } catch (...) {
+         if (connection->requestCount == 1) {
+            LOG_ERROR("unknown exception parsing request")
+         }
+         connection->closeAfterWrite = true;
+      }
+   }
+}
+
+//******************************************************************************
+
+void HttpEventLoop::closeConnection(HttpEventConnection* connection) {
+   m_idleConnections.erase(connection);
+   m_writingConnections.erase(connection);
+   m_connections.erase(connection);
+
+   // closing the (never dup'ed) fd also removes it from the epoll set
+   delete connection;
+}
+
+//******************************************************************************
@@ -0,0 +1,164 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef MISERE_HTTPEVENTLOOP_H
+#define MISERE_HTTPEVENTLOOP_H
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "ListeningSocket.h"
+
+namespace chaudiere
+{
+   class ThreadPoolDispatcher;
+}
+
+namespace misere
+{
+
+class HttpServer;
+class HttpEventConnection;
+
+/**
+ * HttpEventLoop is misere's own edge-triggered epoll event loop, used when
+ * the server is configured with "sockets = event_loop". Unlike
+ * "kernel_events" (chaudiere's KernelEventServer, which only detects
+ * readability and then hands the socket to an HttpRequestHandler that
+ * blocks a pool thread for the rest of the connection), every connection
+ * here is a non-blocking state machine owned by the loop: read whatever
+ * is available into the connection's buffer, and once a complete request
+ * is buffered, dispatch it (to the thread pool if there is one, inline
+ * otherwise), buffer the response, write as much as the socket accepts,
+ * and go back to waiting. An idle keep-alive connection costs an epoll
+ * registration and its buffers - never a thread. A connection whose
+ * peer stops reading its responses is closed once keep_alive_timeout
+ * passes without any of its output being sent.
+ *
+ * Threading: only the loop thread ever calls epoll_ctl(), changes a
+ * connection's registration or deletes a connection. A pool worker
+ * servicing a connection owns it exclusively (the connection is
+ * registered EPOLLONESHOT, so no further events for it are delivered
+ * while it's out) and hands it back via requestComplete() when done.
+ *
+ * With "sockets = reuseport_reactors", HttpServer runs several loops,
+ * each on its own thread with its own SO_REUSEPORT listener and no
+ * dispatcher, so accepting, parsing and servicing all happen on that one
+ * thread and no queue or lock is shared between reactors.
+ *
+ * When the server starts draining (HttpServer::shutdown()), the loop stops
+ * accepting, closes the connections waiting for a request, and lets each
+ * of the others finish the request it's on (answered with "Connection:
+ * close"), returning once they're all gone or shutdown_timeout runs out.
+ *
+ * Linux only (epoll) - see isSupportedPlatform(). TLS is not supported
+ * on this path; HttpServer falls back to socket_server when both are
+ * configured.
+ */
+class HttpEventLoop
+{
+   public:
+      /**
+       * Determines whether the event loop is available on this platform
+       * @return boolean indicating if the platform supports the event loop
+       */
+      static bool isSupportedPlatform();
+
+      /**
+       * Constructs an event loop for the specified server
+       * @param server the HttpServer whose handlers and settings are used
+       * @param dispatcher thread pool that complete requests are handed to,
+       *        or nullptr to service requests inline on the loop thread
+       */
+      HttpEventLoop(HttpServer& server, chaudiere::ThreadPoolDispatcher* dispatcher);
+
+      /**
+       * Destructor. Closes the listening socket and any connections still
+       * owned by the loop.
+       */
+      ~HttpEventLoop();
+
+      /**
+       * Creates the epoll instance and the non-blocking listening socket
+       * @param port the port number to listen on
+       * @param reusePort whether the listening socket is one of several
+       *        SO_REUSEPORT sockets on the same port (one per reactor)
+       * @param listenerFD a socket already listening on the port to use
+       *        instead (e.g., handed over by the process this one
+       *        replaces), or -1 to open one
+       * @return boolean indicating whether initialization succeeded
+       */
+      bool init(int port, bool reusePort, int listenerFD=-1);
+
+      /**
+       * Retrieves the listening socket's file descriptor
+       * @return the file descriptor, or -1 if not listening
+       */
+      int getListenerFileDescriptor() const;
+
+      /**
+       * Runs the loop until stop() is called
+       * @return exit code for the HTTP server process
+       */
+      int run();
+
+      /**
+       * Asks the loop to exit. Safe to call from any thread.
+       */
+      void stop();
+
+      /**
+       * Parses and services every complete request currently buffered on
+       * the connection, buffering the responses. Called by the pool worker
+       * the connection was dispatched to (or inline by the loop thread).
+       * @param connection the connection to service
+       */
+      void serviceConnection(HttpEventConnection* connection);
+
+      /**
+       * Hands a serviced connection back to the loop thread, which writes
+       * out its buffered responses and re-arms it. Safe to call from any
+       * thread.
+       * @param connection the connection that was serviced
+       */
+      void requestComplete(HttpEventConnection* connection);
+
+   private:
+      void acceptConnections();
+      void beginDrain();
+      void handleEvent(HttpEventConnection* connection, unsigned int events);
+      void serviceOrWait(HttpEventConnection* connection);
+      void dispatch(HttpEventConnection* connection);
+      void afterService(HttpEventConnection* connection);
+      void processCompletions();
+      void sweepIdleConnections();
+      bool flushOutput(HttpEventConnection* connection);
+      void waitToWrite(HttpEventConnection* connection);
+      bool arm(HttpEventConnection* connection, unsigned int events);
+      void closeConnection(HttpEventConnection* connection);
+
+      HttpServer& m_server;
+      chaudiere::ThreadPoolDispatcher* m_dispatcher;
+      int m_epollFD;
+      ListeningSocket m_listener;
+      int m_wakeupFD;
+      std::atomic<bool> m_isDone;
+      bool m_isDraining;
+      std::unordered_set<HttpEventConnection*> m_connections;
+      std::unordered_set<HttpEventConnection*> m_idleConnections;
+      std::unordered_set<HttpEventConnection*> m_writingConnections;
+      std::mutex m_completedMutex;
+      std::vector<HttpEventConnection*> m_completed;
+      int m_busyCount;
+
+      // disallow copies
+      HttpEventLoop(const HttpEventLoop&);
+      HttpEventLoop& operator=(const HttpEventLoop&);
+};
+
+}
+
+#endif
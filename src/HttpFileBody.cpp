@@ -0,0 +1,64 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "HttpFileBody.h"
+
+using namespace misere;
+
+//******************************************************************************
+
+HttpFileBody::HttpFileBody(int fd, off_t offset, std::size_t length, bool fdOwned) :
+   m_fd(fd),
+   m_offset(offset),
+   m_length(length),
+   m_fdOwned(fdOwned) {
+}
+
+//******************************************************************************
+
+HttpFileBody::~HttpFileBody() {
+   if (m_fdOwned && (m_fd > -1)) {
+      ::close(m_fd);
+   }
+}
+
+//******************************************************************************
+
+HttpFileBody* HttpFileBody::open(const std::string& path) {
+   const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+   if (fd < 0) {
+      return nullptr;
+   }
+
+   struct stat st;
+   if ((::fstat(fd, &st) != 0) || !S_ISREG(st.st_mode)) {
+      ::close(fd);
+      return nullptr;
+   }
+
+   return new HttpFileBody(fd, 0, (std::size_t) st.st_size);
+}
+
+//******************************************************************************
+
+int HttpFileBody::getFileDescriptor() const {
+   return m_fd;
+}
+
+//******************************************************************************
+
+off_t HttpFileBody::getOffset() const {
+   return m_offset;
+}
+
+//******************************************************************************
+
+std::size_t HttpFileBody::getLength() const {
+   return m_length;
+}
+
+//******************************************************************************
@@ -0,0 +1,79 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef MISERE_HTTPFILEBODY_H
+#define MISERE_HTTPFILEBODY_H
+
+#include <sys/types.h>
+#include <cstddef>
+#include <string>
+
+
+namespace misere
+{
+
+/**
+ * HttpFileBody is a response body that is a range of an open file - a
+ * descriptor, offset and length - rather than bytes in memory. The
+ * server writes it with ByteConnection::sendFile(), so on a plain socket
+ * the kernel copies it straight from the page cache (sendfile(2)) and
+ * the file is never read into user space at all.
+ */
+class HttpFileBody
+{
+   public:
+      /**
+       * Constructs a body from a range of an open file
+       * @param fd the file descriptor
+       * @param offset position in the file of the first byte of the body
+       * @param length number of bytes in the body
+       * @param fdOwned whether the descriptor is closed when the body is
+       *        destroyed
+       */
+      HttpFileBody(int fd, off_t offset, std::size_t length, bool fdOwned=true);
+
+      /**
+       * Destructor. Closes the descriptor if it's owned.
+       */
+      ~HttpFileBody();
+
+      /**
+       * Opens a regular file as a body holding its entire contents
+       * @param path the path of the file
+       * @return the body (owned by the caller), or nullptr if the file
+       *         can't be opened or isn't a regular file
+       */
+      static HttpFileBody* open(const std::string& path);
+
+      /**
+       * Retrieves the file descriptor
+       * @return the file descriptor
+       */
+      int getFileDescriptor() const;
+
+      /**
+       * Retrieves the position in the file of the first byte of the body
+       * @return the file offset
+       */
+      off_t getOffset() const;
+
+      /**
+       * Retrieves the number of bytes in the body
+       * @return the body length
+       */
+      std::size_t getLength() const;
+
+   private:
+      int m_fd;
+      off_t m_offset;
+      std::size_t m_length;
+      bool m_fdOwned;
+
+      // disallow copies
+      HttpFileBody(const HttpFileBody&);
+      HttpFileBody& operator=(const HttpFileBody&);
+};
+
+}
+
+#endif
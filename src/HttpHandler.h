@@ -56,6 +56,51 @@ class HttpHandler
        * @return boolean indicating whether the handler is currently available for handing requests.
        */
       virtual bool isAvailable() const = 0;
+
+      /**
+       * The streamsRequestBody method is called by the server before a request
+       * with a body is handed off, to decide who reads the body. By default the
+       * server reads it into memory first (refusing bodies larger than its
+       * max_request_body_size), and the handler finds it in getBody(). A handler
+       * that returns true reads the body itself, a piece at a time, from the
+       * request's body reader - so uploads of any size use bounded memory.
+       * @return boolean indicating whether the handler reads request bodies itself
+       * @see HttpTransaction::getBodyReader()
+       */
+      virtual bool streamsRequestBody() const { return false; }
+
+      /**
+       * The handlesSubpaths method tells the server whether requests for paths
+       * below the handler's own path (e.g., "/static/css/site.css" for a handler
+       * on "/static") are routed to it when no handler is registered for them.
+       * @return boolean indicating whether the handler serves paths below its own
+       */
+      virtual bool handlesSubpaths() const { return false; }
+
+      /**
+       * The responseCacheTtl method tells the server whether the handler's
+       * responses to GET requests may be cached - when the server's
+       * response cache is enabled - and for how long. A cached response
+       * is served for the same path, query and negotiated content coding
+       * without calling serviceRequest(), so only a handler whose output
+       * depends on nothing else (not on cookies or other headers) should
+       * opt in. Only 200 responses with a body set in memory, and without
+       * Set-Cookie or Cache-Control: no-store/private, are cached.
+       * @return the number of seconds a response stays cached (0 for none)
+       * @see HttpResponseCache
+       */
+      virtual int responseCacheTtl() const { return 0; }
+
+      /**
+       * The responseCacheGeneration method is consulted on each cache hit.
+       * Responses cached under an earlier generation are no longer served,
+       * so a handler invalidates everything it has cached by changing it.
+       * (The cache is also cleared whenever the server's routes change,
+       * e.g. on a reload, so a replacement handler doesn't get its
+       * predecessor's responses.)
+       * @return the handler's current cache generation
+       */
+      virtual unsigned long responseCacheGeneration() const { return 0; }
 };
 
 }
@@ -0,0 +1,313 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include <algorithm>
+#include <charconv>
+
+#include "HttpHeaderParser.h"
+#include "HttpScan.h"
+
+static const std::string_view HEADER_TERMINATOR = "\r\n\r\n";
+static const std::string_view EOL               = "\r\n";
+static const std::string_view CONTENT_LENGTH    = "content-length";
+static const std::string_view TRANSFER_ENCODING = "transfer-encoding";
+static const std::string_view CHUNKED           = "chunked";
+
+using namespace misere;
+
+//******************************************************************************
+
+static std::string_view trim(std::string_view s) {
+   while (!s.empty() && ((s.front() == ' ') || (s.front() == '\t'))) {
+      s.remove_prefix(1);
+   }
+
+   while (!s.empty() && ((s.back() == ' ') || (s.back() == '\t'))) {
+      s.remove_suffix(1);
+   }
+
+   return s;
+}
+
+//******************************************************************************
+
+static inline char lowerAscii(char c) {
+   return ((c >= 'A') && (c <= 'Z')) ? (char) (c + ('a' - 'A')) : c;
+}
+
+//******************************************************************************
+
+bool HttpHeaderParser::equalsIgnoreCase(std::string_view a, std::string_view b) {
+   if (a.size() != b.size()) {
+      return false;
+   }
+
+   for (std::size_t i = 0; i < a.size(); ++i) {
+      if (lowerAscii(a[i]) != lowerAscii(b[i])) {
+         return false;
+      }
+   }
+
+   return true;
+}
+
+//******************************************************************************
+
+HttpHeaderParser::HttpHeaderParser(std::pmr::memory_resource* resource) :
+   m_fields(resource),
+   m_firstLineTokenCount(0),
+   m_contentLength(-1),
+   m_isChunked(false),
+   m_hasInvalidFraming(false),
+   m_scanOffset(0),
+   m_headerLength(0),
+   m_isComplete(false) {
+}
+
+//******************************************************************************
+
+void HttpHeaderParser::reset() {
+   m_fields.clear();
+   m_firstLine = std::string_view();
+   for (std::string_view& token : m_firstLineTokens) {
+      token = std::string_view();
+   }
+   m_firstLineTokenCount = 0;
+   m_contentLength = -1;
+   m_isChunked = false;
+   m_hasInvalidFraming = false;
+   m_scanOffset = 0;
+   m_headerLength = 0;
+   m_isComplete = false;
+}
+
+//******************************************************************************
+
+bool HttpHeaderParser::parse(const char* data, std::size_t length) {
+   if (m_isComplete) {
+      return true;
+   }
+
+   // back up far enough to catch a terminator split across two reads, but
+   // never rescan anything before that
+   const std::size_t scanFrom =
+      (m_scanOffset >= HEADER_TERMINATOR.size() - 1) ?
+         m_scanOffset - (HEADER_TERMINATOR.size() - 1) : 0;
+
+   const char* end = data + length;
+   const char* terminator = (scanFrom < length) ?
+      HttpScan::findHeaderTerminator(data + scanFrom, end) : end;
+
+   if (terminator == end) {
+      m_scanOffset = length;
+      return false;
+   }
+
+   m_headerLength = (terminator - data) + HEADER_TERMINATOR.size();
+   m_scanOffset = m_headerLength;
+   m_isComplete = true;
+   parseLines(data);
+
+   return true;
+}
+
+//******************************************************************************
+
+void HttpHeaderParser::parseLines(const char* data) {
+   // everything before the blank line; a single EOL separates lines
+   const char* blockEnd = data + (m_headerLength - HEADER_TERMINATOR.size());
+   const char* lineStart = data;
+   bool isFirstLine = true;
+
+   m_fields.clear();
+   m_hasInvalidFraming = false;
+
+   while (lineStart <= blockEnd) {
+      const char* lineEnd = HttpScan::findEol(lineStart, blockEnd);
+      const std::string_view line(lineStart, lineEnd - lineStart);
+
+      if (isFirstLine) {
+         isFirstLine = false;
+         m_firstLine = line;
+
+         std::string_view rest = line;
+         while ((m_firstLineTokenCount < 3) && !rest.empty()) {
+            std::string_view::size_type posSpace = std::string_view::npos;
+            if (m_firstLineTokenCount < 2) {
+               const char* space =
+                  HttpScan::findByte(rest.data(), rest.data() + rest.size(), ' ');
+               if (space != rest.data() + rest.size()) {
+                  posSpace = space - rest.data();
+               }
+            }
+
+            if (posSpace == std::string_view::npos) {
+               m_firstLineTokens[m_firstLineTokenCount++] = rest;
+               rest = std::string_view();
+            } else {
+               m_firstLineTokens[m_firstLineTokenCount++] = rest.substr(0, posSpace);
+               rest.remove_prefix(posSpace + 1);
+            }
+         }
+      } else {
+         const char* colon = HttpScan::findByte(lineStart, lineEnd, ':');
+         if (colon != lineEnd) {
+            const std::string_view::size_type posColon = colon - lineStart;
+            const std::string_view name = line.substr(0, posColon);
+            const std::string_view value = trim(line.substr(posColon + 1));
+            if (name.size() != trim(name).size()) {
+               // "Content-Length : 5" or a folded line - something in
+               // front of this server may not read it as we would
+               m_hasInvalidFraming = true;
+            } else if (!name.empty() && !value.empty()) {
+               m_fields.push_back(HttpHeaderField{name, value});
+            }
+         }
+      }
+
+      lineStart = lineEnd + EOL.size();
+   }
+
+   // resolved once here, so it stays available even if the buffer the
+   // views point into has since grown (e.g. while a body is arriving)
+   m_contentLength = -1;
+   bool hasContentLength = false;
+
+   // every Content-Length must be a number, and the same number
+   for (const HttpHeaderField& contentLengthField : m_fields) {
+      if (!equalsIgnoreCase(contentLengthField.name, CONTENT_LENGTH)) {
+         continue;
+      }
+
+      long contentLength = -1;
+      const char* first = contentLengthField.value.data();
+      const char* last = first + contentLengthField.value.size();
+      const std::from_chars_result result =
+         std::from_chars(first, last, contentLength);
+
+      if ((result.ec != std::errc()) ||
+          (result.ptr != last) ||
+          (contentLength < 0) ||
+          (hasContentLength && (contentLength != m_contentLength))) {
+         m_hasInvalidFraming = true;
+         m_contentLength = -1;
+         break;
+      }
+
+      hasContentLength = true;
+      m_contentLength = contentLength;
+   }
+
+   // the codings of every Transfer-Encoding field, in order, as if the
+   // fields were joined into one list (as a proxy would join them).
+   // chunked must be the final coding, and only the final one - anything
+   // else leaves no way to tell where the body ends
+   m_isChunked = false;
+   bool hasTransferEncoding = false;
+   bool isChunkedBeforeLast = false;
+   std::string_view lastCoding;
+
+   for (const HttpHeaderField& transferEncodingField : m_fields) {
+      if (!equalsIgnoreCase(transferEncodingField.name, TRANSFER_ENCODING)) {
+         continue;
+      }
+
+      hasTransferEncoding = true;
+      std::string_view codings = transferEncodingField.value;
+      while (!codings.empty()) {
+         std::string_view::size_type posComma = codings.find(',');
+         if (posComma == std::string_view::npos) {
+            posComma = codings.size();
+         }
+
+         const std::string_view coding = trim(codings.substr(0, posComma));
+         if (!coding.empty()) {
+            if (equalsIgnoreCase(lastCoding, CHUNKED)) {
+               isChunkedBeforeLast = true;
+            }
+            lastCoding = coding;
+         }
+
+         codings.remove_prefix(std::min(posComma + 1, codings.size()));
+      }
+   }
+
+   if (hasTransferEncoding) {
+      m_isChunked = equalsIgnoreCase(lastCoding, CHUNKED);
+      if (hasContentLength || !m_isChunked || isChunkedBeforeLast) {
+         m_hasInvalidFraming = true;
+      }
+   }
+}
+
+//******************************************************************************
+
+bool HttpHeaderParser::isComplete() const {
+   return m_isComplete;
+}
+
+//******************************************************************************
+
+std::size_t HttpHeaderParser::getHeaderLength() const {
+   return m_headerLength;
+}
+
+//******************************************************************************
+
+std::string_view HttpHeaderParser::getFirstLine() const {
+   return m_firstLine;
+}
+
+//******************************************************************************
+
+std::string_view HttpHeaderParser::getFirstLineToken(int index) const {
+   if ((index < 0) || (index >= m_firstLineTokenCount)) {
+      return std::string_view();
+   }
+
+   return m_firstLineTokens[index];
+}
+
+//******************************************************************************
+
+int HttpHeaderParser::getFirstLineTokenCount() const {
+   return m_firstLineTokenCount;
+}
+
+//******************************************************************************
+
+const std::pmr::vector<HttpHeaderField>& HttpHeaderParser::getFields() const {
+   return m_fields;
+}
+
+//******************************************************************************
+
+const HttpHeaderField* HttpHeaderParser::find(std::string_view name) const {
+   for (auto it = m_fields.rbegin(); it != m_fields.rend(); ++it) {
+      if (equalsIgnoreCase(it->name, name)) {
+         return &(*it);
+      }
+   }
+
+   return nullptr;
+}
+
+//******************************************************************************
+
+long HttpHeaderParser::getContentLength() const {
+   return m_contentLength;
+}
+
+//******************************************************************************
+
+bool HttpHeaderParser::isChunked() const {
+   return m_isChunked;
+}
+
+//******************************************************************************
+
+bool HttpHeaderParser::hasInvalidFraming() const {
+   return m_hasInvalidFraming;
+}
+
+//******************************************************************************
@@ -0,0 +1,174 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef MISERE_HTTPHEADERPARSER_H
+#define MISERE_HTTPHEADERPARSER_H
+
+#include <cstddef>
+#include <memory_resource>
+#include <string_view>
+#include <vector>
+
+
+namespace misere
+{
+
+/**
+ * HttpHeaderField is one parsed header line: name and value as slices of
+ * the buffer the header block was parsed from (value has surrounding
+ * whitespace trimmed; name keeps its original case).
+ */
+struct HttpHeaderField
+{
+   std::string_view name;
+   std::string_view value;
+};
+
+/**
+ * HttpHeaderParser finds and parses the header block (start line plus
+ * header lines) of an HTTP request or response without copying it.
+ *
+ * It is resumable: parse() is called each time more bytes have been
+ * appended to the same buffer, and only looks at bytes it hasn't already
+ * scanned for the blank line that ends the headers. Once that line is
+ * found, the start line and headers are broken into string_views
+ * pointing into the buffer, so the buffer must not be modified (or
+ * reallocated) for as long as the views are in use - re-run parse() after
+ * reset() if it is copied or moved.
+ *
+ * The byte scanning itself (terminator, line ends, ':' and ' ') is done
+ * by the HttpScan kernels.
+ */
+class HttpHeaderParser
+{
+   public:
+      // a header block that hasn't ended within this many bytes is
+      // refused rather than buffered without bound
+      static const std::size_t MAX_HEADER_LENGTH = 64 * 1024;
+
+      /**
+       * Constructor
+       * @param resource memory resource the header field list allocates
+       *        from (e.g., a connection's HttpConnectionArena)
+       */
+      explicit HttpHeaderParser(std::pmr::memory_resource* resource=std::pmr::get_default_resource());
+
+      /**
+       * Discards all parse state so a new header block can be parsed
+       */
+      void reset();
+
+      /**
+       * Continues scanning for the end of the header block
+       * @param data start of the buffer (the same buffer on every call,
+       *        possibly with more bytes appended since the previous call)
+       * @param length number of bytes currently in the buffer
+       * @return boolean indicating whether the header block is complete
+       */
+      bool parse(const char* data, std::size_t length);
+
+      /**
+       * Determines whether the whole header block has been parsed
+       * @return boolean indicating if the header block is complete
+       */
+      bool isComplete() const;
+
+      /**
+       * Retrieves the length of the header block, including the blank
+       * line that ends it - i.e., the offset of the first body byte
+       * @return length of header block (0 if not yet complete)
+       */
+      std::size_t getHeaderLength() const;
+
+      /**
+       * Retrieves the start line (request line or status line)
+       * @return the start line, without its line terminator
+       */
+      std::string_view getFirstLine() const;
+
+      /**
+       * Retrieves a space-delimited token from the start line. Tokens 0
+       * and 1 are the first two words; token 2 is the rest of the line
+       * (so a multi-word reason phrase stays in one piece).
+       * @param index the token index (0-2)
+       * @return the token, or an empty view if the line has fewer tokens
+       */
+      std::string_view getFirstLineToken(int index) const;
+
+      /**
+       * Retrieves the number of start line tokens found (at most 3)
+       * @return number of start line tokens
+       */
+      int getFirstLineTokenCount() const;
+
+      /**
+       * Retrieves all parsed header lines, in the order they were received
+       * @return the parsed header fields
+       */
+      const std::pmr::vector<HttpHeaderField>& getFields() const;
+
+      /**
+       * Finds a header by name (case-insensitive). If the header appears
+       * more than once, the last occurrence wins.
+       * @param name the header name to find
+       * @return the matching field, or nullptr if there is none
+       */
+      const HttpHeaderField* find(std::string_view name) const;
+
+      /**
+       * Retrieves the value of the Content-Length header. Unlike the
+       * views, this stays valid if the parsed buffer grows afterward.
+       * @return the content length, or -1 if absent or not valid (see
+       *         hasInvalidFraming())
+       */
+      long getContentLength() const;
+
+      /**
+       * Determines whether the headers leave the body's length in doubt:
+       * a Content-Length that isn't a non-negative number, several
+       * Content-Length headers that disagree, a Content-Length along
+       * with Transfer-Encoding, or a Transfer-Encoding (all its fields
+       * taken together) whose final coding isn't "chunked" or that lists
+       * "chunked" more than once - or any header line with whitespace
+       * around its name (before the colon, or a folded line). A peer (or
+       * a proxy in front of this server) could take the body to end
+       * somewhere else, so such a message is refused rather than guessed
+       * at.
+       * @return boolean indicating if the body's framing is invalid
+       */
+      bool hasInvalidFraming() const;
+
+      /**
+       * Determines whether the body uses chunked transfer coding (the
+       * final coding listed by Transfer-Encoding is "chunked"). Like the
+       * content length, this stays valid if the parsed buffer grows.
+       * @return boolean indicating if the body is chunked
+       */
+      bool isChunked() const;
+
+      /**
+       * Compares two strings for equality ignoring ASCII case
+       * @param a first string to compare
+       * @param b second string to compare
+       * @return boolean indicating if the two strings are equal
+       */
+      static bool equalsIgnoreCase(std::string_view a, std::string_view b);
+
+   private:
+      void parseLines(const char* data);
+
+      std::pmr::vector<HttpHeaderField> m_fields;
+      std::string_view m_firstLine;
+      std::string_view m_firstLineTokens[3];
+      int m_firstLineTokenCount;
+      long m_contentLength;
+      bool m_isChunked;
+      bool m_hasInvalidFraming;
+      std::size_t m_scanOffset;
+      std::size_t m_headerLength;
+      bool m_isComplete;
+};
+
+}
+
+#endif
@@ -0,0 +1,87 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include "HttpHeaderPrefixes.h"
+#include "HTTP.h"
+
+static const std::string EOL = "\r\n";
+static const std::string SERVER_PREFIX = "Server: ";
+static const std::string CONNECTION_KEEP_ALIVE = "Connection: keep-alive\r\n";
+static const std::string CONNECTION_CLOSE = "Connection: close\r\n";
+
+// status codes that get a pre-rendered prefix
+static const int COMMON_STATUS_CODES[] = {
+   200, 201, 202, 204, 206,
+   301, 302, 303, 304, 307,
+   400, 401, 403, 404, 405, 408, 411, 412, 413, 414, 415, 417,
+   500, 501, 502, 503, 504, 505
+};
+
+static const int MIN_STATUS_CODE = 100;
+static const int MAX_STATUS_CODE = 599;
+
+using namespace misere;
+
+//******************************************************************************
+
+HttpHeaderPrefixes::HttpHeaderPrefixes() {
+}
+
+//******************************************************************************
+
+int HttpHeaderPrefixes::slotFor(int statusCode, bool keepAlive) {
+   if ((statusCode < MIN_STATUS_CODE) || (statusCode > MAX_STATUS_CODE)) {
+      return -1;
+   }
+
+   return ((statusCode - MIN_STATUS_CODE) * 2) + (keepAlive ? 1 : 0);
+}
+
+//******************************************************************************
+
+void HttpHeaderPrefixes::build(const std::string& serverString) {
+   m_serverString = serverString;
+   m_prefixes.clear();
+   m_prefixes.resize((MAX_STATUS_CODE - MIN_STATUS_CODE + 1) * 2);
+
+   for (int statusCode : COMMON_STATUS_CODES) {
+      render(m_prefixes[slotFor(statusCode, true)], statusCode, true);
+      render(m_prefixes[slotFor(statusCode, false)], statusCode, false);
+   }
+}
+
+//******************************************************************************
+
+void HttpHeaderPrefixes::render(std::string& output,
+                                int statusCode,
+                                bool keepAlive) const {
+   output += HTTP::HTTP_PROTOCOL1_1;
+   output += ' ';
+   output += HTTP::responseLineForStatusCode(statusCode);
+   output += EOL;
+
+   if (!m_serverString.empty()) {
+      output += SERVER_PREFIX;
+      output += m_serverString;
+      output += EOL;
+   }
+
+   output += keepAlive ? CONNECTION_KEEP_ALIVE : CONNECTION_CLOSE;
+}
+
+//******************************************************************************
+
+void HttpHeaderPrefixes::append(std::string& output,
+                                int statusCode,
+                                bool keepAlive) const {
+   const int slot = slotFor(statusCode, keepAlive);
+   if ((slot >= 0) &&
+       (slot < (int) m_prefixes.size()) &&
+       !m_prefixes[slot].empty()) {
+      output += m_prefixes[slot];
+   } else {
+      render(output, statusCode, keepAlive);
+   }
+}
+
+//******************************************************************************
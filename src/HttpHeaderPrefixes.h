@@ -0,0 +1,54 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef MISERE_HTTPHEADERPREFIXES_H
+#define MISERE_HTTPHEADERPREFIXES_H
+
+#include <string>
+#include <vector>
+
+
+namespace misere
+{
+
+/**
+ * HttpHeaderPrefixes holds the part of a response header block that
+ * doesn't change from one response to the next - the status line, the
+ * Server header and the Connection header - pre-rendered at startup for
+ * the common status codes, once for keep-alive and once for close. The
+ * response path appends the matching prefix and then only the per-request
+ * headers (Date, Content-Length and whatever the handler set).
+ *
+ * Immutable once built, so it's shared by every worker without locking.
+ */
+class HttpHeaderPrefixes
+{
+   public:
+      HttpHeaderPrefixes();
+
+      /**
+       * Renders the prefixes for the common status codes
+       * @param serverString value of the Server header (omitted if empty)
+       */
+      void build(const std::string& serverString);
+
+      /**
+       * Appends the prefix for a response. Status codes without a
+       * pre-rendered prefix are rendered on the spot.
+       * @param output the buffer to append to
+       * @param statusCode the HTTP status code of the response
+       * @param keepAlive whether the connection stays open afterward
+       */
+      void append(std::string& output, int statusCode, bool keepAlive) const;
+
+   private:
+      void render(std::string& output, int statusCode, bool keepAlive) const;
+      static int slotFor(int statusCode, bool keepAlive);
+
+      std::string m_serverString;
+      std::vector<std::string> m_prefixes;  // indexed by slotFor()
+};
+
+}
+
+#endif
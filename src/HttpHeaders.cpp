@@ -0,0 +1,279 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include <utility>
+
+#include "HttpHeaders.h"
+#include "HttpHeaderParser.h"
+
+using namespace misere;
+
+namespace {
+
+struct WellKnownHeader {
+   int id;
+   std::string_view name;
+};
+
+}
+
+// indexed by ID
+static const WellKnownHeader WELL_KNOWN_HEADERS[] = {
+   { HttpHeaders::UNKNOWN,           "" },
+   { HttpHeaders::ACCEPT,            "Accept" },
+   { HttpHeaders::ACCEPT_ENCODING,   "Accept-Encoding" },
+   { HttpHeaders::ACCEPT_LANGUAGE,   "Accept-Language" },
+   { HttpHeaders::CACHE_CONTROL,     "Cache-Control" },
+   { HttpHeaders::CONNECTION,        "Connection" },
+   { HttpHeaders::CONTENT_ENCODING,  "Content-Encoding" },
+   { HttpHeaders::CONTENT_LENGTH,    "Content-Length" },
+   { HttpHeaders::CONTENT_TYPE,      "Content-Type" },
+   { HttpHeaders::DATE,              "Date" },
+   { HttpHeaders::ETAG,              "ETag" },
+   { HttpHeaders::EXPECT,            "Expect" },
+   { HttpHeaders::HOST,              "Host" },
+   { HttpHeaders::IF_MODIFIED_SINCE, "If-Modified-Since" },
+   { HttpHeaders::IF_NONE_MATCH,     "If-None-Match" },
+   { HttpHeaders::LAST_MODIFIED,     "Last-Modified" },
+   { HttpHeaders::SERVER,            "Server" },
+   { HttpHeaders::TRANSFER_ENCODING, "Transfer-Encoding" },
+   { HttpHeaders::USER_AGENT,        "User-Agent" },
+   { HttpHeaders::VARY,              "Vary" }
+};
+
+static const int WELL_KNOWN_HEADER_COUNT =
+   sizeof(WELL_KNOWN_HEADERS) / sizeof(WELL_KNOWN_HEADERS[0]);
+
+//******************************************************************************
+
+int HttpHeaders::idForName(std::string_view name) {
+   for (int id = 1; id < WELL_KNOWN_HEADER_COUNT; ++id) {
+      if (HttpHeaderParser::equalsIgnoreCase(WELL_KNOWN_HEADERS[id].name, name)) {
+         return id;
+      }
+   }
+
+   return UNKNOWN;
+}
+
+//******************************************************************************
+
+std::string_view HttpHeaders::nameForId(int id) {
+   if ((id <= UNKNOWN) || (id >= WELL_KNOWN_HEADER_COUNT)) {
+      return std::string_view();
+   }
+
+   return WELL_KNOWN_HEADERS[id].name;
+}
+
+//******************************************************************************
+
+HttpHeaders::HttpHeaders() :
+   HttpHeaders(std::pmr::get_default_resource()) {
+}
+
+//******************************************************************************
+
+HttpHeaders::HttpHeaders(std::pmr::memory_resource* resource) :
+   m_inline{Entry(resource), Entry(resource), Entry(resource), Entry(resource),
+            Entry(resource), Entry(resource), Entry(resource), Entry(resource)},
+   m_inlineCount(0),
+   m_overflow(resource) {
+   static_assert(INLINE_CAPACITY == 8, "one initializer per inline entry");
+}
+
+//******************************************************************************
+
+HttpHeaders::HttpHeaders(const HttpHeaders& copy) :
+   HttpHeaders() {
+   *this = copy;
+}
+
+//******************************************************************************
+
+HttpHeaders& HttpHeaders::operator=(const HttpHeaders& copy) {
+   // entry by entry, so each string keeps the allocator it was made with
+   if (this != &copy) {
+      clear();
+      for (const Entry& entry : copy) {
+         append(entry.id, entry.name, entry.value);
+      }
+   }
+
+   return *this;
+}
+
+//******************************************************************************
+
+HttpHeaders::Entry* HttpHeaders::data() {
+   return m_overflow.empty() ? m_inline : m_overflow.data();
+}
+
+//******************************************************************************
+
+const HttpHeaders::Entry* HttpHeaders::data() const {
+   return m_overflow.empty() ? m_inline : m_overflow.data();
+}
+
+//******************************************************************************
+
+std::size_t HttpHeaders::size() const {
+   return m_overflow.empty() ? m_inlineCount : m_overflow.size();
+}
+
+//******************************************************************************
+
+bool HttpHeaders::empty() const {
+   return size() == 0;
+}
+
+//******************************************************************************
+
+const HttpHeaders::Entry* HttpHeaders::begin() const {
+   return data();
+}
+
+//******************************************************************************
+
+const HttpHeaders::Entry* HttpHeaders::end() const {
+   return data() + size();
+}
+
+//******************************************************************************
+
+const HttpHeaders::Entry* HttpHeaders::findEntry(int id,
+                                                 std::string_view name) const {
+   const Entry* entriesEnd = end();
+
+   // a well-known name only ever matches by ID; anything else only by name
+   if (id != UNKNOWN) {
+      for (const Entry* entry = begin(); entry != entriesEnd; ++entry) {
+         if (entry->id == id) {
+            return entry;
+         }
+      }
+   } else {
+      for (const Entry* entry = begin(); entry != entriesEnd; ++entry) {
+         if ((entry->id == UNKNOWN) &&
+             HttpHeaderParser::equalsIgnoreCase(entry->name, name)) {
+            return entry;
+         }
+      }
+   }
+
+   return nullptr;
+}
+
+//******************************************************************************
+
+void HttpHeaders::append(int id, std::string_view name, std::string_view value) {
+   if (m_overflow.empty() && (m_inlineCount < INLINE_CAPACITY)) {
+      Entry& entry = m_inline[m_inlineCount++];
+      entry.id = id;
+      entry.name.assign(name);
+      entry.value.assign(value);
+      return;
+   }
+
+   if (m_overflow.empty()) {
+      m_overflow.reserve(INLINE_CAPACITY * 2);
+      for (std::size_t i = 0; i < m_inlineCount; ++i) {
+         m_overflow.push_back(std::move(m_inline[i]));
+      }
+      m_inlineCount = 0;
+   }
+
+   Entry& entry = m_overflow.emplace_back(m_overflow.get_allocator().resource());
+   entry.id = id;
+   entry.name.assign(name);
+   entry.value.assign(value);
+}
+
+//******************************************************************************
+
+void HttpHeaders::set(std::string_view name, std::string_view value) {
+   const int id = idForName(name);
+   Entry* entry = const_cast<Entry*>(findEntry(id, name));
+
+   if (nullptr != entry) {
+      entry->value.assign(value);
+   } else {
+      append(id, name, value);
+   }
+}
+
+//******************************************************************************
+
+void HttpHeaders::set(int id, std::string_view value) {
+   Entry* entry = const_cast<Entry*>(findEntry(id, std::string_view()));
+
+   if (nullptr != entry) {
+      entry->value.assign(value);
+   } else {
+      append(id, nameForId(id), value);
+   }
+}
+
+//******************************************************************************
+
+const std::pmr::string* HttpHeaders::find(std::string_view name) const {
+   const Entry* entry = findEntry(idForName(name), name);
+   return (nullptr != entry) ? &entry->value : nullptr;
+}
+
+//******************************************************************************
+
+const std::pmr::string* HttpHeaders::find(int id) const {
+   const Entry* entry = findEntry(id, std::string_view());
+   return (nullptr != entry) ? &entry->value : nullptr;
+}
+
+//******************************************************************************
+
+bool HttpHeaders::has(std::string_view name) const {
+   return nullptr != find(name);
+}
+
+//******************************************************************************
+
+bool HttpHeaders::has(int id) const {
+   return nullptr != find(id);
+}
+
+//******************************************************************************
+
+bool HttpHeaders::remove(std::string_view name) {
+   const Entry* entry = findEntry(idForName(name), name);
+   if (nullptr == entry) {
+      return false;
+   }
+
+   if (!m_overflow.empty()) {
+      m_overflow.erase(m_overflow.begin() + (entry - m_overflow.data()));
+      return true;
+   }
+
+   // keep insertion order - shift the rest down
+   for (std::size_t i = entry - m_inline; (i + 1) < m_inlineCount; ++i) {
+      m_inline[i] = std::move(m_inline[i + 1]);
+   }
+   --m_inlineCount;
+   m_inline[m_inlineCount].name.clear();
+   m_inline[m_inlineCount].value.clear();
+
+   return true;
+}
+
+//******************************************************************************
+
+void HttpHeaders::clear() {
+   // keep the inline strings' capacity for reuse
+   for (std::size_t i = 0; i < m_inlineCount; ++i) {
+      m_inline[i].name.clear();
+      m_inline[i].value.clear();
+   }
+   m_inlineCount = 0;
+   m_overflow.clear();
+}
+
+//******************************************************************************
@@ -0,0 +1,192 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef MISERE_HTTPHEADERS_H
+#define MISERE_HTTPHEADERS_H
+
+#include <cstddef>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+namespace misere
+{
+
+/**
+ * HttpHeaders is a header name/value container for the small header sets
+ * of a single request or response. Entries live in a fixed inline array
+ * until that fills up (then in a vector), in insertion order, and are
+ * found by a linear scan - cheaper than hashing for a dozen or so
+ * entries. Names keep the case they were set with and are compared
+ * case-insensitively without copying.
+ *
+ * Well-known header names are interned as integer IDs when set, so
+ * lookups by ID (or by a name that resolves to one) compare integers
+ * rather than strings.
+ *
+ * Names and values are allocated from the memory resource the headers
+ * are constructed with - a connection arena's, for a transaction that
+ * has one (see HttpTransaction::getMemoryResource()). A copy allocates
+ * from the default resource, so it may outlive the arena.
+ */
+class HttpHeaders
+{
+   public:
+      // IDs for well-known header names (UNKNOWN for anything else)
+      static const int UNKNOWN = 0;
+      static const int ACCEPT = 1;
+      static const int ACCEPT_ENCODING = 2;
+      static const int ACCEPT_LANGUAGE = 3;
+      static const int CACHE_CONTROL = 4;
+      static const int CONNECTION = 5;
+      static const int CONTENT_ENCODING = 6;
+      static const int CONTENT_LENGTH = 7;
+      static const int CONTENT_TYPE = 8;
+      static const int DATE = 9;
+      static const int ETAG = 10;
+      static const int EXPECT = 11;
+      static const int HOST = 12;
+      static const int IF_MODIFIED_SINCE = 13;
+      static const int IF_NONE_MATCH = 14;
+      static const int LAST_MODIFIED = 15;
+      static const int SERVER = 16;
+      static const int TRANSFER_ENCODING = 17;
+      static const int USER_AGENT = 18;
+      static const int VARY = 19;
+
+      /**
+       * Entry is one header: its interned ID, name as set, and value
+       */
+      struct Entry
+      {
+         Entry() = default;
+         explicit Entry(std::pmr::memory_resource* resource) :
+            name(resource),
+            value(resource) {
+         }
+
+         int id = UNKNOWN;
+         std::pmr::string name;
+         std::pmr::string value;
+      };
+
+      HttpHeaders();
+
+      /**
+       * Constructs an empty set whose entries allocate from a resource
+       * @param resource the memory resource for names and values
+       */
+      explicit HttpHeaders(std::pmr::memory_resource* resource);
+
+      /**
+       * Copy constructor. The copy allocates from the default resource.
+       * @param copy the headers to copy
+       */
+      HttpHeaders(const HttpHeaders& copy);
+
+      HttpHeaders& operator=(const HttpHeaders& copy);
+
+      /**
+       * Resolves a header name to its interned ID (case-insensitive)
+       * @param name the header name
+       * @return the ID, or UNKNOWN if the name isn't a well-known header
+       */
+      static int idForName(std::string_view name);
+
+      /**
+       * Retrieves the canonical name for an interned ID
+       * @param id the header ID
+       * @return the canonical name (e.g., "Content-Length"), or an empty
+       *         view for UNKNOWN or an invalid ID
+       */
+      static std::string_view nameForId(int id);
+
+      /**
+       * Sets a header, replacing the value of an existing header with the
+       * same name (case-insensitive) or appending a new one
+       * @param name the header name
+       * @param value the header value
+       */
+      void set(std::string_view name, std::string_view value);
+
+      /**
+       * Sets a well-known header by ID, using its canonical name if it's
+       * not already present
+       * @param id the header ID (must not be UNKNOWN)
+       * @param value the header value
+       */
+      void set(int id, std::string_view value);
+
+      /**
+       * Finds a header value by name (case-insensitive)
+       * @param name the header name
+       * @return the value, or nullptr if the header isn't present
+       */
+      const std::pmr::string* find(std::string_view name) const;
+
+      /**
+       * Finds a well-known header value by ID
+       * @param id the header ID
+       * @return the value, or nullptr if the header isn't present
+       */
+      const std::pmr::string* find(int id) const;
+
+      /**
+       * Determines if a header is present (case-insensitive)
+       * @param name the header name
+       * @return boolean indicating if the header is present
+       */
+      bool has(std::string_view name) const;
+
+      /**
+       * Determines if a well-known header is present
+       * @param id the header ID
+       * @return boolean indicating if the header is present
+       */
+      bool has(int id) const;
+
+      /**
+       * Removes a header (case-insensitive)
+       * @param name the header name
+       * @return boolean indicating if a header was removed
+       */
+      bool remove(std::string_view name);
+
+      /**
+       * Removes all headers
+       */
+      void clear();
+
+      /**
+       * Retrieves the number of headers
+       * @return number of headers
+       */
+      std::size_t size() const;
+
+      /**
+       * Determines whether there are no headers
+       * @return boolean indicating if there are no headers
+       */
+      bool empty() const;
+
+      const Entry* begin() const;
+      const Entry* end() const;
+
+   private:
+      Entry* data();
+      const Entry* data() const;
+      const Entry* findEntry(int id, std::string_view name) const;
+      void append(int id, std::string_view name, std::string_view value);
+
+      static const std::size_t INLINE_CAPACITY = 8;
+
+      Entry m_inline[INLINE_CAPACITY];
+      std::size_t m_inlineCount;
+      std::pmr::vector<Entry> m_overflow;  // all entries, once inline is full
+};
+
+}
+
+#endif
@@ -2,6 +2,7 @@
 // BSD License
 
 #include <stdio.h>
+#include <strings.h>
 #include <utility>
 
 #include "HttpRequest.h"
@@ -76,6 +77,54 @@ static const std::string EOL = "\r\n";
 using namespace misere;
 using namespace chaudiere;
 
+static std::string_view trim(std::string_view s) {
+   while (!s.empty() && ((s.front() == ' ') || (s.front() == '\t'))) {
+      s.remove_prefix(1);
+   }
+   while (!s.empty() && ((s.back() == ' ') || (s.back() == '\t'))) {
+      s.remove_suffix(1);
+   }
+   return s;
+}
+
+// the q-value among a list element's parameters ("q=0.5;foo=bar") in
+// thousandths - 1000 if there isn't one, -1 if it's malformed
+static int parseQuality(std::string_view params) {
+   while (!params.empty()) {
+      const std::string_view::size_type semicolon = params.find(';');
+      const std::string_view param = trim(params.substr(0, semicolon));
+      params = (semicolon == std::string_view::npos) ?
+         std::string_view() : params.substr(semicolon + 1);
+
+      if ((param.size() < 2) ||
+          ((param[0] != 'q') && (param[0] != 'Q')) ||
+          (param[1] != '=')) {
+         continue;
+      }
+
+      // qvalue = ( "0" [ "." 0*3DIGIT ] ) / ( "1" [ "." 0*3("0") ] )
+      const std::string_view value = param.substr(2);
+      if (value.empty() || (value.size() > 5) ||
+          ((value[0] != '0') && (value[0] != '1')) ||
+          ((value.size() > 1) && (value[1] != '.'))) {
+         return -1;
+      }
+
+      int quality = (value[0] - '0') * 1000;
+      int scale = 100;
+      for (std::size_t i = 2; i < value.size(); ++i, scale /= 10) {
+         if ((value[i] < '0') || (value[i] > '9')) {
+            return -1;
+         }
+         quality += (value[i] - '0') * scale;
+      }
+
+      return (quality <= 1000) ? quality : -1;
+   }
+
+   return 1000;
+}
+
 //******************************************************************************
 
 HttpRequest* HttpRequest::create(const Url& url) {
@@ -115,8 +164,8 @@ HttpRequest::HttpRequest(const Url& url) :
 
 //******************************************************************************
 
-HttpRequest::HttpRequest(ByteConnection* connection, bool connectionOwned, std::string leadingBytes) :
-   HttpTransaction(connection, connectionOwned, std::move(leadingBytes)),
+HttpRequest::HttpRequest(ByteConnection* connection, bool connectionOwned, std::string leadingBytes, HttpConnectionArena* arena) :
+   HttpTransaction(connection, connectionOwned, std::move(leadingBytes), arena),
    m_initialized(false) {
 
    LOG_INSTANCE_CREATE("HttpRequest")
@@ -151,6 +200,7 @@ HttpRequest& HttpRequest::operator=(const HttpRequest& copy) {
    m_method = copy.m_method;
    m_path = copy.m_path;
    m_arguments = copy.m_arguments;
+   m_routeParameters.clear();
 
    return *this;
 }
@@ -161,19 +211,17 @@ bool HttpRequest::streamFromConnection() {
    bool streamSuccess = false;
 
    if (HttpTransaction::streamFromConnection()) {
-      const std::string& firstLine = getFirstHeaderLine();
-      std::vector<std::string> reqLineValues = StrUtils::split(firstLine, " ");
-      if (reqLineValues.size() != 3) {
+      // METHOD PATH PROTOCOL - exactly 3 tokens; method, path and
+      // protocol are then read straight from the parsed request line
+      const HttpHeaderParser& parser = getHeaderParser();
+      if ((parser.getFirstLineTokenCount() != 3) ||
+          parser.getFirstLineToken(0).empty() ||
+          parser.getFirstLineToken(1).empty() ||
+          (parser.getFirstLineToken(2).find(' ') != std::string_view::npos)) {
          //throw BasicException("unable to parse headers");
          return false;
       }
 
-      m_method = reqLineValues[0];
-      m_path = reqLineValues[1];
-      setProtocol(reqLineValues[2]);
-
-      setRequestLineValues(reqLineValues);
-
       streamSuccess = true;
    } else {
       throw BasicException("unable to parse headers");
@@ -190,19 +238,29 @@ bool HttpRequest::isInitialized() const {
 
 //******************************************************************************
 
-const std::string& HttpRequest::getRequest() const {
+std::string_view HttpRequest::getRequest() const {
    return getFirstHeaderLine();
 }
 
 //******************************************************************************
 
-const std::string& HttpRequest::getMethod() const {
+std::string_view HttpRequest::getMethod() const {
+   // m_method is only set for outgoing requests
+   if (m_method.empty()) {
+      return getRequestMethod();
+   }
+
    return m_method;
 }
 
 //******************************************************************************
 
-const std::string& HttpRequest::getPath() const {
+std::string_view HttpRequest::getPath() const {
+   // m_path is only set for outgoing requests
+   if (m_path.empty()) {
+      return getRequestPath();
+   }
+
    return m_path;
 }
 
@@ -224,6 +282,30 @@ void HttpRequest::getArgumentKeys(std::vector<std::string>& vecKeys) const {
    m_arguments.getKeys(vecKeys);
 }
 
+//******************************************************************************
+
+bool HttpRequest::hasRouteParameter(std::string_view name) const {
+   return m_routeParameters.has(name);
+}
+
+//******************************************************************************
+
+std::string_view HttpRequest::getRouteParameter(std::string_view name) const {
+   return m_routeParameters.get(name);
+}
+
+//******************************************************************************
+
+const HttpRouteParameters& HttpRequest::getRouteParameters() const {
+   return m_routeParameters;
+}
+
+//******************************************************************************
+
+void HttpRequest::setRouteParameters(const HttpRouteParameters& parameters) {
+   m_routeParameters = parameters;
+}
+
 //******************************************************************************
 /*
 void HttpRequest::parseBody() {
@@ -319,43 +401,92 @@ bool HttpRequest::hasUserAgent() const {
 
 //******************************************************************************
 
-const std::string& HttpRequest::getAccept() const {
+std::string_view HttpRequest::getAccept() const {
    return getHeaderValue(HTTP::HTTP_ACCEPT);
 }
 
 //******************************************************************************
 
-const std::string& HttpRequest::getAcceptEncoding() const {
+std::string_view HttpRequest::getAcceptEncoding() const {
    return getHeaderValue(HTTP::HTTP_ACCEPT_ENCODING);
 }
 
 //******************************************************************************
 
-const std::string& HttpRequest::getAcceptLanguage() const {
+bool HttpRequest::acceptsEncoding(std::string_view coding) const {
+   return getAcceptEncodingQuality(coding) > 0;
+}
+
+//******************************************************************************
+
+int HttpRequest::getAcceptEncodingQuality(std::string_view coding,
+                                          bool matchWildcard) const {
+   if (!hasAcceptEncoding()) {
+      return -1;
+   }
+
+   std::string_view acceptEncoding = getAcceptEncoding();
+   int wildcardQuality = -1;
+
+   while (!acceptEncoding.empty()) {
+      const std::string_view::size_type comma = acceptEncoding.find(',');
+      std::string_view listed = acceptEncoding.substr(0, comma);
+      acceptEncoding = (comma == std::string_view::npos) ?
+         std::string_view() : acceptEncoding.substr(comma + 1);
+
+      std::string_view params;
+      const std::string_view::size_type semicolon = listed.find(';');
+      if (semicolon != std::string_view::npos) {
+         params = listed.substr(semicolon + 1);
+         listed = listed.substr(0, semicolon);
+      }
+      listed = trim(listed);
+
+      const bool isCoding =
+         (listed.size() == coding.size()) &&
+         (::strncasecmp(listed.data(), coding.data(), coding.size()) == 0);
+      if (!isCoding && (!matchWildcard || (listed != "*"))) {
+         continue;
+      }
+
+      const int quality = parseQuality(params);
+      if (isCoding) {
+         // the coding's own entry wins over "*", wherever they appear
+         return quality;
+      }
+      wildcardQuality = quality;
+   }
+
+   return wildcardQuality;
+}
+
+//******************************************************************************
+
+std::string_view HttpRequest::getAcceptLanguage() const {
    return getHeaderValue(HTTP::HTTP_ACCEPT_LANGUAGE);
 }
 
 //******************************************************************************
 
-const std::string& HttpRequest::getConnection() const {
+std::string_view HttpRequest::getConnection() const {
    return getHeaderValue(HTTP::HTTP_CONNECTION);
 }
 
 //******************************************************************************
 
-const std::string& HttpRequest::getDNT() const {
+std::string_view HttpRequest::getDNT() const {
    return getHeaderValue("dnt");
 }
 
 //******************************************************************************
 
-const std::string& HttpRequest::getHost() const {
+std::string_view HttpRequest::getHost() const {
    return getHeaderValue(HTTP::HTTP_HOST);
 }
 
 //******************************************************************************
 
-const std::string& HttpRequest::getUserAgent() const {
+std::string_view HttpRequest::getUserAgent() const {
    return getHeaderValue(HTTP::HTTP_USER_AGENT);
 }
 
@@ -367,18 +498,6 @@ void HttpRequest::setMethod(const std::string& method) {
 
 //******************************************************************************
 
-void HttpRequest::setHeaderValue(const std::string& key,
-                                 const std::string& value) {
-   // m_arguments is what write() serializes for an outgoing request;
-   // also populate the inherited header store so hasHeaderValue()/
-   // getHeaderValue() (which are not overridden here) can read back
-   // what was just set.
-   m_arguments.addPair(key, value);
-   HttpTransaction::setHeaderValue(key, value);
-}
-
-//******************************************************************************
-
 HttpResponse* HttpRequest::getResponse() {
    return new HttpResponse(takeConnection());
 }
@@ -394,8 +513,8 @@ bool HttpRequest::write(ByteConnection* c) {
 bool HttpRequest::write(ByteConnection* c, long bodyLength) {
    bool success = false;
    if (c != nullptr) {
-      const std::string& method = getMethod();
-      const std::string& path = getPath();
+      const std::string_view method = getMethod();
+      const std::string_view path = getPath();
       if (method.empty()) {
          return false;
       }
@@ -417,13 +536,10 @@ bool HttpRequest::write(ByteConnection* c, long bodyLength) {
       headers += "HTTP/1.1";
       headers += EOL;
 
-      std::vector<std::string> headerKeys;
-      m_arguments.getKeys(headerKeys);
-
-      for (const auto& headerKey : headerKeys) {
-         headers += headerKey;
+      for (const HttpHeaders::Entry& entry : getHeaders()) {
+         headers += entry.name;
          headers += ": ";
-         headers += m_arguments.getValue(headerKey);
+         headers += entry.value;
          headers += EOL;
       }
 
@@ -5,10 +5,12 @@
 #define MISERE_HTTPREQUEST_H
 
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "HttpTransaction.h"
 #include "HttpResponse.h"
+#include "HttpRouteParameters.h"
 #include "KeyValuePairs.h"
 #include "ByteConnection.h"
 #include "Url.h"
@@ -36,9 +38,10 @@ class HttpRequest : public HttpTransaction {
        * @param leadingBytes bytes already read from the connection but
        *        not consumed by a previous request sharing it - see
        *        HttpTransaction::takeUnconsumedBytes()
+       * @param arena the connection's arena, if any - see HttpTransaction()
        * @see ByteConnection()
        */
-      explicit HttpRequest(ByteConnection* connection, bool connectionOwned=true, std::string leadingBytes=std::string());
+      explicit HttpRequest(ByteConnection* connection, bool connectionOwned=true, std::string leadingBytes=std::string(), HttpConnectionArena* arena=nullptr);
 
       /**
        * Copy constructor
@@ -74,19 +77,19 @@ class HttpRequest : public HttpTransaction {
        * Retrieves the request line for the request
        * @return the request line value
        */
-      const std::string& getRequest() const;
+      std::string_view getRequest() const;
 
       /**
        * Retrieves the HTTP method for the request
        * @return the method value
        */
-      const std::string& getMethod() const;
+      std::string_view getMethod() const;
 
       /**
        * Retrieves the path for the request
        * @return the path value
        */
-      const std::string& getPath() const;
+      std::string_view getPath() const;
 
       /**
        * Determines if the specified key exists in the arguments
@@ -109,6 +112,35 @@ class HttpRequest : public HttpTransaction {
        */
       void getArgumentKeys(std::vector<std::string>& vecKeys) const;
 
+      /**
+       * Determines if the handler's route captured the specified parameter
+       * (e.g., "id" for the route "/users/:id")
+       * @param name the parameter name
+       * @return boolean indicating whether the parameter was captured
+       */
+      bool hasRouteParameter(std::string_view name) const;
+
+      /**
+       * Retrieves a parameter captured by the handler's route
+       * @param name the parameter name
+       * @return the captured path text (empty if it wasn't captured)
+       */
+      std::string_view getRouteParameter(std::string_view name) const;
+
+      /**
+       * Retrieves all parameters captured by the handler's route
+       * @return the route parameters
+       */
+      const HttpRouteParameters& getRouteParameters() const;
+
+      /**
+       * Sets the parameters captured by the handler's route (done by the
+       * server when it routes the request). They refer to the request's
+       * path, so they aren't carried over to a copy of the request.
+       * @param parameters the route parameters
+       */
+      void setRouteParameters(const HttpRouteParameters& parameters);
+
       /**
        * Determines if the Accept header is present
        * @return boolean indicating if the header value is present
@@ -155,43 +187,65 @@ class HttpRequest : public HttpTransaction {
        * Retrieves the value associated with the Accept header
        * @return the specified HTTP header value
        */
-      const std::string& getAccept() const;
+      std::string_view getAccept() const;
 
       /**
        * Retrieves the value associated with the Accept-encoding header
        * @return the specified HTTP header value
        */
-      const std::string& getAcceptEncoding() const;
+      std::string_view getAcceptEncoding() const;
+
+      /**
+       * Determines if the client accepts a response body with the specified
+       * content coding - i.e. its Accept-Encoding header gives the coding
+       * (or "*") a non-zero q-value
+       * @param coding the content coding (e.g., "gzip"), case-insensitive
+       * @return boolean indicating if the coding is acceptable
+       */
+      bool acceptsEncoding(std::string_view coding) const;
+
+      /**
+       * Retrieves the weight (q-value) the Accept-Encoding header gives a
+       * content coding - from the coding's own entry if it has one,
+       * otherwise from a "*" entry
+       * @param coding the content coding (e.g., "br"), case-insensitive
+       * @param matchWildcard whether a "*" entry applies to the coding
+       *        (false for codings a client has to name to get)
+       * @return the q-value in thousandths (0 - 1000), or -1 if the
+       *         coding isn't listed (or there's no Accept-Encoding header)
+       */
+      int getAcceptEncodingQuality(std::string_view coding,
+                                   bool matchWildcard=true) const;
 
       /**
        * Retrieves the value associated with the Accept-language header
        * @return the specified HTTP header value
        */
-      const std::string& getAcceptLanguage() const;
+      std::string_view getAcceptLanguage() const;
 
       /**
        * Retrieves the value associated with the Connection header
        * @return the specified HTTP header value
        */
-      const std::string& getConnection() const;
+      std::string_view getConnection() const;
 
       /**
        * Retrieves the value associated with the Do Not Track (dnt) header
        * @return the specified HTTP header value
        */
-      const std::string& getDNT() const;
+      std::string_view getDNT() const;
 
       /**
        * Retrieves the value associated with the Host header
        * @return the specified HTTP header value
        */
-      const std::string& getHost() const;
+      std::string_view getHost() const;
 
       /**
        * Retrieves the value associated with the User-agent header
        * @return the specified HTTP header value
        */
-      const std::string& getUserAgent() const;
+      std::string_view getUserAgent() const;
 
       /**
        * Set the HTTP method
@@ -199,13 +253,6 @@ class HttpRequest : public HttpTransaction {
        */
       void setMethod(const std::string& method);
 
-      /**
-       * Add/update the specified HTTP header and value
-       * @param key the header identifier to add/update
-       * @param value the value associated with header key
-       */
-      void setHeaderValue(const std::string& key, const std::string& value);
-
       /**
        * Opens socket with HTTP request and retrieves the response
        * @return HTTP response
@@ -235,6 +282,7 @@ class HttpRequest : public HttpTransaction {
       std::string m_method;
       std::string m_path;
       chaudiere::KeyValuePairs m_arguments;
+      HttpRouteParameters m_routeParameters;
       bool m_initialized;
       Url m_url;
 
@@ -11,13 +11,26 @@
 #include "Socket.h"
 #include "ByteConnection.h"
 #include "SocketConnection.h"
+#include "PipelinedConnection.h"
 #include "SocketTransport.h"
 #include "TlsConnection.h"
 #include "SocketRequest.h"
 #include "HttpServer.h"
+#include "EpochReclaimer.h"
 #include "HTTP.h"
+#include "HttpConnectionArena.h"
+#include "HttpHeaders.h"
+#include "HttpHeaderParser.h"
+#include "HttpBodyReader.h"
+#include "HttpConditional.h"
+#include "HttpFileBody.h"
+#include "HttpResponseCache.h"
+#include "BrotliCompressor.h"
+#include "GzipCompressor.h"
+#include "ZstdCompressor.h"
 #include "HttpRequest.h"
 #include "HttpResponse.h"
+#include "HttpResponseWriter.h"
 #include "Thread.h"
 #include "BasicException.h"
 #include "Logger.h"
@@ -25,17 +38,19 @@
 
 
 static const std::string HTTP_ACCEPT_ENCODING = "accept-encoding";
-static const std::string HTTP_CONNECTION      = "Connection:";
-static const std::string HTTP_CONTENT_LENGTH  = "content-length:";
-static const std::string HTTP_CONTENT_TYPE    = "content-type:";
-static const std::string HTTP_DATE            = "date:";
-static const std::string HTTP_SERVER          = "server:";
 static const std::string HTTP_USER_AGENT      = "User-Agent";
 
 static const std::string CONNECTION_CLOSE     = "close";
 static const std::string CONNECTION_KEEP_ALIVE = "keep-alive";
 
-static const std::string ZERO                 = "0";
+static const int STATUS_OK                       = 200;
+static const int STATUS_BAD_REQUEST              = 400;
+static const int STATUS_NOT_MODIFIED             = 304;
+static const int STATUS_NOT_FOUND                = 404;
+static const int STATUS_PAYLOAD_TOO_LARGE        = 413;
+static const int STATUS_INTERNAL_ERROR           = 500;
+static const int STATUS_SERVICE_UNAVAILABLE      = 503;
+static const int STATUS_HTTP_VERSION_UNSUPPORTED = 505;
 static const std::string FAVICON_ICO          = "/favicon.ico";
 
 static const std::string CONTENT_TYPE_HTML    = "text/html";
@@ -45,7 +60,11 @@ static const std::string COUNT_USER_AGENT     = "user_agent";
 
 static const std::string QUESTION_MARK        = "?";
 
-static const std::string GZIP                 = "gzip";
+static const std::string SET_COOKIE           = "set-cookie";
+static const std::string NO_STORE             = "no-store";
+static const std::string PRIVATE              = "private";
+
+static const std::string WEAK_ETAG_PREFIX     = "W/";
 
 using namespace misere;
 using namespace chaudiere;
@@ -54,9 +73,8 @@ using namespace chaudiere;
 
 static bool clientRequestedClose(const HttpRequest& request) {
    if (request.hasConnection()) {
-      std::string value = request.getConnection();
-      StrUtils::toLowerCase(value);
-      return (value == "close");
+      return HttpHeaderParser::equalsIgnoreCase(request.getConnection(),
+                                                CONNECTION_CLOSE);
    }
    return false;
 }
@@ -65,20 +83,279 @@ static bool clientRequestedClose(const HttpRequest& request) {
 
 static bool clientRequestedKeepAlive(const HttpRequest& request) {
    if (request.hasConnection()) {
-      std::string value = request.getConnection();
-      StrUtils::toLowerCase(value);
-      return (value == "keep-alive");
+      return HttpHeaderParser::equalsIgnoreCase(request.getConnection(),
+                                                CONNECTION_KEEP_ALIVE);
    }
    return false;
 }
 
 //******************************************************************************
 
+/**
+ * Retrieves the in-memory body of a response - the body view if one was
+ * set, otherwise the body buffer
+ */
+static std::string_view responseBody(const HttpResponse& response) {
+   const std::string_view bodyView = response.getBodyView();
+   if (!bodyView.empty()) {
+      return bodyView;
+   }
+
+   const ByteBuffer* body = response.getBody();
+   if (body != nullptr) {
+      return std::string_view(body->const_data(), body->size());
+   }
+
+   return std::string_view();
+}
+
+//******************************************************************************
+
+/**
+ * Picks the content coding to compress a response with - of the server's
+ * codings (and the zstd dictionary's, if one is loaded), the one the
+ * request's Accept-Encoding weights highest, with the server's order of
+ * preference breaking ties
+ * @param server the server whose codings are offered
+ * @param request the request whose Accept-Encoding is consulted
+ * @return the coding, or nullptr if the client accepts none of them
+ */
+static const std::string* negotiateEncoding(const HttpServer& server,
+                                            const HttpRequest& request) {
+   if (!request.hasAcceptEncoding()) {
+      return nullptr;
+   }
+
+   const std::string* chosen = nullptr;
+   int chosenQuality = 0;
+
+   // only clients holding the dictionary name its coding - "*" doesn't
+   // count - so when one does it's the best choice there is
+   if (server.zstdDictionary() != nullptr) {
+      const int quality =
+         request.getAcceptEncodingQuality(server.zstdDictionaryEncoding(), false);
+      if (quality > chosenQuality) {
+         chosen = &server.zstdDictionaryEncoding();
+         chosenQuality = quality;
+      }
+   }
+
+   for (const std::string& coding : server.compressionEncodings()) {
+      const int quality = request.getAcceptEncodingQuality(coding);
+      if (quality > chosenQuality) {
+         chosen = &coding;
+         chosenQuality = quality;
+      }
+   }
+
+   return chosen;
+}
+
+//******************************************************************************
+
+/**
+ * Compresses with a content coding. Each worker thread keeps its own
+ * compressor for each coding, created the first time the thread needs it
+ * and reused from then on. The level is the server's current one for
+ * each body, not whatever it was when the compressor was created.
+ */
+static bool compress(const HttpServer& server,
+                     const std::string& coding,
+                     const char* data,
+                     std::size_t length,
+                     std::string& output) {
+   const bool isDictionaryCoding = (server.zstdDictionary() != nullptr) &&
+                                   (coding == server.zstdDictionaryEncoding());
+
+   if (isDictionaryCoding || (coding == HTTP::HTTP_CODING_ZSTD)) {
+      static thread_local ZstdCompressor zstd;
+      zstd.setLevel(server.compressionLevel(HTTP::HTTP_CODING_ZSTD));
+      return zstd.compress(data,
+                           length,
+                           output,
+                           isDictionaryCoding ? server.zstdDictionary() : nullptr);
+   } else if (coding == HTTP::HTTP_CODING_BROTLI) {
+      static thread_local BrotliCompressor brotli;
+      brotli.setLevel(server.compressionLevel(HTTP::HTTP_CODING_BROTLI));
+      return brotli.compress(data, length, output);
+   } else {
+      static thread_local GzipCompressor gzip;
+      return gzip.setLevel(server.compressionLevel(HTTP::HTTP_CODING_GZIP)) &&
+             gzip.compress(data, length, output);
+   }
+}
+
+//******************************************************************************
+
+/**
+ * Replaces the response body with its encoding in a content coding, if
+ * that's smaller. The compressed body goes into an output buffer each
+ * worker thread keeps from one response to the next - the body view left
+ * on the response refers to that buffer, so it's only good until the
+ * thread's next response is compressed.
+ * @param server the server whose compression settings apply
+ * @param response the response whose body is compressed
+ * @param coding the content coding to compress with
+ * @param contentLength the length of the body
+ * @return the length of the body now on the response
+ */
+static long compressBody(const HttpServer& server,
+                         HttpResponse& response,
+                         const std::string& coding,
+                         long contentLength) {
+   static thread_local std::string compressedBody;
+
+   const std::string_view body = responseBody(response);
+
+   if (body.empty() ||
+       !compress(server, coding, body.data(), (std::size_t) contentLength, compressedBody)) {
+      LOG_ERROR("unable to compress response with " + coding)
+      return contentLength;
+   }
+
+   if ((long) compressedBody.size() >= contentLength) {
+      // already compressed or too random to gain anything
+      return contentLength;
+   }
+
+   response.setBodyView(compressedBody.data(), compressedBody.size(), nullptr);
+   response.setContentEncoding(coding);
+
+   // the encoded bytes differ from the ones a strong ETag vouches for
+   if (response.hasHeaderValue(HTTP::HTTP_ETAG)) {
+      const std::string_view etag = response.getHeaderValue(HTTP::HTTP_ETAG);
+      if (etag.compare(0, WEAK_ETAG_PREFIX.size(), WEAK_ETAG_PREFIX) != 0) {
+         response.setHeaderValue(HTTP::HTTP_ETAG, HttpConditional::weakETag(etag));
+      }
+   }
+
+   return (long) compressedBody.size();
+}
+
+//******************************************************************************
+
+/**
+ * Settles a response's validators and checks the request's preconditions
+ * against them. The ETag is hashed from the body if the handler asked for
+ * that. It's left strong here - compressBody() weakens it only if the body
+ * does get compressed - and If-None-Match compares weakly either way.
+ * @param request the request with any conditional headers
+ * @param response the response whose validators are checked
+ * @return boolean indicating whether 304 Not Modified can be sent instead
+ */
+static bool isNotModified(const HttpRequest& request,
+                          HttpResponse& response) {
+   if (!response.hasHeaderValue(HTTP::HTTP_ETAG) &&
+       response.isETagFromBody() &&
+       (response.getFileBody() == nullptr)) {
+      const std::string_view body = responseBody(response);
+      response.setHeaderValue(HTTP::HTTP_ETAG,
+                              HttpConditional::hashETag(body.data(), body.size()));
+   }
+
+   std::string_view etag;
+   if (response.hasHeaderValue(HTTP::HTTP_ETAG)) {
+      etag = response.getHeaderValue(HTTP::HTTP_ETAG);
+   }
+
+   std::string_view lastModified;
+   if (response.hasHeaderValue(HTTP::HTTP_LAST_MODIFIED)) {
+      lastModified = response.getHeaderValue(HTTP::HTTP_LAST_MODIFIED);
+   }
+
+   return HttpConditional::isNotModified(request, etag, lastModified);
+}
+
+//******************************************************************************
+
+/**
+ * Removes the header fields that describe a body from those of a 304 Not
+ * Modified response, which has none - the validators and caching fields
+ * stay
+ */
+static void removeBodyFields(HttpHeaders& headers) {
+   headers.remove(HTTP::HTTP_CONTENT_TYPE);
+   headers.remove(HTTP::HTTP_CONTENT_ENCODING);
+   headers.remove(HTTP::HTTP_CONTENT_LANGUAGE);
+}
+
+//******************************************************************************
+
+/**
+ * Determines whether a response may be kept in the response cache - not
+ * if it sets a cookie or its Cache-Control forbids storing it
+ */
+static bool isCacheable(const HttpHeaders& headers) {
+   if (headers.has(SET_COOKIE)) {
+      return false;
+   }
+
+   const std::pmr::string* cacheControl = headers.find(HttpHeaders::CACHE_CONTROL);
+   if (cacheControl != nullptr) {
+      std::string directives(*cacheControl);
+      StrUtils::toLowerCase(directives);
+      if ((directives.find(NO_STORE) != std::string::npos) ||
+          (directives.find(PRIVATE) != std::string::npos)) {
+         return false;
+      }
+   }
+
+   return true;
+}
+
+//******************************************************************************
+
+/**
+ * Writes a response from the response cache - the cached header fields and
+ * body, with the per-response headers added - or, if the client's copy is
+ * current, a 304 Not Modified without the body
+ * @return boolean indicating whether the connection stays open
+ */
+static bool sendCachedResponse(const HttpServer& server,
+                               const HttpResponseCache::Entry& entry,
+                               ByteConnection& connection,
+                               bool keepAlive,
+                               bool notModified) {
+   static thread_local std::string headerBlock;
+   headerBlock.clear();
+   if (notModified) {
+      HttpResponseWriter::appendHeaderBlock(headerBlock,
+                                            server,
+                                            STATUS_NOT_MODIFIED,
+                                            keepAlive,
+                                            entry.notModifiedFields,
+                                            HttpResponseWriter::NO_BODY);
+   } else {
+      HttpResponseWriter::appendHeaderBlock(headerBlock,
+                                            server,
+                                            entry.statusCode,
+                                            keepAlive,
+                                            entry.headerFields,
+                                            (long) entry.body.size());
+   }
+
+   ByteConnection::Segment segments[2];
+   std::size_t segmentCount = 0;
+   segments[segmentCount++] = { headerBlock.data(), headerBlock.size() };
+   if (!notModified && !entry.body.empty()) {
+      segments[segmentCount++] = { entry.body.data(), entry.body.size() };
+   }
+
+   if (!connection.writev(segments, segmentCount)) {
+      return false;
+   }
+
+   return keepAlive;
+}
+
+//******************************************************************************
+
 HttpRequestHandler::HttpRequestHandler(HttpServer& server,
                                        SocketRequest* socketRequest) :
    RequestHandler(socketRequest),
    m_server(server) {
    LOG_INSTANCE_CREATE("HttpRequestHandler")
+   m_server.addActiveConnection();
    if (nullptr != socketRequest) {
       setSocketOwned(false);
    }
@@ -91,12 +368,14 @@ HttpRequestHandler::HttpRequestHandler(HttpServer& server,
    RequestHandler(socket),
    m_server(server) {
    LOG_INSTANCE_CREATE("HttpRequestHandler")
+   m_server.addActiveConnection();
 }
 
 //******************************************************************************
 
 HttpRequestHandler::~HttpRequestHandler() {
    LOG_INSTANCE_DESTROY("HttpRequestHandler")
+   m_server.removeActiveConnection();
 }
 
 //******************************************************************************
@@ -179,7 +458,6 @@ void HttpRequestHandler::run() {
    }
 
    const bool keepAliveEnabled = m_server.keepAliveEnabled();
-   const int keepAliveMaxRequests = m_server.keepAliveMaxRequests();
 
    int requestCount = 0;
    bool connectionOpen = true;
@@ -189,6 +467,17 @@ void HttpRequestHandler::run() {
    // iteration of this loop to the next via HttpRequest::takeUnconsumedBytes()
    std::string unconsumedBytes;
 
+   // request-scoped allocations for every request on this connection come
+   // from here, and are released all at once after each request
+   HttpConnectionArena arena;
+
+   // responses to pipelined requests are held while the next request is
+   // already buffered, then written together. Declared after the TLS
+   // close guard so anything still held is written before close_notify.
+   PipelinedConnection pipeline(*connection);
+   HttpHeaderParser framer;
+   HttpBodyReader::ChunkScan chunkScan;
+
    while (connectionOpen) {
       connectionOpen = false;
       ++requestCount;
@@ -203,11 +492,19 @@ void HttpRequestHandler::run() {
 
       try {
 
+      // the request (and its response) is gone by the time this resets
+      // the arena, whether it was served or threw
+      HttpConnectionArena::ResetGuard arenaReset(arena);
+
       // stack-allocated: if the constructor throws (a malformed/truncated
       // request), the object never comes into existence, so there's
       // nothing to clean up - no heap allocation needed just to make this
       // exception-safe
-      HttpRequest request(connection.get(), false, unconsumedBytes);
+      HttpRequest request(connection.get(), false, std::move(unconsumedBytes), &arena);
+
+      // where the next request starts isn't known until the body (if
+      // any) has been read to its end
+      const bool bodyPending = request.hasPendingBody();
       unconsumedBytes = request.takeUnconsumedBytes();
 
       if (request.isInitialized()) {
@@ -216,220 +513,479 @@ void HttpRequestHandler::run() {
          //LOG_DEBUG("ending parse of HttpRequest")
       }
 
-      //const std::string& method = request.getMethod();
-      const std::string& protocol = request.getProtocol();
-      const std::string& path = request.getPath();
-
-      std::string routingPath = path;
+      // if the client has already sent the next request, this response
+      // can wait and go out with the next one
+      framer.reset();
+      chunkScan.reset();
+      pipeline.setHolding(!bodyPending &&
+                          !unconsumedBytes.empty() &&
+                          haveCompleteRequest(unconsumedBytes,
+                                              framer,
+                                              chunkScan,
+                                              m_server.maxRequestBodySize()));
+
+      connectionOpen = processRequest(m_server, request, pipeline, requestCount);
+
+      // whatever of the body the handler didn't read is skipped, so the
+      // connection is positioned at the next request
+      if (bodyPending && connectionOpen) {
+         if (request.finishBody()) {
+            unconsumedBytes = request.takeUnconsumedBytes();
+         } else {
+            connectionOpen = false;
+         }
+      }
 
-      std::string clientIPAddress;
-      socket->getPeerIPAddress(clientIPAddress);
+      // nothing may be left held once the next request needs a read
+      if (!pipeline.isHolding() || !connectionOpen) {
+         pipeline.flush();
+      }
+      }
 
-      if (StrUtils::containsString(path, QUESTION_MARK)) {
-         // strip arguments from path
-         const std::string::size_type posQuestionMark =
-            path.find(QUESTION_MARK);
-         if (posQuestionMark != std::string::npos) {
-            routingPath = path.substr(0, posQuestionMark);
+      } catch (const BasicException& be) {
+         if (requestCount == 1) {
+            LOG_ERROR("exception parsing request: " + be.whatString())
+         }
+         return;
+      } catch (const std::exception& e) {
+         if (requestCount == 1) {
+            LOG_ERROR(std::string("exception parsing request: ") + e.what())
+         }
+         return;
+      } catch (...) {
+         if (requestCount == 1) {
+            LOG_ERROR("unknown exception parsing request")
          }
+         return;
       }
+   }
+}
+
+//******************************************************************************
+
+bool HttpRequestHandler::haveCompleteRequest(const std::string& input,
+                                             HttpHeaderParser& framer,
+                                             HttpBodyReader::ChunkScan& chunkScan,
+                                             long maxBodySize) {
+   if (!framer.parse(input.data(), input.size())) {
+      return false;
+   }
+
+   // refused as soon as the headers are in - there's no telling where
+   // the body ends
+   if (framer.hasInvalidFraming()) {
+      return true;
+   }
+
+   const std::size_t headerLength = framer.getHeaderLength();
+   const std::size_t bufferedLength = input.size() - headerLength;
+
+   if (framer.isChunked()) {
+      // a malformed body counts as complete - parsing it fails without
+      // waiting for more input
+      const long bodyLength =
+         HttpBodyReader::getChunkedBodyLength(input.data() + headerLength,
+                                              bufferedLength,
+                                              chunkScan);
+      return (bodyLength != HttpBodyReader::INCOMPLETE) ||
+             ((long) bufferedLength > maxBodySize);
+   }
 
-      //LOG_COUNT_OCCURRENCE(COUNT_PATH, routingPath)
-      //if (request.hasHeaderValue(HTTP_USER_AGENT)) {
-      //   LOG_COUNT_OCCURRENCE(COUNT_USER_AGENT,
-      //                        request.getHeaderValue(HTTP_USER_AGENT))
-      //}
+   long contentLength = framer.getContentLength();
+   if (contentLength < 0) {
+      contentLength = 0;
+   }
+
+   return (bufferedLength >= (std::size_t) contentLength) ||
+          (contentLength > maxBodySize);
+}
+
+//******************************************************************************
+
+bool HttpRequestHandler::processRequest(HttpServer& server,
+                                        HttpRequest& request,
+                                        ByteConnection& connection,
+                                        int requestCount) {
+   const bool keepAliveEnabled = server.keepAliveEnabled();
+   const int keepAliveMaxRequests = server.keepAliveMaxRequests();
 
-      HttpHandler* pHandler = m_server.getPathHandler(routingPath);
-      bool handlerAvailable = false;
+   // the route table and the handler it leads to stay valid until the
+   // response is done, even if the handler is removed meanwhile
+   EpochReclaimer::ReadGuard routesGuard;
+
+   //const std::string& method = request.getMethod();
+   const std::string_view protocol = request.getProtocol();
+   const std::string_view path = request.getPath();
+
+   // strip arguments from path
+   const std::string_view routingPath = path.substr(0, path.find(QUESTION_MARK));
+
+   //LOG_COUNT_OCCURRENCE(COUNT_PATH, routingPath)
+   //if (request.hasHeaderValue(HTTP_USER_AGENT)) {
+   //   LOG_COUNT_OCCURRENCE(COUNT_USER_AGENT,
+   //                        request.getHeaderValue(HTTP_USER_AGENT))
+   //}
+
+   HttpRouteParameters routeParameters;
+   HttpHandler* pHandler = server.getPathHandler(routingPath, routeParameters);
+   bool handlerAvailable = false;
+
+   if (pHandler == nullptr) {
+      LOG_INFO("no handler for request: " + std::string(routingPath))
+   } else {
+      request.setRouteParameters(routeParameters);
+   }
 
-      if (pHandler == nullptr) {
-         LOG_INFO("no handler for request: " + routingPath)
+   // assume the worst
+   int statusCode = STATUS_INTERNAL_ERROR;
+   HttpHeaders headers;  // set by the handler
+
+   // HTTP/1.1 defaults to persistent unless the client asked to close;
+   // HTTP/1.0 defaults to close unless the client explicitly asked to
+   // keep the connection alive
+   bool negotiatedKeepAlive = false;
+
+   // a draining server finishes the request in hand and closes
+   if (keepAliveEnabled &&
+       (requestCount < keepAliveMaxRequests) &&
+       !server.isDraining() &&
+       !clientRequestedClose(request)) {
+      if (HTTP::HTTP_PROTOCOL1_1 == protocol) {
+         negotiatedKeepAlive = true;
+      } else if (HTTP::HTTP_PROTOCOL1_0 == protocol) {
+         negotiatedKeepAlive = clientRequestedKeepAlive(request);
       }
+   }
 
-      // assume the worst
-      std::string responseCode = HTTP::HTTP_RESP_SERV_ERR_INTERNAL_ERROR;
-      const std::string systemDate = m_server.getSystemDateGMT();
-      KeyValuePairs headers;
-
-      // HTTP/1.1 defaults to persistent unless the client asked to close;
-      // HTTP/1.0 defaults to close unless the client explicitly asked to
-      // keep the connection alive
-      bool negotiatedKeepAlive = false;
-
-      if (keepAliveEnabled &&
-          (requestCount < keepAliveMaxRequests) &&
-          !clientRequestedClose(request)) {
-         if (HTTP::HTTP_PROTOCOL1_1 == protocol) {
-            negotiatedKeepAlive = true;
-         } else if (HTTP::HTTP_PROTOCOL1_0 == protocol) {
-            negotiatedKeepAlive = clientRequestedKeepAlive(request);
-         }
+   if (request.hasInvalidFraming()) {
+      // a proxy in front of us may have taken the body to end elsewhere,
+      // so nothing after this request on the connection can be trusted
+      statusCode = STATUS_BAD_REQUEST;
+      negotiatedKeepAlive = false;
+      LOG_WARNING("bad request: conflicting or invalid body length")
+   } else if ((HTTP::HTTP_PROTOCOL1_0 != protocol) &&
+              (HTTP::HTTP_PROTOCOL1_1 != protocol)) {
+      statusCode = STATUS_HTTP_VERSION_UNSUPPORTED;
+      LOG_WARNING("unsupported protocol: " + std::string(protocol))
+   } else if (nullptr == pHandler) { // path recognized?
+      statusCode = STATUS_NOT_FOUND;
+      LOG_WARNING("bad request: " + std::string(path))
+   } else if (!pHandler->isAvailable()) { // is our handler available?
+      statusCode = STATUS_SERVICE_UNAVAILABLE;
+      LOG_WARNING("handler not available: " + std::string(routingPath))
+   } else {
+      handlerAvailable = true;
+   }
+
+   // a GET for a handler that caches its responses is answered from the
+   // cache if it can be, without calling the handler
+   HttpResponseCache* cache = server.responseCache();
+   int cacheTtl = 0;
+   unsigned long cacheGeneration = 0;
+   static thread_local std::string cacheKey;
+
+   if (handlerAvailable &&
+       (cache != nullptr) &&
+       (request.getMethod() == HTTP::HTTP_METHOD_GET) &&
+       (request.getBodyReader() == nullptr)) {
+      cacheTtl = pHandler->responseCacheTtl();
+   }
+
+   if (cacheTtl > 0) {
+      const std::string* coding = nullptr;
+      if (server.compressionEnabled()) {
+         coding = negotiateEncoding(server, request);
       }
 
-      headers.addPair(HTTP_CONNECTION,
-                      negotiatedKeepAlive ? CONNECTION_KEEP_ALIVE : CONNECTION_CLOSE);
-      connectionOpen = negotiatedKeepAlive;
-      const std::string& serverString = m_server.getServerId();
+      HttpResponseCache::makeKey(cacheKey,
+                                 path,
+                                 (coding != nullptr) ? *coding : std::string());
+
+      // read before the handler runs, so a response it produces while
+      // being invalidated is stored as already stale
+      cacheGeneration = pHandler->responseCacheGeneration();
+
+      std::shared_ptr<const HttpResponseCache::Entry> entry =
+         cache->find(cacheKey, cacheGeneration);
+      if (entry != nullptr) {
+         return sendCachedResponse(server,
+                                   *entry,
+                                   connection,
+                                   negotiatedKeepAlive,
+                                   HttpConditional::isNotModified(request,
+                                                                  entry->etag,
+                                                                  entry->lastModified));
+      }
+   }
 
-      if (!serverString.empty()) {
-         headers.addPair(HTTP_SERVER, serverString);
+   // the body is read into memory now, unless the handler reads it
+   // itself. One that's too large is refused without reading the rest
+   // of it, so the connection can't be used for another request. Where
+   // the whole request was read before it got here, a handler that
+   // streams the body is held to the same limit - there's no more of
+   // the body for it to read.
+   bool bodyRefused = false;
+   if (handlerAvailable) {
+      if (!pHandler->streamsRequestBody()) {
+         bodyRefused = !request.bufferBody(server.maxRequestBodySize());
+      } else if (connection.buffersWholeRequests()) {
+         bodyRefused = !request.hasBufferedBodyWithin(server.maxRequestBodySize());
       }
+   }
 
-      headers.addPair(HTTP_DATE, systemDate);
-      //headers.addPair(HTTP_CONTENT_TYPE, CONTENT_TYPE_HTML);
-
-      if ((HTTP::HTTP_PROTOCOL1_0 != protocol) &&
-          (HTTP::HTTP_PROTOCOL1_1 != protocol)) {
-         responseCode = HTTP::HTTP_RESP_SERV_ERR_HTTP_VERSION_UNSUPPORTED;
-         LOG_WARNING("unsupported protocol: " + protocol)
-      } else if (nullptr == pHandler) { // path recognized?
-         responseCode = HTTP::HTTP_RESP_CLIENT_ERR_NOT_FOUND;
-         LOG_WARNING("bad request: " + path)
-      } else if (!pHandler->isAvailable()) { // is our handler available?
-         responseCode = HTTP::HTTP_RESP_SERV_ERR_SERVICE_UNAVAILABLE;
-         LOG_WARNING("handler not available: " + routingPath)
-      } else {
-         handlerAvailable = true;
+   if (bodyRefused) {
+      if (request.getBodyReader()->hasFailed()) {
+         // truncated or malformed - there's no request to answer
+         return false;
       }
 
-      //const std::string httpHeader = request.getRawHeader();
+      statusCode = STATUS_PAYLOAD_TOO_LARGE;
+      handlerAvailable = false;
+      negotiatedKeepAlive = false;
+      LOG_WARNING("request body too large: " + std::string(routingPath))
+   }
+
+   //const std::string httpHeader = request.getRawHeader();
+
+   //if (isLoggingDebug) {
+   //   LOG_DEBUG("HttpServer method: " + method)
+   //   LOG_DEBUG("HttpServer path: " + routingPath)
+   //   LOG_DEBUG("HttpServer protocol: " + protocol)
+
+   //   LOG_DEBUG("HttpServer header:")
+   //   LOG_DEBUG(httpHeader)
+   //}
+
+   long contentLength = 0;
+   bool notModified = false;
+
+   // built in the request's arena along with the request itself
+   HttpResponse response(request.getMemoryResource());
+   const HttpFileBody* fileBody = nullptr;
 
-      //if (isLoggingDebug) {
-      //   LOG_DEBUG("HttpServer method: " + method)
-      //   LOG_DEBUG("HttpServer path: " + routingPath)
-      //   LOG_DEBUG("HttpServer protocol: " + protocol)
+   // a response to HEAD has the headers (Content-Length included) that
+   // a GET would get, and no body
+   const bool isHead = (request.getMethod() == HTTP::HTTP_METHOD_HEAD);
 
-      //   LOG_DEBUG("HttpServer header:")
-      //   LOG_DEBUG(httpHeader)
-      //}
+   // for handlers that stream their body instead of setting one
+   HttpResponseWriter writer(server,
+                             connection,
+                             response,
+                             negotiatedKeepAlive,
+                             HTTP::HTTP_PROTOCOL1_1 == protocol,
+                             isHead);
+   response.setWriter(&writer);
+   bool handlerFailed = false;
 
-      int contentLength = 0;
-      HttpResponse response;
+   if ((nullptr != pHandler) && handlerAvailable) {
+      try {
+         pHandler->serviceRequest(request, response);
+         statusCode = response.getStatusCode();
+         fileBody = response.getFileBody();
+         if (fileBody != nullptr) {
+            contentLength = (long) fileBody->getLength();
+         } else {
+            contentLength = (long) responseBody(response).size();
+         }
 
-      if ((nullptr != pHandler) && handlerAvailable) {
-         try {
-            pHandler->serviceRequest(request, response);
-            responseCode = HTTP::responseLineForStatusCode(response.getStatusCode());
-            const ByteBuffer* responseBody = response.getBody();
-            if (responseBody != nullptr) {
-               contentLength = responseBody->size();
+         const std::string* coding = nullptr;
+         if ((contentLength > 0) &&
+             (fileBody == nullptr) &&
+             !response.hasContentEncoding() &&
+             server.compressionEnabled() &&
+             server.compressResponse(response.getContentType())) {
+            // caches must key the body on Accept-Encoding whether or not
+            // this particular response gets compressed
+            if (!response.hasHeaderValue(HTTP::HTTP_VARY)) {
+               response.setHeaderValue(HTTP::HTTP_VARY,
+                                       HTTP::HTTP_ACCEPT_ENCODING);
             }
 
-            if ((contentLength > 0) && !response.hasContentEncoding()) {
-               if (request.hasAcceptEncoding()) {
-                  /*
-                  const std::string& acceptEncoding =
-                     request.getAcceptEncoding();
-
-                  if (StrUtils::containsString(acceptEncoding, GZIP) &&
-                      m_server.compressionEnabled() &&
-                      m_server.compressResponse(response.getContentType()) &&
-                      contentLength >= m_server.minimumCompressionSize()) {
-
-                     try {
-                        const std::string compressedResponseBody =
-                           StrUtils::gzipCompress(responseBody);
-                        contentLength = compressedResponseBody.size();
-                        response.setBody(compressedResponseBody);
-                        response.setContentEncoding(GZIP);
-                     } catch (const std::exception& e) {
-                        LOG_ERROR("unable to compress response")
-                     }
-                  }
-                  */
-               }
+            if (contentLength >= server.minimumCompressionSize()) {
+               coding = negotiateEncoding(server, request);
             }
+         }
 
-            response.populateWithHeaders(headers);
-         } catch (const BasicException& be) {
-            responseCode = HTTP::HTTP_RESP_SERV_ERR_INTERNAL_ERROR;
-            LOG_ERROR("exception handling request: " + be.whatString())
-         } catch (const std::exception& e) {
-            responseCode = HTTP::HTTP_RESP_SERV_ERR_INTERNAL_ERROR;
-            LOG_ERROR("exception handling request: " + std::string(e.what()))
-         } catch (...) {
-            responseCode = HTTP::HTTP_RESP_SERV_ERR_INTERNAL_ERROR;
-            LOG_ERROR("unknown exception handling request")
+         // a client whose copy is current gets a 304 without the body -
+         // decided before compressing, which is then skipped
+         notModified =
+            (statusCode == STATUS_OK) &&
+            (isHead || (request.getMethod() == HTTP::HTTP_METHOD_GET)) &&
+            isNotModified(request, response);
+
+         if (notModified) {
+            statusCode = STATUS_NOT_MODIFIED;
+            fileBody = nullptr;
+            contentLength = 0;
+         } else if (coding != nullptr) {
+            contentLength =
+               compressBody(server, response, *coding, contentLength);
          }
+
+         response.populateWithHeaders(headers);
+
+         if (notModified) {
+            removeBodyFields(headers);
+         }
+      } catch (const BasicException& be) {
+         statusCode = STATUS_INTERNAL_ERROR;
+         handlerFailed = true;
+         fileBody = nullptr;
+         contentLength = 0;
+         notModified = false;
+         LOG_ERROR("exception handling request: " + be.whatString())
+      } catch (const std::exception& e) {
+         statusCode = STATUS_INTERNAL_ERROR;
+         handlerFailed = true;
+         fileBody = nullptr;
+         contentLength = 0;
+         notModified = false;
+         LOG_ERROR("exception handling request: " + std::string(e.what()))
+      } catch (...) {
+         statusCode = STATUS_INTERNAL_ERROR;
+         handlerFailed = true;
+         fileBody = nullptr;
+         contentLength = 0;
+         notModified = false;
+         LOG_ERROR("unknown exception handling request")
+      }
+   }
+
+   if (writer.isStarted()) {
+      // the handler streamed its response. If it failed part way, the
+      // status line has already gone out - the only way left to tell
+      // the client is to leave the body unterminated and close.
+      if (handlerFailed) {
+         return false;
       }
 
+      return writer.finish() && writer.isKeepAlive();
+   }
+
+   if ((cacheTtl > 0) &&
+       !handlerFailed &&
+       (statusCode == STATUS_OK) &&
+       (fileBody == nullptr) &&
+       isCacheable(headers)) {
+      auto entry = std::make_shared<HttpResponseCache::Entry>();
+      entry->statusCode = statusCode;
+      HttpResponseWriter::appendHeaderFields(entry->headerFields, headers);
       if (contentLength > 0) {
-         headers.addPair(HTTP_CONTENT_LENGTH,
-                         StrUtils::toString(contentLength));
-      } else {
-         headers.addPair(HTTP_CONTENT_LENGTH, ZERO);
+         const std::string_view body = responseBody(response);
+         entry->body.assign(body.data(), body.size());
+      }
+
+      const std::pmr::string* etag = headers.find(HttpHeaders::ETAG);
+      if (etag != nullptr) {
+         entry->etag = *etag;
+      }
+      const std::pmr::string* lastModified = headers.find(HttpHeaders::LAST_MODIFIED);
+      if (lastModified != nullptr) {
+         entry->lastModified = *lastModified;
       }
 
-      // log the request
-      /*
-      if (isThreadPooling()) {
-         const std::string& runByWorkerThreadId = getRunByThreadWorkerId();
+      HttpHeaders notModifiedHeaders = headers;
+      removeBodyFields(notModifiedHeaders);
+      HttpResponseWriter::appendHeaderFields(entry->notModifiedFields,
+                                             notModifiedHeaders);
+      entry->generation = cacheGeneration;
+      entry->expires = std::chrono::steady_clock::now() +
+                       std::chrono::seconds(cacheTtl);
+      cache->insert(cacheKey, std::move(entry));
+   }
 
-         if (!runByWorkerThreadId.empty()) {
-            m_server.logRequest(clientIPAddress,
-                                request.getFirstHeaderLine(),
-                                responseCode,
-                                runByWorkerThreadId);
-         } else {
-            m_server.logRequest(clientIPAddress,
-                                request.getFirstHeaderLine(),
-                                responseCode);
-         }
+   // log the request
+   /*
+   if (isThreadPooling()) {
+      const std::string& runByWorkerThreadId = getRunByThreadWorkerId();
+
+      if (!runByWorkerThreadId.empty()) {
+         server.logRequest(clientIPAddress,
+                         request.getFirstHeaderLine(),
+                         HTTP::responseLineForStatusCode(statusCode),
+                         runByWorkerThreadId);
       } else {
-         m_server.logRequest(clientIPAddress,
-                             request.getFirstHeaderLine(),
-                             responseCode);
+         server.logRequest(clientIPAddress,
+                         request.getFirstHeaderLine(),
+                         HTTP::responseLineForStatusCode(statusCode));
+      }
+   } else {
+      server.logRequest(clientIPAddress,
+                       request.getFirstHeaderLine(),
+                       HTTP::responseLineForStatusCode(statusCode));
+   }
+   */
+
+   // rendered into a buffer each worker thread reuses from one response
+   // to the next
+   static thread_local std::string headerBlock;
+   headerBlock.clear();
+   HttpResponseWriter::appendHeaderBlock(headerBlock,
+                                         server,
+                                         statusCode,
+                                         negotiatedKeepAlive,
+                                         headers,
+                                         notModified ? HttpResponseWriter::NO_BODY
+                                                     : ((contentLength > 0) ? contentLength : 0));
+
+   // header block and body leave in one vectored write (one syscall for
+   // a plain socket, one record for TLS) instead of two writes
+   ByteConnection::Segment segments[2];
+   std::size_t segmentCount = 0;
+   segments[segmentCount++] = { headerBlock.data(), headerBlock.size() };
+
+   if (isHead) {
+      if (!connection.writev(segments, segmentCount)) {
+         return false;
       }
-      */
 
-      std::string headersAsString =
-         m_server.buildHeader(responseCode, headers);
-      connection->write(headersAsString.data(), headersAsString.size());
+      return negotiatedKeepAlive;
+   }
 
-      if (contentLength > 0) {
-         const ByteBuffer* body = response.getBody();
-         if (body != nullptr) {
-            connection->write(body->const_data(), body->size());
-         }
+   if (fileBody != nullptr) {
+      // the file goes from the page cache to the socket - it's never
+      // read into (or copied through) a buffer here
+      if (!connection.writev(segments, segmentCount) ||
+          !connection.sendFile(fileBody->getFileDescriptor(),
+                               fileBody->getOffset(),
+                               fileBody->getLength())) {
+         return false;
       }
 
-      /*
-       if (isLoggingDebug) {
-         LOG_DEBUG("response written, calling read so that client can close first")
-       }
-
-       // invoke a read to give the client the chance to close the socket
-       // first. this also lets us easily detect the close on the client
-       // end of the connection.  we won't actually read any data here,
-       // this is just a wait to allow the client to close first
-       char readBuffer[5];
-       socket->read(readBuffer, 4);
-
-      //if (m_socketRequest != nullptr) {
-      //   m_socketRequest->requestComplete();
-      //}
-       */
-      }
+      return negotiatedKeepAlive;
+   }
 
-      } catch (const BasicException& be) {
-         if (requestCount == 1) {
-            LOG_ERROR("exception parsing request: " + be.whatString())
-         }
-         return;
-      } catch (const std::exception& e) {
-         if (requestCount == 1) {
-            LOG_ERROR(std::string("exception parsing request: ") + e.what())
-         }
-         return;
-      } catch (...) {
-         if (requestCount == 1) {
-            LOG_ERROR("unknown exception parsing request")
-         }
-         return;
+   if (contentLength > 0) {
+      const std::string_view body = responseBody(response);
+      if (!body.empty()) {
+         segments[segmentCount++] = { body.data(), body.size() };
       }
    }
+
+   // a failed write leaves the peer with a partial response, so the
+   // connection can't be reused for another request
+   if (!connection.writev(segments, segmentCount)) {
+      return false;
+   }
+
+   /*
+    if (isLoggingDebug) {
+      LOG_DEBUG("response written, calling read so that client can close first")
+    }
+
+    // invoke a read to give the client the chance to close the socket
+    // first. this also lets us easily detect the close on the client
+    // end of the connection.  we won't actually read any data here,
+    // this is just a wait to allow the client to close first
+    char readBuffer[5];
+    socket->read(readBuffer, 4);
+
+   //if (m_socketRequest != nullptr) {
+   //   m_socketRequest->requestComplete();
+   //}
+    */
+
+   return negotiatedKeepAlive;
 }
 
 //******************************************************************************
-
@@ -4,16 +4,21 @@
 #ifndef MISERE_HTTPREQUESTHANDLER_H
 #define MISERE_HTTPREQUESTHANDLER_H
 
+#include <string>
 
 #include "Runnable.h"
 #include "RequestHandler.h"
 #include "Socket.h"
 #include "SocketRequest.h"
+#include "HttpBodyReader.h"
 
 
 namespace misere
 {
    class HttpServer;
+   class HttpRequest;
+   class ByteConnection;
+   class HttpHeaderParser;
 
 /**
  * HttpRequestHandler is the interface that must be implemented by all
@@ -54,6 +59,48 @@ public:
     */
    void run();
 
+   /**
+    * Services a single, already-parsed request: routes it to the handler
+    * registered for its path, negotiates keep-alive, and writes the
+    * complete response to the connection. This is the per-request half
+    * of run(), shared with HttpEventLoop, which parses requests off
+    * non-blocking sockets itself and only needs the response side.
+    * Unless the handler streams request bodies itself, the request's
+    * body is read into memory first - or, if it's larger than the
+    * server's max_request_body_size, answered with 413 and the
+    * connection closed.
+    * @param server the HttpServer that is being run
+    * @param request the parsed (initialized) request
+    * @param connection the connection the response is written to
+    * @param requestCount 1-based position of this request on its connection
+    * @return boolean indicating whether the connection should stay open
+    *         for a follow-up request (negotiated keep-alive)
+    */
+   static bool processRequest(HttpServer& server,
+                              HttpRequest& request,
+                              ByteConnection& connection,
+                              int requestCount);
+
+   /**
+    * Determines whether a connection's buffered input holds at least one
+    * complete request - its full header block plus as many body bytes as
+    * its Content-Length says - so parsing it will never need to read().
+    * The framer and chunk scan resume from where the previous call on
+    * the same input stopped; reset both whenever the input is replaced.
+    * @param input bytes read from the connection but not yet consumed
+    * @param framer parser used to find the end of the header block
+    * @param chunkScan progress through a chunked body, so each byte of
+    *        it is scanned once however many reads it arrives in
+    * @param maxBodySize a request whose body is (or is declared to be)
+    *        larger than this counts as complete once its headers are -
+    *        there's no point waiting for a body that will be refused
+    * @return boolean indicating whether a complete request is buffered
+    */
+   static bool haveCompleteRequest(const std::string& input,
+                                   HttpHeaderParser& framer,
+                                   HttpBodyReader::ChunkScan& chunkScan,
+                                   long maxBodySize);
+
 
 private:
    // disallow copies
@@ -3,6 +3,7 @@
 
 #include <cstdio>
 #include <cstdlib>
+#include <climits>
 #include <algorithm>
 #include <utility>
 
@@ -11,6 +12,7 @@
 #include "ByteConnection.h"
 #include "BasicException.h"
 #include "HttpException.h"
+#include "HttpDateCache.h"
 #include "Logger.h"
 #include "StrUtils.h"
 #include "ByteBuffer.h"
@@ -24,7 +26,23 @@ using namespace chaudiere;
 //******************************************************************************
 
 HttpResponse::HttpResponse() :
-   m_statusCodeAsInteger(200) {
+   m_statusCodeAsInteger(200),
+   m_isETagFromBody(false),
+   m_writer(nullptr),
+   m_fileBody(nullptr) {
+
+   LOG_INSTANCE_CREATE("HttpResponse")
+   setContentType(TEXT_HTML);
+}
+
+//******************************************************************************
+
+HttpResponse::HttpResponse(std::pmr::memory_resource* resource) :
+   HttpTransaction(resource),
+   m_statusCodeAsInteger(200),
+   m_isETagFromBody(false),
+   m_writer(nullptr),
+   m_fileBody(nullptr) {
 
    LOG_INSTANCE_CREATE("HttpResponse")
    setContentType(TEXT_HTML);
@@ -36,14 +54,21 @@ HttpResponse::HttpResponse(const HttpResponse& copy) :
    HttpTransaction(copy),
    m_statusCode(copy.m_statusCode),
    m_reasonPhrase(copy.m_reasonPhrase),
-   m_statusCodeAsInteger(copy.m_statusCodeAsInteger) {
+   m_statusCodeAsInteger(copy.m_statusCodeAsInteger),
+   m_isETagFromBody(copy.m_isETagFromBody),
+   m_writer(nullptr),
+   m_fileBody(nullptr) {
    LOG_INSTANCE_CREATE("HttpResponse")
 }
 
 //******************************************************************************
 
 HttpResponse::HttpResponse(ByteConnection* connection, std::string leadingBytes) :
-   HttpTransaction(connection, true, std::move(leadingBytes)) {
+   HttpTransaction(connection, true, std::move(leadingBytes)),
+   m_statusCodeAsInteger(0),
+   m_isETagFromBody(false),
+   m_writer(nullptr),
+   m_fileBody(nullptr) {
    LOG_INSTANCE_CREATE("HttpResponse")
 
    if (!streamFromConnection()) {
@@ -68,6 +93,7 @@ HttpResponse& HttpResponse::operator=(const HttpResponse& copy) {
    m_statusCode = copy.m_statusCode;
    m_reasonPhrase = copy.m_reasonPhrase;
    m_statusCodeAsInteger = copy.m_statusCodeAsInteger;
+   m_isETagFromBody = copy.m_isETagFromBody;
 
    return *this;
 }
@@ -75,136 +101,32 @@ HttpResponse& HttpResponse::operator=(const HttpResponse& copy) {
 //******************************************************************************
 
 bool HttpResponse::streamFromConnection2() {
-   int contentLength = -1;  // unknown
-   int bytes_read;
-   ByteConnection* c = getConnection();
-
-   if (nullptr == c) {
+   if (!HttpTransaction::streamFromConnection()) {
       return false;
    }
 
-   static const std::string HEADER_TERMINATOR = "\r\n\r\n";
-
-   // read in chunks rather than one byte per read() call, scanning the
-   // accumulated buffer for the blank line that ends the headers; any
-   // bytes read past that point are the start of the body (or the start
-   // of the *next* transaction on this connection) and are handed to the
-   // body-reading loop below, or preserved via setUnconsumedBytes() at
-   // the end, instead of being re-read from the connection
-   //
-   // seeded with whatever a previous transaction on this connection
-   // over-read and handed off via takeUnconsumedBytes()
-   std::string buffered = takeUnconsumedBytes();
-   std::string headers;
-   bool foundHeaderEnd = false;
-   char chunk[8192];
-
-   std::string::size_type posTerminator = buffered.find(HEADER_TERMINATOR);
-   if (posTerminator != std::string::npos) {
-      headers = buffered.substr(0, posTerminator);
-      buffered.erase(0, posTerminator + HEADER_TERMINATOR.length());
-      foundHeaderEnd = true;
-   }
-
-   while (!foundHeaderEnd) {
-      bytes_read = c->read(chunk, sizeof(chunk));
-
-      if (bytes_read <= 0) {
-         return false;
-      }
-
-      buffered.append(chunk, bytes_read);
-
-      posTerminator = buffered.find(HEADER_TERMINATOR);
-      if (posTerminator != std::string::npos) {
-         headers = buffered.substr(0, posTerminator);
-         buffered.erase(0, posTerminator + HEADER_TERMINATOR.length());
-         foundHeaderEnd = true;
-      }
-   }
-
-   int lineIndex = 0;
-   std::vector<std::string> vecHeaders = StrUtils::split(headers, "\r\n");
-   for (const std::string& headerLine : vecHeaders) {
-      if (lineIndex == 0) {
-         std::vector<std::string> vecStatusTokens = StrUtils::split(headerLine, " ");
-         // reason phrases are routinely multiple words ("Not Found",
-         // "Internal Server Error"), so StrUtils::split can produce more
-         // than 3 tokens here -- rejoin everything from the 3rd token on
-         // instead of requiring an exact count of 3
-         if (vecStatusTokens.size() >= 3) {
-            std::string reasonPhrase = vecStatusTokens[2];
-            for (std::size_t i = 3; i < vecStatusTokens.size(); ++i) {
-               reasonPhrase += " ";
-               reasonPhrase += vecStatusTokens[i];
-            }
-
-            std::vector<std::string> requestLineValues;
-            requestLineValues.push_back(vecStatusTokens[0]);
-            requestLineValues.push_back(vecStatusTokens[1]);
-            requestLineValues.push_back(reasonPhrase);
-
-            m_statusCode = vecStatusTokens[1];
-            m_statusCodeAsInteger = StrUtils::parseInt(m_statusCode);
-            setRequestLineValues(requestLineValues);
-         }
-      }
-      if (!headerLine.empty()) {
-         string::size_type posColon = headerLine.find(":");
-         if (posColon != string::npos) {
-            string key = StrUtils::strip(headerLine.substr(0, posColon));
-            string value = StrUtils::strip(headerLine.substr(posColon+1, headerLine.size() - 1
-));
-            if (!key.empty() && !value.empty()) {
-               StrUtils::toLowerCase(key);
-               addHeader(key, value);
-            }
-         }
-      }
-      lineIndex++;
+   // callers of a client-side response expect the whole body in
+   // getBody(), so it's read into memory here
+   if (!bufferBody(LONG_MAX)) {
+      return false;
    }
 
-   contentLength = getContentLength();
-
-   if (contentLength > 0) {
-      ByteBuffer* bb = new ByteBuffer(contentLength);
-      int offset = 0;
-
-      // serve whatever was already read past the header terminator first
-      if (!buffered.empty()) {
-         const int fromBuffer = std::min((int) buffered.size(), contentLength);
-         memcpy(bb->data(), buffered.data(), fromBuffer);
-         offset = fromBuffer;
-         buffered.erase(0, fromBuffer);
-      }
-
-      int remainingBytes = contentLength - offset;
-      int bytesToRead = 8192;
-      char buffer[8192];
-      while (remainingBytes > 0) {
-         if (remainingBytes < bytesToRead) {
-            bytesToRead = remainingBytes;
-         }
-         bytes_read = c->read(buffer, bytesToRead);
-         if (bytes_read > 0) {
-            memcpy((void*) (bb->data()+offset), buffer, bytes_read);
-            offset += bytes_read;
-            remainingBytes -= bytes_read;
-         } else {
-            delete bb;
-            return false;
-         }
-      }
-      setBody(bb);
+   // PROTOCOL STATUS [REASON] - the parser keeps a multi-word reason
+   // phrase ("Not Found", "Internal Server Error") together as the 3rd
+   // token
+   const HttpHeaderParser& parser = getHeaderParser();
+   if (parser.getFirstLineTokenCount() >= 2) {
+      setProtocol(std::string(parser.getFirstLineToken(0)));
+      m_statusCode = parser.getFirstLineToken(1);
+      m_reasonPhrase = parser.getFirstLineToken(2);
+      m_statusCodeAsInteger = StrUtils::parseInt(m_statusCode);
    }
 
-   // whatever remains in buffered - whether there was no body at all, or
-   // buffered held more than this response's body - belongs to the next
-   // transaction on this connection
-   setUnconsumedBytes(buffered);
    return true;
 }
 
+//******************************************************************************
+
 bool HttpResponse::streamFromConnection() {
    if (Logger::isLogging(LogLevel::Debug)) {
       LOG_DEBUG("******** start of HttpResponse::streamFromConnection")
@@ -213,15 +135,7 @@ bool HttpResponse::streamFromConnection() {
    bool streamSuccess = false;
 
    if (streamFromConnection2()) {
-      const std::vector<std::string>& vecRequestLineValues =
-         getRequestLineValues();
-
-      if (3 == vecRequestLineValues.size()) {
-         setProtocol(vecRequestLineValues[0]);
-         m_statusCode = vecRequestLineValues[1];
-         m_reasonPhrase = vecRequestLineValues[2];
-         m_statusCodeAsInteger = StrUtils::parseInt(m_statusCode);
-
+      if (getHeaderParser().getFirstLineTokenCount() >= 2) {
          if (0 == m_statusCodeAsInteger) {
             LOG_ERROR("unable to parse status code")
             return false;
@@ -378,13 +292,13 @@ bool HttpResponse::hasContentType() const {
 
 //******************************************************************************
 
-const std::string& HttpResponse::getContentEncoding() const {
+std::string_view HttpResponse::getContentEncoding() const {
    return getHeaderValue(HTTP::HTTP_CONTENT_ENCODING);
 }
 
 //******************************************************************************
 
-const std::string& HttpResponse::getContentType() const {
+std::string_view HttpResponse::getContentType() const {
    return getHeaderValue(HTTP::HTTP_CONTENT_TYPE);
 }
 
@@ -402,6 +316,37 @@ void HttpResponse::setContentType(const std::string& contentType) {
 
 //******************************************************************************
 
+void HttpResponse::setETag(const std::string& etag) {
+   if (!etag.empty() && ((etag.front() == '"') || (etag.compare(0, 2, "W/") == 0))) {
+      setHeaderValue(HTTP::HTTP_ETAG, etag);
+   } else {
+      setHeaderValue(HTTP::HTTP_ETAG, "\"" + etag + "\"");
+   }
+}
+
+//******************************************************************************
+
+void HttpResponse::setLastModified(time_t lastModified) {
+   char httpDate[HttpDateCache::HTTP_DATE_LENGTH + 1];
+   setHeaderValue(HTTP::HTTP_LAST_MODIFIED,
+                  std::string(httpDate,
+                              HttpDateCache::formatHttpDate(lastModified, httpDate)));
+}
+
+//******************************************************************************
+
+void HttpResponse::setETagFromBody(bool isETagFromBody) {
+   m_isETagFromBody = isETagFromBody;
+}
+
+//******************************************************************************
+
+bool HttpResponse::isETagFromBody() const {
+   return m_isETagFromBody;
+}
+
+//******************************************************************************
+
 void HttpResponse::close() {
    //TODO: implement HttpResponse::close
 }
@@ -409,20 +354,57 @@ void HttpResponse::close() {
 //******************************************************************************
 
 int HttpResponse::getContentLength() const {
-   int lengthValue = 0;
+   const int lengthValue = HttpTransaction::getContentLength();
+   return (lengthValue > 0) ? lengthValue : 0;
+}
 
-   if (hasHeaderValue(HTTP::HTTP_CONTENT_LENGTH)) {
-      lengthValue =
-         StrUtils::parseInt(getHeaderValue(HTTP::HTTP_CONTENT_LENGTH));
+//******************************************************************************
+
+void HttpResponse::setContentLength(int contentLength) {
+   setHeaderValue(HTTP::HTTP_CONTENT_LENGTH, StrUtils::toString(contentLength));
+}
+
+//******************************************************************************
+
+void HttpResponse::setBodyView(const char* data,
+                               std::size_t length,
+                               std::shared_ptr<const void> owner) {
+   m_bodyView = std::string_view(data, length);
+   m_bodyViewOwner = std::move(owner);
+   setBody(nullptr);
+}
+
+//******************************************************************************
+
+std::string_view HttpResponse::getBodyView() const {
+   return m_bodyView;
+}
+
+//******************************************************************************
+
+void HttpResponse::setFileBody(HttpFileBody* fileBody) {
+   m_fileBody.reset(fileBody);
+   if (fileBody != nullptr) {
+      setBody(nullptr);
    }
+}
 
-   return lengthValue;
+//******************************************************************************
+
+const HttpFileBody* HttpResponse::getFileBody() const {
+   return m_fileBody.get();
 }
 
 //******************************************************************************
 
-void HttpResponse::setContentLength(int contentLength) {
-   setHeaderValue(HTTP::HTTP_CONTENT_LENGTH, StrUtils::toString(contentLength));
+HttpResponseWriter* HttpResponse::getWriter() const {
+   return m_writer;
+}
+
+//******************************************************************************
+
+void HttpResponse::setWriter(HttpResponseWriter* writer) {
+   m_writer = writer;
 }
 
 //******************************************************************************
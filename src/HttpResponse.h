@@ -4,14 +4,19 @@
 #ifndef MISERE_HTTPRESPONSE_H
 #define MISERE_HTTPRESPONSE_H
 
+#include <ctime>
+#include <memory>
 #include <string>
+#include <string_view>
 
 #include "HttpTransaction.h"
 #include "ByteConnection.h"
+#include "HttpFileBody.h"
 
 
 namespace misere
 {
+   class HttpResponseWriter;
 
 /**
  * HttpRequest is used by an HTTP client for parsing an HTTP response.
@@ -24,6 +29,15 @@ class HttpResponse : public HttpTransaction
        */
       HttpResponse();
 
+      /**
+       * Constructs a response to build, with its headers allocated from a
+       * memory resource
+       * @param resource the memory resource - the request's (see
+       *        HttpTransaction::getMemoryResource()), which must outlive
+       *        the response
+       */
+      explicit HttpResponse(std::pmr::memory_resource* resource);
+
       /**
        * Constructs and HttpResponse by reading from a connection
        * @param connection the connection to read from
@@ -95,13 +109,13 @@ class HttpResponse : public HttpTransaction
        * Retrieves the value for the Content-encoding HTTP header field
        * @return the value for the Content-encoding field
        */
-      const std::string& getContentEncoding() const;
+      std::string_view getContentEncoding() const;
 
       /**
        * Retrieves the value for the Content-type HTTP header field
        * @return the value for the Content-type field
        */
-      const std::string& getContentType() const;
+      std::string_view getContentType() const;
 
       /**
        * Sets the Content-encoding HTTP header field
@@ -115,17 +129,101 @@ class HttpResponse : public HttpTransaction
        */
       void setContentType(const std::string& contentType);
 
+      /**
+       * Sets the ETag HTTP header field, the validator a conditional GET
+       * (If-None-Match) is checked against
+       * @param etag the entity tag - quoted (and with W/ for a weak one)
+       *        or a bare opaque value, which is quoted here
+       */
+      void setETag(const std::string& etag);
+
+      /**
+       * Sets the Last-Modified HTTP header field, the validator
+       * If-Modified-Since is checked against
+       * @param lastModified when the resource last changed
+       */
+      void setLastModified(time_t lastModified);
+
+      /**
+       * Asks the server to give the response a strong ETag hashed from its
+       * body, if the handler doesn't set one itself
+       * @param isETagFromBody whether the ETag is computed from the body
+       */
+      void setETagFromBody(bool isETagFromBody);
+
+      /**
+       * Determines whether the server should compute the ETag from the body
+       * @return boolean indicating if the ETag is computed from the body
+       */
+      bool isETagFromBody() const;
+
       void close();
 
       int getContentLength() const;
 
       void setContentLength(int contentLength);
 
+      /**
+       * Sets the body to bytes the response doesn't copy or own - e.g. an
+       * asset held in memory for the life of the server - in place of
+       * any body set with setBody()
+       * @param data the body bytes
+       * @param length the number of body bytes
+       * @param owner keeps the bytes alive until the response is done
+       *        with them (may be empty if they outlive the response)
+       */
+      void setBodyView(const char* data,
+                       std::size_t length,
+                       std::shared_ptr<const void> owner);
+
+      /**
+       * Retrieves the body set with setBodyView()
+       * @return the body bytes (empty if none were set)
+       */
+      std::string_view getBodyView() const;
+
+      /**
+       * Sets the body to a range of an open file, which the server writes
+       * to the connection without reading it into memory (sendfile(2) on
+       * a plain socket), in place of any body set with setBody()
+       * @param fileBody the file body (ownership is taken)
+       * @see HttpFileBody
+       */
+      void setFileBody(HttpFileBody* fileBody);
+
+      /**
+       * Retrieves the file body, if one was set
+       * @return the file body, or nullptr if none was set
+       */
+      const HttpFileBody* getFileBody() const;
+
+      /**
+       * Retrieves the writer for streaming the body of a response being
+       * served, as an alternative to setBody(). Once anything has been
+       * written, the status and headers have been sent and setting them
+       * has no further effect.
+       * @return the response writer, or nullptr if the response isn't
+       *         being served (e.g., a client-side response)
+       * @see HttpResponseWriter
+       */
+      HttpResponseWriter* getWriter() const;
+
+      /**
+       * Sets the writer for streaming the body (done by the server)
+       * @param writer the writer (not owned)
+       */
+      void setWriter(HttpResponseWriter* writer);
+
 
    private:
       std::string m_statusCode;
       std::string m_reasonPhrase;
       int m_statusCodeAsInteger;
+      bool m_isETagFromBody;
+      HttpResponseWriter* m_writer;
+      std::unique_ptr<HttpFileBody> m_fileBody;
+      std::string_view m_bodyView;
+      std::shared_ptr<const void> m_bodyViewOwner;
 
 };
 
@@ -0,0 +1,154 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include <iterator>
+#include <mutex>
+#include <utility>
+
+#include "HttpResponseCache.h"
+
+using namespace misere;
+
+//******************************************************************************
+
+HttpResponseCache::HttpResponseCache(std::size_t maxSize) :
+   m_maxShardSize(maxSize / SHARD_COUNT) {
+}
+
+//******************************************************************************
+
+void HttpResponseCache::makeKey(std::string& key,
+                                std::string_view target,
+                                std::string_view coding) {
+   // a line feed can't appear in a request target, so it separates the
+   // two without ambiguity
+   key.clear();
+   key.reserve(target.size() + 1 + coding.size());
+   key.append(target);
+   key += '\n';
+   key.append(coding);
+}
+
+//******************************************************************************
+
+HttpResponseCache::Shard& HttpResponseCache::shardFor(std::string_view key) const {
+   return m_shards[KeyHash()(key) % SHARD_COUNT];
+}
+
+//******************************************************************************
+
+std::shared_ptr<const HttpResponseCache::Entry>
+HttpResponseCache::find(std::string_view key, unsigned long generation) const {
+   const Shard& shard = shardFor(key);
+   std::shared_ptr<const Entry> entry;
+
+   {
+      std::shared_lock<std::shared_mutex> lock(shard.mutex);
+      auto it = shard.slots.find(key);
+      if (it == shard.slots.end()) {
+         return nullptr;
+      }
+      entry = it->second.entry;
+   }
+
+   // a stale entry is left for the insert of its replacement to overwrite
+   if ((entry->generation != generation) ||
+       (std::chrono::steady_clock::now() >= entry->expires)) {
+      return nullptr;
+   }
+
+   return entry;
+}
+
+//******************************************************************************
+
+bool HttpResponseCache::insert(std::string_view key,
+                               std::shared_ptr<const Entry> entry) {
+   const std::size_t size =
+      key.size() + entry->headerFields.size() +
+      entry->notModifiedFields.size() + entry->body.size();
+
+   Shard& shard = shardFor(key);
+   std::unique_lock<std::shared_mutex> lock(shard.mutex);
+
+   auto it = shard.slots.find(key);
+   if (it != shard.slots.end()) {
+      erase(shard, it);
+   }
+
+   if (size > m_maxShardSize) {
+      return false;
+   }
+
+   while (shard.size + size > m_maxShardSize) {
+      erase(shard, shard.slots.find(shard.ages.front()));
+   }
+
+   shard.ages.emplace_back(key);
+   Slot slot;
+   slot.entry = std::move(entry);
+   slot.age = std::prev(shard.ages.end());
+   slot.size = size;
+   shard.slots.emplace(shard.ages.back(), std::move(slot));
+   shard.size += size;
+
+   return true;
+}
+
+//******************************************************************************
+
+bool HttpResponseCache::remove(std::string_view key) {
+   Shard& shard = shardFor(key);
+   std::unique_lock<std::shared_mutex> lock(shard.mutex);
+
+   auto it = shard.slots.find(key);
+   if (it == shard.slots.end()) {
+      return false;
+   }
+
+   erase(shard, it);
+   return true;
+}
+
+//******************************************************************************
+
+void HttpResponseCache::erase(Shard& shard, SlotMap::iterator it) {
+   shard.size -= it->second.size;
+   shard.ages.erase(it->second.age);
+   shard.slots.erase(it);
+}
+
+//******************************************************************************
+
+void HttpResponseCache::clear() {
+   for (Shard& shard : m_shards) {
+      std::unique_lock<std::shared_mutex> lock(shard.mutex);
+      shard.slots.clear();
+      shard.ages.clear();
+      shard.size = 0;
+   }
+}
+
+//******************************************************************************
+
+std::size_t HttpResponseCache::getEntryCount() const {
+   std::size_t count = 0;
+   for (const Shard& shard : m_shards) {
+      std::shared_lock<std::shared_mutex> lock(shard.mutex);
+      count += shard.slots.size();
+   }
+   return count;
+}
+
+//******************************************************************************
+
+std::size_t HttpResponseCache::getSize() const {
+   std::size_t size = 0;
+   for (const Shard& shard : m_shards) {
+      std::shared_lock<std::shared_mutex> lock(shard.mutex);
+      size += shard.size;
+   }
+   return size;
+}
+
+//******************************************************************************
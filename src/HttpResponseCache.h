@@ -0,0 +1,163 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef MISERE_HTTPRESPONSECACHE_H
+#define MISERE_HTTPRESPONSECACHE_H
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+
+namespace misere
+{
+
+/**
+ * HttpResponseCache holds finished responses - the handler's rendered
+ * header fields and the body, already compressed if it was going to be -
+ * for handlers that opt in (see HttpHandler::responseCacheTtl()). A
+ * response is keyed on the request target (path and query) and the
+ * content coding negotiated for it, so each representation is cached on
+ * its own. A hit is served without calling the handler at all: the
+ * per-response headers (Date, Connection, Content-Length) are added to
+ * the cached ones and the body is written straight from the entry.
+ *
+ * An entry is good until its expiry time, or until the handler's cache
+ * generation (HttpHandler::responseCacheGeneration()) moves past the one
+ * it was stored under - which is how a handler invalidates everything
+ * it has cached.
+ *
+ * Entries are spread over independently locked shards, and a lookup
+ * only takes its shard's lock shared. When a shard is over its share of
+ * the size limit, its oldest entries are dropped first.
+ */
+class HttpResponseCache
+{
+   public:
+      struct Entry
+      {
+         int statusCode;
+         std::string headerFields;   // rendered "Name: value\r\n" lines
+         std::string notModifiedFields;   // the same, for a 304
+         std::string body;
+         std::string etag;
+         std::string lastModified;
+         unsigned long generation;
+         std::chrono::steady_clock::time_point expires;
+      };
+
+      /**
+       * Default limit on the total size of cached responses (64 MB)
+       */
+      static const std::size_t DEFAULT_MAX_SIZE = 64 * 1024 * 1024;
+
+      /**
+       * Constructs a cache
+       * @param maxSize limit on the total size (in bytes) of the cached
+       *        keys, header fields and bodies
+       */
+      explicit HttpResponseCache(std::size_t maxSize=DEFAULT_MAX_SIZE);
+
+      /**
+       * Builds the cache key for a representation
+       * @param key the string to build the key in (cleared first)
+       * @param target the request target (path and query)
+       * @param coding the content coding negotiated for the response (empty
+       *        for none)
+       */
+      static void makeKey(std::string& key,
+                          std::string_view target,
+                          std::string_view coding);
+
+      /**
+       * Looks up a cached response
+       * @param key the key built by makeKey()
+       * @param generation the handler's current cache generation
+       * @return the response, or nullptr if there's none that's current
+       */
+      std::shared_ptr<const Entry> find(std::string_view key,
+                                        unsigned long generation) const;
+
+      /**
+       * Caches a response, replacing any cached under the same key
+       * @param key the key built by makeKey()
+       * @param entry the response
+       * @return boolean indicating whether it was cached (false if it's
+       *         too large to fit)
+       */
+      bool insert(std::string_view key, std::shared_ptr<const Entry> entry);
+
+      /**
+       * Removes a cached response
+       * @param key the key built by makeKey()
+       * @return boolean indicating whether a response was removed
+       */
+      bool remove(std::string_view key);
+
+      /**
+       * Removes every cached response
+       */
+      void clear();
+
+      /**
+       * Retrieves the number of cached responses
+       * @return the number of entries
+       */
+      std::size_t getEntryCount() const;
+
+      /**
+       * Retrieves the total size of the cached responses
+       * @return the size, in bytes
+       */
+      std::size_t getSize() const;
+
+   private:
+      static const std::size_t SHARD_COUNT = 16;
+
+      struct KeyHash
+      {
+         using is_transparent = void;
+         std::size_t operator()(std::string_view key) const {
+            return std::hash<std::string_view>()(key);
+         }
+      };
+
+      struct Slot
+      {
+         std::shared_ptr<const Entry> entry;
+         std::list<std::string>::iterator age;
+         std::size_t size;
+      };
+
+      using SlotMap = std::unordered_map<std::string, Slot, KeyHash, std::equal_to<>>;
+
+      struct Shard
+      {
+         Shard() : size(0) {}
+
+         mutable std::shared_mutex mutex;
+         SlotMap slots;
+         std::list<std::string> ages;   // oldest first
+         std::size_t size;
+      };
+
+      Shard& shardFor(std::string_view key) const;
+      static void erase(Shard& shard, SlotMap::iterator it);
+
+      mutable Shard m_shards[SHARD_COUNT];
+      std::size_t m_maxShardSize;
+
+      // disallow copies
+      HttpResponseCache(const HttpResponseCache&);
+      HttpResponseCache& operator=(const HttpResponseCache&);
+};
+
+}
+
+#endif
@@ -0,0 +1,335 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include <charconv>
+
+#include "HttpResponseWriter.h"
+#include "HttpServer.h"
+#include "HttpResponse.h"
+#include "HttpHeaders.h"
+#include "HttpHeaderPrefixes.h"
+#include "HttpDateCache.h"
+
+static const std::string EOL                      = "\r\n";
+static const std::string COLON_SPACE              = ": ";
+static const std::string DATE_PREFIX              = "Date: ";
+static const std::string CONTENT_LENGTH_PREFIX    = "Content-Length: ";
+static const std::string TRANSFER_ENCODING_CHUNKED = "Transfer-Encoding: chunked\r\n";
+static const std::string LAST_CHUNK               = "0\r\n\r\n";
+
+// hex digits of a 64-bit size plus CRLF
+static const std::size_t MAX_CHUNK_SIZE_LINE = 18;
+
+using namespace misere;
+
+//******************************************************************************
+
+HttpResponseWriter::HttpResponseWriter(HttpServer& server,
+                                       ByteConnection& connection,
+                                       HttpResponse& response,
+                                       bool keepAlive,
+                                       bool chunkedAllowed,
+                                       bool headersOnly) :
+   m_server(server),
+   m_connection(connection),
+   m_response(response),
+   m_contentLength(CHUNKED),
+   m_bytesWritten(0),
+   m_keepAlive(keepAlive),
+   m_chunkedAllowed(chunkedAllowed),
+   m_headersOnly(headersOnly),
+   m_isStarted(false),
+   m_isFinished(false),
+   m_hasFailed(false) {
+}
+
+//******************************************************************************
+
+void HttpResponseWriter::appendHeaderBlock(std::string& block,
+                                           const HttpServer& server,
+                                           int statusCode,
+                                           bool keepAlive,
+                                           const HttpHeaders& headers,
+                                           long contentLength) {
+   appendHeaderStart(block, server, statusCode, keepAlive);
+   appendHeaderFields(block, headers);
+   appendHeaderEnd(block, contentLength);
+}
+
+//******************************************************************************
+
+void HttpResponseWriter::appendHeaderBlock(std::string& block,
+                                           const HttpServer& server,
+                                           int statusCode,
+                                           bool keepAlive,
+                                           std::string_view headerFields,
+                                           long contentLength) {
+   appendHeaderStart(block, server, statusCode, keepAlive);
+   block.append(headerFields);
+   appendHeaderEnd(block, contentLength);
+}
+
+//******************************************************************************
+
+void HttpResponseWriter::appendHeaderFields(std::string& block,
+                                            const HttpHeaders& headers) {
+   for (const HttpHeaders::Entry& entry : headers) {
+      // these are the server's to set
+      if ((entry.id == HttpHeaders::CONNECTION) ||
+          (entry.id == HttpHeaders::SERVER) ||
+          (entry.id == HttpHeaders::DATE) ||
+          (entry.id == HttpHeaders::CONTENT_LENGTH) ||
+          (entry.id == HttpHeaders::TRANSFER_ENCODING)) {
+         continue;
+      }
+
+      block += entry.name;
+      block += COLON_SPACE;
+      block += entry.value;
+      block += EOL;
+   }
+}
+
+//******************************************************************************
+
+void HttpResponseWriter::appendHeaderStart(std::string& block,
+                                           const HttpServer& server,
+                                           int statusCode,
+                                           bool keepAlive) {
+   // the fixed part of the header block (status line, Server,
+   // Connection) was rendered at startup; only Date, the handler's own
+   // headers and the body framing are appended after it
+   server.getHeaderPrefixes().append(block, statusCode, keepAlive);
+
+   char systemDate[HttpDateCache::HTTP_DATE_LENGTH];
+   block += DATE_PREFIX;
+   block.append(systemDate, server.getDateCache().copyHttpDate(systemDate));
+   block += EOL;
+}
+
+//******************************************************************************
+
+void HttpResponseWriter::appendHeaderEnd(std::string& block, long contentLength) {
+   if (contentLength >= 0) {
+      char lengthText[24];
+      const std::to_chars_result lengthResult =
+         std::to_chars(lengthText, lengthText + sizeof(lengthText), contentLength);
+      block += CONTENT_LENGTH_PREFIX;
+      block.append(lengthText, lengthResult.ptr - lengthText);
+      block += EOL;
+   } else if (contentLength == CHUNKED) {
+      block += TRANSFER_ENCODING_CHUNKED;
+   }
+
+   block += EOL;
+}
+
+//******************************************************************************
+
+bool HttpResponseWriter::send(const ByteConnection::Segment* segments,
+                              std::size_t count) {
+   if (!m_connection.writev(segments, count)) {
+      m_hasFailed = true;
+      return false;
+   }
+
+   return true;
+}
+
+//******************************************************************************
+
+bool HttpResponseWriter::start(const char* data, std::size_t length) {
+   m_isStarted = true;
+
+   if (m_response.getHeaders().has(HttpHeaders::CONTENT_LENGTH)) {
+      m_contentLength = m_response.getContentLength();
+   } else if (m_isFinished) {
+      // finished before anything was streamed - the whole body is known
+      m_contentLength = (long) length;
+   } else if (m_chunkedAllowed) {
+      m_contentLength = CHUNKED;
+   } else {
+      // an HTTP/1.0 client can only find the end of an unknown-length
+      // body by the connection closing
+      m_contentLength = CLOSE_DELIMITED;
+      m_keepAlive = false;
+   }
+
+   HttpHeaders headers;
+   m_response.populateWithHeaders(headers);
+
+   static thread_local std::string headerBlock;
+   headerBlock.clear();
+   appendHeaderBlock(headerBlock,
+                     m_server,
+                     m_response.getStatusCode(),
+                     m_keepAlive,
+                     headers,
+                     m_contentLength);
+
+   m_bytesWritten += length;
+
+   if ((length == 0) || m_headersOnly) {
+      const ByteConnection::Segment segment = { headerBlock.data(), headerBlock.size() };
+      return send(&segment, 1);
+   }
+
+   // the headers and the first piece of the body leave in one write
+   ByteConnection::Segment segments[4];
+   std::size_t count = 0;
+   segments[count++] = { headerBlock.data(), headerBlock.size() };
+
+   char sizeLine[MAX_CHUNK_SIZE_LINE];
+   if (m_contentLength == CHUNKED) {
+      const std::to_chars_result result =
+         std::to_chars(sizeLine, sizeLine + sizeof(sizeLine) - EOL.size(), length, 16);
+      char* end = result.ptr;
+      *end++ = '\r';
+      *end++ = '\n';
+      segments[count++] = { sizeLine, (std::size_t) (end - sizeLine) };
+      segments[count++] = { data, length };
+      segments[count++] = { EOL.data(), EOL.size() };
+   } else {
+      segments[count++] = { data, length };
+   }
+
+   return send(segments, count);
+}
+
+//******************************************************************************
+
+bool HttpResponseWriter::write(const char* data, std::size_t length) {
+   if (m_isFinished || m_hasFailed) {
+      return false;
+   }
+
+   // a zero-length chunk would end the body
+   if (length == 0) {
+      return flush();
+   }
+
+   if (!m_isStarted) {
+      if (m_response.getHeaders().has(HttpHeaders::CONTENT_LENGTH) &&
+          (length > (std::size_t) m_response.getContentLength())) {
+         return false;
+      }
+      return start(data, length);
+   }
+
+   if ((m_contentLength >= 0) &&
+       (m_bytesWritten + length > (std::uint64_t) m_contentLength)) {
+      return false;
+   }
+
+   m_bytesWritten += length;
+
+   if (m_headersOnly) {
+      return true;
+   }
+
+   if (m_contentLength != CHUNKED) {
+      const ByteConnection::Segment segment = { data, length };
+      return send(&segment, 1);
+   }
+
+   char sizeLine[MAX_CHUNK_SIZE_LINE];
+   const std::to_chars_result result =
+      std::to_chars(sizeLine, sizeLine + sizeof(sizeLine) - EOL.size(), length, 16);
+   char* end = result.ptr;
+   *end++ = '\r';
+   *end++ = '\n';
+
+   const ByteConnection::Segment segments[3] = {
+      { sizeLine, (std::size_t) (end - sizeLine) },
+      { data, length },
+      { EOL.data(), EOL.size() }
+   };
+   return send(segments, 3);
+}
+
+//******************************************************************************
+
+bool HttpResponseWriter::flush() {
+   if (m_isStarted) {
+      return !m_hasFailed;
+   }
+
+   return start(nullptr, 0);
+}
+
+//******************************************************************************
+
+bool HttpResponseWriter::finish() {
+   if (m_isFinished) {
+      return !m_hasFailed;
+   }
+
+   m_isFinished = true;
+
+   if (!m_isStarted && !start(nullptr, 0)) {
+      return false;
+   }
+
+   if (m_hasFailed) {
+      return false;
+   }
+
+   // a response to HEAD ends with its headers, whatever the handler
+   // wrote (or didn't) of the body
+   if (m_headersOnly) {
+      return true;
+   }
+
+   if (m_contentLength == CHUNKED) {
+      const ByteConnection::Segment segment = { LAST_CHUNK.data(), LAST_CHUNK.size() };
+      return send(&segment, 1);
+   }
+
+   // the client is still waiting for the rest of the declared length
+   if ((m_contentLength >= 0) &&
+       (m_bytesWritten != (std::uint64_t) m_contentLength)) {
+      m_hasFailed = true;
+      return false;
+   }
+
+   return true;
+}
+
+//******************************************************************************
+
+bool HttpResponseWriter::isStarted() const {
+   return m_isStarted;
+}
+
+//******************************************************************************
+
+bool HttpResponseWriter::isFinished() const {
+   return m_isFinished;
+}
+
+//******************************************************************************
+
+bool HttpResponseWriter::isChunked() const {
+   return m_isStarted && (m_contentLength == CHUNKED);
+}
+
+//******************************************************************************
+
+bool HttpResponseWriter::hasFailed() const {
+   return m_hasFailed;
+}
+
+//******************************************************************************
+
+bool HttpResponseWriter::isKeepAlive() const {
+   return m_keepAlive && !m_hasFailed;
+}
+
+//******************************************************************************
+
+std::uint64_t HttpResponseWriter::getBytesWritten() const {
+   return m_bytesWritten;
+}
+
+//******************************************************************************
+
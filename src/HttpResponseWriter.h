@@ -0,0 +1,219 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef MISERE_HTTPRESPONSEWRITER_H
+#define MISERE_HTTPRESPONSEWRITER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "ByteConnection.h"
+
+
+namespace misere
+{
+   class HttpServer;
+   class HttpResponse;
+   class HttpHeaders;
+
+/**
+ * HttpResponseWriter lets a handler send its response body as it is
+ * produced instead of building it whole in a ByteBuffer first.
+ *
+ * The first write() (or flush()) sends the status line and the headers
+ * set on the response so far; after that the status and headers can't
+ * change. If the handler set a Content-Length, body bytes are sent as
+ * they are; otherwise each write() goes out as one chunk of a
+ * Transfer-Encoding: chunked body, or - for an HTTP/1.0 client, which
+ * can't receive chunked - unframed, ending the connection after the
+ * response. finish() ends the body; the server calls it when the handler
+ * returns if the handler didn't.
+ *
+ * Every write goes straight to the connection, which blocks while the
+ * peer isn't reading, so a slow client slows the handler down rather
+ * than the response piling up in memory.
+ *
+ * Handlers that never touch the writer keep working as before - the
+ * server writes their ByteBuffer body with a Content-Length.
+ */
+class HttpResponseWriter
+{
+   public:
+      /**
+       * appendHeaderBlock() content length for a chunked body
+       */
+      static const long CHUNKED = -1;
+
+      /**
+       * appendHeaderBlock() content length for a body that ends when the
+       * connection closes
+       */
+      static const long CLOSE_DELIMITED = -2;
+
+      /**
+       * appendHeaderBlock() content length for a response that can't have
+       * a body (e.g., 304 Not Modified), so no Content-Length is sent
+       */
+      static const long NO_BODY = -3;
+
+      /**
+       * Constructs a writer for a response being served
+       * @param server the server, for the pre-rendered header prefixes
+       *        and cached date
+       * @param connection the connection the response is written to
+       * @param response the response whose status and headers are sent
+       * @param keepAlive whether the connection is to stay open after the
+       *        response (as negotiated with the client)
+       * @param chunkedAllowed whether the client accepts a chunked body
+       *        (HTTP/1.1)
+       * @param headersOnly whether only the headers are sent (a response
+       *        to HEAD) - the body is still counted, but never written
+       */
+      HttpResponseWriter(HttpServer& server,
+                         ByteConnection& connection,
+                         HttpResponse& response,
+                         bool keepAlive,
+                         bool chunkedAllowed,
+                         bool headersOnly);
+
+      /**
+       * Renders a response header block - status line, Server and
+       * Connection (pre-rendered), Date, the handler's headers, and the
+       * body framing
+       * @param block the buffer to append to
+       * @param server the server
+       * @param statusCode the HTTP status code
+       * @param keepAlive whether the connection stays open
+       * @param headers the headers set by the handler (Connection, Server,
+       *        Date, Content-Length and Transfer-Encoding are skipped -
+       *        they're the server's to set)
+       * @param contentLength the body length, CHUNKED, CLOSE_DELIMITED or
+       *        NO_BODY
+       */
+      static void appendHeaderBlock(std::string& block,
+                                    const HttpServer& server,
+                                    int statusCode,
+                                    bool keepAlive,
+                                    const HttpHeaders& headers,
+                                    long contentLength);
+
+      /**
+       * Renders a response header block around header fields rendered
+       * earlier by appendHeaderFields() (e.g., for a cached response)
+       * @param block the buffer to append to
+       * @param server the server
+       * @param statusCode the HTTP status code
+       * @param keepAlive whether the connection stays open
+       * @param headerFields the rendered header fields
+       * @param contentLength the body length, CHUNKED, CLOSE_DELIMITED or
+       *        NO_BODY
+       */
+      static void appendHeaderBlock(std::string& block,
+                                    const HttpServer& server,
+                                    int statusCode,
+                                    bool keepAlive,
+                                    std::string_view headerFields,
+                                    long contentLength);
+
+      /**
+       * Renders the handler's headers as "Name: value" lines, skipping
+       * the ones that are the server's to set
+       * @param block the buffer to append to
+       * @param headers the headers set by the handler
+       */
+      static void appendHeaderFields(std::string& block,
+                                     const HttpHeaders& headers);
+
+      /**
+       * Sends body bytes, sending the headers first if they haven't been
+       * @param data the bytes to send
+       * @param length the number of bytes
+       * @return boolean indicating whether the write succeeded (false if
+       *         the connection failed, the response is finished, or it
+       *         would exceed a declared Content-Length)
+       */
+      bool write(const char* data, std::size_t length);
+
+      /**
+       * Sends the headers now, if they haven't been sent
+       * @return boolean indicating whether the write succeeded
+       */
+      bool flush();
+
+      /**
+       * Ends the body - the terminating chunk for a chunked body. Sends
+       * the headers first if nothing has been written.
+       * @return boolean indicating whether the response ended cleanly
+       */
+      bool finish();
+
+      /**
+       * Determines whether the headers have been sent
+       * @return boolean indicating if the response has started
+       */
+      bool isStarted() const;
+
+      /**
+       * Determines whether finish() has been called
+       * @return boolean indicating if the response is finished
+       */
+      bool isFinished() const;
+
+      /**
+       * Determines whether the body is being sent chunked
+       * @return boolean indicating if the body is chunked
+       */
+      bool isChunked() const;
+
+      /**
+       * Determines whether a write failed or the declared length wasn't
+       * met, leaving the connection unusable for another response
+       * @return boolean indicating if the response failed
+       */
+      bool hasFailed() const;
+
+      /**
+       * Determines whether the connection can stay open after the
+       * response - false if it had to be close-delimited or it failed
+       * @return boolean indicating if the connection can be kept alive
+       */
+      bool isKeepAlive() const;
+
+      /**
+       * Retrieves the number of body bytes (excluding chunk framing) sent
+       * @return number of body bytes sent
+       */
+      std::uint64_t getBytesWritten() const;
+
+   private:
+      static void appendHeaderStart(std::string& block,
+                                    const HttpServer& server,
+                                    int statusCode,
+                                    bool keepAlive);
+      static void appendHeaderEnd(std::string& block, long contentLength);
+
+      bool start(const char* data, std::size_t length);
+      bool send(const ByteConnection::Segment* segments, std::size_t count);
+
+      HttpServer& m_server;
+      ByteConnection& m_connection;
+      HttpResponse& m_response;
+      long m_contentLength;
+      std::uint64_t m_bytesWritten;
+      bool m_keepAlive;
+      bool m_chunkedAllowed;
+      bool m_headersOnly;
+      bool m_isStarted;
+      bool m_isFinished;
+      bool m_hasFailed;
+
+      // disallow copies
+      HttpResponseWriter(const HttpResponseWriter&);
+      HttpResponseWriter& operator=(const HttpResponseWriter&);
+};
+
+}
+
+#endif
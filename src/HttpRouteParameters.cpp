@@ -0,0 +1,81 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include "HttpRouteParameters.h"
+
+using namespace misere;
+
+//******************************************************************************
+
+HttpRouteParameters::HttpRouteParameters() :
+   m_size(0) {
+}
+
+//******************************************************************************
+
+bool HttpRouteParameters::add(std::string_view name, std::string_view value) {
+   if (m_size >= MAX_PARAMETERS) {
+      return false;
+   }
+
+   m_names[m_size] = name;
+   m_values[m_size] = value;
+   ++m_size;
+   return true;
+}
+
+//******************************************************************************
+
+bool HttpRouteParameters::has(std::string_view name) const {
+   for (std::size_t i = 0; i < m_size; ++i) {
+      if (m_names[i] == name) {
+         return true;
+      }
+   }
+   return false;
+}
+
+//******************************************************************************
+
+std::string_view HttpRouteParameters::get(std::string_view name) const {
+   for (std::size_t i = 0; i < m_size; ++i) {
+      if (m_names[i] == name) {
+         return m_values[i];
+      }
+   }
+   return std::string_view();
+}
+
+//******************************************************************************
+
+std::string_view HttpRouteParameters::getName(std::size_t index) const {
+   return m_names[index];
+}
+
+//******************************************************************************
+
+std::string_view HttpRouteParameters::getValue(std::size_t index) const {
+   return m_values[index];
+}
+
+//******************************************************************************
+
+std::size_t HttpRouteParameters::size() const {
+   return m_size;
+}
+
+//******************************************************************************
+
+void HttpRouteParameters::truncate(std::size_t count) {
+   if (count < m_size) {
+      m_size = count;
+   }
+}
+
+//******************************************************************************
+
+void HttpRouteParameters::clear() {
+   m_size = 0;
+}
+
+//******************************************************************************
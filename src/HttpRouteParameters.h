@@ -0,0 +1,94 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef MISERE_HTTPROUTEPARAMETERS_H
+#define MISERE_HTTPROUTEPARAMETERS_H
+
+#include <cstddef>
+#include <string_view>
+
+
+namespace misere
+{
+
+/**
+ * HttpRouteParameters holds the parameters a route captured from a request
+ * path - for the route "/users/:id" and the path "/users/42", "id" is
+ * "42"; a catch-all segment "*rest" ending a route captures the rest of
+ * the path, slashes and all. Names and values are views (of the
+ * route and of the request path), held in place without allocating, so
+ * they're only good while the request is being served.
+ */
+class HttpRouteParameters
+{
+   public:
+      /**
+       * Most parameters a single route can capture
+       */
+      static const std::size_t MAX_PARAMETERS = 8;
+
+      HttpRouteParameters();
+
+      /**
+       * Adds a captured parameter
+       * @param name the parameter name (without its ':' or '*')
+       * @param value the captured text
+       * @return boolean indicating whether there was room for it
+       */
+      bool add(std::string_view name, std::string_view value);
+
+      /**
+       * Determines whether a parameter was captured
+       * @param name the parameter name
+       * @return boolean indicating whether the parameter is present
+       */
+      bool has(std::string_view name) const;
+
+      /**
+       * Retrieves a captured parameter
+       * @param name the parameter name
+       * @return the captured text (empty if the parameter isn't present)
+       */
+      std::string_view get(std::string_view name) const;
+
+      /**
+       * Retrieves the name of a parameter by position
+       * @param index position of the parameter (less than size())
+       * @return the parameter name
+       */
+      std::string_view getName(std::size_t index) const;
+
+      /**
+       * Retrieves the value of a parameter by position
+       * @param index position of the parameter (less than size())
+       * @return the captured text
+       */
+      std::string_view getValue(std::size_t index) const;
+
+      /**
+       * Retrieves the number of captured parameters
+       * @return number of parameters
+       */
+      std::size_t size() const;
+
+      /**
+       * Drops parameters captured after the first count (used by the
+       * router when it backs out of a route that didn't match)
+       * @param count number of parameters to keep
+       */
+      void truncate(std::size_t count);
+
+      /**
+       * Removes all parameters
+       */
+      void clear();
+
+   private:
+      std::string_view m_names[MAX_PARAMETERS];
+      std::string_view m_values[MAX_PARAMETERS];
+      std::size_t m_size;
+};
+
+}
+
+#endif
@@ -0,0 +1,327 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include <utility>
+
+#include "HttpRouter.h"
+
+using namespace misere;
+
+static const char PARAMETER_MARKER = ':';
+static const char CATCH_ALL_MARKER = '*';
+
+namespace {
+
+/**
+ * Splits the next piece off a route - the literal text up to the next
+ * parameter or catch-all segment, then that segment's marker and name
+ * @param route the route being split
+ * @param position where the piece starts (advanced past it)
+ * @param literal receives the literal text (may be empty)
+ * @param marker receives the segment's marker, or 0 if the route ended
+ *        with the literal text
+ * @param name receives the parameter or catch-all name
+ * @return boolean indicating whether the piece is well formed
+ */
+bool nextPiece(std::string_view route,
+               std::size_t& position,
+               std::string_view& literal,
+               char& marker,
+               std::string_view& name) {
+   std::size_t markerPosition = position;
+   while ((markerPosition < route.size()) &&
+          !(((route[markerPosition] == PARAMETER_MARKER) ||
+             (route[markerPosition] == CATCH_ALL_MARKER)) &&
+            (route[markerPosition - 1] == '/'))) {
+      ++markerPosition;
+   }
+
+   literal = route.substr(position, markerPosition - position);
+
+   if (markerPosition == route.size()) {
+      marker = 0;
+      position = markerPosition;
+      return true;
+   }
+
+   marker = route[markerPosition];
+   std::size_t end = route.find('/', markerPosition);
+   if (end == std::string_view::npos) {
+      end = route.size();
+   }
+
+   name = route.substr(markerPosition + 1, end - markerPosition - 1);
+   position = end;
+
+   // a catch-all takes the rest of the path, so nothing can follow it
+   return !name.empty() &&
+          ((marker == PARAMETER_MARKER) || (end == route.size()));
+}
+
+}
+
+//******************************************************************************
+
+HttpRouter::Node::Node() :
+   handler(nullptr),
+   isMount(false) {
+}
+
+//******************************************************************************
+
+HttpRouter::HttpRouter() :
+   m_size(0) {
+}
+
+//******************************************************************************
+
+HttpRouter::~HttpRouter() {
+}
+
+//******************************************************************************
+
+HttpRouter::Node* HttpRouter::addLiteral(Node* node, std::string_view text) {
+   while (!text.empty()) {
+      const std::string::size_type index = node->indices.find(text[0]);
+      if (index == std::string::npos) {
+         std::unique_ptr<Node> child(new Node);
+         child->prefix.assign(text);
+         node->indices += text[0];
+         node->children.push_back(std::move(child));
+         return node->children.back().get();
+      }
+
+      Node* child = node->children[index].get();
+      std::size_t common = 0;
+      while ((common < child->prefix.size()) &&
+             (common < text.size()) &&
+             (child->prefix[common] == text[common])) {
+         ++common;
+      }
+
+      if (common < child->prefix.size()) {
+         // the edge is split where the new route leaves it
+         std::unique_ptr<Node> middle(new Node);
+         middle->prefix.assign(child->prefix, 0, common);
+         child->prefix.erase(0, common);
+         middle->indices += child->prefix[0];
+         middle->children.push_back(std::move(node->children[index]));
+         node->children[index] = std::move(middle);
+         child = node->children[index].get();
+      }
+
+      node = child;
+      text.remove_prefix(common);
+   }
+
+   return node;
+}
+
+//******************************************************************************
+
+HttpRouter::Node* HttpRouter::addParameter(std::unique_ptr<Node>& slot,
+                                           std::string_view name) {
+   if (slot == nullptr) {
+      slot.reset(new Node);
+      slot->parameterName.assign(name);
+   } else if (slot->parameterName != name) {
+      // the same segment can't be captured under two names
+      return nullptr;
+   }
+
+   return slot.get();
+}
+
+//******************************************************************************
+
+bool HttpRouter::add(std::string_view route, HttpHandler* handler, bool isMount) {
+   if (route.empty() || (route[0] != '/') || (handler == nullptr)) {
+      return false;
+   }
+
+   Node* node = &m_root;
+   std::size_t position = 0;
+
+   while (position < route.size()) {
+      std::string_view literal;
+      char marker;
+      std::string_view name;
+      if (!nextPiece(route, position, literal, marker, name)) {
+         return false;
+      }
+
+      node = addLiteral(node, literal);
+
+      if (marker == PARAMETER_MARKER) {
+         node = addParameter(node->parameter, name);
+      } else if (marker == CATCH_ALL_MARKER) {
+         node = addParameter(node->catchAll, name);
+      }
+
+      if (node == nullptr) {
+         return false;
+      }
+   }
+
+   if (node->handler != nullptr) {
+      return false;
+   }
+
+   node->handler = handler;
+   node->isMount = isMount;
+   ++m_size;
+   return true;
+}
+
+//******************************************************************************
+
+HttpRouter::Node* HttpRouter::findNode(std::string_view route) const {
+   const Node* node = &m_root;
+   std::size_t position = 0;
+
+   while (position < route.size()) {
+      std::string_view literal;
+      char marker;
+      std::string_view name;
+      if (!nextPiece(route, position, literal, marker, name)) {
+         return nullptr;
+      }
+
+      while (!literal.empty()) {
+         const std::string::size_type index = node->indices.find(literal[0]);
+         if (index == std::string::npos) {
+            return nullptr;
+         }
+
+         node = node->children[index].get();
+         if (literal.compare(0, node->prefix.size(), node->prefix) != 0) {
+            return nullptr;
+         }
+         literal.remove_prefix(node->prefix.size());
+      }
+
+      if (marker != 0) {
+         const std::unique_ptr<Node>& slot =
+            (marker == PARAMETER_MARKER) ? node->parameter : node->catchAll;
+         if ((slot == nullptr) || (slot->parameterName != name)) {
+            return nullptr;
+         }
+         node = slot.get();
+      }
+   }
+
+   return const_cast<Node*>(node);
+}
+
+//******************************************************************************
+
+bool HttpRouter::remove(std::string_view route) {
+   Node* node = findNode(route);
+   if ((node == nullptr) || (node->handler == nullptr)) {
+      return false;
+   }
+
+   // the node stays, as the routes sharing its edges may still need it
+   node->handler = nullptr;
+   node->isMount = false;
+   --m_size;
+   return true;
+}
+
+//******************************************************************************
+
+HttpHandler* HttpRouter::find(std::string_view path,
+                              HttpRouteParameters& parameters) const {
+   parameters.clear();
+
+   MountMatch mount;
+   mount.handler = nullptr;
+   mount.length = 0;
+
+   HttpHandler* handler = match(m_root, path, path, parameters, mount);
+   if (handler != nullptr) {
+      return handler;
+   }
+
+   if (mount.handler != nullptr) {
+      parameters = mount.parameters;
+   }
+
+   return mount.handler;
+}
+
+//******************************************************************************
+
+HttpHandler* HttpRouter::match(const Node& node,
+                               std::string_view path,
+                               std::string_view rest,
+                               HttpRouteParameters& parameters,
+                               MountMatch& mount) {
+   // a mount covers the paths below it - at a segment boundary, so that
+   // "/static" doesn't take "/staticx"
+   if (node.isMount &&
+       (rest.empty() ||
+        (rest.front() == '/') ||
+        (!node.prefix.empty() && (node.prefix.back() == '/')))) {
+      const std::size_t length = path.size() - rest.size();
+      if ((mount.handler == nullptr) || (length > mount.length)) {
+         mount.handler = node.handler;
+         mount.length = length;
+         mount.parameters = parameters;
+      }
+   }
+
+   if (rest.empty()) {
+      if (node.handler != nullptr) {
+         return node.handler;
+      }
+   } else {
+      const std::string::size_type index = node.indices.find(rest[0]);
+      if (index != std::string::npos) {
+         const Node& child = *node.children[index];
+         if (rest.compare(0, child.prefix.size(), child.prefix) == 0) {
+            HttpHandler* handler = match(child,
+                                         path,
+                                         rest.substr(child.prefix.size()),
+                                         parameters,
+                                         mount);
+            if (handler != nullptr) {
+               return handler;
+            }
+         }
+      }
+
+      if (node.parameter != nullptr) {
+         const std::string_view value = rest.substr(0, rest.find('/'));
+         const std::size_t count = parameters.size();
+         if (!value.empty() &&
+             parameters.add(node.parameter->parameterName, value)) {
+            HttpHandler* handler = match(*node.parameter,
+                                         path,
+                                         rest.substr(value.size()),
+                                         parameters,
+                                         mount);
+            if (handler != nullptr) {
+               return handler;
+            }
+            parameters.truncate(count);
+         }
+      }
+   }
+
+   if ((node.catchAll != nullptr) &&
+       (node.catchAll->handler != nullptr) &&
+       parameters.add(node.catchAll->parameterName, rest)) {
+      return node.catchAll->handler;
+   }
+
+   return nullptr;
+}
+
+//******************************************************************************
+
+std::size_t HttpRouter::size() const {
+   return m_size;
+}
+
+//******************************************************************************
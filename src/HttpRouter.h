@@ -0,0 +1,123 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef MISERE_HTTPROUTER_H
+#define MISERE_HTTPROUTER_H
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "HttpRouteParameters.h"
+
+
+namespace misere
+{
+   class HttpHandler;
+
+/**
+ * HttpRouter maps request paths to handlers through a radix tree - edges
+ * are the longest runs of path shared by the routes below them, so a
+ * lookup compares each byte of the path about once, however many routes
+ * there are. A route is a path whose segments may also be:
+ *
+ * - a parameter, ":name", matching one non-empty segment
+ *   ("/users/:id" matches "/users/42")
+ * - a catch-all, "*name", as the last segment, matching the rest of the
+ *   path, slashes and all ("/files/" followed by "*path" matches
+ *   "/files/a/b.txt", capturing "a/b.txt")
+ *
+ * A route can also be a mount, serving the paths below it as well as its
+ * own ("/static" serves "/static/css/site.css", but not "/staticx").
+ *
+ * Literal segments take precedence over a parameter, and a parameter over
+ * a catch-all, backing out of a branch that doesn't lead to a route; a
+ * path that no route matches goes to the mount that covers the most of
+ * it. Matching works on views of the path and captures parameters as
+ * views, without allocating.
+ *
+ * The router doesn't own its handlers.
+ */
+class HttpRouter
+{
+   public:
+      HttpRouter();
+      ~HttpRouter();
+
+      /**
+       * Adds a route
+       * @param route the route (e.g., "/users/:id")
+       * @param handler the handler for the route
+       * @param isMount whether the handler also serves the paths below
+       *        the route
+       * @return boolean indicating whether the route was added (false if
+       *         it's malformed, already has a handler, or names its
+       *         parameter differently than a route sharing its position)
+       */
+      bool add(std::string_view route, HttpHandler* handler, bool isMount);
+
+      /**
+       * Removes a route
+       * @param route the route as it was added
+       * @return boolean indicating whether a route was removed
+       */
+      bool remove(std::string_view route);
+
+      /**
+       * Finds the handler for a request path
+       * @param path the request path (without the query)
+       * @param parameters receives the parameters the route captured
+       * @return the handler, or nullptr if no route matches
+       */
+      HttpHandler* find(std::string_view path,
+                        HttpRouteParameters& parameters) const;
+
+      /**
+       * Retrieves the number of routes
+       * @return number of routes
+       */
+      std::size_t size() const;
+
+   private:
+      struct Node
+      {
+         Node();
+
+         std::string prefix;        // edge label (empty for a parameter)
+         std::string indices;       // first byte of each child's prefix
+         std::vector<std::unique_ptr<Node>> children;
+         std::unique_ptr<Node> parameter;
+         std::unique_ptr<Node> catchAll;
+         std::string parameterName;
+         HttpHandler* handler;
+         bool isMount;
+      };
+
+      struct MountMatch
+      {
+         HttpHandler* handler;
+         std::size_t length;
+         HttpRouteParameters parameters;
+      };
+
+      static Node* addLiteral(Node* node, std::string_view text);
+      static Node* addParameter(std::unique_ptr<Node>& slot, std::string_view name);
+      Node* findNode(std::string_view route) const;
+      static HttpHandler* match(const Node& node,
+                                std::string_view path,
+                                std::string_view rest,
+                                HttpRouteParameters& parameters,
+                                MountMatch& mount);
+
+      Node m_root;
+      std::size_t m_size;
+
+      // disallow copies
+      HttpRouter(const HttpRouter&);
+      HttpRouter& operator=(const HttpRouter&);
+};
+
+}
+
+#endif
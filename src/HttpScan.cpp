@@ -0,0 +1,304 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include <atomic>
+#include <string.h>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define MISERE_HTTPSCAN_X86 1
+#include <immintrin.h>
+#endif
+
+#include "HttpScan.h"
+
+using namespace misere;
+
+namespace {
+
+typedef const char* (*FindByteFn)(const char*, const char*, char);
+typedef const char* (*FindTerminatorFn)(const char*, const char*);
+
+struct ScanKernels {
+   const char* name;
+   FindByteFn findByte;
+   FindTerminatorFn findHeaderTerminator;
+};
+
+}
+
+static const char CR = '\r';
+static const char LF = '\n';
+static const long TERMINATOR_SIZE = 4;
+
+//******************************************************************************
+
+static bool isTerminatorAt(const char* p) {
+   return (p[0] == CR) && (p[1] == LF) && (p[2] == CR) && (p[3] == LF);
+}
+
+//******************************************************************************
+
+// the scalar versions are what the parser did before the SIMD kernels:
+// memchr for single bytes, and memchr to each candidate CR for the
+// terminator (the same approach as std::string_view::find)
+static const char* findByteScalar(const char* begin, const char* end, char c) {
+   if (begin >= end) {
+      return end;
+   }
+
+   const void* found = ::memchr(begin, c, end - begin);
+   return (nullptr != found) ? static_cast<const char*>(found) : end;
+}
+
+//******************************************************************************
+
+static const char* findHeaderTerminatorScalar(const char* begin, const char* end) {
+   const char* p = begin;
+   while ((end - p) >= TERMINATOR_SIZE) {
+      p = findByteScalar(p, end - (TERMINATOR_SIZE - 1), CR);
+      if (p == end - (TERMINATOR_SIZE - 1)) {
+         break;
+      }
+      if (isTerminatorAt(p)) {
+         return p;
+      }
+      ++p;
+   }
+
+   return end;
+}
+
+//******************************************************************************
+
+#if defined(MISERE_HTTPSCAN_X86)
+
+// SSE2 is part of the x86-64 baseline, so these need no target attribute
+
+static const char* findByteSse2(const char* begin, const char* end, char c) {
+   const __m128i needle = _mm_set1_epi8(c);
+   const char* p = begin;
+
+   while ((end - p) >= 16) {
+      const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+      const int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, needle));
+      if (mask != 0) {
+         return p + __builtin_ctz(mask);
+      }
+      p += 16;
+   }
+
+   for (; p < end; ++p) {
+      if (*p == c) {
+         return p;
+      }
+   }
+
+   return end;
+}
+
+//******************************************************************************
+
+// compares four overlapping loads (offset 0..3) against CR, LF, CR, LF so
+// a set bit marks a position where the whole terminator starts
+static const char* findHeaderTerminatorSse2(const char* begin, const char* end) {
+   const __m128i cr = _mm_set1_epi8(CR);
+   const __m128i lf = _mm_set1_epi8(LF);
+   const char* p = begin;
+
+   while ((end - p) >= 16 + (TERMINATOR_SIZE - 1)) {
+      const __m128i b0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+      const __m128i b1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 1));
+      const __m128i b2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 2));
+      const __m128i b3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 3));
+      const __m128i match =
+         _mm_and_si128(_mm_and_si128(_mm_cmpeq_epi8(b0, cr), _mm_cmpeq_epi8(b1, lf)),
+                       _mm_and_si128(_mm_cmpeq_epi8(b2, cr), _mm_cmpeq_epi8(b3, lf)));
+      const int mask = _mm_movemask_epi8(match);
+      if (mask != 0) {
+         return p + __builtin_ctz(mask);
+      }
+      p += 16;
+   }
+
+   for (; (end - p) >= TERMINATOR_SIZE; ++p) {
+      if (isTerminatorAt(p)) {
+         return p;
+      }
+   }
+
+   return end;
+}
+
+//******************************************************************************
+
+__attribute__((target("avx2")))
+static const char* findByteAvx2(const char* begin, const char* end, char c) {
+   const __m256i needle = _mm256_set1_epi8(c);
+   const char* p = begin;
+
+   while ((end - p) >= 32) {
+      const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+      const unsigned int mask =
+         (unsigned int) _mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, needle));
+      if (mask != 0) {
+         return p + __builtin_ctz(mask);
+      }
+      p += 32;
+   }
+
+   return findByteSse2(p, end, c);
+}
+
+//******************************************************************************
+
+__attribute__((target("avx2")))
+static const char* findHeaderTerminatorAvx2(const char* begin, const char* end) {
+   const __m256i cr = _mm256_set1_epi8(CR);
+   const __m256i lf = _mm256_set1_epi8(LF);
+   const char* p = begin;
+
+   while ((end - p) >= 32 + (TERMINATOR_SIZE - 1)) {
+      const __m256i b0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+      const __m256i b1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 1));
+      const __m256i b2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 2));
+      const __m256i b3 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 3));
+      const __m256i match =
+         _mm256_and_si256(_mm256_and_si256(_mm256_cmpeq_epi8(b0, cr), _mm256_cmpeq_epi8(b1, lf)),
+                          _mm256_and_si256(_mm256_cmpeq_epi8(b2, cr), _mm256_cmpeq_epi8(b3, lf)));
+      const unsigned int mask = (unsigned int) _mm256_movemask_epi8(match);
+      if (mask != 0) {
+         return p + __builtin_ctz(mask);
+      }
+      p += 32;
+   }
+
+   return findHeaderTerminatorSse2(p, end);
+}
+
+#endif
+
+//******************************************************************************
+
+static const ScanKernels SCALAR_KERNELS =
+   { "scalar", findByteScalar, findHeaderTerminatorScalar };
+
+#if defined(MISERE_HTTPSCAN_X86)
+static const ScanKernels SSE2_KERNELS =
+   { "sse2", findByteSse2, findHeaderTerminatorSse2 };
+static const ScanKernels AVX2_KERNELS =
+   { "avx2", findByteAvx2, findHeaderTerminatorAvx2 };
+#endif
+
+// selected lazily on first use rather than by a static initializer, so
+// it's safe to scan from other static initializers
+static std::atomic<const ScanKernels*> activeKernels(nullptr);
+
+//******************************************************************************
+
+static bool cpuSupportsAvx2() {
+#if defined(MISERE_HTTPSCAN_X86)
+   __builtin_cpu_init();
+   return __builtin_cpu_supports("avx2");
+#else
+   return false;
+#endif
+}
+
+//******************************************************************************
+
+static const ScanKernels* bestKernels() {
+#if defined(MISERE_HTTPSCAN_X86)
+   return cpuSupportsAvx2() ? &AVX2_KERNELS : &SSE2_KERNELS;
+#else
+   return &SCALAR_KERNELS;
+#endif
+}
+
+//******************************************************************************
+
+static inline const ScanKernels* kernels() {
+   const ScanKernels* k = activeKernels.load(std::memory_order_relaxed);
+   if (nullptr == k) {
+      k = bestKernels();
+      activeKernels.store(k, std::memory_order_relaxed);
+   }
+   return k;
+}
+
+//******************************************************************************
+
+const char* HttpScan::findByte(const char* begin, const char* end, char c) {
+   return kernels()->findByte(begin, end, c);
+}
+
+//******************************************************************************
+
+const char* HttpScan::findEol(const char* begin, const char* end) {
+   const FindByteFn findByteFn = kernels()->findByte;
+   const char* p = begin;
+
+   while (p < end) {
+      p = findByteFn(p, end, CR);
+      if (p == end) {
+         break;
+      }
+      if (((p + 1) < end) && (p[1] == LF)) {
+         return p;
+      }
+      ++p;
+   }
+
+   return end;
+}
+
+//******************************************************************************
+
+const char* HttpScan::findHeaderTerminator(const char* begin, const char* end) {
+   return kernels()->findHeaderTerminator(begin, end);
+}
+
+//******************************************************************************
+
+std::string HttpScan::getImplementationName() {
+   return kernels()->name;
+}
+
+//******************************************************************************
+
+std::vector<std::string> HttpScan::getAvailableImplementations() {
+   std::vector<std::string> names;
+   names.push_back(SCALAR_KERNELS.name);
+#if defined(MISERE_HTTPSCAN_X86)
+   names.push_back(SSE2_KERNELS.name);
+   if (cpuSupportsAvx2()) {
+      names.push_back(AVX2_KERNELS.name);
+   }
+#endif
+   return names;
+}
+
+//******************************************************************************
+
+bool HttpScan::selectImplementation(const std::string& name) {
+   const ScanKernels* selected = nullptr;
+
+   if (name == SCALAR_KERNELS.name) {
+      selected = &SCALAR_KERNELS;
+   }
+#if defined(MISERE_HTTPSCAN_X86)
+   else if (name == SSE2_KERNELS.name) {
+      selected = &SSE2_KERNELS;
+   } else if ((name == AVX2_KERNELS.name) && cpuSupportsAvx2()) {
+      selected = &AVX2_KERNELS;
+   }
+#endif
+
+   if (nullptr == selected) {
+      return false;
+   }
+
+   activeKernels.store(selected, std::memory_order_relaxed);
+   return true;
+}
+
+//******************************************************************************
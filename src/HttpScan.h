@@ -0,0 +1,77 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef MISERE_HTTPSCAN_H
+#define MISERE_HTTPSCAN_H
+
+#include <string>
+#include <vector>
+
+
+namespace misere
+{
+
+/**
+ * HttpScan holds the byte-scanning kernels used when parsing HTTP header
+ * blocks: finding the blank line that ends the headers, line ends, and
+ * the ':' and ' ' delimiters within a line.
+ *
+ * On x86-64 there are SSE2 and AVX2 versions that compare 16 or 32 bytes
+ * per step; elsewhere (or if forced) a scalar version is used. The best
+ * version the CPU supports is selected the first time any kernel is
+ * called. selectImplementation() exists for tests and benchmarks and is
+ * not meant to be called while the server is handling requests.
+ */
+class HttpScan
+{
+   public:
+      /**
+       * Finds the first occurrence of a byte
+       * @param begin start of the range to search
+       * @param end one past the last byte of the range
+       * @param c the byte to find
+       * @return pointer to the byte, or end if not found
+       */
+      static const char* findByte(const char* begin, const char* end, char c);
+
+      /**
+       * Finds the first CRLF line ending
+       * @param begin start of the range to search
+       * @param end one past the last byte of the range
+       * @return pointer to the CR of the CRLF, or end if not found
+       */
+      static const char* findEol(const char* begin, const char* end);
+
+      /**
+       * Finds the CRLFCRLF sequence that ends a header block
+       * @param begin start of the range to search
+       * @param end one past the last byte of the range
+       * @return pointer to the first CR of the sequence, or end if not found
+       */
+      static const char* findHeaderTerminator(const char* begin, const char* end);
+
+      /**
+       * Retrieves the name of the implementation in use ("scalar", "sse2"
+       * or "avx2")
+       * @return name of the active implementation
+       */
+      static std::string getImplementationName();
+
+      /**
+       * Retrieves the names of the implementations this CPU can run,
+       * scalar first
+       * @return list of implementation names
+       */
+      static std::vector<std::string> getAvailableImplementations();
+
+      /**
+       * Forces use of the named implementation
+       * @param name the implementation name (see getAvailableImplementations)
+       * @return boolean indicating whether the implementation is available
+       */
+      static bool selectImplementation(const std::string& name);
+};
+
+}
+
+#endif
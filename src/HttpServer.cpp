@@ -2,12 +2,27 @@
 // BSD License
 
 #include <string>
+#include <chrono>
 #include <exception>
-
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
+#include <unistd.h>
+#include <sys/socket.h>
 #include <sys/time.h>
+#if defined(__linux__)
+#include <dlfcn.h>
+#include <link.h>
+#endif
 
 // http
 #include "HttpServer.h"
@@ -16,13 +31,18 @@
 #include "HttpHandler.h"
 #include "HttpRequestHandler.h"
 #include "HttpSocketServiceHandler.h"
+#include "HttpEventLoop.h"
+#include "BrotliCompressor.h"
+#include "GzipCompressor.h"
 
 // sockets
-#include "ServerSocket.h"
+#include "ListenerHandoff.h"
+#include "ListeningSocket.h"
 #include "Socket.h"
 
 // utils
 #include "BasicException.h"
+#include "CpuAffinity.h"
 #include "IniReader.h"
 #include "KeyValuePairs.h"
 #include "DynamicLibrary.h"
@@ -38,6 +58,7 @@
 #include "ThreadPoolDispatcher.h"
 #include "PthreadsThreadingFactory.h"
 #include "StdThreadingFactory.h"
+#include "WorkStealingDispatcher.h"
 
 // kernel events
 #include "KernelEventServer.h"
@@ -49,8 +70,10 @@
 #include "GMTDateTimeHandler.h"
 #include "ServerDateTimeHandler.h"
 #include "ServerObjectsDebugging.h"
+#include "ServerReloadHandler.h"
 #include "ServerStatsHandler.h"
 #include "ServerStatusHandler.h"
+#include "StaticFileHandler.h"
 
 // TLS
 #include "armure/Armure.h"
@@ -75,6 +98,26 @@ static const int CFG_DEFAULT_PORT_NUMBER          = 9000;
 static const int CFG_DEFAULT_THREAD_POOL_SIZE     = 4;
 static const int CFG_DEFAULT_KEEP_ALIVE_TIMEOUT       = 5;
 static const int CFG_DEFAULT_KEEP_ALIVE_MAX_REQUESTS  = 100;
+static const int CFG_DEFAULT_MAX_REQUEST_BODY_SIZE    = 10 * 1024 * 1024;
+static const int CFG_DEFAULT_SHUTDOWN_TIMEOUT         = 30;
+static const int CFG_DEFAULT_COMPRESSION_MIN_SIZE     = 1000;
+static const string CFG_DEFAULT_COMPRESSION_ENCODINGS  = "zstd, br, gzip";
+static const string CFG_DEFAULT_ZSTD_DICTIONARY_ENCODING = "x-zstd-dictionary";
+static const string CFG_DEFAULT_COMPRESSION_MIME_TYPES =
+   "text/html,text/plain,text/css,text/csv,application/javascript,"
+   "application/json,application/xml,image/svg+xml";
+static const string CFG_DEFAULT_STATIC_FILES_PATH     = "/static";
+
+// how often the signal thread checks for signals, a handoff request and
+// old route tables
+static const int SIGNAL_WATCH_MILLIS = 250;
+
+// how long the socket server waits for a connection before checking
+// whether it's been shut down
+static const int ACCEPT_WAIT_MILLIS = 250;
+
+// how often a shut down server checks whether its connections are done
+static const int DRAIN_CHECK_MILLIS = 50;
 
 // configuration sections
 static const string CFG_SECTION_SERVER                 = "server";
@@ -98,18 +141,43 @@ static const string CFG_SERVER_SOCKETS                 = "sockets";
 static const string CFG_SERVER_KEEP_ALIVE              = "keep_alive";
 static const string CFG_SERVER_KEEP_ALIVE_TIMEOUT      = "keep_alive_timeout";
 static const string CFG_SERVER_KEEP_ALIVE_MAX_REQUESTS = "keep_alive_max_requests";
+static const string CFG_SERVER_MAX_REQUEST_BODY_SIZE   = "max_request_body_size";
+static const string CFG_SERVER_COMPRESSION             = "compression";
+static const string CFG_SERVER_COMPRESSION_MIN_SIZE    = "compression_min_size";
+static const string CFG_SERVER_COMPRESSION_MIME_TYPES  = "compression_mime_types";
+static const string CFG_SERVER_COMPRESSION_ENCODINGS   = "compression_encodings";
+static const string CFG_SERVER_COMPRESSION_GZIP_LEVEL  = "compression_gzip_level";
+static const string CFG_SERVER_COMPRESSION_BROTLI_LEVEL = "compression_brotli_level";
+static const string CFG_SERVER_COMPRESSION_ZSTD_LEVEL  = "compression_zstd_level";
+static const string CFG_SERVER_COMPRESSION_ZSTD_DICTIONARY = "compression_zstd_dictionary";
+static const string CFG_SERVER_COMPRESSION_ZSTD_DICTIONARY_ENCODING = "compression_zstd_dictionary_encoding";
+static const string CFG_SERVER_RESPONSE_CACHE          = "response_cache";
+static const string CFG_SERVER_RESPONSE_CACHE_MAX_SIZE = "response_cache_max_size";
+static const string CFG_SERVER_STATIC_FILES_DIRECTORY  = "static_files_directory";
+static const string CFG_SERVER_STATIC_FILES_PATH       = "static_files_path";
 static const string CFG_SERVER_TLS_ENABLED             = "tls_enabled";
 static const string CFG_SERVER_TLS_CERTIFICATE         = "tls_certificate";
 static const string CFG_SERVER_TLS_PRIVATE_KEY         = "tls_private_key";
+static const string CFG_SERVER_REACTOR_COUNT           = "reactor_count";
+static const string CFG_SERVER_RELOAD_PATH             = "reload_path";
+static const string CFG_SERVER_RELOAD_SECRET           = "reload_secret";
+static const string CFG_SERVER_RELOAD_TRUST_LOOPBACK   = "reload_trust_loopback";
+static const string CFG_SERVER_SHUTDOWN_TIMEOUT        = "shutdown_timeout";
+static const string CFG_SERVER_HANDOFF_SOCKET          = "handoff_socket";
+static const string CFG_SERVER_WORKER_CPUS             = "worker_cpus";
+static const string CFG_SERVER_REACTOR_CPUS            = "reactor_cpus";
 
 // socket options
 static const string CFG_SOCKETS_SOCKET_SERVER          = "socket_server";
 static const string CFG_SOCKETS_KERNEL_EVENTS          = "kernel_events";
+static const string CFG_SOCKETS_EVENT_LOOP             = "event_loop";
+static const string CFG_SOCKETS_REUSEPORT_REACTORS     = "reuseport_reactors";
 
 // threading options
 static const string CFG_THREADING_PTHREADS             = "pthreads";
 static const string CFG_THREADING_CPP11                = "c++11";
 static const string CFG_THREADING_GCD_LIBDISPATCH      = "gcd_libdispatch";
+static const string CFG_THREADING_WORK_STEALING        = "work_stealing";
 static const string CFG_THREADING_NONE                 = "none";
 
 // logging level options
@@ -120,73 +188,288 @@ static const string CFG_LOGGING_INFO                   = "info";
 static const string CFG_LOGGING_DEBUG                  = "debug";
 static const string CFG_LOGGING_VERBOSE                = "verbose";
 
-// mime types
-static const string MIME_APPLICATION_JSON  = "application/json";
-static const string MIME_APPLICATION_XML   = "application/xml";
-static const string MIME_TEXT_HTML         = "text/html";
-static const string MIME_TEXT_PLAIN        = "text/plain";
-
 // module config values
 static const string MODULE_DLL_NAME = "dll";
 static const string APP_PREFIX = "app:";
+static const string MODULE_COPY_SUFFIX = ".reload-XXXXXX";
 
 static const size_t APP_PREFIX_LEN = APP_PREFIX.length();
 
-static const char* LOG_WEEKDAY_NAME[7] = {
-   "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"
-};
-
-static const char* LOG_MONTH_NAME[12] = {
-   "Jan", "Feb", "Mar", "Apr", "May", "Jun",
-   "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"
-};
-
 using namespace misere;
 using namespace chaudiere;
 
 typedef HttpHandler* (*PFN_CREATE_HANDLER)();
 
+// the write end of the signal self-pipe, for the signal handler
+static std::atomic<int> s_signalFD(-1);
+
+//******************************************************************************
+
+static void onSignal(int signalNumber) {
+   // the reload or shutdown itself runs on the server's signal thread -
+   // all a signal handler can safely do is wake it
+   const int savedErrno = errno;
+   const char wakeup = (char) signalNumber;
+   const ssize_t rc = ::write(s_signalFD.load(), &wakeup, 1);
+   (void) rc;
+   errno = savedErrno;
+}
+
+//******************************************************************************
+
+/**
+ * Checks a configured compression level against the coding's range. One
+ * outside it (or not a number) is ignored with a warning rather than left
+ * to fail every compression at serving time.
+ * @return the configured level, or currentLevel if it's invalid
+ */
+static int validCompressionLevel(const KeyValuePairs& kvp,
+                                 const string& setting,
+                                 int level,
+                                 int minLevel,
+                                 int maxLevel,
+                                 int currentLevel) {
+   if ((level < minLevel) || (level > maxLevel)) {
+      LOG_WARNING(setting + " must be from " + std::to_string(minLevel) +
+                  " to " + std::to_string(maxLevel) + ", ignoring '" +
+                  kvp.getValue(setting) + "'")
+      return currentLevel;
+   }
+
+   return level;
+}
+
+//******************************************************************************
+
+/**
+ * Formats CPUs for a log message (e.g., "8,9,10")
+ */
+static string cpuListToString(const vector<int>& cpus) {
+   string text;
+   for (int cpu : cpus) {
+      if (!text.empty()) {
+         text += ",";
+      }
+      text += std::to_string(cpu);
+   }
+   return text;
+}
+
+//******************************************************************************
+
+static bool copyModuleFile(const string& path, string& copyName, int& error) {
+   const int source = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+   if (source < 0) {
+      error = errno;
+      return false;
+   }
+
+   string copyTemplate = path + MODULE_COPY_SUFFIX;
+   const int copy = ::mkstemp(&copyTemplate[0]);
+   if (copy < 0) {
+      error = errno;
+      ::close(source);
+      return false;
+   }
+
+   char buffer[65536];
+   bool isCopied = true;
+   ssize_t bytesRead;
+
+   while ((bytesRead = ::read(source, buffer, sizeof(buffer))) != 0) {
+      if (bytesRead < 0) {
+         error = errno;
+         isCopied = false;
+         break;
+      }
+      const ssize_t bytesWritten = ::write(copy, buffer, bytesRead);
+      if (bytesWritten != bytesRead) {
+         error = (bytesWritten < 0) ? errno : EIO;
+         isCopied = false;
+         break;
+      }
+   }
+
+   ::close(source);
+   if ((::close(copy) != 0) && isCopied) {
+      error = errno;
+      isCopied = false;
+   }
+
+   if (!isCopied) {
+      ::unlink(copyTemplate.c_str());
+      return false;
+   }
+
+   copyName = copyTemplate;
+   return true;
+}
+
+//******************************************************************************
+
+/**
+ * Finds the file a bare library name (no '/') was loaded from - dlopen()
+ * looks such a name up on the library search path, not in the working
+ * directory
+ * @param dllName the library name as configured
+ * @param path set to the file the library was loaded from
+ * @return false if the library isn't loaded (or its file can't be told)
+ */
+static bool findLoadedModulePath(const string& dllName, string& path) {
+#if defined(__linux__)
+   void* handle = ::dlopen(dllName.c_str(), RTLD_LAZY | RTLD_NOLOAD);
+   if (handle == nullptr) {
+      return false;
+   }
+
+   struct link_map* linkMap = nullptr;
+   if ((::dlinfo(handle, RTLD_DI_LINKMAP, &linkMap) == 0) &&
+       (linkMap != nullptr) &&
+       (linkMap->l_name != nullptr)) {
+      path = linkMap->l_name;
+   }
+   ::dlclose(handle);
+
+   // loaded from an earlier reload's copy - the original is next to it
+   const string::size_type posSuffix = path.rfind(".reload-");
+   if ((posSuffix != string::npos) &&
+       (path.size() - posSuffix == MODULE_COPY_SUFFIX.size())) {
+      path.erase(posSuffix);
+   }
+
+   return !path.empty();
+#else
+   return false;
+#endif
+}
+
+//******************************************************************************
+
+static std::shared_ptr<DynamicLibrary> loadModuleLibrary(const string& dllName,
+                                                         bool isReload) {
+   if (!isReload) {
+      return std::make_shared<DynamicLibrary>(dllName);
+   }
+
+   string path = dllName;
+   if (dllName.find('/') == string::npos) {
+      path.clear();
+      if (!findLoadedModulePath(dllName, path)) {
+#if defined(__linux__)
+         // not loaded, so there's no old version for dlopen() to hand back
+         return std::make_shared<DynamicLibrary>(dllName);
+#else
+         throw BasicException(string("unable to reload module library ") +
+                              dllName + ": give dll as a path to reload it");
+#endif
+      }
+   }
+
+   char* resolvedPath = ::realpath(path.c_str(), nullptr);
+   if (resolvedPath == nullptr) {
+      const int error = errno;
+      throw BasicException(string("unable to resolve module library ") +
+                           path + ": " + ::strerror(error));
+   }
+   path = resolvedPath;
+   ::free(resolvedPath);
+
+   // dlopen() hands back the library already loaded from a path instead
+   // of loading it again, so a new version of a module is loaded from a
+   // copy of its file - removed again once it's mapped. the copy's path
+   // is absolute, so dlopen() opens it rather than searching for it
+   string copyName;
+   int error = 0;
+   if (!copyModuleFile(path, copyName, error)) {
+      throw BasicException(string("unable to copy module library ") + path +
+                           " to reload it: " + ::strerror(error));
+   }
+
+   std::shared_ptr<DynamicLibrary> library;
+   try {
+      library = std::make_shared<DynamicLibrary>(copyName);
+   } catch (...) {
+      ::unlink(copyName.c_str());
+      throw;
+   }
+
+   ::unlink(copyName.c_str());
+   return library;
+}
+
 
 //******************************************************************************
 //******************************************************************************
 
 HttpServer::HttpServer(const std::string& configFilePath) :
-   m_serverSocket(nullptr),
    m_threadPool(nullptr),
+   m_workStealingPool(nullptr),
    m_threadingFactory(nullptr),
+   m_routeTable(new RouteTable),
+   m_pendingRouteShadows(false),
+   m_isWatchingSignals(false),
+   m_signalFDs{-1, -1},
+   m_reloadTrustsLoopback(false),
+   m_handoffListenerFD(-1),
+   m_inheritedListenerFD(-1),
+   m_activeConnectionCount(0),
    m_configFilePath(configFilePath),
+   m_staticFilesPath(CFG_DEFAULT_STATIC_FILES_PATH),
+   m_zstdDictionaryEncoding(CFG_DEFAULT_ZSTD_DICTIONARY_ENCODING),
    m_isDone(false),
    m_isThreaded(true),
    m_isUsingKernelEventServer(false),
+   m_isUsingEventLoop(false),
+   m_isUsingReusePortReactors(false),
    m_isFullyInitialized(false),
    m_allowBuiltInHandlers(false),
    m_requireAllHandlersForStartup(false),
-   m_compressionEnabled(true),
+   m_compressionEnabled(false),
    m_usingConfigFile(true),
    m_keepAliveEnabled(false),
    m_tlsEnabled(false),
    m_tlsContext(std::nullopt),
    m_threadPoolSize(CFG_DEFAULT_THREAD_POOL_SIZE),
+   m_reactorCount(0),
    m_serverPort(CFG_DEFAULT_PORT_NUMBER),
    m_socketSendBufferSize(CFG_DEFAULT_SEND_BUFFER_SIZE),
    m_socketReceiveBufferSize(CFG_DEFAULT_RECEIVE_BUFFER_SIZE),
-   m_minimumCompressionSize(1000),
+   m_minimumCompressionSize(CFG_DEFAULT_COMPRESSION_MIN_SIZE),
+   m_gzipCompressionLevel(GzipCompressor::DEFAULT_LEVEL),
+   m_brotliCompressionLevel(BrotliCompressor::DEFAULT_LEVEL),
+   m_zstdCompressionLevel(ZstdCompressor::DEFAULT_LEVEL),
    m_keepAliveTimeoutSecs(CFG_DEFAULT_KEEP_ALIVE_TIMEOUT),
-   m_keepAliveMaxRequests(CFG_DEFAULT_KEEP_ALIVE_MAX_REQUESTS) {
+   m_keepAliveMaxRequests(CFG_DEFAULT_KEEP_ALIVE_MAX_REQUESTS),
+   m_shutdownTimeoutSecs(CFG_DEFAULT_SHUTDOWN_TIMEOUT),
+   m_maxRequestBodySize(CFG_DEFAULT_MAX_REQUEST_BODY_SIZE) {
    LOG_INSTANCE_CREATE("HttpServer")
+   setCompressionMimeTypes(CFG_DEFAULT_COMPRESSION_MIME_TYPES);
+   setCompressionEncodings(CFG_DEFAULT_COMPRESSION_ENCODINGS);
    init(CFG_DEFAULT_PORT_NUMBER);
 }
 
 //******************************************************************************
 
 HttpServer::HttpServer(int port) :
-   m_serverSocket(nullptr),
    m_threadPool(nullptr),
+   m_workStealingPool(nullptr),
    m_threadingFactory(nullptr),
+   m_routeTable(new RouteTable),
+   m_pendingRouteShadows(false),
+   m_isWatchingSignals(false),
+   m_signalFDs{-1, -1},
+   m_reloadTrustsLoopback(false),
+   m_handoffListenerFD(-1),
+   m_inheritedListenerFD(-1),
+   m_activeConnectionCount(0),
    m_configFilePath(""),
+   m_staticFilesPath(CFG_DEFAULT_STATIC_FILES_PATH),
+   m_zstdDictionaryEncoding(CFG_DEFAULT_ZSTD_DICTIONARY_ENCODING),
    m_isDone(false),
    m_isThreaded(true),
    m_isUsingKernelEventServer(false),
+   m_isUsingEventLoop(false),
+   m_isUsingReusePortReactors(false),
    m_isFullyInitialized(false),
    m_allowBuiltInHandlers(false),
    m_requireAllHandlersForStartup(false),
@@ -196,13 +479,21 @@ HttpServer::HttpServer(int port) :
    m_tlsEnabled(false),
    m_tlsContext(std::nullopt),
    m_threadPoolSize(CFG_DEFAULT_THREAD_POOL_SIZE),
+   m_reactorCount(0),
    m_serverPort(CFG_DEFAULT_PORT_NUMBER),
    m_socketSendBufferSize(CFG_DEFAULT_SEND_BUFFER_SIZE),
    m_socketReceiveBufferSize(CFG_DEFAULT_RECEIVE_BUFFER_SIZE),
-   m_minimumCompressionSize(1000),
+   m_minimumCompressionSize(CFG_DEFAULT_COMPRESSION_MIN_SIZE),
+   m_gzipCompressionLevel(GzipCompressor::DEFAULT_LEVEL),
+   m_brotliCompressionLevel(BrotliCompressor::DEFAULT_LEVEL),
+   m_zstdCompressionLevel(ZstdCompressor::DEFAULT_LEVEL),
    m_keepAliveTimeoutSecs(CFG_DEFAULT_KEEP_ALIVE_TIMEOUT),
-   m_keepAliveMaxRequests(CFG_DEFAULT_KEEP_ALIVE_MAX_REQUESTS) {
+   m_keepAliveMaxRequests(CFG_DEFAULT_KEEP_ALIVE_MAX_REQUESTS),
+   m_shutdownTimeoutSecs(CFG_DEFAULT_SHUTDOWN_TIMEOUT),
+   m_maxRequestBodySize(CFG_DEFAULT_MAX_REQUEST_BODY_SIZE) {
    LOG_INSTANCE_CREATE("HttpServer")
+   setCompressionMimeTypes(CFG_DEFAULT_COMPRESSION_MIME_TYPES);
+   setCompressionEncodings(CFG_DEFAULT_COMPRESSION_ENCODINGS);
    init(port);
 }
 
@@ -344,6 +635,12 @@ bool HttpServer::init(int port) {
             setupLogLevel(kvpServerSettings);
             setupSocketBufferSizes(kvpServerSettings);
             setupKeepAlive(kvpServerSettings);
+            setupRequestLimits(kvpServerSettings);
+            setupCompression(kvpServerSettings);
+            setupResponseCache(kvpServerSettings);
+            setupStaticFiles(kvpServerSettings);
+            setupShutdown(kvpServerSettings);
+            setupCpuAffinity(kvpServerSettings);
 
             if (!setupTls(kvpServerSettings)) {
                return false;
@@ -352,13 +649,31 @@ bool HttpServer::init(int port) {
             m_allowBuiltInHandlers =
                hasTrueValue(kvpServerSettings,
                             CFG_SERVER_ALLOW_BUILTIN_HANDLERS);
+
+            if (kvpServerSettings.hasKey(CFG_SERVER_RELOAD_PATH)) {
+               m_reloadPath = kvpServerSettings.getValue(CFG_SERVER_RELOAD_PATH);
+            }
+
+            if (kvpServerSettings.hasKey(CFG_SERVER_RELOAD_SECRET)) {
+               m_reloadSecret =
+                  StrUtils::strip(kvpServerSettings.getValue(CFG_SERVER_RELOAD_SECRET));
+            }
+
+            m_reloadTrustsLoopback =
+               hasTrueValue(kvpServerSettings,
+                            CFG_SERVER_RELOAD_TRUST_LOOPBACK);
+
             setupServerString(kvpServerSettings);
          } else {
             LOG_WARNING("HttpServer init no server section found")
          }
 
-         // read and process "handlers" section
-         if (!setupHandlers(configDataSource())) {
+         // read and process "handlers" section, routing them all with
+         // one table rather than a table per handler
+         beginRouteBatch();
+         const bool isHandlersSetUp = setupHandlers(configDataSource());
+         endRouteBatch();
+         if (!isHandlersSetUp) {
             return false;
          }
       } catch (const BasicException& be) {
@@ -379,6 +694,16 @@ bool HttpServer::init(int port) {
    }
 
    setupConcurrency();
+   m_headerPrefixes.build(m_serverString);
+
+   // from here on the Date header and access log timestamps are rendered
+   // once a second rather than per request
+   m_dateCache.start();
+
+   if (m_usingConfigFile) {
+      startSignalWatcher();
+   }
+
    m_startupTime = getLocalDateTime();
    m_isFullyInitialized = true;
    outputStartupMessage();
@@ -391,72 +716,70 @@ bool HttpServer::init(int port) {
 HttpServer::~HttpServer() {
    LOG_INSTANCE_DESTROY("HttpServer")
 
-   if (m_serverSocket) {
-      m_serverSocket->close();
+   stopSignalWatcher();
+
+   m_listener.close();
+
+   if (m_inheritedListenerFD > -1) {
+      ::close(m_inheritedListenerFD);
    }
 
    if (m_threadPool) {
       m_threadPool->stop();
    }
 
-   m_mapPathHandlers.erase(m_mapPathHandlers.begin(),
-                           m_mapPathHandlers.end());
+   // nothing is being served any more, so the handlers can go without
+   // waiting on readers
+   delete m_routeTable.exchange(nullptr);
+   m_routeReclaimer.clear();
 
-   m_mapPathLibraries.erase(m_mapPathLibraries.begin(),
-                            m_mapPathLibraries.end());
+   // a module's library is unloaded along with its last handler
+   m_mapPathHandlers.clear();
 }
 
 //******************************************************************************
 
 std::string HttpServer::getSystemDateGMT() const {
-   time_t currentGMT;
-   ::time(&currentGMT);
-
-   struct tm* timeptr = ::gmtime(&currentGMT);
-   char dateBuffer[128];
-
-   ::snprintf(dateBuffer, 128,
-              "%.3s, %02d %.3s %d %.2d:%.2d:%.2d GMT",
-              LOG_WEEKDAY_NAME[timeptr->tm_wday],
-              timeptr->tm_mday,
-              LOG_MONTH_NAME[timeptr->tm_mon],
-              1900 + timeptr->tm_year,
-              timeptr->tm_hour,
-              timeptr->tm_min,
-              timeptr->tm_sec);
-
-   return string(dateBuffer);
+   return m_dateCache.getHttpDate();
 }
 
 //******************************************************************************
 
 std::string HttpServer::getLocalDateTime() const {
-   time_t currentTime;
-   ::time(&currentTime);
+   return m_dateCache.getLocalDateTime();
+}
+
+//******************************************************************************
 
-   struct tm* timeptr = ::localtime(&currentTime);
-   char dateBuffer[128];
+const HttpDateCache& HttpServer::getDateCache() const {
+   return m_dateCache;
+}
 
-   ::snprintf(dateBuffer, 128,
-              "%d-%02d-%02d %.2d:%.2d:%.2d",
-              1900 + timeptr->tm_year,
-              timeptr->tm_mon + 1,
-              timeptr->tm_mday,
-              timeptr->tm_hour,
-              timeptr->tm_min,
-              timeptr->tm_sec);
+//******************************************************************************
 
-   return string(dateBuffer);
+const HttpHeaderPrefixes& HttpServer::getHeaderPrefixes() const {
+   return m_headerPrefixes;
 }
 
 //******************************************************************************
 
-bool HttpServer::compressResponse(const std::string& mimeType) const {
-   //TODO: make this configurable through config file
-   return (mimeType == MIME_TEXT_HTML) ||
-          (mimeType == MIME_TEXT_PLAIN) ||
-          (mimeType == MIME_APPLICATION_JSON) ||
-          (mimeType == MIME_APPLICATION_XML);
+bool HttpServer::compressResponse(std::string_view mimeType) const {
+   // ignore parameters ("text/html; charset=utf-8")
+   mimeType = mimeType.substr(0, mimeType.find(';'));
+   while (!mimeType.empty() && (mimeType.back() == ' ')) {
+      mimeType.remove_suffix(1);
+   }
+
+   for (const std::string& compressedType : m_compressionMimeTypes) {
+      if ((compressedType.size() == mimeType.size()) &&
+          (::strncasecmp(compressedType.data(),
+                         mimeType.data(),
+                         mimeType.size()) == 0)) {
+         return true;
+      }
+   }
+
+   return false;
 }
 
 //******************************************************************************
@@ -475,186 +798,693 @@ int HttpServer::minimumCompressionSize() const {
 
 bool HttpServer::addPathHandler(const std::string& path,
                                 HttpHandler* pHandler) {
-   bool isSuccess = false;
-
-   if (!path.empty() && (nullptr != pHandler)) {
-      m_mapPathHandlers.emplace(path, pHandler);
-      isSuccess = true;
+   if (path.empty() || (nullptr == pHandler)) {
+      return false;
    }
 
-   return isSuccess;
+   return insertPathHandler(path, std::shared_ptr<HttpHandler>(pHandler));
 }
 
 //******************************************************************************
 
-bool HttpServer::removePathHandler(const std::string& path) {
-   bool isSuccess = false;
-   auto it = m_mapPathHandlers.find(path);
+bool HttpServer::insertPathHandler(const std::string& path,
+                                   std::shared_ptr<HttpHandler> handler) {
+   std::lock_guard<std::mutex> lock(m_routesMutex);
+
+   if (m_mapPathHandlers.find(path) != m_mapPathHandlers.end()) {
+      return false;
+   }
+
+   // during a batch the route goes straight into the table that's
+   // published at its end, rather than into a copy of every route
+   std::unique_ptr<RouteTable> table;
+   RouteTable* target = m_pendingRouteTable.get();
+   if (target == nullptr) {
+      table = buildRouteTable(m_mapPathHandlers);
+      if (!table) {
+         return false;
+      }
+      target = table.get();
+   }
+
+   if (!target->router.add(path, handler.get(), handler->handlesSubpaths())) {
+      if (m_pendingRouteTable) {
+         // a failed add can leave empty nodes behind
+         m_pendingRouteTable = buildRouteTable(m_mapPathHandlers);
+      }
+      return false;
+   }
+
+   // a path that another route (a parameter, or a handler of subpaths)
+   // already answered may have responses cached from that handler
+   HttpRouteParameters parameters;
+   const bool isShadowing =
+      m_routeTable.load()->router.find(path, parameters) != nullptr;
+
+   target->handlers.push_back(handler);
+   m_mapPathHandlers.emplace(path, std::move(handler));
 
-   if (it != m_mapPathHandlers.end()) {
-      m_mapPathHandlers.erase(it);
-      isSuccess = true;
+   if (m_pendingRouteTable) {
+      m_pendingRouteShadows = m_pendingRouteShadows || isShadowing;
+   } else {
+      publishRouteTable(std::move(table), isShadowing);
    }
 
-   return isSuccess;
+   return true;
 }
 
 //******************************************************************************
 
-HttpHandler* HttpServer::getPathHandler(const std::string& path) {
+bool HttpServer::removePathHandler(const std::string& path) {
+   std::lock_guard<std::mutex> lock(m_routesMutex);
+
    auto it = m_mapPathHandlers.find(path);
-   if (it != m_mapPathHandlers.end()) {
-      return it->second.get();
+   if (it == m_mapPathHandlers.end()) {
+      return false;
    }
 
-   return nullptr;
-}
+   // requests already routed to the handler keep it until they're done
+   m_mapPathHandlers.erase(it);
+   m_modulePaths.erase(path);
 
-//******************************************************************************
+   std::unique_ptr<RouteTable> table = buildRouteTable(m_mapPathHandlers);
+   if (!table) {
+      return false;
+   }
 
-std::string HttpServer::buildHeader(const std::string& responseCode,
-                                    const chaudiere::KeyValuePairs& headers) const {
-   string sb;
-   if (!responseCode.empty()) {
-      sb += HTTP::HTTP_PROTOCOL1_1;
-      sb += SPACE;
-      sb += responseCode;
-      sb += EOL;
+   if (m_pendingRouteTable) {
+      m_pendingRouteTable = std::move(table);
+      m_pendingRouteShadows = true;
+   } else {
+      publishRouteTable(std::move(table), true);
    }
 
-   vector<string> keys;
-   headers.getKeys(keys);
+   return true;
+}
 
-   for (const auto& headerKey : keys) {
-      sb += headerKey;  // header key
+//******************************************************************************
 
-      if (!StrUtils::endsWith(headerKey, COLON)) {
-         sb += COLON;
+bool HttpServer::replaceModuleHandlers(HandlerMap handlers) {
+   std::lock_guard<std::mutex> lock(m_routesMutex);
+
+   HandlerMap pathHandlers(m_mapPathHandlers);
+   for (const std::string& path : m_modulePaths) {
+      pathHandlers.erase(path);
+   }
+
+   for (const auto& pathHandler : handlers) {
+      if (!pathHandlers.insert(pathHandler).second) {
+         LOG_ERROR(string("handler path is already taken: ") +
+                   pathHandler.first)
+         return false;
       }
+   }
 
-      sb += SPACE;
+   std::unique_ptr<RouteTable> table = buildRouteTable(pathHandlers);
+   if (!table) {
+      return false;
+   }
 
-      sb += headers.getValue(headerKey);  // header value
-      sb += EOL;
+   m_modulePaths.clear();
+   for (const auto& pathHandler : handlers) {
+      m_modulePaths.insert(pathHandler.first);
    }
 
-   sb += EOL;
+   m_mapPathHandlers.swap(pathHandlers);
+   publishRouteTable(std::move(table), true);
 
-   return sb;
+   return true;
 }
 
 //******************************************************************************
 
-bool HttpServer::addBuiltInHandlers() {
-   return addPathHandler("/Echo", new EchoHandler()) &&
-          addPathHandler("/GMTDateTime", new GMTDateTimeHandler()) &&
-          addPathHandler("/ServerDateTime", new ServerDateTimeHandler()) &&
-          addPathHandler("/ServerObjectsDebugging", new ServerObjectsDebugging()) &&
-          addPathHandler("/ServerStats", new ServerStatsHandler()) &&
-          addPathHandler("/ServerStatus", new ServerStatusHandler());
+void HttpServer::beginRouteBatch() {
+   std::lock_guard<std::mutex> lock(m_routesMutex);
+
+   if (!m_pendingRouteTable) {
+      m_pendingRouteTable = buildRouteTable(m_mapPathHandlers);
+      m_pendingRouteShadows = false;
+   }
 }
 
 //******************************************************************************
 
-int HttpServer::platformPointerSizeBits() const {
-   return sizeof(void*) * 8;
+void HttpServer::endRouteBatch() {
+   std::lock_guard<std::mutex> lock(m_routesMutex);
+
+   if (m_pendingRouteTable) {
+      publishRouteTable(std::move(m_pendingRouteTable), m_pendingRouteShadows);
+   }
 }
 
 //******************************************************************************
 
-void HttpServer::serviceSocket(SocketRequest* socketRequest) {
-   if (nullptr != m_threadPool) {
-      // Hand off the request to the thread pool for asynchronous processing
-      HttpRequestHandler* requestHandler =
-         new HttpRequestHandler(*this, socketRequest);
-      requestHandler->setThreadPooling(true);
-      requestHandler->setAutoDelete();
-      m_threadPool->addRequest(requestHandler);
-   } else {
-      // no thread pool available -- process it synchronously
-      HttpRequestHandler requestHandler(*this, socketRequest);
-
-      try {
-         requestHandler.run();
-      } catch (const BasicException& be) {
-         LOG_ERROR("HttpServer serviceSocket BasicException caught: " +
-                   be.whatString())
-      } catch (const exception& e) {
-         LOG_ERROR(string("HttpServer serviceSocket exception caught: ") +
-                   string(e.what()))
-      } catch (...) {
-         LOG_ERROR("HttpServer serviceSocket unknown exception caught")
+std::unique_ptr<HttpServer::RouteTable>
+HttpServer::buildRouteTable(const HandlerMap& handlers) {
+   std::unique_ptr<RouteTable> table(new RouteTable);
+   table->handlers.reserve(handlers.size() + 1);
+
+   for (const auto& pathHandler : handlers) {
+      if (!table->router.add(pathHandler.first,
+                             pathHandler.second.get(),
+                             pathHandler.second->handlesSubpaths())) {
+         LOG_ERROR(string("unable to route path ") + pathHandler.first)
+         return nullptr;
       }
+      table->handlers.push_back(pathHandler.second);
+   }
 
-      if (socketRequest->isAutoDelete()) {
-         delete socketRequest;
-      }
+   return table;
+}
+
+//******************************************************************************
+
+void HttpServer::publishRouteTable(std::unique_ptr<RouteTable> table,
+                                   bool isClearingCache) {
+   // the old table - and any handler only it refers to - is freed once
+   // the requests that may be using it are done
+   std::shared_ptr<const RouteTable> previous(m_routeTable.exchange(table.release()));
+   m_routeReclaimer.retire(std::move(previous));
+
+   // a path that now routes to a different handler mustn't be answered
+   // with what the one it replaced left in the cache
+   if (isClearingCache && m_responseCache) {
+      m_responseCache->clear();
    }
 }
 
 //******************************************************************************
 
-int HttpServer::runSocketServer() {
-   int rc = 0;
+HttpHandler* HttpServer::getPathHandler(std::string_view path,
+                                        HttpRouteParameters& parameters) const {
+   return m_routeTable.load()->router.find(path, parameters);
+}
 
-   if (!m_serverSocket) {
-      LOG_CRITICAL("runSocketServer called with null serverSocket")
-      return 1;
+//******************************************************************************
+
+HttpHandler* HttpServer::getPathHandler(std::string_view path) const {
+   HttpRouteParameters parameters;
+   return getPathHandler(path, parameters);
+}
+
+//******************************************************************************
+
+bool HttpServer::reload() {
+   if (!m_usingConfigFile) {
+      LOG_WARNING("reload: server has no config file to re-read")
+      return false;
    }
 
-   while (!m_isDone) {
-      Socket* socket = m_serverSocket->accept();
+   poivre::AutoPointer<SectionedConfigDataSource> configDataSource(nullptr);
 
-      if (nullptr == socket) {
-         continue;
-      }
+   try {
+      configDataSource.assign(getConfigDataSource());
+   } catch (const BasicException& be) {
+      LOG_ERROR("BasicException retrieving config data: " + be.whatString())
+   } catch (const exception& e) {
+      LOG_ERROR("exception retrieving config data: " + string(e.what()))
+   } catch (...) {
+      LOG_ERROR("unknown exception retrieving config data")
+   }
 
-      //if (Logger::isLogging(Debug)) {
-         //LOG_DEBUG("*****************************************")
-         //LOG_DEBUG("client connected")
-      //}
+   if (!configDataSource.haveObject()) {
+      LOG_ERROR("reload: unable to retrieve config data")
+      return false;
+   }
 
-      try {
-         if (m_isThreaded && (nullptr != m_threadPool)) {
-            HttpRequestHandler* handler =
-               new HttpRequestHandler(*this, socket);
-            handler->setThreadPooling(true);
-            handler->setAutoDelete();
+   return reloadHandlers(*configDataSource());
+}
 
-            // give it to the thread pool
-            bool added = m_threadPool->addRequest(handler);
-            if (!added) {
-               printf("HttpServer::runServer unable to add request\n");
-            }
-         } else {
-            HttpRequestHandler handler(*this, socket);
-            handler.run();
-         }
-      } catch (const BasicException& be) {
-         rc = 1;
-         LOG_ERROR("HttpServer runServer BasicException caught: " +
-                   be.whatString())
-      } catch (const exception& e) {
-         rc = 1;
-         LOG_ERROR(string("HttpServer runServer exception caught: ") +
-                   string(e.what()))
-      } catch (...) {
-         rc = 1;
-         LOG_ERROR("HttpServer runServer unknown exception caught")
+//******************************************************************************
+
+bool HttpServer::reloadHandlers(const chaudiere::SectionedConfigDataSource& dataSource) {
+   std::lock_guard<std::mutex> lock(m_reloadMutex);
+   HandlerMap handlers;
+
+   try {
+      if (!loadModuleHandlers(dataSource, handlers, true, true) ||
+          !replaceModuleHandlers(std::move(handlers))) {
+         LOG_ERROR("reload failed, keeping the current handlers")
+         return false;
       }
+   } catch (const BasicException& be) {
+      LOG_ERROR("BasicException reloading handlers: " + be.whatString())
+      return false;
+   } catch (const exception& e) {
+      LOG_ERROR("exception reloading handlers: " + string(e.what()))
+      return false;
+   } catch (...) {
+      LOG_ERROR("unknown exception reloading handlers")
+      return false;
    }
 
-   return rc;
+   LOG_INFO("handlers reloaded")
+   return true;
 }
 
 //******************************************************************************
 
-int HttpServer::runKernelEventServer() {
-   const int MAX_CON = 1200;
-   int rc = 0;
+void HttpServer::startSignalWatcher() {
+   if (::pipe(m_signalFDs) != 0) {
+      LOG_WARNING("unable to create signal pipe, SIGHUP and SIGTERM are not handled")
+      return;
+   }
 
-   if (m_threadingFactory != nullptr) {
-      Mutex* mutexFD = m_threadingFactory->createMutex("fdMutex");
+   for (int fd : m_signalFDs) {
+      ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+      ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+   }
+
+   s_signalFD = m_signalFDs[1];
+
+   struct sigaction action;
+   ::memset(&action, 0, sizeof(action));
+   action.sa_handler = onSignal;
+   action.sa_flags = SA_RESTART;
+   ::sigemptyset(&action.sa_mask);
+   ::sigaction(SIGHUP, &action, nullptr);
+
+   // the kernel event server has no way to stop short of the process
+   // exiting, so it's left to the default action
+   if (!m_isUsingKernelEventServer) {
+      ::sigaction(SIGTERM, &action, nullptr);
+      ::sigaction(SIGINT, &action, nullptr);
+   }
+
+   if (!m_handoffSocketPath.empty()) {
+      m_handoff.offer(m_handoffSocketPath);
+   }
+
+   m_isWatchingSignals = true;
+   m_signalThread = std::thread(&HttpServer::watchSignals, this);
+}
+
+//******************************************************************************
+
+void HttpServer::stopSignalWatcher() {
+   if ((m_signalFDs[1] > -1) &&
+       (s_signalFD == m_signalFDs[1])) {
+      ::signal(SIGHUP, SIG_DFL);
+      ::signal(SIGTERM, SIG_DFL);
+      ::signal(SIGINT, SIG_DFL);
+      s_signalFD = -1;
+   }
+
+   m_isWatchingSignals = false;
+   if (m_signalThread.joinable()) {
+      m_signalThread.join();
+   }
+
+   m_handoff.close();
+
+   for (int& fd : m_signalFDs) {
+      if (fd > -1) {
+         ::close(fd);
+         fd = -1;
+      }
+   }
+}
+
+//******************************************************************************
+
+void HttpServer::watchSignals() {
+   char buffer[64];
+
+   while (m_isWatchingSignals) {
+      struct pollfd pfds[2];
+      pfds[0].fd = m_signalFDs[0];
+      pfds[0].events = POLLIN;
+      pfds[0].revents = 0;
+
+      // a new process asking for the listener is only answered once
+      // there's a listener to give it
+      nfds_t count = 1;
+      {
+         std::lock_guard<std::mutex> lock(m_handoffMutex);
+         if ((m_handoffListenerFD > -1) &&
+             (m_handoff.getFileDescriptor() > -1)) {
+            pfds[1].fd = m_handoff.getFileDescriptor();
+            pfds[1].events = POLLIN;
+            pfds[1].revents = 0;
+            count = 2;
+         }
+      }
+
+      if (::poll(pfds, count, SIGNAL_WATCH_MILLIS) > 0) {
+         if (pfds[0].revents & POLLIN) {
+            bool isReloadSignaled = false;
+            bool isShutdownSignaled = false;
+            ssize_t bytesRead;
+
+            // signals that arrive together are one reload (or shutdown)
+            while ((bytesRead = ::read(m_signalFDs[0], buffer, sizeof(buffer))) > 0) {
+               for (ssize_t i = 0; i < bytesRead; ++i) {
+                  if (buffer[i] == SIGHUP) {
+                     isReloadSignaled = true;
+                  } else {
+                     isShutdownSignaled = true;
+                  }
+               }
+            }
+
+            if (isShutdownSignaled) {
+               shutdown();
+            } else if (isReloadSignaled) {
+               LOG_INFO("SIGHUP received, reloading handlers")
+               reload();
+            }
+         }
+
+         if ((count > 1) && (pfds[1].revents & POLLIN)) {
+            handOverListener();
+         }
+      }
+
+      // route tables replaced since are freed - along with the handlers
+      // and libraries only they hold - once their requests are done,
+      // rather than waiting for the next route change
+      if (m_routeReclaimer.getRetiredCount() > 0) {
+         m_routeReclaimer.reclaim();
+      }
+   }
+}
+
+//******************************************************************************
+
+void HttpServer::handOverListener() {
+   std::lock_guard<std::mutex> lock(m_handoffMutex);
+
+   if ((m_handoffListenerFD < 0) || isDraining()) {
+      return;
+   }
+
+   if (m_handoff.handOver(m_handoffListenerFD)) {
+      LOG_INFO("listening socket handed over to new server process, draining")
+
+      // the new process is offering at the same path by now, or soon
+      // will be - only the file that's still ours is removed
+      m_handoff.close();
+      shutdown();
+   }
+}
+
+//******************************************************************************
+
+void HttpServer::setHandoffListener(int listenerFD) {
+   std::lock_guard<std::mutex> lock(m_handoffMutex);
+   m_handoffListenerFD = listenerFD;
+}
+
+//******************************************************************************
+
+void HttpServer::shutdown() {
+   if (!m_isDone.exchange(true)) {
+      LOG_INFO("shutting down, draining connections")
+   }
+}
+
+//******************************************************************************
+
+bool HttpServer::isDraining() const {
+   return m_isDone;
+}
+
+//******************************************************************************
+
+int HttpServer::shutdownTimeoutSecs() const {
+   return m_shutdownTimeoutSecs;
+}
+
+//******************************************************************************
+
+void HttpServer::addActiveConnection() {
+   ++m_activeConnectionCount;
+}
+
+//******************************************************************************
+
+void HttpServer::removeActiveConnection() {
+   --m_activeConnectionCount;
+}
+
+//******************************************************************************
+
+int HttpServer::getActiveConnectionCount() const {
+   return m_activeConnectionCount;
+}
+
+//******************************************************************************
+
+void HttpServer::waitForConnections() {
+   const auto deadline = std::chrono::steady_clock::now() +
+                         std::chrono::seconds(m_shutdownTimeoutSecs);
+
+   while ((m_activeConnectionCount > 0) &&
+          (std::chrono::steady_clock::now() < deadline)) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(DRAIN_CHECK_MILLIS));
+   }
+
+   const int remaining = m_activeConnectionCount;
+   if (remaining > 0) {
+      LOG_WARNING("shutdown timeout reached with " +
+                  StrUtils::toString(remaining) +
+                  " connection(s) still open")
+   }
+}
+
+//******************************************************************************
+
+std::string HttpServer::buildHeader(const std::string& responseCode,
+                                    const chaudiere::KeyValuePairs& headers) const {
+   string sb;
+   if (!responseCode.empty()) {
+      sb += HTTP::HTTP_PROTOCOL1_1;
+      sb += SPACE;
+      sb += responseCode;
+      sb += EOL;
+   }
+
+   vector<string> keys;
+   headers.getKeys(keys);
+
+   for (const auto& headerKey : keys) {
+      sb += headerKey;  // header key
+
+      if (!StrUtils::endsWith(headerKey, COLON)) {
+         sb += COLON;
+      }
+
+      sb += SPACE;
+
+      sb += headers.getValue(headerKey);  // header value
+      sb += EOL;
+   }
+
+   sb += EOL;
+
+   return sb;
+}
+
+//******************************************************************************
+
+std::string HttpServer::buildHeader(const std::string& responseCode,
+                                    const HttpHeaders& headers) const {
+   // size it once up front rather than growing per append
+   std::size_t length = HTTP::HTTP_PROTOCOL1_1.size() + responseCode.size() + 8;
+   for (const HttpHeaders::Entry& entry : headers) {
+      length += entry.name.size() + entry.value.size() + 4;
+   }
+
+   string sb;
+   sb.reserve(length);
+
+   if (!responseCode.empty()) {
+      sb += HTTP::HTTP_PROTOCOL1_1;
+      sb += SPACE;
+      sb += responseCode;
+      sb += EOL;
+   }
+
+   for (const HttpHeaders::Entry& entry : headers) {
+      sb += entry.name;
+      sb += COLON;
+      sb += SPACE;
+      sb += entry.value;
+      sb += EOL;
+   }
+
+   sb += EOL;
+
+   return sb;
+}
+
+//******************************************************************************
+
+bool HttpServer::addBuiltInHandlers() {
+   return addPathHandler("/Echo", new EchoHandler()) &&
+          addPathHandler("/GMTDateTime", new GMTDateTimeHandler()) &&
+          addPathHandler("/ServerDateTime", new ServerDateTimeHandler()) &&
+          addPathHandler("/ServerObjectsDebugging", new ServerObjectsDebugging()) &&
+          addPathHandler("/ServerStats", new ServerStatsHandler()) &&
+          addPathHandler("/ServerStatus", new ServerStatusHandler());
+}
+
+//******************************************************************************
+
+bool HttpServer::addStaticFileHandler() {
+   if (m_staticFilesDirectory.empty()) {
+      return true;
+   }
+
+   std::unique_ptr<StaticFileHandler> handler(
+      new StaticFileHandler(m_staticFilesDirectory));
+
+   if (!handler->init(m_staticFilesPath, KeyValuePairs())) {
+      LOG_ERROR("unable to initialize static file handler for " +
+                m_staticFilesDirectory)
+      return false;
+   }
+
+   return addPathHandler(m_staticFilesPath, handler.release());
+}
+
+//******************************************************************************
+
+int HttpServer::platformPointerSizeBits() const {
+   return sizeof(void*) * 8;
+}
+
+//******************************************************************************
+
+void HttpServer::serviceSocket(SocketRequest* socketRequest) {
+   if (nullptr != m_threadPool) {
+      // Hand off the request to the thread pool for asynchronous processing
+      HttpRequestHandler* requestHandler =
+         new HttpRequestHandler(*this, socketRequest);
+      requestHandler->setThreadPooling(true);
+      requestHandler->setAutoDelete();
+      dispatchRequest(requestHandler, socketRequest->getSocketFD());
+   } else {
+      // no thread pool available -- process it synchronously
+      HttpRequestHandler requestHandler(*this, socketRequest);
+
+      try {
+         requestHandler.run();
+      } catch (const BasicException& be) {
+         LOG_ERROR("HttpServer serviceSocket BasicException caught: " +
+                   be.whatString())
+      } catch (const exception& e) {
+         LOG_ERROR(string("HttpServer serviceSocket exception caught: ") +
+                   string(e.what()))
+      } catch (...) {
+         LOG_ERROR("HttpServer serviceSocket unknown exception caught")
+      }
+
+      if (socketRequest->isAutoDelete()) {
+         delete socketRequest;
+      }
+   }
+}
+
+//******************************************************************************
+
+bool HttpServer::dispatchRequest(Runnable* request, int socketFD) {
+   if ((nullptr != m_workStealingPool) && !m_workerCpus.empty()) {
+      return m_workStealingPool->addRequest(request,
+                                            CpuAffinity::incomingCpu(socketFD));
+   }
+
+   return m_threadPool->addRequest(request);
+}
+
+//******************************************************************************
+
+int HttpServer::runSocketServer() {
+   int rc = 0;
+
+   const int listenerFD = m_listener.getFileDescriptor();
+   if (listenerFD < 0) {
+      LOG_CRITICAL("runSocketServer called without a listening socket")
+      return 1;
+   }
+
+   setHandoffListener(listenerFD);
+
+   while (!m_isDone) {
+      // the listener is non-blocking, so a shutdown is noticed without
+      // waiting on a connection that may never come
+      struct pollfd pfd;
+      pfd.fd = listenerFD;
+      pfd.events = POLLIN;
+      pfd.revents = 0;
+
+      if (::poll(&pfd, 1, ACCEPT_WAIT_MILLIS) <= 0) {
+         continue;
+      }
+
+      // another process sharing the listener may have taken the connection
+      const int socketFD = ::accept(listenerFD, nullptr, nullptr);
+      if (socketFD < 0) {
+         continue;
+      }
+
+      ::fcntl(socketFD, F_SETFL, ::fcntl(socketFD, F_GETFL, 0) & ~O_NONBLOCK);
+      ::fcntl(socketFD, F_SETFD, FD_CLOEXEC);
+
+      Socket* socket = new Socket(socketFD);
+
+      //if (Logger::isLogging(Debug)) {
+         //LOG_DEBUG("*****************************************")
+         //LOG_DEBUG("client connected")
+      //}
+
+      try {
+         if (m_isThreaded && (nullptr != m_threadPool)) {
+            HttpRequestHandler* handler =
+               new HttpRequestHandler(*this, socket);
+            handler->setThreadPooling(true);
+            handler->setAutoDelete();
+
+            // give it to the thread pool
+            bool added = dispatchRequest(handler, socketFD);
+            if (!added) {
+               printf("HttpServer::runServer unable to add request\n");
+            }
+         } else {
+            HttpRequestHandler handler(*this, socket);
+            handler.run();
+         }
+      } catch (const BasicException& be) {
+         rc = 1;
+         LOG_ERROR("HttpServer runServer BasicException caught: " +
+                   be.whatString())
+      } catch (const exception& e) {
+         rc = 1;
+         LOG_ERROR(string("HttpServer runServer exception caught: ") +
+                   string(e.what()))
+      } catch (...) {
+         rc = 1;
+         LOG_ERROR("HttpServer runServer unknown exception caught")
+      }
+   }
+
+   // stop offering the listener before it's closed
+   setHandoffListener(-1);
+   m_listener.close();
+
+   waitForConnections();
+
+   return rc;
+}
+
+//******************************************************************************
+
+int HttpServer::runKernelEventServer() {
+   const int MAX_CON = 1200;
+   int rc = 0;
+
+   if (m_threadingFactory != nullptr) {
+      Mutex* mutexFD = m_threadingFactory->createMutex("fdMutex");
       Mutex* mutexHWMConnections =
          m_threadingFactory->createMutex("hwmConnectionsMutex");
       poivre::AutoPointer<KernelEventServer> kernelEventServer(nullptr);
@@ -670,34 +1500,149 @@ int HttpServer::runKernelEventServer() {
          rc = 1;
       }
 
-      if (kernelEventServer.haveObject()) {
-         try {
-            SocketServiceHandler* serviceHandler =
-               new HttpSocketServiceHandler(*this);
+      if (kernelEventServer.haveObject()) {
+         try {
+            SocketServiceHandler* serviceHandler =
+               new HttpSocketServiceHandler(*this);
+
+            if (kernelEventServer->init(serviceHandler,
+                                        m_serverPort,
+                                        MAX_CON)) {
+               kernelEventServer->run();
+            } else {
+               rc = 1;
+            }
+         } catch (const BasicException& be) {
+            LOG_CRITICAL("exception running kernel event server: " +
+                         be.whatString())
+         } catch (const exception& e) {
+            LOG_CRITICAL("exception running kernel event server: " +
+                         string(e.what()))
+         } catch (...) {
+            LOG_CRITICAL("unidentified exception running kernel event server")
+         }
+      }
+   } else {
+      LOG_CRITICAL("no threading factory configured")
+      rc = 1;
+   }
+
+   return rc;
+}
+
+//******************************************************************************
+
+int HttpServer::runEventLoopServer() {
+   int rc = 0;
+
+   try {
+      HttpEventLoop eventLoop(*this,
+                              m_isThreaded ? m_threadPool.get() : nullptr);
+
+      // the event loop owns the inherited listener from here on
+      const int listenerFD = m_inheritedListenerFD;
+      m_inheritedListenerFD = -1;
+
+      if (eventLoop.init(m_serverPort, false, listenerFD)) {
+         setHandoffListener(eventLoop.getListenerFileDescriptor());
+
+         try {
+            rc = eventLoop.run();
+         } catch (...) {
+            setHandoffListener(-1);
+            throw;
+         }
+
+         setHandoffListener(-1);
+      } else {
+         rc = 1;
+      }
+   } catch (const BasicException& be) {
+      rc = 1;
+      LOG_CRITICAL("exception running event loop: " + be.whatString())
+   } catch (const exception& e) {
+      rc = 1;
+      LOG_CRITICAL("exception running event loop: " + string(e.what()))
+   } catch (...) {
+      rc = 1;
+      LOG_CRITICAL("unidentified exception running event loop")
+   }
+
+   return rc;
+}
+
+//******************************************************************************
+
+int HttpServer::runReusePortReactors() {
+   // open every reactor's listener up front, so a port that can't be
+   // bound fails startup instead of leaving a partial set of reactors
+   std::vector<std::unique_ptr<HttpEventLoop>> reactors;
+
+   for (int i = 0; i < m_reactorCount; ++i) {
+      reactors.push_back(std::make_unique<HttpEventLoop>(*this, nullptr));
+      if (!reactors.back()->init(m_serverPort, true)) {
+         LOG_CRITICAL("unable to initialize reactor " + StrUtils::toString(i))
+         return 1;
+      }
+   }
+
+   std::vector<int> exitCodes(m_reactorCount, 0);
+   std::vector<std::thread> threads;
 
-            if (kernelEventServer->init(serviceHandler,
-                                        m_serverPort,
-                                        MAX_CON)) {
-               kernelEventServer->run();
-            } else {
-               rc = 1;
-            }
+   for (int i = 0; i < m_reactorCount; ++i) {
+      HttpEventLoop* reactor = reactors[i].get();
+      int* exitCode = &exitCodes[i];
+
+      // reactor i stays on one CPU (the i'th of reactor_cpus, or of the
+      // CPUs the process may run on) so its connections' state stays in
+      // that core's cache
+      int cpu = -1;
+      if (!m_reactorCpus.empty()) {
+         cpu = m_reactorCpus[i % m_reactorCpus.size()];
+      }
+
+      // and the kernel hands it the connections whose packets that CPU
+      // processes, rather than hashing them over all the listeners
+      if ((cpu > -1) &&
+          !CpuAffinity::setIncomingCpu(reactor->getListenerFileDescriptor(), cpu)) {
+         LOG_DEBUG("unable to set SO_INCOMING_CPU on reactor " +
+                   StrUtils::toString(i) + " listener")
+      }
+
+      threads.emplace_back([reactor, exitCode, cpu, i]() {
+         // pinned before the loop allocates its buffers, so they're on
+         // the CPU's own NUMA node
+         if ((cpu > -1) && !CpuAffinity::pinCurrentThread(cpu)) {
+            LOG_WARNING("unable to pin reactor " + StrUtils::toString(i) +
+                        " to CPU " + StrUtils::toString(cpu))
+         }
+
+         try {
+            *exitCode = reactor->run();
          } catch (const BasicException& be) {
-            LOG_CRITICAL("exception running kernel event server: " +
-                         be.whatString())
+            *exitCode = 1;
+            LOG_CRITICAL("exception running reactor: " + be.whatString())
          } catch (const exception& e) {
-            LOG_CRITICAL("exception running kernel event server: " +
-                         string(e.what()))
+            *exitCode = 1;
+            LOG_CRITICAL("exception running reactor: " + string(e.what()))
          } catch (...) {
-            LOG_CRITICAL("unidentified exception running kernel event server")
+            *exitCode = 1;
+            LOG_CRITICAL("unidentified exception running reactor")
          }
+      });
+   }
+
+   for (std::thread& thread : threads) {
+      thread.join();
+   }
+
+   for (int exitCode : exitCodes) {
+      if (exitCode != 0) {
+         return exitCode;
       }
-   } else {
-      LOG_CRITICAL("no threading factory configured")
-      rc = 1;
    }
 
-   return rc;
+   return 0;
 }
 
 //******************************************************************************
@@ -708,7 +1653,11 @@ int HttpServer::run() {
       LOG_CRITICAL("server not initialized")
       return 1;
    } else {
-      if (m_isUsingKernelEventServer) {
+      if (m_isUsingReusePortReactors) {
+         return runReusePortReactors();
+      } else if (m_isUsingEventLoop) {
+         return runEventLoopServer();
+      } else if (m_isUsingKernelEventServer) {
          return runKernelEventServer();
       } else {
          return runSocketServer();
@@ -875,6 +1824,274 @@ int HttpServer::keepAliveMaxRequests() const {
 
 //******************************************************************************
 
+void HttpServer::setupRequestLimits(const chaudiere::KeyValuePairs& kvp) {
+   //LOG_DEBUG("setupRequestLimits")
+   if (kvp.hasKey(CFG_SERVER_MAX_REQUEST_BODY_SIZE)) {
+      const int maxBodySize =
+         getIntValue(kvp, CFG_SERVER_MAX_REQUEST_BODY_SIZE);
+
+      if (maxBodySize >= 0) {
+         m_maxRequestBodySize = maxBodySize;
+      }
+   }
+}
+
+//******************************************************************************
+
+long HttpServer::maxRequestBodySize() const {
+   return m_maxRequestBodySize;
+}
+
+//******************************************************************************
+
+void HttpServer::setupCompression(const chaudiere::KeyValuePairs& kvp) {
+   //LOG_DEBUG("setupCompression")
+   m_compressionEnabled = hasTrueValue(kvp, CFG_SERVER_COMPRESSION);
+
+   if (kvp.hasKey(CFG_SERVER_COMPRESSION_MIN_SIZE)) {
+      const int minSize = getIntValue(kvp, CFG_SERVER_COMPRESSION_MIN_SIZE);
+      if (minSize >= 0) {
+         m_minimumCompressionSize = minSize;
+      }
+   }
+
+   if (kvp.hasKey(CFG_SERVER_COMPRESSION_MIME_TYPES)) {
+      setCompressionMimeTypes(kvp.getValue(CFG_SERVER_COMPRESSION_MIME_TYPES));
+   }
+
+   if (kvp.hasKey(CFG_SERVER_COMPRESSION_ENCODINGS)) {
+      setCompressionEncodings(kvp.getValue(CFG_SERVER_COMPRESSION_ENCODINGS));
+   }
+
+   if (kvp.hasKey(CFG_SERVER_COMPRESSION_GZIP_LEVEL)) {
+      m_gzipCompressionLevel =
+         validCompressionLevel(kvp,
+                               CFG_SERVER_COMPRESSION_GZIP_LEVEL,
+                               getIntValue(kvp, CFG_SERVER_COMPRESSION_GZIP_LEVEL),
+                               GzipCompressor::MIN_LEVEL,
+                               GzipCompressor::MAX_LEVEL,
+                               m_gzipCompressionLevel);
+   }
+
+   if (kvp.hasKey(CFG_SERVER_COMPRESSION_BROTLI_LEVEL)) {
+      m_brotliCompressionLevel =
+         validCompressionLevel(kvp,
+                               CFG_SERVER_COMPRESSION_BROTLI_LEVEL,
+                               getIntValue(kvp, CFG_SERVER_COMPRESSION_BROTLI_LEVEL),
+                               BrotliCompressor::MIN_LEVEL,
+                               BrotliCompressor::MAX_LEVEL,
+                               m_brotliCompressionLevel);
+   }
+
+   if (kvp.hasKey(CFG_SERVER_COMPRESSION_ZSTD_LEVEL)) {
+      m_zstdCompressionLevel =
+         validCompressionLevel(kvp,
+                               CFG_SERVER_COMPRESSION_ZSTD_LEVEL,
+                               getIntValue(kvp, CFG_SERVER_COMPRESSION_ZSTD_LEVEL),
+                               ZstdCompressor::MIN_LEVEL,
+                               ZstdCompressor::MAX_LEVEL,
+                               m_zstdCompressionLevel);
+   }
+
+   if (kvp.hasKey(CFG_SERVER_COMPRESSION_ZSTD_DICTIONARY_ENCODING)) {
+      m_zstdDictionaryEncoding =
+         kvp.getValue(CFG_SERVER_COMPRESSION_ZSTD_DICTIONARY_ENCODING);
+   }
+
+   if (kvp.hasKey(CFG_SERVER_COMPRESSION_ZSTD_DICTIONARY)) {
+      // digested once for the configured level, then shared read-only
+      // by every thread compressing with it
+      m_zstdDictionary.reset(
+         ZstdDictionary::load(kvp.getValue(CFG_SERVER_COMPRESSION_ZSTD_DICTIONARY),
+                              m_zstdCompressionLevel));
+   }
+}
+
+//******************************************************************************
+
+void HttpServer::setCompressionEncodings(const std::string& encodings) {
+   m_compressionEncodings.clear();
+
+   for (std::string coding : StrUtils::split(encodings, ",")) {
+      coding = StrUtils::strip(coding);
+      StrUtils::toLowerCase(coding);
+
+      if (coding.empty()) {
+         continue;
+      }
+
+      bool isAvailable = false;
+      if (coding == HTTP::HTTP_CODING_GZIP) {
+         isAvailable = true;
+      } else if (coding == HTTP::HTTP_CODING_BROTLI) {
+         isAvailable = BrotliCompressor::isSupported();
+      } else if (coding == HTTP::HTTP_CODING_ZSTD) {
+         isAvailable = ZstdCompressor::isSupported();
+      } else {
+         LOG_WARNING("unknown compression encoding: " + coding)
+         continue;
+      }
+
+      // the defaults name every coding, built in or not
+      if (isAvailable) {
+         m_compressionEncodings.push_back(coding);
+      }
+   }
+}
+
+//******************************************************************************
+
+const std::vector<std::string>& HttpServer::compressionEncodings() const {
+   return m_compressionEncodings;
+}
+
+//******************************************************************************
+
+int HttpServer::compressionLevel(std::string_view coding) const {
+   if (coding == HTTP::HTTP_CODING_BROTLI) {
+      return m_brotliCompressionLevel;
+   } else if (coding == HTTP::HTTP_CODING_ZSTD) {
+      return m_zstdCompressionLevel;
+   } else {
+      return m_gzipCompressionLevel;
+   }
+}
+
+//******************************************************************************
+
+const ZstdDictionary* HttpServer::zstdDictionary() const {
+   return m_zstdDictionary.get();
+}
+
+//******************************************************************************
+
+const std::string& HttpServer::zstdDictionaryEncoding() const {
+   return m_zstdDictionaryEncoding;
+}
+
+//******************************************************************************
+
+void HttpServer::setCompressionMimeTypes(const std::string& mimeTypes) {
+   m_compressionMimeTypes.clear();
+
+   for (std::string mimeType : StrUtils::split(mimeTypes, ",")) {
+      mimeType = StrUtils::strip(mimeType);
+      if (!mimeType.empty()) {
+         m_compressionMimeTypes.push_back(mimeType);
+      }
+   }
+}
+
+//******************************************************************************
+
+void HttpServer::setupResponseCache(const chaudiere::KeyValuePairs& kvp) {
+   //LOG_DEBUG("setupResponseCache")
+   if (!hasTrueValue(kvp, CFG_SERVER_RESPONSE_CACHE)) {
+      m_responseCache.reset();
+      return;
+   }
+
+   std::size_t maxSize = HttpResponseCache::DEFAULT_MAX_SIZE;
+
+   if (kvp.hasKey(CFG_SERVER_RESPONSE_CACHE_MAX_SIZE)) {
+      const int value = getIntValue(kvp, CFG_SERVER_RESPONSE_CACHE_MAX_SIZE);
+      if (value > 0) {
+         maxSize = value;
+      } else {
+         LOG_WARNING("invalid " + CFG_SERVER_RESPONSE_CACHE_MAX_SIZE +
+                     ", using default")
+      }
+   }
+
+   m_responseCache = std::make_unique<HttpResponseCache>(maxSize);
+}
+
+//******************************************************************************
+
+HttpResponseCache* HttpServer::responseCache() {
+   return m_responseCache.get();
+}
+
+//******************************************************************************
+
+void HttpServer::setupStaticFiles(const chaudiere::KeyValuePairs& kvp) {
+   //LOG_DEBUG("setupStaticFiles")
+   if (kvp.hasKey(CFG_SERVER_STATIC_FILES_DIRECTORY)) {
+      m_staticFilesDirectory = kvp.getValue(CFG_SERVER_STATIC_FILES_DIRECTORY);
+   }
+
+   if (kvp.hasKey(CFG_SERVER_STATIC_FILES_PATH)) {
+      m_staticFilesPath = kvp.getValue(CFG_SERVER_STATIC_FILES_PATH);
+   }
+}
+
+//******************************************************************************
+
+void HttpServer::setupShutdown(const chaudiere::KeyValuePairs& kvp) {
+   //LOG_DEBUG("setupShutdown")
+   if (kvp.hasKey(CFG_SERVER_SHUTDOWN_TIMEOUT)) {
+      const int timeout = getIntValue(kvp, CFG_SERVER_SHUTDOWN_TIMEOUT);
+
+      if (timeout >= 0) {
+         m_shutdownTimeoutSecs = timeout;
+      }
+   }
+
+   if (kvp.hasKey(CFG_SERVER_HANDOFF_SOCKET)) {
+      m_handoffSocketPath = kvp.getValue(CFG_SERVER_HANDOFF_SOCKET);
+   }
+}
+
+//******************************************************************************
+
+void HttpServer::setupCpuAffinity(const chaudiere::KeyValuePairs& kvp) {
+   //LOG_DEBUG("setupCpuAffinity")
+   if (kvp.hasKey(CFG_SERVER_WORKER_CPUS)) {
+      const string& cpuList = kvp.getValue(CFG_SERVER_WORKER_CPUS);
+      if (!CpuAffinity::parseCpuList(cpuList, m_workerCpus)) {
+         LOG_WARNING("invalid worker_cpus, pool workers not pinned: " + cpuList)
+      } else if (!m_isThreaded || (m_threading != CFG_THREADING_WORK_STEALING)) {
+         // chaudiere's pools don't expose their threads to pin
+         LOG_WARNING("worker_cpus is only used with threading = work_stealing")
+         m_workerCpus.clear();
+      }
+   }
+
+   // in a cpuset-limited container these needn't start at CPU 0, and a
+   // CPU outside them can't be pinned to
+   vector<int> allowedCpus;
+   CpuAffinity::allowedCpus(allowedCpus);
+   vector<int> removedCpus;
+
+   CpuAffinity::keepAllowedCpus(m_workerCpus, allowedCpus, removedCpus);
+   if (!removedCpus.empty()) {
+      LOG_WARNING("worker_cpus not available to the process, ignored: " +
+                  cpuListToString(removedCpus))
+      if (m_workerCpus.empty()) {
+         LOG_WARNING("no worker_cpus available, pool workers not pinned")
+      }
+   }
+
+   if (kvp.hasKey(CFG_SERVER_REACTOR_CPUS)) {
+      const string& cpuList = kvp.getValue(CFG_SERVER_REACTOR_CPUS);
+      if (!CpuAffinity::parseCpuList(cpuList, m_reactorCpus)) {
+         LOG_WARNING("invalid reactor_cpus, reactors pinned to the process's CPUs: " + cpuList)
+      }
+   }
+
+   CpuAffinity::keepAllowedCpus(m_reactorCpus, allowedCpus, removedCpus);
+   if (!removedCpus.empty()) {
+      LOG_WARNING("reactor_cpus not available to the process, ignored: " +
+                  cpuListToString(removedCpus))
+   }
+
+   if (m_reactorCpus.empty()) {
+      m_reactorCpus = allowedCpus;
+   }
+}
+
+//******************************************************************************
+
 bool HttpServer::tlsEnabled() const {
    return m_tlsEnabled;
 }
@@ -993,154 +2210,193 @@ void HttpServer::setupServerString(const chaudiere::KeyValuePairs& kvp) {
 
 bool HttpServer::setupHandlers(const chaudiere::SectionedConfigDataSource* dataSource) {
    //LOG_DEBUG("setupHandlers")
-   const bool isLoggingDebug = Logger::isLogging(Debug);
-
    if (m_allowBuiltInHandlers) {
       //LOG_DEBUG("adding built-in handlers")
       addBuiltInHandlers();
    }
 
-   if (isLoggingDebug) {
-      //LOG_DEBUG("processing handlers")
+   if (!addStaticFileHandler() && m_requireAllHandlersForStartup) {
+      return false;
    }
 
-   KeyValuePairs kvpHandlers;
-   if (dataSource->hasSection(CFG_SECTION_HANDLERS) &&
-       dataSource->readSection(CFG_SECTION_HANDLERS, kvpHandlers)) {
+   if (!m_reloadPath.empty()) {
+      // a reload runs module code again, so it's never left open to
+      // whoever can reach the path
+      if (m_reloadSecret.empty() && !m_reloadTrustsLoopback) {
+         LOG_ERROR(CFG_SERVER_RELOAD_PATH + " needs " +
+                   CFG_SERVER_RELOAD_SECRET + " (or " +
+                   CFG_SERVER_RELOAD_TRUST_LOOPBACK +
+                   " = true); not registering the reload handler")
+         if (m_requireAllHandlersForStartup) {
+            return false;
+         }
+      } else if (!addPathHandler(m_reloadPath,
+                                 new ServerReloadHandler(*this,
+                                                         m_reloadSecret,
+                                                         m_reloadTrustsLoopback))) {
+         LOG_ERROR(string("unable to register reload handler for path ") +
+                   m_reloadPath)
+         if (m_requireAllHandlersForStartup) {
+            return false;
+         }
+      }
+   }
 
-      vector<string> vecKeys;
-      kvpHandlers.getKeys(vecKeys);
+   HandlerMap moduleHandlers;
+   if (!loadModuleHandlers(*dataSource,
+                           moduleHandlers,
+                           m_requireAllHandlersForStartup,
+                           false)) {
+      return false;
+   }
 
-      for (const auto& path : vecKeys) {
-         const string& moduleSection = kvpHandlers.getValue(path);
+   for (const auto& pathHandler : moduleHandlers) {
+      if (insertPathHandler(pathHandler.first, pathHandler.second)) {
+         m_modulePaths.insert(pathHandler.first);
+      } else {
+         LOG_ERROR(string("unable to register handler for path ") +
+                   pathHandler.first)
 
-         if (isLoggingDebug) {
-            LOG_DEBUG("path='" + path + "'")
+         if (m_requireAllHandlersForStartup) {
+            return false;
          }
+      }
+   }
 
-         if (moduleSection.empty()) {
-            LOG_WARNING(string("nothing specified for path ") + path)
-            LOG_WARNING("Not servicing this path")
-            continue;
-         }
+   // do we have any handlers?
+   if (!m_allowBuiltInHandlers && m_mapPathHandlers.empty()) {
+      LOG_CRITICAL("no handlers registered")
+      return false;
+   }
 
-         if (dataSource->hasSection(moduleSection)) {
-            KeyValuePairs kvpModule;
-            if (dataSource->readSection(moduleSection, kvpModule)) {
-               if (!kvpModule.hasKey(MODULE_DLL_NAME)) {
-                  LOG_ERROR(MODULE_DLL_NAME +
-                            string(" not specified for module ") +
-                            moduleSection)
-               }
+   return true;
+}
 
-               const string& dllName = kvpModule.getValue(MODULE_DLL_NAME);
-               HttpHandler* pHandler = nullptr;
+//******************************************************************************
 
-               if (isLoggingDebug) {
-                  LOG_DEBUG("trying to load dynamic library='" +
-                            dllName +
-                            "'")
-               }
+bool HttpServer::loadModuleHandlers(const chaudiere::SectionedConfigDataSource& dataSource,
+                                    HandlerMap& handlers,
+                                    bool requireAll,
+                                    bool isReload) {
+   const bool isLoggingDebug = Logger::isLogging(Debug);
 
-               std::unique_ptr<DynamicLibrary> dll(new DynamicLibrary(dllName));
+   KeyValuePairs kvpHandlers;
+   if (!dataSource.hasSection(CFG_SECTION_HANDLERS) ||
+       !dataSource.readSection(CFG_SECTION_HANDLERS, kvpHandlers)) {
+      return true;
+   }
 
-               // load the dll
-               try {
-                  void* pfn = dll->resolve("CreateHandler");
-                  if (pfn == nullptr) {
-                     LOG_ERROR("unable to find module library entry point")
-                  } else {
-                     if (isLoggingDebug) {
-                        LOG_DEBUG("dynamic library loaded")
-                     }
+   vector<string> vecKeys;
+   kvpHandlers.getKeys(vecKeys);
 
-                     PFN_CREATE_HANDLER pfnCreateHandler = (PFN_CREATE_HANDLER) pfn;
-                     pHandler = (*pfnCreateHandler)();
-                  }
-               } catch (const exception& e) {
-                  LOG_ERROR(string("exception caught trying to load module library ") +
-                            dllName)
-                  LOG_ERROR(e.what())
-               } catch (...) {
-                  LOG_ERROR(string("unable to load module library ") +
-                            dllName)
-               }
+   for (const auto& path : vecKeys) {
+      const string& moduleSection = kvpHandlers.getValue(path);
 
-               // continue loading application specific parameters for the module
-               vector<string> vecModuleKeys;
-               kvpModule.getKeys(vecModuleKeys);
+      if (isLoggingDebug) {
+         LOG_DEBUG("path='" + path + "'")
+      }
 
-               KeyValuePairs kvpApp;
+      if (moduleSection.empty()) {
+         LOG_WARNING(string("nothing specified for path ") + path)
+         LOG_WARNING("Not servicing this path")
+         continue;
+      }
 
-               for (const auto& moduleKey : vecModuleKeys) {
+      KeyValuePairs kvpModule;
+      if (!dataSource.hasSection(moduleSection) ||
+          !dataSource.readSection(moduleSection, kvpModule)) {
+         LOG_ERROR(string("no configuration for handler ") + moduleSection)
 
-                  // starts with app prefix?
-                  if (StrUtils::startsWith(moduleKey, APP_PREFIX)) {
-                     if (moduleKey.length() > APP_PREFIX_LEN) {
-                        kvpApp.addPair(moduleKey.substr(APP_PREFIX_LEN),
-                                       kvpModule.getValue(moduleKey));
-                     }
-                  }
-               }
+         if (requireAll) {
+            return false;
+         }
+         continue;
+      }
 
-               if (isLoggingDebug) {
-                  //LOG_DEBUG("initializing the handler")
-               }
+      if (!kvpModule.hasKey(MODULE_DLL_NAME)) {
+         LOG_ERROR(MODULE_DLL_NAME +
+                   string(" not specified for module ") +
+                   moduleSection)
+      }
 
-               // now initialize the servlet
-               if (nullptr == pHandler) {
-                  LOG_ERROR(string("unable to create handler for path ") +
-                            path)
-                  if (m_requireAllHandlersForStartup) {
-                     return false;
-                  }
-               } else if (pHandler->init(path, kvpApp)) {
-                  if (isLoggingDebug) {
-                     //LOG_DEBUG("initialization succeeded")
-                  }
+      const string& dllName = kvpModule.getValue(MODULE_DLL_NAME);
+      std::shared_ptr<DynamicLibrary> library;
+      HttpHandler* pHandler = nullptr;
 
-                  // register it
-                  if (!addPathHandler(path, pHandler)) {
-                     LOG_ERROR(string("unable to register handler for path ") +
-                               path)
+      if (isLoggingDebug) {
+         LOG_DEBUG("trying to load dynamic library='" +
+                   dllName +
+                   "'")
+      }
 
-                     if (m_requireAllHandlersForStartup) {
-                        return false;
-                     }
-                  } else {
-                     // keep the library loaded for as long as the handler
-                     // created from it is registered -- the handler's code
-                     // lives inside it
-                     m_mapPathLibraries[path] = std::move(dll);
-                  }
-               } else {
-                  LOG_ERROR(string("unable to initialize handler for path ") +
-                            path)
-                  if (m_requireAllHandlersForStartup) {
-                     return false;
-                  }
-               }
-            }
+      // load the dll
+      try {
+         library = loadModuleLibrary(dllName, isReload);
+         void* pfn = library->resolve("CreateHandler");
+         if (pfn == nullptr) {
+            LOG_ERROR("unable to find module library entry point")
          } else {
-            if (!moduleSection.empty()) {
-               LOG_ERROR(string("no configuration for handler ") +
-                         moduleSection)
-            } else {
-               LOG_ERROR(string("no configuration for handler ") +
-                         path)
+            if (isLoggingDebug) {
+               LOG_DEBUG("dynamic library loaded")
             }
 
-            if (m_requireAllHandlersForStartup) {
-               return false;
+            PFN_CREATE_HANDLER pfnCreateHandler = (PFN_CREATE_HANDLER) pfn;
+            pHandler = (*pfnCreateHandler)();
+         }
+      } catch (const exception& e) {
+         LOG_ERROR(string("exception caught trying to load module library ") +
+                   dllName)
+         LOG_ERROR(e.what())
+      } catch (...) {
+         LOG_ERROR(string("unable to load module library ") +
+                   dllName)
+      }
+
+      if (nullptr == pHandler) {
+         LOG_ERROR(string("unable to create handler for path ") +
+                   path)
+         if (requireAll) {
+            return false;
+         }
+         continue;
+      }
+
+      // the handler's code lives in the library, so the library stays
+      // loaded until the handler is deleted - after the last request
+      // routed to it is done
+      std::shared_ptr<HttpHandler> handler(pHandler,
+                                           [library](HttpHandler* h) {
+                                              delete h;
+                                           });
+
+      // continue loading application specific parameters for the module
+      vector<string> vecModuleKeys;
+      kvpModule.getKeys(vecModuleKeys);
+
+      KeyValuePairs kvpApp;
+
+      for (const auto& moduleKey : vecModuleKeys) {
+
+         // starts with app prefix?
+         if (StrUtils::startsWith(moduleKey, APP_PREFIX)) {
+            if (moduleKey.length() > APP_PREFIX_LEN) {
+               kvpApp.addPair(moduleKey.substr(APP_PREFIX_LEN),
+                              kvpModule.getValue(moduleKey));
             }
          }
       }
-   }
 
-   // do we have any handlers?
-   if (!m_allowBuiltInHandlers && m_mapPathHandlers.empty()) {
-      LOG_CRITICAL("no handlers registered")
-      return false;
+      // now initialize the servlet
+      if (!handler->init(path, kvpApp)) {
+         LOG_ERROR(string("unable to initialize handler for path ") +
+                   path)
+         if (requireAll) {
+            return false;
+         }
+         continue;
+      }
+
+      handlers[path] = std::move(handler);
    }
 
    return true;
@@ -1160,7 +2416,8 @@ void HttpServer::setupThreading(const chaudiere::KeyValuePairs& kvp) {
       if (!threading.empty()) {
          if ((threading == CFG_THREADING_PTHREADS) ||
              (threading == CFG_THREADING_CPP11) ||
-             (threading == CFG_THREADING_GCD_LIBDISPATCH)) {
+             (threading == CFG_THREADING_GCD_LIBDISPATCH) ||
+             (threading == CFG_THREADING_WORK_STEALING)) {
             m_threading = threading;
             m_isThreaded = true;
          } else if (threading == CFG_THREADING_NONE) {
@@ -1190,8 +2447,41 @@ void HttpServer::setupSocketHandling(const chaudiere::KeyValuePairs& kvp) {
       if (sockets == CFG_SOCKETS_KERNEL_EVENTS) {
          m_isUsingKernelEventServer = true;
          m_sockets = CFG_SOCKETS_KERNEL_EVENTS;
+      } else if (sockets == CFG_SOCKETS_EVENT_LOOP) {
+         if (HttpEventLoop::isSupportedPlatform()) {
+            m_isUsingEventLoop = true;
+            m_sockets = CFG_SOCKETS_EVENT_LOOP;
+         } else {
+            LOG_WARNING("event_loop sockets not supported on this platform, falling back to socket_server")
+         }
+      } else if (sockets == CFG_SOCKETS_REUSEPORT_REACTORS) {
+         if (HttpEventLoop::isSupportedPlatform()) {
+            m_isUsingReusePortReactors = true;
+            m_sockets = CFG_SOCKETS_REUSEPORT_REACTORS;
+         } else {
+            LOG_WARNING("reuseport_reactors sockets not supported on this platform, falling back to socket_server")
+         }
+      }
+   }
+
+   // one reactor per CPU the process may run on unless configured
+   // otherwise
+   vector<int> allowedCpus;
+   if (CpuAffinity::allowedCpus(allowedCpus)) {
+      m_reactorCount = (int) allowedCpus.size();
+   } else {
+      m_reactorCount = (int) ::sysconf(_SC_NPROCESSORS_ONLN);
+   }
+   if (kvp.hasKey(CFG_SERVER_REACTOR_COUNT)) {
+      const int reactorCount = getIntValue(kvp, CFG_SERVER_REACTOR_COUNT);
+      if (reactorCount > 0) {
+         m_reactorCount = reactorCount;
       }
    }
+
+   if (m_reactorCount < 1) {
+      m_reactorCount = 1;
+   }
 }
 
 //******************************************************************************
@@ -1218,7 +2508,14 @@ void HttpServer::setupConcurrency() {
    //LOG_DEBUG("setupConcurrency")
    string concurrencyModel = EMPTY;
 
-   if (m_isThreaded) {
+   if (m_isUsingReusePortReactors) {
+      // each reactor services its own connections on its own thread -
+      // there's no shared pool to hand requests to
+      char numberReactors[128];
+      ::snprintf(numberReactors, 128, "reactors [%d threads]",
+                 m_reactorCount);
+      concurrencyModel = numberReactors;
+   } else if (m_isThreaded) {
       bool isUsingLibDispatch = false;
 
       if (m_threading == CFG_THREADING_CPP11) {
@@ -1234,9 +2531,17 @@ void HttpServer::setupConcurrency() {
          m_threadingFactory.reset(new PthreadsThreadingFactory);
       }
       //ThreadingFactory::setThreadingFactory(m_threadingFactory);
-      m_threadPool.reset(
-         m_threadingFactory->createThreadPoolDispatcher(m_threadPoolSize,
-                                                        "thread_pool"));
+      if (m_threading == CFG_THREADING_WORK_STEALING) {
+         // misere's own pool - the factory above still supplies the
+         // kernel event server's mutexes
+         m_workStealingPool = new WorkStealingDispatcher(m_threadPoolSize);
+         m_workStealingPool->setWorkerCpus(m_workerCpus);
+         m_threadPool.reset(m_workStealingPool);
+      } else {
+         m_threadPool.reset(
+            m_threadingFactory->createThreadPoolDispatcher(m_threadPoolSize,
+                                                           "thread_pool"));
+      }
 
       m_threadPool->start();
 
@@ -1261,18 +2566,41 @@ void HttpServer::setupConcurrency() {
 
 bool HttpServer::setupServerSocket() {
    //LOG_DEBUG("setupServerSocket")
-   if (!m_isUsingKernelEventServer) {
-      try {
-         if (Logger::isLogging(LogLevel::Debug)) {
-            //char msg[128];
-            //::snprintf(msg, 128,
-            //           "creating server socket on port=%d",
-            //           m_serverPort);
-            //LOG_DEBUG(string(msg))
+   if ((m_isUsingEventLoop || m_isUsingReusePortReactors) && m_tlsEnabled) {
+      // the event loop only speaks plain TCP; TLS connections need the
+      // blocking TlsConnection path
+      LOG_WARNING(m_sockets + " sockets do not support TLS, falling back to socket_server")
+      m_isUsingEventLoop = false;
+      m_isUsingReusePortReactors = false;
+      m_sockets = CFG_SOCKETS_SOCKET_SERVER;
+   }
+
+   if (!m_handoffSocketPath.empty()) {
+      if (m_isUsingKernelEventServer || m_isUsingReusePortReactors) {
+         // reuseport reactors bind alongside the running process instead
+         LOG_WARNING(m_sockets + " sockets do not support handoff_socket, ignoring it")
+         m_handoffSocketPath.clear();
+      } else {
+         // a server already running with the same configuration hands
+         // over its listener, and drains
+         m_inheritedListenerFD =
+            ListenerHandoff::receiveListener(m_handoffSocketPath);
+
+         if (m_inheritedListenerFD > -1) {
+            LOG_INFO("took over listening socket from running server process")
          }
+      }
+   }
 
-         m_serverSocket = std::make_unique<ServerSocket>(m_serverPort);
-      } catch (...) {
+   // event loops create and own their own non-blocking listeners (the
+   // inherited one is passed along when the loop starts)
+   if (!m_isUsingKernelEventServer &&
+       !m_isUsingEventLoop &&
+       !m_isUsingReusePortReactors) {
+      if (m_inheritedListenerFD > -1) {
+         m_listener.adopt(m_inheritedListenerFD, true);
+         m_inheritedListenerFD = -1;
+      } else if (!m_listener.open(m_serverPort, false, true)) {
          string exception = "unable to open server socket port '";
          exception += StrUtils::toString(m_serverPort);
          exception += "'";
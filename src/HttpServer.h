@@ -4,28 +4,46 @@
 #ifndef MISERE_HTTPSERVER_H
 #define MISERE_HTTPSERVER_H
 
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
+#include <string_view>
+#include <thread>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
+#include "EpochReclaimer.h"
+#include "HttpDateCache.h"
 #include "HttpHandler.h"
+#include "HttpHeaderPrefixes.h"
+#include "HttpHeaders.h"
+#include "HttpResponseCache.h"
+#include "HttpRouteParameters.h"
+#include "HttpRouter.h"
 #include "KeyValuePairs.h"
-#include "ServerSocket.h"
+#include "ListenerHandoff.h"
+#include "ListeningSocket.h"
 #include "SocketRequest.h"
 #include "DynamicLibrary.h"
 #include "ThreadPoolDispatcher.h"
 #include "SectionedConfigDataSource.h"
 #include "ThreadingFactory.h"
+#include "ZstdCompressor.h"
 #include "armure/Context.h"
 
 
 namespace misere {
 
+class WorkStealingDispatcher;
+
 /**
  * HttpServer is an HTTP server meant to be used for servicing application
- * HTTP requests. It is not meant to be a general purpose web server (no
- * provisions for serving files).
+ * HTTP requests. It is not meant to be a general purpose web server (it
+ * can serve a directory of assets alongside the application - see
+ * StaticFileHandler - but nothing more).
  */
 class HttpServer {
    public:
@@ -58,6 +76,20 @@ class HttpServer {
        */
       std::string getLocalDateTime() const;
 
+      /**
+       * Retrieves the server's once-per-second date cache, for copying the
+       * current HTTP date without formatting it
+       * @return the date cache
+       */
+      const HttpDateCache& getDateCache() const;
+
+      /**
+       * Retrieves the pre-rendered status line/Server/Connection prefixes
+       * used when building response headers
+       * @return the response header prefixes
+       */
+      const HttpHeaderPrefixes& getHeaderPrefixes() const;
+
       /**
        * Constructs HTTP response headers using the specified response code and
        * collection of header key/value pairs
@@ -69,7 +101,22 @@ class HttpServer {
                               const chaudiere::KeyValuePairs& headers) const;
 
       /**
-       * Registers an HttpHandler for the specified path
+       * Constructs HTTP response headers using the specified response code and
+       * collection of headers
+       * @param responseCode the HTTP response code
+       * @param headers collection of HTTP headers
+       * @return HTTP headers formatted as a string
+       */
+      std::string buildHeader(const std::string& responseCode,
+                              const HttpHeaders& headers) const;
+
+      /**
+       * Registers an HttpHandler for the specified path. The path is a
+       * route, so it may capture segments (e.g., "/users/:id") or the rest
+       * of the path (a final "*name" segment) - see HttpRouter. A handler
+       * whose handlesSubpaths() is true also serves the paths below its own.
+       * The server takes ownership of the handler, and deletes it if the
+       * route can't be registered (e.g., it's already taken).
        * @param path the path to associate with the specified handler
        * @param handler the handler to invoke when a request arrives for the specified path
        * @see HttpHandler()
@@ -85,11 +132,92 @@ class HttpServer {
       bool removePathHandler(const std::string& path);
 
       /**
-       * Retrieves the handler associated with the specified path
-       * @param path the path whose handler is desired
+       * Retrieves the handler whose route matches the specified path - or,
+       * if none does, the handler serving the paths below the nearest
+       * enclosing path (see HttpHandler::handlesSubpaths()). Handlers can
+       * be added and removed while requests are being routed: the handler
+       * (and the parameter names) stay valid for as long as the calling
+       * thread holds an EpochReclaimer::ReadGuard, even if the handler is
+       * removed in the meantime.
+       * @param path the path whose handler is desired (without the query)
+       * @param parameters receives the parameters the route captured
        * @return the handler associated with the path, or null if there is none
        */
-      HttpHandler* getPathHandler(const std::string& path);
+      HttpHandler* getPathHandler(std::string_view path,
+                                  HttpRouteParameters& parameters) const;
+
+      /**
+       * Retrieves the handler whose route matches the specified path
+       * @param path the path whose handler is desired (without the query)
+       * @return the handler associated with the path, or null if there is none
+       */
+      HttpHandler* getPathHandler(std::string_view path) const;
+
+      /**
+       * Re-reads the config file and replaces the handlers loaded from
+       * modules (the "[handlers]" section) with the ones it now lists -
+       * without a restart, and without disturbing requests in flight.
+       * Sent on SIGHUP, and on a POST to the configured reload_path.
+       * Changes to the "[server]" section still need a restart.
+       * @return boolean indicating whether the handlers were replaced
+       * @see reloadHandlers()
+       */
+      bool reload();
+
+      /**
+       * Replaces the handlers loaded from modules with the ones a
+       * configuration lists. Each module is loaded afresh, next to the
+       * version being replaced; if any of them can't be loaded or
+       * initialized, or its route can't be added, nothing changes. The
+       * routes are swapped in one step, and a replaced handler (and its
+       * library) is freed once the requests using it are done. Handlers
+       * registered by other means (addPathHandler(), built-in handlers)
+       * are left as they are.
+       * @param dataSource the configuration to load the handlers from
+       * @return boolean indicating whether the handlers were replaced
+       */
+      bool reloadHandlers(const chaudiere::SectionedConfigDataSource& dataSource);
+
+      /**
+       * Stops accepting connections and drains the ones open: requests in
+       * flight are finished, but no connection is kept alive for another.
+       * The run...Server() call returns once every connection is closed,
+       * or once shutdown_timeout seconds have passed. Sent on SIGTERM and
+       * SIGINT, and once the listening socket has been handed to a new
+       * server process (see handoff_socket).
+       */
+      void shutdown();
+
+      /**
+       * Determines whether the server is draining its connections ahead
+       * of stopping (see shutdown())
+       * @return boolean indicating whether the server is draining
+       */
+      bool isDraining() const;
+
+      /**
+       * Retrieves the longest the server waits for open connections to
+       * finish when it shuts down
+       * @return the shutdown timeout, in seconds
+       */
+      int shutdownTimeoutSecs() const;
+
+      /**
+       * Records that a connection is being served by an HttpRequestHandler
+       */
+      void addActiveConnection();
+
+      /**
+       * Records that an HttpRequestHandler is done with its connection
+       */
+      void removeActiveConnection();
+
+      /**
+       * Retrieves the number of connections being served by
+       * HttpRequestHandlers
+       * @return the number of active connections
+       */
+      int getActiveConnectionCount() const;
 
       /**
        * Runs the built-in socket server
@@ -104,7 +232,20 @@ class HttpServer {
       int runKernelEventServer();
 
       /**
-       * Runs the HTTP server using either the built-in socket server or a kernel event server
+       * Runs misere's own edge-triggered event loop (see HttpEventLoop)
+       * @return exit code for the HTTP server process
+       */
+      int runEventLoopServer();
+
+      /**
+       * Runs one event loop per reactor, each on its own CPU-pinned thread
+       * with its own SO_REUSEPORT listener on the server port
+       * @return exit code for the HTTP server process
+       */
+      int runReusePortReactors();
+
+      /**
+       * Runs the HTTP server using the built-in socket server, a kernel event server or the event loop
        * @return exit code for the HTTP server process
        */
       int run();
@@ -199,17 +340,55 @@ class HttpServer {
 
       /**
        * Determines if compression is turned on for the specified mime type
-       * @param mimeType the mime type to check whether to compress
+       * (one of those listed by compression_mime_types)
+       * @param mimeType the mime type to check whether to compress (any
+       *        parameters, e.g. "; charset=utf-8", are ignored)
        * @return boolean indicating whether the specified mime type is to be compressed
        */
-      bool compressResponse(const std::string& mimeType) const;
+      bool compressResponse(std::string_view mimeType) const;
 
       /**
-       * Determines if gzip compression is enabled for the server
-       * @return boolean indicating if gzip compression is enabled
+       * Determines if response compression is enabled for the server
+       * @return boolean indicating if response compression is enabled
        */
       bool compressionEnabled() const;
 
+      /**
+       * Retrieves the content codings ("zstd", "br", "gzip") responses may
+       * be compressed with - those configured and built in - in the
+       * server's order of preference
+       * @return the content codings
+       */
+      const std::vector<std::string>& compressionEncodings() const;
+
+      /**
+       * Retrieves the configured compression level for a content coding
+       * @param coding the content coding
+       * @return the compression level
+       */
+      int compressionLevel(std::string_view coding) const;
+
+      /**
+       * Retrieves the zstd dictionary loaded from compression_zstd_dictionary
+       * @return the dictionary, or nullptr if none is configured
+       */
+      const ZstdDictionary* zstdDictionary() const;
+
+      /**
+       * Retrieves the content coding that clients holding the zstd
+       * dictionary list in Accept-Encoding to get responses compressed
+       * with it
+       * @return the dictionary's content coding
+       */
+      const std::string& zstdDictionaryEncoding() const;
+
+      /**
+       * Retrieves the cache of finished responses, for handlers that opt
+       * in to it (see HttpHandler::responseCacheTtl())
+       * @return the response cache, or nullptr if response_cache is off
+       */
+      HttpResponseCache* responseCache();
+
       /**
        * Retrieves the minimum size of the response payload to be compressed
        * @return minimum size of response payload (in bytes) to be compressed
@@ -227,6 +406,24 @@ class HttpServer {
       void setupListeningPort(const chaudiere::KeyValuePairs& kvp);
       void setupSocketHandling(const chaudiere::KeyValuePairs& kvp);
       void setupKeepAlive(const chaudiere::KeyValuePairs& kvp);
+      void setupRequestLimits(const chaudiere::KeyValuePairs& kvp);
+      void setupCompression(const chaudiere::KeyValuePairs& kvp);
+      void setCompressionMimeTypes(const std::string& mimeTypes);
+      void setCompressionEncodings(const std::string& encodings);
+      void setupResponseCache(const chaudiere::KeyValuePairs& kvp);
+      void setupStaticFiles(const chaudiere::KeyValuePairs& kvp);
+      void setupShutdown(const chaudiere::KeyValuePairs& kvp);
+      void setupCpuAffinity(const chaudiere::KeyValuePairs& kvp);
+
+      /**
+       * Hands a request to the thread pool - to a worker on the NUMA node
+       * the connection's packets arrive on, if the pool's workers are
+       * pinned (worker_cpus)
+       * @param request the request
+       * @param socketFD the connection's socket
+       * @return boolean indicating whether the pool took the request
+       */
+      bool dispatchRequest(chaudiere::Runnable* request, int socketFD);
 
       /**
        * Reads TLS configuration ("tls_enabled"/"tls_certificate"/
@@ -261,6 +458,14 @@ class HttpServer {
        */
       int keepAliveMaxRequests() const;
 
+      /**
+       * Retrieves the largest request body that will be read into memory
+       * for a handler that doesn't stream its request bodies. A request
+       * with a larger body is answered with 413 (Payload Too Large).
+       * @return the maximum buffered request body size, in bytes
+       */
+      long maxRequestBodySize() const;
+
       /**
        * Determines whether this server is configured to accept TLS
        * (HTTPS) connections rather than plain HTTP.
@@ -293,18 +498,74 @@ class HttpServer {
        */
       virtual bool addBuiltInHandlers();
 
+      /**
+       * Adds the handler that serves the configured static files directory
+       * (static_files_directory) on its configured path (static_files_path)
+       * @return boolean indicating whether the handler was added (true if
+       *         no directory is configured)
+       */
+      virtual bool addStaticFileHandler();
+
       /**
        */
       virtual void outputStartupMessage();
 
 
    private:
-      std::unique_ptr<chaudiere::ServerSocket> m_serverSocket;
+      ListeningSocket m_listener;
       std::unique_ptr<chaudiere::ThreadPoolDispatcher> m_threadPool;
+      WorkStealingDispatcher* m_workStealingPool;   // m_threadPool, if work_stealing
       std::unique_ptr<chaudiere::ThreadingFactory> m_threadingFactory;
       chaudiere::KeyValuePairs m_properties;
-      std::unordered_map<std::string, std::unique_ptr<HttpHandler>> m_mapPathHandlers;
-      std::unordered_map<std::string, std::unique_ptr<chaudiere::DynamicLibrary>> m_mapPathLibraries;
+      // the routes requests are matched against - never changed once
+      // published, but replaced whole when a handler is added or removed
+      struct RouteTable
+      {
+         HttpRouter router;
+         std::vector<std::shared_ptr<HttpHandler>> handlers;
+      };
+
+      using HandlerMap = std::unordered_map<std::string, std::shared_ptr<HttpHandler>>;
+
+      bool insertPathHandler(const std::string& path,
+                             std::shared_ptr<HttpHandler> handler);
+      bool replaceModuleHandlers(HandlerMap handlers);
+      bool loadModuleHandlers(const chaudiere::SectionedConfigDataSource& dataSource,
+                              HandlerMap& handlers,
+                              bool requireAll,
+                              bool isReload);
+      void beginRouteBatch();
+      void endRouteBatch();
+      static std::unique_ptr<RouteTable> buildRouteTable(const HandlerMap& handlers);
+      void publishRouteTable(std::unique_ptr<RouteTable> table,
+                             bool isClearingCache);
+      void startSignalWatcher();
+      void stopSignalWatcher();
+      void watchSignals();
+      void handOverListener();
+      void setHandoffListener(int listenerFD);
+      void waitForConnections();
+
+      HandlerMap m_mapPathHandlers;
+      std::unordered_set<std::string> m_modulePaths;   // loaded from modules
+      std::atomic<const RouteTable*> m_routeTable;
+      std::unique_ptr<RouteTable> m_pendingRouteTable;   // routes added in a batch
+      bool m_pendingRouteShadows;   // the batch changes where a path routes
+      std::mutex m_routesMutex;   // held while routes are changed
+      std::mutex m_reloadMutex;   // held for the whole of a reload
+      EpochReclaimer m_routeReclaimer;
+      std::thread m_signalThread;
+      std::atomic<bool> m_isWatchingSignals;
+      int m_signalFDs[2];   // signal self-pipe (read, write)
+      std::string m_reloadPath;
+      std::string m_reloadSecret;   // required of a reload request
+      bool m_reloadTrustsLoopback;   // loopback clients may reload without it
+      ListenerHandoff m_handoff;
+      std::mutex m_handoffMutex;   // held while the listener is handed over
+      int m_handoffListenerFD;   // the listener to hand over, or -1
+      int m_inheritedListenerFD;   // received at startup, or -1
+      std::string m_handoffSocketPath;
+      std::atomic<int> m_activeConnectionCount;
       std::string m_accessLogFile;
       std::string m_errorLogFile;
       std::string m_logLevel;
@@ -314,9 +575,20 @@ class HttpServer {
       std::string m_serverString;
       std::string m_threading;
       std::string m_sockets;
-      bool m_isDone;
+      std::string m_staticFilesDirectory;
+      std::string m_staticFilesPath;
+      std::vector<std::string> m_compressionMimeTypes;
+      std::vector<std::string> m_compressionEncodings;
+      std::vector<int> m_workerCpus;
+      std::vector<int> m_reactorCpus;
+      std::unique_ptr<ZstdDictionary> m_zstdDictionary;
+      std::unique_ptr<HttpResponseCache> m_responseCache;
+      std::string m_zstdDictionaryEncoding;
+      std::atomic<bool> m_isDone;
       bool m_isThreaded;
       bool m_isUsingKernelEventServer;
+      bool m_isUsingEventLoop;
+      bool m_isUsingReusePortReactors;
       bool m_isFullyInitialized;
       bool m_allowBuiltInHandlers;
       bool m_requireAllHandlersForStartup;
@@ -325,13 +597,21 @@ class HttpServer {
       bool m_keepAliveEnabled;
       bool m_tlsEnabled;
       std::optional<armure::Context> m_tlsContext;
+      HttpDateCache m_dateCache;
+      HttpHeaderPrefixes m_headerPrefixes;
       int m_threadPoolSize;
+      int m_reactorCount;
       int m_serverPort;
       int m_socketSendBufferSize;
       int m_socketReceiveBufferSize;
       int m_minimumCompressionSize;
+      int m_gzipCompressionLevel;
+      int m_brotliCompressionLevel;
+      int m_zstdCompressionLevel;
       int m_keepAliveTimeoutSecs;
       int m_keepAliveMaxRequests;
+      int m_shutdownTimeoutSecs;
+      long m_maxRequestBodySize;
 
       // copies not allowed
       HttpServer(const HttpServer&);
@@ -4,8 +4,11 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
 #include <algorithm>
 #include <utility>
+#include <netinet/in.h>
+#include <sys/socket.h>
 
 #include "HttpTransaction.h"
 #include "HTTP.h"
@@ -18,36 +21,55 @@
 
 using namespace std;
 
-static const std::string COLON  = ":";
+static const std::size_t READ_CHUNK_SIZE = 8192;
 
 using namespace misere;
 using namespace chaudiere;
 
 //******************************************************************************
 
-HttpTransaction::HttpTransaction(ByteConnection* connection, bool connectionOwned, std::string leadingBytes) :
+HttpTransaction::HttpTransaction(ByteConnection* connection, bool connectionOwned, std::string leadingBytes, HttpConnectionArena* arena) :
+   m_parser((arena != nullptr) ? arena->getResource() : std::pmr::get_default_resource()),
    m_body(nullptr),
-   m_contentLength(0),
+   m_bodyReader(nullptr),
+   m_headers((arena != nullptr) ? arena->getResource() : std::pmr::get_default_resource()),
    m_connection(connection),
    m_connectionOwned(connectionOwned),
-   m_unconsumedBytes(std::move(leadingBytes)) {
+   m_unconsumedBytes(std::move(leadingBytes)),
+   m_arena(arena),
+   m_resource((arena != nullptr) ? arena->getResource() : std::pmr::get_default_resource()) {
+}
+
+//******************************************************************************
+
+HttpTransaction::HttpTransaction(std::pmr::memory_resource* resource) :
+   m_parser(resource),
+   m_body(nullptr),
+   m_bodyReader(nullptr),
+   m_headers(resource),
+   m_connection(nullptr),
+   m_connectionOwned(false),
+   m_arena(nullptr),
+   m_resource(resource) {
 }
 
 //******************************************************************************
 
 HttpTransaction::HttpTransaction(const HttpTransaction& copy) :
-   m_vecHeaderLines(copy.m_vecHeaderLines),
-   m_vecRequestLineValues(copy.m_vecRequestLineValues),
    m_header(copy.m_header),
    m_body(nullptr),
+   m_bodyReader(nullptr),
    m_protocol(copy.m_protocol),
-   m_firstHeaderLine(copy.m_firstHeaderLine),
    m_headers(copy.m_headers),
-   m_method(copy.m_method),
-   m_contentLength(copy.m_contentLength),
    m_connection(nullptr),
    m_connectionOwned(false),
-   m_unconsumedBytes() {
+   m_unconsumedBytes(),
+   m_arena(nullptr),
+   m_resource(std::pmr::get_default_resource()) {
+   // the parsed views must point into this copy's buffer, not the source's
+   if (copy.m_parser.isComplete()) {
+      m_parser.parse(m_header.data(), m_header.size());
+   }
 }
 
 //******************************************************************************
@@ -56,6 +78,11 @@ HttpTransaction::~HttpTransaction() {
    if ((m_connection != nullptr) && m_connectionOwned) {
       delete m_connection;
    }
+
+   // let the next request on the connection read into this buffer
+   if (m_arena != nullptr) {
+      m_arena->returnReadBuffer(std::move(m_header));
+   }
 }
 
 //*****************************************************************************
@@ -65,15 +92,14 @@ HttpTransaction& HttpTransaction::operator=(const HttpTransaction& copy) {
       return *this;
    }
 
-   m_vecHeaderLines = copy.m_vecHeaderLines;
-   m_vecRequestLineValues = copy.m_vecRequestLineValues;
    m_header = copy.m_header;
+   m_parser.reset();
+   if (copy.m_parser.isComplete()) {
+      m_parser.parse(m_header.data(), m_header.size());
+   }
    //m_body = copy.m_body;
    m_protocol = copy.m_protocol;
-   m_firstHeaderLine = copy.m_firstHeaderLine;
    m_headers = copy.m_headers;
-   m_method = copy.m_method;
-   m_contentLength = copy.m_contentLength;
    if (m_connection != nullptr) {
       if (m_connectionOwned) {
          delete m_connection;
@@ -91,141 +117,220 @@ HttpTransaction& HttpTransaction::operator=(const HttpTransaction& copy) {
 
 //******************************************************************************
 
-bool HttpTransaction::parseHeaders() {
-   bool parseSuccess = false;
+const std::string& HttpTransaction::getRawHeader() const {
+   return m_header;
+}
 
-   if (m_vecHeaderLines.empty()) {
-      return false;
-   }
+//******************************************************************************
 
-   m_firstHeaderLine = m_vecHeaderLines[0];
-   std::vector<std::string> vecTokens = StrUtils::split(m_firstHeaderLine, " ");
-   const int tokenCount = vecTokens.size();
+const chaudiere::ByteBuffer* HttpTransaction::getBody() const {
+   return m_body.get();
+}
 
-   if (3 <= tokenCount) {
-      m_vecRequestLineValues.clear();
-      m_vecRequestLineValues.reserve(3);
-      string thirdValue;
+//******************************************************************************
 
-      for (int i = 0; i < tokenCount; ++i) {
-         if (i > 1) {
-            thirdValue += vecTokens[i];
-         } else {
-            m_vecRequestLineValues.push_back(vecTokens[i]);
-         }
-      }
+ByteBuffer* HttpTransaction::takeBody() {
+   return m_body.release();
+}
 
-      m_vecRequestLineValues.push_back(thirdValue);
-      m_method = m_vecRequestLineValues[0];
-      m_protocol = thirdValue;
+//******************************************************************************
 
-      for (const auto& headerLine : m_vecHeaderLines) {
-         const string::size_type posColon = headerLine.find(COLON);
+void HttpTransaction::setBody(ByteBuffer* body) {
+   m_body.reset(body);
+}
 
-         if (std::string::npos != posColon) {
-            std::string lowerHeaderKey = headerLine.substr(0, posColon);
-            StrUtils::toLowerCase(lowerHeaderKey);
-            std::string value = headerLine.substr(posColon + 1);
-            StrUtils::trimLeadingSpaces(value);
-            m_headers.addPair(lowerHeaderKey, value);
-         }
-      }
+//******************************************************************************
 
-      if (hasHeaderValue(HTTP::HTTP_CONTENT_LENGTH)) {
-         const std::string& contentLengthAsString =
-            getHeaderValue(HTTP::HTTP_CONTENT_LENGTH);
+HttpBodyReader* HttpTransaction::getBodyReader() const {
+   return m_bodyReader.get();
+}
 
-         if (!contentLengthAsString.empty()) {
-            const int length = StrUtils::parseInt(contentLengthAsString);
+//******************************************************************************
 
-            if (length > 0) {
-               m_contentLength = length;
-            }
-         }
-      }
+bool HttpTransaction::hasPendingBody() const {
+   return (m_bodyReader != nullptr) && !m_bodyReader->isComplete();
+}
 
-      parseSuccess = true;
-   }
+//******************************************************************************
 
-   return parseSuccess;
+bool HttpTransaction::hasInvalidFraming() const {
+   return m_parser.hasInvalidFraming();
 }
 
 //******************************************************************************
 
-const std::string& HttpTransaction::getRawHeader() const {
-   return m_header;
+bool HttpTransaction::isFromLoopback() const {
+   const int fd = (m_connection != nullptr) ? m_connection->getSocketDescriptor() : -1;
+   if (fd < 0) {
+      return false;
+   }
+
+   struct sockaddr_storage address;
+   socklen_t addressLength = sizeof(address);
+   if (::getpeername(fd, (struct sockaddr*) &address, &addressLength) != 0) {
+      return false;
+   }
+
+   if (address.ss_family == AF_INET) {
+      const struct sockaddr_in* ipv4 = (const struct sockaddr_in*) &address;
+      return (ntohl(ipv4->sin_addr.s_addr) >> 24) == IN_LOOPBACKNET;
+   } else if (address.ss_family == AF_INET6) {
+      const struct sockaddr_in6* ipv6 = (const struct sockaddr_in6*) &address;
+      if (IN6_IS_ADDR_V4MAPPED(&ipv6->sin6_addr)) {
+         return ipv6->sin6_addr.s6_addr[12] == IN_LOOPBACKNET;
+      }
+      return IN6_IS_ADDR_LOOPBACK(&ipv6->sin6_addr);
+   }
+
+   return false;
 }
 
 //******************************************************************************
 
-const chaudiere::ByteBuffer* HttpTransaction::getBody() const {
-   return m_body.get();
+bool HttpTransaction::finishBody() {
+   if (m_bodyReader == nullptr) {
+      return true;
+   }
+
+   return m_bodyReader->skipRemaining();
 }
 
 //******************************************************************************
 
-ByteBuffer* HttpTransaction::takeBody() {
-   return m_body.release();
+bool HttpTransaction::bufferBody(long maxSize) {
+   if ((m_bodyReader == nullptr) || (m_body != nullptr)) {
+      return true;
+   }
+
+   if (m_bodyReader->isChunked()) {
+      // of unknown size, so the limit is checked as it arrives
+      std::string body;
+      char buffer[READ_CHUNK_SIZE];
+      int bytesRead;
+      while ((bytesRead = m_bodyReader->read(buffer, sizeof(buffer))) > 0) {
+         if ((long) (body.size() + bytesRead) > maxSize) {
+            return false;
+         }
+         body.append(buffer, bytesRead);
+      }
+
+      if (bytesRead < 0) {
+         return false;
+      }
+
+      if (!body.empty()) {
+         setBody(new ByteBuffer(body));
+      }
+      return true;
+   }
+
+   // a declared length is checked before anything is allocated
+   const long contentLength = m_parser.getContentLength();
+   if ((contentLength > maxSize) || (contentLength > INT_MAX)) {
+      return false;
+   }
+
+   std::unique_ptr<ByteBuffer> body(new ByteBuffer((int) contentLength));
+   int offset = 0;
+   while (offset < contentLength) {
+      const int bytesRead =
+         m_bodyReader->read(body->data() + offset, (int) contentLength - offset);
+      if (bytesRead <= 0) {
+         return false;
+      }
+      offset += bytesRead;
+   }
+
+   setBody(body.release());
+   return true;
 }
 
-//******************************************************************************
+bool HttpTransaction::hasBufferedBodyWithin(long maxSize) const {
+   if ((m_bodyReader == nullptr) || (m_body != nullptr)) {
+      return true;
+   }
 
-void HttpTransaction::setBody(ByteBuffer* body) {
-   m_body.reset(body);
+   // a body that isn't all here was only handed over because it's
+   // (or, chunked, has already grown) too large to wait for
+   return (m_parser.getContentLength() <= maxSize) &&
+          m_bodyReader->isBuffered();
 }
 
 //******************************************************************************
 
-bool HttpTransaction::hasHeaderValue(const std::string& headerKey) const {
-   string lowerHeaderKey = headerKey;
-   StrUtils::toLowerCase(lowerHeaderKey);
-   return m_headers.hasKey(lowerHeaderKey);
+bool HttpTransaction::hasHeaderValue(std::string_view headerKey) const {
+   return m_headers.has(headerKey) || (nullptr != m_parser.find(headerKey));
 }
 
 //******************************************************************************
 
-const std::string& HttpTransaction::getHeaderValue(const std::string& headerKey) const {
-   string lowerHeaderKey = headerKey;
-   StrUtils::toLowerCase(lowerHeaderKey);
+std::string_view HttpTransaction::getHeaderValue(std::string_view headerKey) const {
+   // a value set locally overrides what was received
+   const std::pmr::string* value = m_headers.find(headerKey);
+   if (nullptr != value) {
+      return *value;
+   }
 
-   if (m_headers.hasKey(lowerHeaderKey)) {
-      return m_headers.getValue(lowerHeaderKey);
+   const HttpHeaderField* field = m_parser.find(headerKey);
+   if (nullptr != field) {
+      return field->value;
    }
 
-   throw InvalidKeyException(headerKey);
+   throw InvalidKeyException(std::string(headerKey));
 }
 
 //******************************************************************************
 
 void HttpTransaction::setHeaderValue(const std::string& key,
                                      const std::string& value) {
-   std::string lowerHeaderKey = key;
-   StrUtils::toLowerCase(lowerHeaderKey);
-   m_headers.addPair(lowerHeaderKey, value);
+   m_headers.set(key, value);
 }
 
 //******************************************************************************
 
 void HttpTransaction::getHeaderKeys(std::vector<std::string>& vecHeaderKeys) const {
-   m_headers.getKeys(vecHeaderKeys);
+   for (const HttpHeaders::Entry& entry : m_headers) {
+      string lowerHeaderKey(entry.name);
+      StrUtils::toLowerCase(lowerHeaderKey);
+      vecHeaderKeys.push_back(lowerHeaderKey);
+   }
+
+   for (const HttpHeaderField& field : m_parser.getFields()) {
+      if (m_headers.has(field.name)) {
+         continue;
+      }
+
+      string lowerHeaderKey(field.name);
+      StrUtils::toLowerCase(lowerHeaderKey);
+
+      if (std::find(vecHeaderKeys.begin(), vecHeaderKeys.end(), lowerHeaderKey) ==
+          vecHeaderKeys.end()) {
+         vecHeaderKeys.push_back(lowerHeaderKey);
+      }
+   }
 }
 
 //******************************************************************************
 
-const std::string& HttpTransaction::getProtocol() const {
-   return m_protocol;
+std::string_view HttpTransaction::getProtocol() const {
+   if (!m_protocol.empty()) {
+      return m_protocol;
+   }
+
+   // request line: METHOD PATH PROTOCOL
+   return m_parser.getFirstLineToken(2);
 }
 
 //******************************************************************************
 
-const std::string& HttpTransaction::getRequestMethod() const {
-   return m_method;
+std::string_view HttpTransaction::getRequestMethod() const {
+   return m_parser.getFirstLineToken(0);
 }
 
 //******************************************************************************
 
-const std::string& HttpTransaction::getRequestPath() const {
-   return m_vecRequestLineValues[1];
+std::string_view HttpTransaction::getRequestPath() const {
+   return m_parser.getFirstLineToken(1);
 }
 
 //******************************************************************************
@@ -236,35 +341,50 @@ void HttpTransaction::setProtocol(const std::string& protocol) {
 
 //******************************************************************************
 
-const std::vector<std::string>& HttpTransaction::getRequestLineValues() const {
-   return m_vecRequestLineValues;
+const HttpHeaderParser& HttpTransaction::getHeaderParser() const {
+   return m_parser;
 }
 
 //******************************************************************************
 
-void HttpTransaction::setRequestLineValues(const std::vector<std::string>& requestLineValues) {
-   m_vecRequestLineValues = requestLineValues;
+std::string_view HttpTransaction::getFirstHeaderLine() const {
+   return m_parser.getFirstLine();
 }
 
 //******************************************************************************
 
-const std::string& HttpTransaction::getFirstHeaderLine() const {
-   return m_firstHeaderLine;
+void HttpTransaction::populateWithHeaders(KeyValuePairs& headers) {
+   std::vector<std::string> keys;
+   getHeaderKeys(keys);
+
+   for (const auto& key : keys) {
+      headers.addPair(key, string(getHeaderValue(key)));
+   }
 }
 
 //******************************************************************************
 
-void HttpTransaction::populateWithHeaders(KeyValuePairs& headers) {
-   std::vector<std::string> keys;
-   m_headers.getKeys(keys);
+void HttpTransaction::populateWithHeaders(HttpHeaders& headers) const {
+   // received headers first, so any set locally replace them
+   for (const HttpHeaderField& field : m_parser.getFields()) {
+      if (!m_headers.has(field.name)) {
+         headers.set(field.name, field.value);
+      }
+   }
 
-   for (const auto& key : keys) {
-      headers.addPair(key, m_headers.getValue(key));
+   for (const HttpHeaders::Entry& entry : m_headers) {
+      headers.set(entry.name, entry.value);
    }
 }
 
 //******************************************************************************
 
+const HttpHeaders& HttpTransaction::getHeaders() const {
+   return m_headers;
+}
+
+//******************************************************************************
+
 void HttpTransaction::close() {
    if (m_connection != nullptr) {
       m_connection->close();
@@ -301,166 +421,101 @@ ByteConnection* HttpTransaction::getConnection() {
 //*****************************************************************************
 
 void HttpTransaction::addHeader(const std::string& key, const std::string& value) {
-   m_headers.addPair(key, value);
+   m_headers.set(key, value);
 }
 
 //*****************************************************************************
 
 bool HttpTransaction::hasHeader(const std::string& key) const {
-   return m_headers.hasKey(key);
+   return m_headers.has(key);
 }
 
 //*****************************************************************************
 
 int HttpTransaction::getContentLength() const {
-   if (hasHeader("content-length")) {
-      const string& lengthAsText = m_headers.getValue("content-length");
-      return StrUtils::parseInt(lengthAsText);
-   } else {
+   const std::pmr::string* lengthAsText = m_headers.find(HttpHeaders::CONTENT_LENGTH);
+   if (nullptr != lengthAsText) {
+      return StrUtils::parseInt(std::string(*lengthAsText));
+   }
+
+   const long contentLength = m_parser.getContentLength();
+   if ((contentLength < 0) || (contentLength > INT_MAX)) {
       return -1;
    }
+
+   return (int) contentLength;
 }
 
 //*****************************************************************************
 
 bool HttpTransaction::streamFromConnection() {
-   int contentLength = -1;  // unknown
-   int bytes_read;
    ByteConnection* c = getConnection();
 
    if (nullptr == c) {
       return false;
    }
 
-   static const std::string HEADER_TERMINATOR = "\r\n\r\n";
-
-   // read in chunks rather than one byte per read() call, scanning the
-   // accumulated buffer for the blank line that ends the headers; any
-   // bytes read past that point are the start of the body (or the start
-   // of the *next* transaction on this connection) and are handed to the
-   // body-reading loop below, or preserved via setUnconsumedBytes() at
-   // the end, instead of being re-read from the connection
+   // read straight into m_header, which becomes the one buffer every
+   // parsed view (request line tokens, header names and values) points
+   // into. The parser remembers how far it has scanned for the blank line
+   // that ends the headers, so each read only scans the new bytes.
    //
    // seeded with whatever a previous transaction on this connection
    // over-read and handed off via takeUnconsumedBytes() - this may
    // already contain this entire request/response (and then some), in
-   // which case the terminator check below finds it before a single new
-   // read() call is made
-   std::string buffered = takeUnconsumedBytes();
-   std::string headers;
-   bool foundHeaderEnd = false;
-   char chunk[8192];
-
-   std::string::size_type posTerminator = buffered.find(HEADER_TERMINATOR);
-   if (posTerminator != std::string::npos) {
-      headers = buffered.substr(0, posTerminator);
-      buffered.erase(0, posTerminator + HEADER_TERMINATOR.length());
-      foundHeaderEnd = true;
+   // which case it's parsed before a single new read() call is made.
+   // Otherwise, start from the connection arena's spare read buffer.
+   m_header = takeUnconsumedBytes();
+   if (m_header.empty() && (m_arena != nullptr)) {
+      m_header = m_arena->takeReadBuffer();
    }
+   m_parser.reset();
 
-   while (!foundHeaderEnd) {
-      bytes_read = c->read(chunk, sizeof(chunk));
-
-      if (bytes_read <= 0) {
+   while (!m_parser.parse(m_header.data(), m_header.size())) {
+      const std::size_t used = m_header.size();
+      if (used > HttpHeaderParser::MAX_HEADER_LENGTH) {
          return false;
       }
 
-      buffered.append(chunk, bytes_read);
+      m_header.resize(used + READ_CHUNK_SIZE);
+      const int bytesRead = c->read(&m_header[used], READ_CHUNK_SIZE);
 
-      posTerminator = buffered.find(HEADER_TERMINATOR);
-      if (posTerminator != std::string::npos) {
-         headers = buffered.substr(0, posTerminator);
-         buffered.erase(0, posTerminator + HEADER_TERMINATOR.length());
-         foundHeaderEnd = true;
+      if (bytesRead <= 0) {
+         m_header.resize(used);
+         return false;
       }
-   }
 
-   int lineIndex = 0;
-   std::vector<std::string> vecHeaders = StrUtils::split(headers, "\r\n");
-   for (const std::string& token : vecHeaders) {
-      if (lineIndex == 0) {
-         m_firstHeaderLine = token;
-
-         // populate the first-line-derived fields (method/protocol and the
-         // raw 3-token breakdown) the same way parseHeaders() does, since
-         // that method is never actually invoked on this code path
-         std::vector<std::string> vecTokens = StrUtils::split(m_firstHeaderLine, " ");
-         const std::size_t tokenCount = vecTokens.size();
-
-         if (3 <= tokenCount) {
-            m_vecRequestLineValues.clear();
-            m_vecRequestLineValues.reserve(3);
-            string thirdValue;
-
-            for (std::size_t i = 0; i < tokenCount; ++i) {
-               if (i > 1) {
-                  if (i > 2) {
-                     thirdValue += " ";
-                  }
-                  thirdValue += vecTokens[i];
-               } else {
-                  m_vecRequestLineValues.push_back(vecTokens[i]);
-               }
-            }
-
-            m_vecRequestLineValues.push_back(thirdValue);
-            m_method = m_vecRequestLineValues[0];
-            m_protocol = thirdValue;
-         }
-      }
-      if (!token.empty()) {
-         string::size_type posColon = token.find(":");
-         if (posColon != string::npos) {
-            string key = StrUtils::strip(token.substr(0, posColon));
-            string value = StrUtils::strip(token.substr(posColon+1, token.length() - 1
-));
-            if (!key.empty() && !value.empty()) {
-               StrUtils::toLowerCase(key);
-               addHeader(key, value);
-            }
-         }
-      }
-      lineIndex++;
+      m_header.resize(used + bytesRead);
    }
 
-   contentLength = getContentLength();
-
-   if (contentLength > 0) {
-      ByteBuffer* bb = new ByteBuffer(contentLength);
-      int offset = 0;
-
-      // serve whatever was already read past the header terminator first
-      if (!buffered.empty()) {
-         const int fromBuffer = std::min((int) buffered.size(), contentLength);
-         memcpy(bb->data(), buffered.data(), fromBuffer);
-         offset = fromBuffer;
-         buffered.erase(0, fromBuffer);
-      }
-
-      int remainingBytes = contentLength - offset;
-      int bytesToRead = 8192;
-      char buffer[8192];
-      while (remainingBytes > 0) {
-         if (remainingBytes < bytesToRead) {
-            bytesToRead = remainingBytes;
-         }
-         bytes_read = c->read(buffer, bytesToRead);
-         if (bytes_read > 0) {
-            memcpy((void*) (bb->data()+offset), buffer, bytes_read);
-            offset += bytes_read;
-            remainingBytes -= bytes_read;
-         } else {
-            delete bb;
-            return false;
-         }
-      }
-      setBody(bb);
+   // from here on m_header may only shrink - growing it could reallocate
+   // out from under the parsed views
+   const std::size_t headerLength = m_parser.getHeaderLength();
+   const char* extra = m_header.data() + headerLength;
+   std::size_t extraLength = m_header.size() - headerLength;
+
+   // the body isn't read here - whoever consumes it decides whether to
+   // read it into memory (see bufferBody()) or a piece at a time, and the
+   // reader starts with whatever was already read past the headers. Any
+   // bytes past the end of the body are handed back by the reader once
+   // it gets there.
+   // (a missing Content-Length is -1, which must not be taken for
+   // HttpBodyReader::CHUNKED)
+   const bool isChunked = m_parser.isChunked();
+   const long contentLength = isChunked ?
+      HttpBodyReader::CHUNKED : m_parser.getContentLength();
+
+   if (isChunked || (contentLength > 0)) {
+      m_bodyReader.reset(new HttpBodyReader(c,
+                                            contentLength,
+                                            std::string(extra, extraLength)));
+   } else if (extraLength > 0) {
+      // whatever remains belongs to the next transaction on this
+      // connection
+      m_unconsumedBytes.assign(extra, extraLength);
    }
 
-   // whatever remains in buffered - whether there was no body at all, or
-   // buffered held more than this transaction's body - belongs to the
-   // next transaction on this connection
-   setUnconsumedBytes(buffered);
+   m_header.resize(headerLength);
    return true;
 }
 
@@ -481,11 +536,23 @@ void HttpTransaction::setConnectionOwned(bool connectionOwned) {
 std::string HttpTransaction::takeUnconsumedBytes() {
    std::string bytes;
    bytes.swap(m_unconsumedBytes);
+
+   // what follows the body is only known once it has been read
+   if (bytes.empty() && (m_bodyReader != nullptr)) {
+      bytes = m_bodyReader->takeUnconsumedBytes();
+   }
+
    return bytes;
 }
 
 //*****************************************************************************
 
+std::pmr::memory_resource* HttpTransaction::getMemoryResource() const {
+   return m_resource;
+}
+
+//*****************************************************************************
+
 void HttpTransaction::setUnconsumedBytes(const std::string& bytes) {
    m_unconsumedBytes = bytes;
 }
@@ -5,12 +5,18 @@
 #define MISERE_HTTPTRANSACTION_H
 
 #include <memory>
+#include <memory_resource>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "KeyValuePairs.h"
 #include "ByteConnection.h"
 #include "ByteBuffer.h"
+#include "HttpHeaderParser.h"
+#include "HttpHeaders.h"
+#include "HttpConnectionArena.h"
+#include "HttpBodyReader.h"
 
 
 namespace misere
@@ -33,8 +39,21 @@ class HttpTransaction
        *        start of this request/response, over-read along with the
        *        end of the previous one on the same persistent connection.
        *        See takeUnconsumedBytes().
+       * @param arena the arena of the connection, if any, that request-
+       *        scoped allocations and the header read buffer come from.
+       *        Must outlive the transaction (and must not be reset before
+       *        the transaction is destroyed).
        */
-      HttpTransaction(ByteConnection* connection=nullptr, bool connectionOwned=true, std::string leadingBytes=std::string());
+      HttpTransaction(ByteConnection* connection=nullptr, bool connectionOwned=true, std::string leadingBytes=std::string(), HttpConnectionArena* arena=nullptr);
+
+      /**
+       * Constructs a transaction without a connection (e.g., a response
+       * being built) whose headers allocate from a memory resource
+       * @param resource the memory resource - typically the request's
+       *        (see getMemoryResource()), and it must outlive the
+       *        transaction
+       */
+      explicit HttpTransaction(std::pmr::memory_resource* resource);
 
       /**
        * Copy constructor
@@ -55,7 +74,9 @@ class HttpTransaction
       HttpTransaction& operator=(const HttpTransaction& copy);
 
       /**
-       * Retrieves the full set of HTTP headers as a single string
+       * Retrieves the full set of HTTP headers as a single string. Header
+       * names/values and request line tokens handed out by this class are
+       * views into this buffer, valid for the life of the transaction.
        * @return HTTP headers (unparsed)
        */
       const std::string& getRawHeader() const;
@@ -79,23 +100,86 @@ class HttpTransaction
        */
       void setBody(chaudiere::ByteBuffer* body);
 
+      /**
+       * Retrieves the reader for the body that followed the headers read
+       * from the connection. Reading from it pulls the body from the
+       * connection as needed, so a body of any size is handled in bounded
+       * memory. Once bufferBody() has read it into getBody(), the reader
+       * has nothing left to give.
+       * @return the body reader, or nullptr if there is no body
+       */
+      HttpBodyReader* getBodyReader() const;
+
+      /**
+       * Reads the whole body from the body reader into getBody()
+       * @param maxSize the largest body (in bytes) that may be read into
+       *        memory
+       * @return boolean indicating whether the body (if any) was read.
+       *         False if it's larger than maxSize - in which case no more
+       *         of it than maxSize was read - or if the body reader
+       *         failed (see HttpBodyReader::hasFailed()).
+       */
+      bool bufferBody(long maxSize);
+
+      /**
+       * Checks the body against a size limit without reading any of it,
+       * for a handler that reads the body itself from a connection that
+       * has already read all of the request it ever will
+       * @param maxSize the largest body (in bytes) accepted
+       * @return boolean indicating whether the body (if any) is no larger
+       *         than maxSize and is already buffered in full
+       * @see ByteConnection::buffersWholeRequests()
+       */
+      bool hasBufferedBodyWithin(long maxSize) const;
+
+      /**
+       * Determines if the body hasn't been read to its end yet
+       * @return boolean indicating if body bytes remain to be read
+       */
+      bool hasPendingBody() const;
+
+      /**
+       * Determines if the headers leave the body's length in doubt (see
+       * HttpHeaderParser::hasInvalidFraming())
+       * @return boolean indicating if the body's framing is invalid
+       */
+      bool hasInvalidFraming() const;
+
+      /**
+       * Determines if the peer on the other end of the connection is on
+       * this host - its address is a loopback one (127.0.0.0/8 or ::1)
+       * @return boolean indicating if the peer connected over loopback
+       *         (false if there's no socket to ask)
+       */
+      bool isFromLoopback() const;
+
+      /**
+       * Reads and discards whatever remains of the body, so the
+       * bytes that follow it (see takeUnconsumedBytes()) are known
+       * @return boolean indicating whether the body ended cleanly (false
+       *         if it was malformed or the connection closed early)
+       */
+      bool finishBody();
+
       /**
        * Determines if the specified header key exists
        * @param headerKey the key being tested for existence in HTTP headers
+       *        (case-insensitive)
        * @return boolean indicating if the specified key exists
        */
-      bool hasHeaderValue(const std::string& headerKey) const;
+      bool hasHeaderValue(std::string_view headerKey) const;
 
       /**
        * Retrieves the header value associated with the specified key
        * @param headerKey the HTTP header key whose value is being retrieved
+       *        (case-insensitive)
        * @throw InvalidKeyException
        * @return the header value associated with the specified key
        */
-      const std::string& getHeaderValue(const std::string& headerKey) const;
+      std::string_view getHeaderValue(std::string_view headerKey) const;
 
       /**
-       * Retrieves the keys of all the HTTP header key/value pairs
+       * Retrieves the keys (lowercased) of all the HTTP header key/value pairs
        * @param headerKeys list that will be populated with HTTP header keys
        */
       void getHeaderKeys(std::vector<std::string>& headerKeys) const;
@@ -111,25 +195,25 @@ class HttpTransaction
        * Retrieves the protocol (e.g., "HTTP/1.1") of the request
        * @return the protocol
        */
-      const std::string& getProtocol() const;
+      std::string_view getProtocol() const;
 
       /**
        * Retrieves the HTTP method (e.g., "GET" or "POST")
        * @return the HTTP method for the request
        */
-      const std::string& getRequestMethod() const;
+      std::string_view getRequestMethod() const;
 
       /**
        * Retrieves the path for the HTTP request
        * @return the HTTP request path
        */
-      const std::string& getRequestPath() const;
+      std::string_view getRequestPath() const;
 
       /**
        * Returns the first line (request line) of the HTTP request or response
        * @return the request line
        */
-      const std::string& getFirstHeaderLine() const;
+      std::string_view getFirstHeaderLine() const;
 
       /**
        * Retrieves the HTTP header key/value pairs
@@ -137,6 +221,20 @@ class HttpTransaction
        */
       void populateWithHeaders(chaudiere::KeyValuePairs& headers);
 
+      /**
+       * Adds (or replaces) this transaction's headers in the specified
+       * collection - locally set headers plus any received ones they
+       * don't override
+       * @param headers the header collection to populate
+       */
+      void populateWithHeaders(HttpHeaders& headers) const;
+
+      /**
+       * Retrieves the headers set locally (not the ones received)
+       * @return the locally set headers
+       */
+      const HttpHeaders& getHeaders() const;
+
       void close();
 
       void setConnectionOwned(bool connectionOwned);
@@ -151,19 +249,28 @@ class HttpTransaction
        * one). Intended to be passed as the leadingBytes constructor
        * argument of the next HttpTransaction constructed against the
        * same connection; see HttpRequestHandler::run() for the intended
-       * usage pattern. Empty if nothing was left over.
+       * usage pattern. Empty if nothing was left over, or if the body
+       * hasn't been read to its end (see finishBody()).
        * @return the unconsumed bytes
        */
       std::string takeUnconsumedBytes();
 
-   protected:
       /**
-       * Retrieves the parsed values/tokens of the request line (the first line)
-       * @return list of parsed tokens on request line
+       * Retrieves the memory resource for allocations that live no longer
+       * than this transaction
+       * @return the connection arena's resource (or the resource the
+       *         transaction was constructed with), or the default
+       *         resource
        */
-      const std::vector<std::string>& getRequestLineValues() const;
+      std::pmr::memory_resource* getMemoryResource() const;
 
-      void setRequestLineValues(const std::vector<std::string>& requestLineValues);
+   protected:
+      /**
+       * Retrieves the parser holding the start line tokens and header
+       * fields read by streamFromConnection()
+       * @return the header parser
+       */
+      const HttpHeaderParser& getHeaderParser() const;
 
       /**
        * Sets the protocol (e.g., "HTTP/1.1")
@@ -171,12 +278,6 @@ class HttpTransaction
        */
       void setProtocol(const std::string& protocol);
 
-      /**
-       * Parse the HTTP headers
-       * @return boolean indicating whether the headers were successfully parsed
-       */
-      bool parseHeaders();
-
       void setConnection(ByteConnection* c, bool connectionOwned);
       ByteConnection* takeConnection();
       ByteConnection* getConnection();
@@ -197,18 +298,17 @@ class HttpTransaction
       void setUnconsumedBytes(const std::string& bytes);
 
    private:
-      std::vector<std::string> m_vecHeaderLines;
-      std::vector<std::string> m_vecRequestLineValues;
       std::string m_header;
+      HttpHeaderParser m_parser;
       std::unique_ptr<chaudiere::ByteBuffer> m_body;
+      std::unique_ptr<HttpBodyReader> m_bodyReader;
       std::string m_protocol;
-      std::string m_firstHeaderLine;
-      chaudiere::KeyValuePairs m_headers;
-      std::string m_method;
-      int m_contentLength;
+      HttpHeaders m_headers;  // set locally
       ByteConnection* m_connection;
       bool m_connectionOwned;
       std::string m_unconsumedBytes;
+      HttpConnectionArena* m_arena;
+      std::pmr::memory_resource* m_resource;
 
 };
 
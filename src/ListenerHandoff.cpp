@@ -0,0 +1,273 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+
+#include "ListenerHandoff.h"
+#include "Logger.h"
+
+using namespace misere;
+using namespace chaudiere;
+
+// neither side waits on the other for longer than this
+static const int HANDOFF_TIMEOUT_SECS = 5;
+
+static const char HANDOFF_MESSAGE = 'L';
+static const char HANDOFF_ACK     = 'A';
+
+namespace {
+
+bool makeAddress(const std::string& path, struct sockaddr_un& address) {
+   ::memset(&address, 0, sizeof(address));
+   if (path.empty() || (path.size() >= sizeof(address.sun_path))) {
+      LOG_ERROR("invalid handoff socket path: " + path)
+      return false;
+   }
+
+   address.sun_family = AF_UNIX;
+   ::memcpy(address.sun_path, path.data(), path.size());
+   return true;
+}
+
+void setTimeouts(int fd) {
+   struct timeval timeout;
+   timeout.tv_sec = HANDOFF_TIMEOUT_SECS;
+   timeout.tv_usec = 0;
+   ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+   ::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+}
+
+}
+
+//******************************************************************************
+
+int ListenerHandoff::receiveListener(const std::string& path) {
+   struct sockaddr_un address;
+   if (!makeAddress(path, address)) {
+      return -1;
+   }
+
+   const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+   if (fd < 0) {
+      return -1;
+   }
+
+   setTimeouts(fd);
+
+   if (::connect(fd, (struct sockaddr*) &address, sizeof(address)) < 0) {
+      // nothing is offered there - the usual case, on a first start
+      ::close(fd);
+      return -1;
+   }
+
+   char message = 0;
+   struct iovec iov;
+   iov.iov_base = &message;
+   iov.iov_len = 1;
+
+   union {
+      struct cmsghdr header;
+      char buffer[CMSG_SPACE(sizeof(int))];
+   } control;
+
+   struct msghdr msg;
+   ::memset(&msg, 0, sizeof(msg));
+   msg.msg_iov = &iov;
+   msg.msg_iovlen = 1;
+   msg.msg_control = control.buffer;
+   msg.msg_controllen = sizeof(control.buffer);
+
+   ssize_t bytesRead;
+   do {
+      bytesRead = ::recvmsg(fd, &msg, 0);
+   } while ((bytesRead < 0) && (errno == EINTR));
+
+   int listenerFD = -1;
+
+   if ((bytesRead == 1) && (message == HANDOFF_MESSAGE)) {
+      struct cmsghdr* header = CMSG_FIRSTHDR(&msg);
+      if ((header != nullptr) &&
+          (header->cmsg_level == SOL_SOCKET) &&
+          (header->cmsg_type == SCM_RIGHTS) &&
+          (header->cmsg_len == CMSG_LEN(sizeof(int)))) {
+         ::memcpy(&listenerFD, CMSG_DATA(header), sizeof(int));
+      }
+   }
+
+   if (listenerFD > -1) {
+      ::fcntl(listenerFD, F_SETFD, FD_CLOEXEC);
+
+      int isListening = 0;
+      socklen_t length = sizeof(isListening);
+      if ((::getsockopt(listenerFD, SOL_SOCKET, SO_ACCEPTCONN,
+                        &isListening, &length) < 0) || !isListening) {
+         ::close(listenerFD);
+         listenerFD = -1;
+      }
+   }
+
+   // the other process only stops accepting once it knows the socket
+   // arrived
+   if ((listenerFD > -1) && (::write(fd, &HANDOFF_ACK, 1) != 1)) {
+      ::close(listenerFD);
+      listenerFD = -1;
+   }
+
+   if (listenerFD < 0) {
+      LOG_ERROR("unable to take over the listening socket offered on " + path)
+   }
+
+   ::close(fd);
+   return listenerFD;
+}
+
+//******************************************************************************
+
+ListenerHandoff::ListenerHandoff() :
+   m_fd(-1),
+   m_device(0),
+   m_inode(0) {
+}
+
+//******************************************************************************
+
+ListenerHandoff::~ListenerHandoff() {
+   close();
+}
+
+//******************************************************************************
+
+bool ListenerHandoff::offer(const std::string& path) {
+   close();
+
+   struct sockaddr_un address;
+   if (!makeAddress(path, address)) {
+      return false;
+   }
+
+   m_fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+   if (m_fd < 0) {
+      LOG_ERROR("unable to create handoff socket: " +
+                std::string(::strerror(errno)))
+      return false;
+   }
+
+   ::fcntl(m_fd, F_SETFD, FD_CLOEXEC);
+   ::fcntl(m_fd, F_SETFL, ::fcntl(m_fd, F_GETFL, 0) | O_NONBLOCK);
+
+   // the socket file of the process this one took over from (if any) is
+   // replaced; only the owner may connect to the new one
+   ::unlink(path.c_str());
+   const mode_t previousMask = ::umask(0077);
+   const int rc = ::bind(m_fd, (struct sockaddr*) &address, sizeof(address));
+   ::umask(previousMask);
+
+   struct stat info;
+   if ((rc < 0) ||
+       (::listen(m_fd, 1) < 0) ||
+       (::stat(path.c_str(), &info) < 0)) {
+      LOG_ERROR("unable to listen on handoff socket " + path + ": " +
+                std::string(::strerror(errno)))
+      ::close(m_fd);
+      m_fd = -1;
+      return false;
+   }
+
+   m_path = path;
+   m_device = info.st_dev;
+   m_inode = info.st_ino;
+
+   return true;
+}
+
+//******************************************************************************
+
+int ListenerHandoff::getFileDescriptor() const {
+   return m_fd;
+}
+
+//******************************************************************************
+
+bool ListenerHandoff::handOver(int listenerFD) {
+   if ((m_fd < 0) || (listenerFD < 0)) {
+      return false;
+   }
+
+   const int peer = ::accept(m_fd, nullptr, nullptr);
+   if (peer < 0) {
+      return false;
+   }
+
+   // accepted sockets inherit O_NONBLOCK on some platforms - the
+   // exchange below blocks, for no longer than the timeouts
+   ::fcntl(peer, F_SETFL, ::fcntl(peer, F_GETFL, 0) & ~O_NONBLOCK);
+   setTimeouts(peer);
+
+   char message = HANDOFF_MESSAGE;
+   struct iovec iov;
+   iov.iov_base = &message;
+   iov.iov_len = 1;
+
+   union {
+      struct cmsghdr header;
+      char buffer[CMSG_SPACE(sizeof(int))];
+   } control;
+   ::memset(&control, 0, sizeof(control));
+
+   struct msghdr msg;
+   ::memset(&msg, 0, sizeof(msg));
+   msg.msg_iov = &iov;
+   msg.msg_iovlen = 1;
+   msg.msg_control = control.buffer;
+   msg.msg_controllen = sizeof(control.buffer);
+
+   struct cmsghdr* header = CMSG_FIRSTHDR(&msg);
+   header->cmsg_level = SOL_SOCKET;
+   header->cmsg_type = SCM_RIGHTS;
+   header->cmsg_len = CMSG_LEN(sizeof(int));
+   ::memcpy(CMSG_DATA(header), &listenerFD, sizeof(int));
+
+   bool isHandedOver = (::sendmsg(peer, &msg, 0) == 1);
+
+   if (isHandedOver) {
+      char ack = 0;
+      isHandedOver = (::read(peer, &ack, 1) == 1) && (ack == HANDOFF_ACK);
+   }
+
+   ::close(peer);
+
+   if (!isHandedOver) {
+      LOG_ERROR("listening socket handoff failed, still accepting")
+   }
+
+   return isHandedOver;
+}
+
+//******************************************************************************
+
+void ListenerHandoff::close() {
+   if (m_fd < 0) {
+      return;
+   }
+
+   ::close(m_fd);
+   m_fd = -1;
+
+   // the process that took over may already have put its own socket
+   // file at the path
+   struct stat info;
+   if ((::stat(m_path.c_str(), &info) == 0) &&
+       (info.st_dev == m_device) &&
+       (info.st_ino == m_inode)) {
+      ::unlink(m_path.c_str());
+   }
+}
+
+//******************************************************************************
@@ -0,0 +1,88 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef MISERE_LISTENERHANDOFF_H
+#define MISERE_LISTENERHANDOFF_H
+
+#include <string>
+
+#include <sys/types.h>
+
+namespace misere
+{
+
+/**
+ * ListenerHandoff passes a listening socket from a running server process
+ * to the one replacing it, over a Unix-domain socket (SCM_RIGHTS), so an
+ * upgrade never closes the port: the new process accepts on the very
+ * socket the old one was accepting on - connections waiting in its
+ * backlog included - while the old one drains.
+ *
+ * The running process offer()s its listener at a path; the new process
+ * calls receiveListener() on the same path during startup, and the
+ * running process answers with handOver() once the connection shows up
+ * on getFileDescriptor(). The path is created readable and writable by
+ * its owner only.
+ */
+class ListenerHandoff
+{
+   public:
+      /**
+       * Asks the process offering a listening socket at a path to hand
+       * it over
+       * @param path the Unix-domain socket path the socket is offered on
+       * @return the listening socket's file descriptor, or -1 if no
+       *         process offers one there (or the handoff failed)
+       */
+      static int receiveListener(const std::string& path);
+
+      ListenerHandoff();
+
+      /**
+       * Destructor. Stops offering, if still offering.
+       */
+      ~ListenerHandoff();
+
+      /**
+       * Starts offering a listening socket at a path, replacing the
+       * socket file of a previous process left there
+       * @param path the Unix-domain socket path to offer it on
+       * @return boolean indicating whether the path is being listened on
+       */
+      bool offer(const std::string& path);
+
+      /**
+       * Retrieves the descriptor that becomes readable when a new
+       * process asks for the listening socket
+       * @return the file descriptor, or -1 if not offering
+       */
+      int getFileDescriptor() const;
+
+      /**
+       * Hands a listening socket to the process asking for it. The
+       * caller still owns (and eventually closes) its own descriptor.
+       * @param listenerFD the listening socket to hand over
+       * @return boolean indicating whether it was handed over
+       */
+      bool handOver(int listenerFD);
+
+      /**
+       * Stops offering. The socket file is removed unless another
+       * process has since replaced it with its own.
+       */
+      void close();
+
+   private:
+      std::string m_path;
+      int m_fd;
+      dev_t m_device;
+      ino_t m_inode;
+
+      // disallow copies
+      ListenerHandoff(const ListenerHandoff&);
+      ListenerHandoff& operator=(const ListenerHandoff&);
+};
+
+}
+
+#endif
@@ -0,0 +1,118 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include <string>
+
+#include "ListeningSocket.h"
+#include "Logger.h"
+#include "StrUtils.h"
+
+using namespace misere;
+using namespace chaudiere;
+
+//******************************************************************************
+
+ListeningSocket::ListeningSocket() :
+   m_fd(-1) {
+}
+
+//******************************************************************************
+
+ListeningSocket::~ListeningSocket() {
+   close();
+}
+
+//******************************************************************************
+
+bool ListeningSocket::open(int port, bool reusePort, bool nonBlocking) {
+   close();
+
+   m_fd = ::socket(AF_INET, SOCK_STREAM, 0);
+   if (m_fd < 0) {
+      LOG_CRITICAL("unable to create listening socket: " +
+                   std::string(::strerror(errno)))
+      return false;
+   }
+
+   ::fcntl(m_fd, F_SETFD, FD_CLOEXEC);
+
+   if (nonBlocking) {
+      ::fcntl(m_fd, F_SETFL, ::fcntl(m_fd, F_GETFL, 0) | O_NONBLOCK);
+   }
+
+   int enable = 1;
+   ::setsockopt(m_fd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+
+   if (reusePort) {
+#if defined(SO_REUSEPORT)
+      if (::setsockopt(m_fd, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable)) < 0) {
+         LOG_CRITICAL("unable to set SO_REUSEPORT on listening socket: " +
+                      std::string(::strerror(errno)))
+         close();
+         return false;
+      }
+#else
+      LOG_CRITICAL("SO_REUSEPORT is not supported on this platform")
+      close();
+      return false;
+#endif
+   }
+
+   struct sockaddr_in address;
+   ::memset(&address, 0, sizeof(address));
+   address.sin_family = AF_INET;
+   address.sin_addr.s_addr = htonl(INADDR_ANY);
+   address.sin_port = htons((unsigned short) port);
+
+   if (::bind(m_fd, (struct sockaddr*) &address, sizeof(address)) < 0) {
+      LOG_CRITICAL("unable to bind port " + StrUtils::toString(port) + ": " +
+                   std::string(::strerror(errno)))
+      close();
+      return false;
+   }
+
+   if (::listen(m_fd, SOMAXCONN) < 0) {
+      LOG_CRITICAL("unable to listen on port " + StrUtils::toString(port) + ": " +
+                   std::string(::strerror(errno)))
+      close();
+      return false;
+   }
+
+   return true;
+}
+
+//******************************************************************************
+
+void ListeningSocket::adopt(int fd, bool nonBlocking) {
+   close();
+   m_fd = fd;
+
+   ::fcntl(m_fd, F_SETFD, FD_CLOEXEC);
+
+   const int flags = ::fcntl(m_fd, F_GETFL, 0);
+   ::fcntl(m_fd, F_SETFL, nonBlocking ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK));
+}
+
+//******************************************************************************
+
+void ListeningSocket::close() {
+   if (m_fd > -1) {
+      ::close(m_fd);
+      m_fd = -1;
+   }
+}
+
+//******************************************************************************
+
+int ListeningSocket::getFileDescriptor() const {
+   return m_fd;
+}
+
+//******************************************************************************
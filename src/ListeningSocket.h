@@ -0,0 +1,68 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef MISERE_LISTENINGSOCKET_H
+#define MISERE_LISTENINGSOCKET_H
+
+namespace misere
+{
+
+/**
+ * ListeningSocket is a bare listening TCP socket (any local address) for
+ * the server modes that need control over socket options that
+ * chaudiere's ServerSocket doesn't expose - non-blocking accepts for
+ * the event loop, SO_REUSEPORT for per-reactor listeners - and the
+ * listening descriptor itself, to hand to another process (see
+ * ListenerHandoff).
+ */
+class ListeningSocket
+{
+   public:
+      ListeningSocket();
+
+      /**
+       * Destructor. Closes the socket if it's still open.
+       */
+      ~ListeningSocket();
+
+      /**
+       * Creates, binds and starts listening on the socket
+       * @param port the port number to listen on
+       * @param reusePort whether to set SO_REUSEPORT, so that several
+       *        sockets (one per reactor) can listen on the same port and
+       *        have the kernel balance incoming connections across them
+       * @param nonBlocking whether the socket should be non-blocking
+       * @return boolean indicating whether the socket is listening
+       */
+      bool open(int port, bool reusePort, bool nonBlocking);
+
+      /**
+       * Takes ownership of a socket that is already listening (e.g., one
+       * handed over by the server process this one replaces)
+       * @param fd the listening socket's file descriptor
+       * @param nonBlocking whether the socket should be non-blocking
+       */
+      void adopt(int fd, bool nonBlocking);
+
+      /**
+       * Closes the socket
+       */
+      void close();
+
+      /**
+       * Retrieves the socket's file descriptor
+       * @return the file descriptor, or -1 if not open
+       */
+      int getFileDescriptor() const;
+
+   private:
+      int m_fd;
+
+      // disallow copies
+      ListeningSocket(const ListeningSocket&);
+      ListeningSocket& operator=(const ListeningSocket&);
+};
+
+}
+
+#endif
@@ -0,0 +1,122 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include "PipelinedConnection.h"
+
+using namespace misere;
+
+// held responses plus the segments of the response that releases them
+static const std::size_t MAX_SEGMENTS = 16;
+
+//******************************************************************************
+
+PipelinedConnection::PipelinedConnection(ByteConnection& connection) :
+   m_connection(connection),
+   m_isHolding(false) {
+}
+
+//******************************************************************************
+
+PipelinedConnection::~PipelinedConnection() {
+   flush();
+}
+
+//******************************************************************************
+
+int PipelinedConnection::read(char* buffer, int bufferSize) {
+   return m_connection.read(buffer, bufferSize);
+}
+
+//******************************************************************************
+
+bool PipelinedConnection::write(const char* buffer, std::size_t length) {
+   const Segment segment = { buffer, length };
+   return writev(&segment, 1);
+}
+
+//******************************************************************************
+
+bool PipelinedConnection::writev(const Segment* segments, std::size_t count) {
+   if (m_isHolding) {
+      for (std::size_t i = 0; i < count; ++i) {
+         m_held.append(segments[i].data, segments[i].length);
+      }
+
+      if (m_held.size() > MAX_HELD_BYTES) {
+         return flush();
+      }
+      return true;
+   }
+
+   if (m_held.empty()) {
+      return m_connection.writev(segments, count);
+   }
+
+   if (count >= MAX_SEGMENTS) {
+      return flush() && m_connection.writev(segments, count);
+   }
+
+   // everything held goes out ahead of this response, in the same write
+   Segment all[MAX_SEGMENTS];
+   all[0] = { m_held.data(), m_held.size() };
+   for (std::size_t i = 0; i < count; ++i) {
+      all[i + 1] = segments[i];
+   }
+
+   const bool written = m_connection.writev(all, count + 1);
+   m_held.clear();
+   return written;
+}
+
+//******************************************************************************
+
+bool PipelinedConnection::sendFile(int fd, off_t offset, std::size_t length) {
+   // a file isn't held - whatever is goes out ahead of it
+   return flush() && m_connection.sendFile(fd, offset, length);
+}
+
+//******************************************************************************
+
+int PipelinedConnection::getSocketDescriptor() const {
+   return m_connection.getSocketDescriptor();
+}
+
+//******************************************************************************
+
+void PipelinedConnection::close() {
+   flush();
+   m_connection.close();
+}
+
+//******************************************************************************
+
+void PipelinedConnection::setHolding(bool holding) {
+   m_isHolding = holding;
+}
+
+//******************************************************************************
+
+bool PipelinedConnection::isHolding() const {
+   return m_isHolding;
+}
+
+//******************************************************************************
+
+std::size_t PipelinedConnection::getHeldSize() const {
+   return m_held.size();
+}
+
+//******************************************************************************
+
+bool PipelinedConnection::flush() {
+   if (m_held.empty()) {
+      return true;
+   }
+
+   const bool written = m_connection.write(m_held.data(), m_held.size());
+   m_held.clear();
+   return written;
+}
+
+//******************************************************************************
+
@@ -0,0 +1,91 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef MISERE_PIPELINEDCONNECTION_H
+#define MISERE_PIPELINEDCONNECTION_H
+
+#include <cstddef>
+#include <string>
+
+#include "ByteConnection.h"
+
+namespace misere
+{
+
+/**
+ * PipelinedConnection wraps the connection of a persistent connection's
+ * request loop so the responses to pipelined requests - requests the
+ * client sent without waiting for the previous response - go out
+ * together. While holding (set when the next request is already
+ * buffered), responses are appended to a buffer instead of being
+ * written; the first response written once holding stops carries
+ * everything held with it, in order, in one vectored write.
+ *
+ * Reads and close() pass through to the wrapped connection (close()
+ * flushes first), as does sendFile(), after writing anything held. The
+ * wrapped connection isn't owned.
+ */
+class PipelinedConnection : public ByteConnection
+{
+   public:
+      /**
+       * Most response bytes held before they are written anyway, so a
+       * deep pipeline of large responses doesn't buffer without bound
+       */
+      static const std::size_t MAX_HELD_BYTES = 65536;
+
+      /**
+       * Constructs a PipelinedConnection around an existing connection
+       * @param connection the connection responses are written to
+       */
+      explicit PipelinedConnection(ByteConnection& connection);
+
+      /**
+       * Destructor. Writes any responses still held.
+       */
+      virtual ~PipelinedConnection();
+
+      virtual int read(char* buffer, int bufferSize);
+      virtual bool write(const char* buffer, std::size_t length);
+      virtual bool writev(const Segment* segments, std::size_t count);
+      virtual bool sendFile(int fd, off_t offset, std::size_t length);
+      virtual int getSocketDescriptor() const;
+      virtual void close();
+
+      /**
+       * Sets whether responses written from now on are held back
+       * @param holding true if another request is already buffered
+       */
+      void setHolding(bool holding);
+
+      /**
+       * Determines whether responses are currently being held back
+       * @return boolean indicating if responses are being held
+       */
+      bool isHolding() const;
+
+      /**
+       * Retrieves the number of response bytes held back
+       * @return number of bytes held
+       */
+      std::size_t getHeldSize() const;
+
+      /**
+       * Writes any held responses
+       * @return boolean indicating whether the write succeeded
+       */
+      bool flush();
+
+   private:
+      ByteConnection& m_connection;
+      std::string m_held;
+      bool m_isHolding;
+
+      // disallow copies
+      PipelinedConnection(const PipelinedConnection&);
+      PipelinedConnection& operator=(const PipelinedConnection&);
+};
+
+}
+
+#endif
@@ -0,0 +1,94 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include "ServerReloadHandler.h"
+#include "HTTP.h"
+#include "HttpRequest.h"
+#include "HttpResponse.h"
+#include "HttpServer.h"
+#include "Logger.h"
+
+using namespace misere;
+using namespace chaudiere;
+
+static const std::string BEARER_PREFIX = "Bearer ";
+
+static const int STATUS_FORBIDDEN = 403;
+static const int STATUS_METHOD_NOT_ALLOWED = 405;
+static const int STATUS_INTERNAL_SERVER_ERROR = 500;
+
+//******************************************************************************
+//******************************************************************************
+
+ServerReloadHandler::ServerReloadHandler(HttpServer& server,
+                                         const std::string& secret,
+                                         bool trustsLoopback) :
+   m_server(server),
+   m_secret(secret),
+   m_trustsLoopback(trustsLoopback) {
+   LOG_INSTANCE_CREATE("ServerReloadHandler")
+}
+
+//******************************************************************************
+
+ServerReloadHandler::~ServerReloadHandler() {
+   LOG_INSTANCE_DESTROY("ServerReloadHandler")
+}
+
+//******************************************************************************
+
+void ServerReloadHandler::serviceRequest(const HttpRequest& request,
+                                         HttpResponse& response) {
+   // a reload changes the server, so a GET (e.g., from a crawler or a
+   // prefetching browser) mustn't trigger one
+   if (request.getMethod() != HTTP::HTTP_METHOD_POST) {
+      response.setStatusCode(STATUS_METHOD_NOT_ALLOWED);
+      response.setHeaderValue(HTTP::HTTP_ALLOW, HTTP::HTTP_METHOD_POST);
+      return;
+   }
+
+   if (!isAuthorized(request)) {
+      LOG_WARNING("reload refused: no valid secret presented")
+      response.setStatusCode(STATUS_FORBIDDEN);
+      return;
+   }
+
+   if (m_server.reload()) {
+      response.setBody(new ByteBuffer("reloaded\n"));
+   } else {
+      response.setStatusCode(STATUS_INTERNAL_SERVER_ERROR);
+      response.setBody(new ByteBuffer("reload failed, see the error log\n"));
+   }
+}
+
+//******************************************************************************
+
+bool ServerReloadHandler::isAuthorized(const HttpRequest& request) const {
+   if (m_trustsLoopback && request.isFromLoopback()) {
+      return true;
+   }
+
+   if (m_secret.empty() || !request.hasHeaderValue(HTTP::HTTP_AUTHORIZATION)) {
+      return false;
+   }
+
+   const std::string_view credentials = request.getHeaderValue(HTTP::HTTP_AUTHORIZATION);
+   if ((credentials.size() != BEARER_PREFIX.size() + m_secret.size()) ||
+       (credentials.compare(0, BEARER_PREFIX.size(), BEARER_PREFIX) != 0)) {
+      return false;
+   }
+
+   // compared in full whatever the first mismatch, so the time taken
+   // doesn't reveal how much of a guess was right
+   const std::string_view presented = credentials.substr(BEARER_PREFIX.size());
+   unsigned char difference = 0;
+   for (std::size_t i = 0; i < m_secret.size(); ++i) {
+      difference |= (unsigned char) (presented[i] ^ m_secret[i]);
+   }
+
+   return difference == 0;
+}
+
+//******************************************************************************
+//******************************************************************************
+
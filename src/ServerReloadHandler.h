@@ -0,0 +1,59 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef MISERE_SERVERRELOADHANDLER_H
+#define MISERE_SERVERRELOADHANDLER_H
+
+#include <string>
+
+#include "AbstractHandler.h"
+
+namespace misere
+{
+   class HttpRequest;
+   class HttpResponse;
+   class HttpServer;
+
+/**
+ * ServerReloadHandler reloads the server's module handlers (see
+ * HttpServer::reload()) on a POST - registered on the configured
+ * reload_path, as an alternative to sending the process SIGHUP. A
+ * client must present the configured shared secret as
+ * "Authorization: Bearer <secret>". Clients connected over loopback may
+ * be trusted without it, but only when that's asked for - behind a local
+ * reverse proxy every client appears to come from loopback.
+ */
+class ServerReloadHandler : public AbstractHandler
+{
+public:
+   /**
+    * Constructs the handler
+    * @param server the server to reload
+    * @param secret the shared secret a client must present, or empty to
+    *        accept none
+    * @param trustsLoopback whether a client connected over loopback may
+    *        reload without the secret
+    */
+   ServerReloadHandler(HttpServer& server,
+                       const std::string& secret,
+                       bool trustsLoopback);
+   virtual ~ServerReloadHandler();
+
+   virtual void serviceRequest(const HttpRequest& request,
+                               HttpResponse& response);
+
+private:
+   bool isAuthorized(const HttpRequest& request) const;
+
+   HttpServer& m_server;
+   std::string m_secret;
+   bool m_trustsLoopback;
+
+   // disallow copies
+   ServerReloadHandler(const ServerReloadHandler&);
+   ServerReloadHandler& operator=(const ServerReloadHandler&);
+};
+
+}
+
+#endif
@@ -1,9 +1,19 @@
 // Copyright Paul Dardeau, SwampBits LLC 2014
 // BSD License
 
+#include <errno.h>
+#include <sys/uio.h>
+#if defined(__linux__)
+#include <sys/sendfile.h>
+#endif
+
 #include "SocketConnection.h"
 #include "Socket.h"
 
+// segments handed to a single writev() call; IOV_MAX is at least 16
+// everywhere and far more than a response ever needs
+static const std::size_t MAX_IOVECS = 16;
+
 using namespace misere;
 using namespace chaudiere;
 
@@ -36,6 +46,102 @@ bool SocketConnection::write(const char* buffer, std::size_t length) {
 
 //******************************************************************************
 
+bool SocketConnection::writev(const Segment* segments, std::size_t count) {
+   const int fd = m_socket->getFileDescriptor();
+   if (fd < 0) {
+      // not backed by a real descriptor (e.g. a test double) - let the
+      // socket's own write() handle each segment
+      return ByteConnection::writev(segments, count);
+   }
+
+   struct iovec iov[MAX_IOVECS];
+
+   while (count > 0) {
+      std::size_t iovCount = 0;
+      for (; (iovCount < count) && (iovCount < MAX_IOVECS); ++iovCount) {
+         iov[iovCount].iov_base = const_cast<char*>(segments[iovCount].data);
+         iov[iovCount].iov_len = segments[iovCount].length;
+      }
+
+      struct iovec* next = iov;
+      std::size_t remaining = iovCount;
+
+      while (remaining > 0) {
+         const ssize_t written = ::writev(fd, next, (int) remaining);
+         if (written < 0) {
+            if (errno == EINTR) {
+               continue;
+            }
+            return false;
+         }
+
+         // short write - skip what went out and resume mid-segment
+         std::size_t consumed = (std::size_t) written;
+         while ((remaining > 0) && (consumed >= next->iov_len)) {
+            consumed -= next->iov_len;
+            ++next;
+            --remaining;
+         }
+
+         if (remaining > 0) {
+            next->iov_base = static_cast<char*>(next->iov_base) + consumed;
+            next->iov_len -= consumed;
+         }
+      }
+
+      segments += iovCount;
+      count -= iovCount;
+   }
+
+   return true;
+}
+
+//******************************************************************************
+
+bool SocketConnection::sendFile(int fd, off_t offset, std::size_t length) {
+#if defined(__linux__)
+   const int socketFD = m_socket->getFileDescriptor();
+   if (socketFD < 0) {
+      return ByteConnection::sendFile(fd, offset, length);
+   }
+
+   while (length > 0) {
+      const ssize_t sent = ::sendfile(socketFD, fd, &offset, length);
+      if (sent < 0) {
+         if (errno == EINTR) {
+            continue;
+         }
+
+         // a descriptor sendfile() can't read from (e.g. a pipe) - copy
+         // the rest through user space instead
+         if ((errno == EINVAL) || (errno == ENOSYS)) {
+            return ByteConnection::sendFile(fd, offset, length);
+         }
+         return false;
+      }
+
+      // the file ended early
+      if (sent == 0) {
+         return false;
+      }
+
+      length -= (std::size_t) sent;
+   }
+
+   return true;
+#else
+   return ByteConnection::sendFile(fd, offset, length);
+#endif
+}
+
+//******************************************************************************
+
+int SocketConnection::getSocketDescriptor() const {
+   return (m_socket != nullptr) ? m_socket->getFileDescriptor() : -1;
+}
+
+//******************************************************************************
+
 void SocketConnection::close() {
    m_socket->close();
 }
@@ -44,6 +44,29 @@ class SocketConnection : public ByteConnection
 
       virtual int read(char* buffer, int bufferSize);
       virtual bool write(const char* buffer, std::size_t length);
+
+      /**
+       * Writes all segments with writev() on the socket's descriptor -
+       * one system call (and, with TCP_NODELAY, typically one packet)
+       * for a response's header block and body, looping only on a
+       * short write
+       * @param segments the segments to write
+       * @param count the number of segments
+       * @return boolean indicating whether the write succeeded
+       */
+      virtual bool writev(const Segment* segments, std::size_t count);
+
+      /**
+       * Writes a range of a file with sendfile() on the socket's
+       * descriptor where available, so the file's contents go from the
+       * page cache to the socket without being copied through user space
+       * @param fd the file descriptor to read from
+       * @param offset position in the file of the first byte to write
+       * @param length the number of bytes to write
+       * @return boolean indicating whether the write succeeded
+       */
+      virtual bool sendFile(int fd, off_t offset, std::size_t length);
+      virtual int getSocketDescriptor() const;
       virtual void close();
 
    private:
@@ -0,0 +1,415 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#if defined(__linux__)
+#include <sys/inotify.h>
+#endif
+#include <cerrno>
+#include <cstdint>
+#include <filesystem>
+#include <system_error>
+#include <utility>
+
+#include "StaticFileHandler.h"
+#include "GzipCompressor.h"
+#include "HTTP.h"
+#include "HttpConditional.h"
+#include "HttpDateCache.h"
+#include "HttpRequest.h"
+#include "HttpResponse.h"
+#include "Logger.h"
+
+using namespace misere;
+using namespace chaudiere;
+
+static const int STATUS_NOT_FOUND = 404;
+
+static const std::string INDEX_FILE = "index.html";
+
+// smaller bodies gain too little from compression to be worth a variant
+static const std::size_t MIN_GZIP_SIZE = 256;
+
+// a burst of changes is over once this long passes without another
+static const int WATCH_SETTLE_MILLIS = 250;
+
+static const std::size_t WATCH_EVENT_BUFFER_SIZE = 4096;
+
+namespace {
+
+struct ContentType {
+   const char* extension;
+   const char* mimeType;
+   bool isCompressible;
+};
+
+const ContentType CONTENT_TYPES[] = {
+   { "html",  "text/html",                true },
+   { "htm",   "text/html",                true },
+   { "css",   "text/css",                 true },
+   { "js",    "application/javascript",   true },
+   { "mjs",   "application/javascript",   true },
+   { "json",  "application/json",         true },
+   { "map",   "application/json",         true },
+   { "xml",   "application/xml",          true },
+   { "txt",   "text/plain",               true },
+   { "csv",   "text/csv",                 true },
+   { "svg",   "image/svg+xml",            true },
+   { "wasm",  "application/wasm",         true },
+   { "png",   "image/png",                false },
+   { "jpg",   "image/jpeg",               false },
+   { "jpeg",  "image/jpeg",               false },
+   { "gif",   "image/gif",                false },
+   { "webp",  "image/webp",               false },
+   { "ico",   "image/x-icon",             false },
+   { "woff",  "font/woff",                false },
+   { "woff2", "font/woff2",               false },
+   { "pdf",   "application/pdf",          false }
+};
+
+const ContentType DEFAULT_CONTENT_TYPE = { "", "application/octet-stream", false };
+
+const ContentType& contentTypeForPath(const std::string& path) {
+   const std::string::size_type dot = path.rfind('.');
+   const std::string::size_type slash = path.rfind('/');
+   if ((dot == std::string::npos) ||
+       ((slash != std::string::npos) && (dot < slash))) {
+      return DEFAULT_CONTENT_TYPE;
+   }
+
+   const char* extension = path.c_str() + dot + 1;
+   for (const ContentType& contentType : CONTENT_TYPES) {
+      if (::strcasecmp(extension, contentType.extension) == 0) {
+         return contentType;
+      }
+   }
+
+   return DEFAULT_CONTENT_TYPE;
+}
+
+}
+
+//******************************************************************************
+
+StaticFileHandler::StaticFileHandler(const std::string& directory) :
+   m_directory(directory),
+   m_isWatching(false),
+   m_inotifyFD(-1) {
+   LOG_INSTANCE_CREATE("StaticFileHandler")
+}
+
+//******************************************************************************
+
+StaticFileHandler::~StaticFileHandler() {
+   LOG_INSTANCE_DESTROY("StaticFileHandler")
+   stopWatching();
+}
+
+//******************************************************************************
+
+bool StaticFileHandler::init(const std::string& path,
+                             const KeyValuePairs& kvpArguments) {
+   m_path = path;
+
+   // strip a trailing slash so the path below it starts with one
+   while ((m_path.size() > 1) && (m_path.back() == '/')) {
+      m_path.pop_back();
+   }
+   if (m_path == "/") {
+      m_path.clear();
+   }
+
+#if defined(__linux__)
+   m_inotifyFD = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+   if (m_inotifyFD < 0) {
+      LOG_WARNING("static files: unable to watch for changes in " + m_directory)
+   }
+#endif
+
+   if (!reload()) {
+      LOG_ERROR("static files: unable to read directory " + m_directory)
+      stopWatching();
+      return false;
+   }
+
+   startWatching();
+   return true;
+}
+
+//******************************************************************************
+
+void StaticFileHandler::destroy() {
+   stopWatching();
+}
+
+//******************************************************************************
+
+bool StaticFileHandler::handlesSubpaths() const {
+   return true;
+}
+
+//******************************************************************************
+
+bool StaticFileHandler::reload() {
+   namespace fs = std::filesystem;
+
+   std::error_code ec;
+   if (!fs::is_directory(m_directory, ec)) {
+      return false;
+   }
+
+   std::shared_ptr<AssetTable> table = std::make_shared<AssetTable>();
+   GzipCompressor compressor;
+
+#if defined(__linux__)
+   const uint32_t WATCH_MASK = IN_CLOSE_WRITE | IN_CREATE | IN_DELETE |
+                               IN_MOVED_FROM | IN_MOVED_TO;
+   if (m_inotifyFD > -1) {
+      ::inotify_add_watch(m_inotifyFD, m_directory.c_str(), WATCH_MASK);
+   }
+#endif
+
+   fs::recursive_directory_iterator it(m_directory,
+                                       fs::directory_options::skip_permission_denied,
+                                       ec);
+   const fs::recursive_directory_iterator end;
+
+   for (; !ec && (it != end); it.increment(ec)) {
+      const fs::path& entryPath = it->path();
+      const std::string name = entryPath.filename().string();
+
+      // hidden files and directories (.git, editor swap files) aren't
+      // served
+      if (!name.empty() && (name[0] == '.')) {
+         if (it->is_directory(ec)) {
+            it.disable_recursion_pending();
+         }
+         continue;
+      }
+
+      if (it->is_directory(ec)) {
+#if defined(__linux__)
+         if (m_inotifyFD > -1) {
+            ::inotify_add_watch(m_inotifyFD, entryPath.c_str(), WATCH_MASK);
+         }
+#endif
+         continue;
+      }
+
+      if (!it->is_regular_file(ec)) {
+         continue;
+      }
+
+      const std::string urlPath =
+         "/" + entryPath.lexically_relative(m_directory).generic_string();
+      loadFile(*table, compressor, entryPath.string(), urlPath);
+   }
+
+   // a directory's index.html also answers for the directory, with or
+   // without a trailing slash
+   std::vector<std::pair<std::string, std::size_t>> indexes;
+   for (const auto& entry : table->paths) {
+      const std::string& urlPath = entry.first;
+      if ((urlPath.size() > INDEX_FILE.size()) &&
+          (urlPath.compare(urlPath.size() - INDEX_FILE.size(),
+                           INDEX_FILE.size(),
+                           INDEX_FILE) == 0) &&
+          (urlPath[urlPath.size() - INDEX_FILE.size() - 1] == '/')) {
+         const std::string directory =
+            urlPath.substr(0, urlPath.size() - INDEX_FILE.size());
+         indexes.emplace_back(directory, entry.second);
+         indexes.emplace_back(directory.substr(0, directory.size() - 1),
+                              entry.second);
+      }
+   }
+   for (auto& index : indexes) {
+      table->paths.emplace(std::move(index.first), index.second);
+   }
+
+   m_table.store(std::move(table));
+   return true;
+}
+
+//******************************************************************************
+
+bool StaticFileHandler::loadFile(AssetTable& table,
+                                 GzipCompressor& compressor,
+                                 const std::string& filePath,
+                                 const std::string& urlPath) {
+   const int fd = ::open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+   if (fd < 0) {
+      return false;
+   }
+
+   struct stat st;
+   if ((::fstat(fd, &st) != 0) || !S_ISREG(st.st_mode)) {
+      ::close(fd);
+      return false;
+   }
+
+   // copied rather than mapped: a mapping of a file that's then
+   // truncated in place faults (SIGBUS) when read past the new end.
+   // whatever the file holds when the read ends is what's served
+   Asset asset;
+   asset.content.resize((std::size_t) st.st_size);
+   std::size_t length = 0;
+   while (length < asset.content.size()) {
+      const ssize_t bytesRead = ::read(fd,
+                                       &asset.content[length],
+                                       asset.content.size() - length);
+      if (bytesRead < 0) {
+         if (errno == EINTR) {
+            continue;
+         }
+         ::close(fd);
+         LOG_WARNING("static files: unable to read " + filePath)
+         return false;
+      }
+      if (bytesRead == 0) {
+         break;
+      }
+      length += (std::size_t) bytesRead;
+   }
+   asset.content.resize(length);
+   ::close(fd);
+
+   const ContentType& contentType = contentTypeForPath(filePath);
+   asset.contentType = contentType.mimeType;
+
+   asset.etag = HttpConditional::hashETag(asset.content.data(),
+                                          asset.content.size());
+
+   if (contentType.isCompressible &&
+       (asset.content.size() >= MIN_GZIP_SIZE) &&
+       compressor.compress(asset.content.data(),
+                           asset.content.size(),
+                           asset.gzipped) &&
+       (asset.gzipped.size() < asset.content.size())) {
+      // a different representation, so a different strong validator
+      asset.gzipEtag = asset.etag;
+      asset.gzipEtag.insert(asset.gzipEtag.size() - 1, "-gz");
+   } else {
+      asset.gzipped.clear();
+      asset.gzipped.shrink_to_fit();
+   }
+
+   char lastModified[HttpDateCache::HTTP_DATE_LENGTH + 1];
+   asset.lastModified.assign(lastModified,
+                             HttpDateCache::formatHttpDate(st.st_mtime, lastModified));
+
+   table.paths.emplace(urlPath, table.assets.size());
+   table.assets.push_back(std::move(asset));
+   return true;
+}
+
+//******************************************************************************
+
+void StaticFileHandler::serviceRequest(const HttpRequest& request,
+                                       HttpResponse& response) {
+   // holds this generation of files until the response has been written
+   std::shared_ptr<const AssetTable> table = m_table.load();
+   if (table == nullptr) {
+      response.setStatusCode(STATUS_NOT_FOUND);
+      return;
+   }
+
+   std::string_view path = request.getPath();
+   path = path.substr(0, path.find('?'));
+   if (path.compare(0, m_path.size(), m_path) == 0) {
+      path.remove_prefix(m_path.size());
+   }
+
+   const auto it = table->paths.find(path);
+   if (it == table->paths.end()) {
+      response.setStatusCode(STATUS_NOT_FOUND);
+      return;
+   }
+
+   const Asset& asset = table->assets[it->second];
+   const bool isGzipped = !asset.gzipped.empty() &&
+                          request.acceptsEncoding(HTTP::HTTP_CODING_GZIP);
+
+   response.setContentType(asset.contentType);
+   response.setHeaderValue(HTTP::HTTP_LAST_MODIFIED, asset.lastModified);
+
+   if (!asset.gzipped.empty()) {
+      response.setHeaderValue(HTTP::HTTP_VARY, HTTP::HTTP_ACCEPT_ENCODING);
+   }
+
+   if (isGzipped) {
+      response.setContentEncoding(HTTP::HTTP_CODING_GZIP);
+      response.setHeaderValue(HTTP::HTTP_ETAG, asset.gzipEtag);
+      response.setBodyView(asset.gzipped.data(), asset.gzipped.size(), table);
+   } else {
+      response.setHeaderValue(HTTP::HTTP_ETAG, asset.etag);
+      response.setBodyView(asset.content.data(), asset.content.size(), table);
+   }
+}
+
+//******************************************************************************
+
+std::size_t StaticFileHandler::getFileCount() const {
+   std::shared_ptr<const AssetTable> table = m_table.load();
+   return (table != nullptr) ? table->assets.size() : 0;
+}
+
+//******************************************************************************
+
+void StaticFileHandler::startWatching() {
+   if (m_inotifyFD < 0) {
+      return;
+   }
+
+   m_isWatching = true;
+   m_watchThread = std::thread(&StaticFileHandler::watch, this);
+}
+
+//******************************************************************************
+
+void StaticFileHandler::stopWatching() {
+   m_isWatching = false;
+   if (m_watchThread.joinable()) {
+      m_watchThread.join();
+   }
+
+   if (m_inotifyFD > -1) {
+      ::close(m_inotifyFD);
+      m_inotifyFD = -1;
+   }
+}
+
+//******************************************************************************
+
+void StaticFileHandler::watch() {
+   char buffer[WATCH_EVENT_BUFFER_SIZE];
+   bool isChanged = false;
+
+   while (m_isWatching) {
+      struct pollfd pfd;
+      pfd.fd = m_inotifyFD;
+      pfd.events = POLLIN;
+      pfd.revents = 0;
+
+      const int ready = ::poll(&pfd, 1, WATCH_SETTLE_MILLIS);
+
+      if (ready > 0) {
+         // which files changed doesn't matter - everything is reloaded
+         while (::read(m_inotifyFD, buffer, sizeof(buffer)) > 0) {
+         }
+         isChanged = true;
+      } else if ((ready == 0) && isChanged) {
+         isChanged = false;
+         if (!reload()) {
+            LOG_WARNING("static files: unable to reload directory " + m_directory)
+         }
+      }
+   }
+}
+
+//******************************************************************************
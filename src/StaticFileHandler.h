@@ -0,0 +1,138 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef MISERE_STATICFILEHANDLER_H
+#define MISERE_STATICFILEHANDLER_H
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "AbstractHandler.h"
+
+namespace misere
+{
+   class GzipCompressor;
+   class HttpRequest;
+   class HttpResponse;
+
+/**
+ * StaticFileHandler serves the files below a directory from memory. At
+ * startup every (non-hidden) file is read into memory, given a strong
+ * ETag computed from its contents and, for text types, a gzip variant
+ * compressed once up front. A request then costs a hash lookup and
+ * headers - the body goes out straight from the loaded copy (or the gzip
+ * variant), without being read or copied into a per-request buffer.
+ *
+ * On Linux the directory tree is watched with inotify, and after a burst
+ * of changes settles the whole set of files is reloaded and swapped in;
+ * requests already being served keep the set they started with. Since
+ * the handler holds its own copies, a file being rewritten in place
+ * can't affect a response - at worst a half-written file is loaded, and
+ * replaced by the next reload once the writer is done. Renaming new files
+ * into place avoids even that.
+ *
+ * Registered on a path (e.g. "/static"), it serves the paths below it -
+ * "/static/css/site.css" is the file "css/site.css" - and a directory's
+ * index.html for the directory itself.
+ */
+class StaticFileHandler : public AbstractHandler
+{
+public:
+   /**
+    * Constructs a handler for a directory of files
+    * @param directory the directory whose files are served
+    */
+   explicit StaticFileHandler(const std::string& directory);
+
+   /**
+    * Destructor. Stops watching for changes.
+    */
+   virtual ~StaticFileHandler();
+
+   /**
+    * Loads the directory's files and starts watching it for changes
+    * @param path the path the handler is registered on
+    * @param kvpArguments not used
+    * @return boolean indicating whether the directory could be loaded
+    */
+   virtual bool init(const std::string& path,
+                     const chaudiere::KeyValuePairs& kvpArguments);
+
+   virtual void destroy();
+
+   virtual void serviceRequest(const HttpRequest& request,
+                               HttpResponse& response);
+
+   virtual bool handlesSubpaths() const;
+
+   /**
+    * Reloads every file below the directory and swaps the new set in
+    * @return boolean indicating whether the directory could be read
+    */
+   bool reload();
+
+   /**
+    * Retrieves the number of files being served
+    * @return the number of files
+    */
+   std::size_t getFileCount() const;
+
+private:
+   struct Asset
+   {
+      std::string content;
+      std::string gzipped;     // empty if not worth compressing
+      std::string etag;
+      std::string gzipEtag;
+      std::string lastModified;
+      const char* contentType;
+   };
+
+   struct PathHash
+   {
+      using is_transparent = void;
+      std::size_t operator()(std::string_view path) const {
+         return std::hash<std::string_view>()(path);
+      }
+   };
+
+   /**
+    * AssetTable is one loaded generation of the directory, freed when the
+    * last request using it is done
+    */
+   struct AssetTable
+   {
+      std::vector<Asset> assets;
+      std::unordered_map<std::string, std::size_t, PathHash, std::equal_to<>> paths;
+   };
+
+   bool loadFile(AssetTable& table,
+                 GzipCompressor& compressor,
+                 const std::string& filePath,
+                 const std::string& urlPath);
+   void startWatching();
+   void stopWatching();
+   void watch();
+
+   std::string m_directory;
+   std::string m_path;
+   std::atomic<std::shared_ptr<const AssetTable>> m_table;
+   std::thread m_watchThread;
+   std::atomic<bool> m_isWatching;
+   int m_inotifyFD;
+
+   // disallow copies
+   StaticFileHandler(const StaticFileHandler&);
+   StaticFileHandler& operator=(const StaticFileHandler&);
+};
+
+}
+
+#endif
@@ -10,6 +10,9 @@
 #include "BasicException.h"
 #include "Logger.h"
 
+// largest plaintext a single TLS record carries (RFC 8446 section 5.1)
+static const std::size_t TLS_MAX_RECORD_PLAINTEXT = 16384;
+
 using namespace misere;
 using namespace chaudiere;
 
@@ -119,6 +122,51 @@ bool TlsConnection::write(const char* buffer, std::size_t length) {
 
 //******************************************************************************
 
+bool TlsConnection::writev(const Segment* segments, std::size_t count) {
+   if (count == 1) {
+      return write(segments[0].data, segments[0].length);
+   }
+
+   std::size_t totalLength = 0;
+   for (std::size_t i = 0; i < count; ++i) {
+      totalLength += segments[i].length;
+   }
+
+   std::string record;
+   record.reserve((totalLength < TLS_MAX_RECORD_PLAINTEXT) ?
+                  totalLength : TLS_MAX_RECORD_PLAINTEXT);
+
+   for (std::size_t i = 0; i < count; ++i) {
+      const char* data = segments[i].data;
+      std::size_t length = segments[i].length;
+
+      while (length > 0) {
+         const std::size_t space = TLS_MAX_RECORD_PLAINTEXT - record.size();
+         const std::size_t chunk = (length < space) ? length : space;
+         record.append(data, chunk);
+         data += chunk;
+         length -= chunk;
+
+         if (record.size() == TLS_MAX_RECORD_PLAINTEXT) {
+            if (!write(record.data(), record.size())) {
+               return false;
+            }
+            record.clear();
+         }
+      }
+   }
+
+   return record.empty() || write(record.data(), record.size());
+}
+
+//******************************************************************************
+
+int TlsConnection::getSocketDescriptor() const {
+   return (m_socket != nullptr) ? m_socket->getFileDescriptor() : -1;
+}
+
+//******************************************************************************
+
 void TlsConnection::close() {
    for (;;) {
       armure::Result<void> result = m_connection.shutdown();
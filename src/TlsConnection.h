@@ -73,6 +73,24 @@ class TlsConnection : public ByteConnection
       virtual int read(char* buffer, int bufferSize);
       virtual bool write(const char* buffer, std::size_t length);
 
+      /**
+       * Copies the segments into record-sized chunks and writes each
+       * chunk with a single write(), so a small response's header block
+       * and body go out as one TLS record (and one socket write) rather
+       * than one per segment
+       * @param segments the segments to write
+       * @param count the number of segments
+       * @return boolean indicating whether the write succeeded
+       */
+      virtual bool writev(const Segment* segments, std::size_t count);
+
+      /**
+       * Retrieves the descriptor of the socket supplied to the
+       * constructor
+       * @return the socket's descriptor, or -1 if no socket was supplied
+       */
+      virtual int getSocketDescriptor() const;
+
       /**
        * Sends a TLS close_notify (best-effort - see the .cpp for why
        * this can't report failure) and then, if a socket was supplied to
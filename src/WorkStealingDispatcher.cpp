@@ -0,0 +1,348 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include <exception>
+#include <string>
+
+#include <unistd.h>
+
+#include "WorkStealingDispatcher.h"
+#include "BasicException.h"
+#include "CpuAffinity.h"
+#include "Logger.h"
+#include "StrUtils.h"
+
+using namespace misere;
+using namespace chaudiere;
+
+thread_local WorkStealingDispatcher::Worker* WorkStealingDispatcher::s_currentWorker = nullptr;
+
+//******************************************************************************
+
+WorkStealingDispatcher::WorkStealingDispatcher(int numberWorkers) :
+   m_queuedCount(0),
+   m_sleepingCount(0),
+   m_nextWorker(0),
+   m_stealCount(0),
+   m_isRunning(false),
+   m_isStopping(false),
+   m_numberWorkers(numberWorkers > 0 ? numberWorkers : 1) {
+   LOG_INSTANCE_CREATE("WorkStealingDispatcher")
+}
+
+//******************************************************************************
+
+WorkStealingDispatcher::~WorkStealingDispatcher() {
+   LOG_INSTANCE_DESTROY("WorkStealingDispatcher")
+   stop();
+}
+
+//******************************************************************************
+
+bool WorkStealingDispatcher::start() {
+   if (m_isRunning) {
+      return false;
+   }
+
+   m_isStopping = false;
+   m_workers.clear();
+   m_cpuNodes.clear();
+   m_nodeWorkers.clear();
+
+   // the node of each CPU, looked up once rather than per request
+   if (!m_workerCpus.empty()) {
+      const long cpuCount = ::sysconf(_SC_NPROCESSORS_CONF);
+      for (long cpu = 0; cpu < cpuCount; ++cpu) {
+         m_cpuNodes.push_back(CpuAffinity::nodeOfCpu((int) cpu));
+      }
+   }
+
+   for (int i = 0; i < m_numberWorkers; ++i) {
+      m_workers.push_back(std::make_unique<Worker>(this));
+      Worker& worker = *m_workers.back();
+
+      // xorshift needs a non-zero seed
+      worker.randomState = 2654435761u * (std::uint32_t) (i + 1);
+
+      if (!m_workerCpus.empty()) {
+         worker.cpu = m_workerCpus[i % m_workerCpus.size()];
+         if ((worker.cpu >= 0) && (worker.cpu < (int) m_cpuNodes.size())) {
+            worker.node = m_cpuNodes[worker.cpu];
+         }
+
+         if (worker.node > -1) {
+            if (worker.node >= (int) m_nodeWorkers.size()) {
+               m_nodeWorkers.resize(worker.node + 1);
+            }
+            m_nodeWorkers[worker.node].push_back(&worker);
+         }
+      }
+   }
+
+   // every worker exists before any of them looks for one to steal from
+   for (std::unique_ptr<Worker>& worker : m_workers) {
+      Worker* w = worker.get();
+      w->thread = std::thread([this, w]() {
+         runWorker(*w);
+      });
+   }
+
+   m_isRunning = true;
+   return true;
+}
+
+//******************************************************************************
+
+bool WorkStealingDispatcher::stop() {
+   if (!m_isRunning) {
+      return false;
+   }
+
+   {
+      std::lock_guard<std::mutex> lock(m_idleMutex);
+      m_isStopping = true;
+   }
+   m_wakeup.notify_all();
+
+   for (std::unique_ptr<Worker>& worker : m_workers) {
+      if (worker->thread.joinable()) {
+         worker->thread.join();
+      }
+   }
+
+   m_nodeWorkers.clear();
+   m_workers.clear();
+   m_isRunning = false;
+   return true;
+}
+
+//******************************************************************************
+
+bool WorkStealingDispatcher::addRequest(Runnable* runnableRequest) {
+   // one of our own workers keeps what it adds; anyone else's requests
+   // are dealt out to the workers in turn
+   Worker* worker = s_currentWorker;
+   if ((nullptr == worker) || (worker->owner != this)) {
+      worker = nextWorker();
+   }
+
+   return push(worker, runnableRequest);
+}
+
+//******************************************************************************
+
+bool WorkStealingDispatcher::addRequest(Runnable* runnableRequest, int incomingCpu) {
+   Worker* worker = nullptr;
+
+   if ((incomingCpu >= 0) && (incomingCpu < (int) m_cpuNodes.size())) {
+      const int node = m_cpuNodes[incomingCpu];
+      if ((node > -1) &&
+          (node < (int) m_nodeWorkers.size()) &&
+          !m_nodeWorkers[node].empty()) {
+         const std::vector<Worker*>& workers = m_nodeWorkers[node];
+         worker = workers[m_nextWorker.fetch_add(1, std::memory_order_relaxed) %
+                          workers.size()];
+      }
+   }
+
+   if (nullptr == worker) {
+      worker = nextWorker();
+   }
+
+   return push(worker, runnableRequest);
+}
+
+//******************************************************************************
+
+void WorkStealingDispatcher::setWorkerCpus(const std::vector<int>& cpus) {
+   if (!m_isRunning) {
+      m_workerCpus = cpus;
+   }
+}
+
+//******************************************************************************
+
+WorkStealingDispatcher::Worker* WorkStealingDispatcher::nextWorker() {
+   if (m_workers.empty()) {
+      return nullptr;
+   }
+
+   return m_workers[m_nextWorker.fetch_add(1, std::memory_order_relaxed) %
+                    m_workers.size()].get();
+}
+
+//******************************************************************************
+
+bool WorkStealingDispatcher::push(Worker* worker, Runnable* runnableRequest) {
+   if ((nullptr == runnableRequest) || (nullptr == worker) ||
+       !m_isRunning || m_isStopping) {
+      return false;
+   }
+
+   {
+      std::lock_guard<std::mutex> lock(worker->mutex);
+      worker->requests.push_back(runnableRequest);
+      worker->size.store(worker->requests.size(), std::memory_order_relaxed);
+   }
+
+   // pairs with waitForRequests(): either a sleeper is counted here and
+   // woken, or it sees the request before it sleeps
+   ++m_queuedCount;
+   if (m_sleepingCount.load() > 0) {
+      std::lock_guard<std::mutex> lock(m_idleMutex);
+      m_wakeup.notify_one();
+   }
+
+   return true;
+}
+
+//******************************************************************************
+
+int WorkStealingDispatcher::getNumberWorkers() const {
+   return m_numberWorkers;
+}
+
+//******************************************************************************
+
+void WorkStealingDispatcher::setNumberWorkers(int numberWorkers) {
+   if (!m_isRunning && (numberWorkers > 0)) {
+      m_numberWorkers = numberWorkers;
+   }
+}
+
+//******************************************************************************
+
+std::uint64_t WorkStealingDispatcher::getStealCount() const {
+   return m_stealCount.load(std::memory_order_relaxed);
+}
+
+//******************************************************************************
+
+void WorkStealingDispatcher::runWorker(Worker& worker) {
+   // before anything is allocated on this thread, so its memory comes
+   // from the CPU's own node
+   if ((worker.cpu > -1) && !CpuAffinity::pinCurrentThread(worker.cpu)) {
+      LOG_WARNING("unable to pin pool worker to CPU " +
+                  StrUtils::toString(worker.cpu))
+   }
+
+   s_currentWorker = &worker;
+
+   for (;;) {
+      Runnable* request = popLocal(worker);
+      if (nullptr == request) {
+         request = steal(worker);
+      }
+
+      if (nullptr != request) {
+         runRequest(request);
+      } else if (!waitForRequests()) {
+         break;
+      }
+   }
+
+   s_currentWorker = nullptr;
+}
+
+//******************************************************************************
+
+Runnable* WorkStealingDispatcher::popLocal(Worker& worker) {
+   if (worker.size.load(std::memory_order_relaxed) == 0) {
+      return nullptr;
+   }
+
+   std::lock_guard<std::mutex> lock(worker.mutex);
+   if (worker.requests.empty()) {
+      return nullptr;
+   }
+
+   Runnable* request = worker.requests.back();
+   worker.requests.pop_back();
+   worker.size.store(worker.requests.size(), std::memory_order_relaxed);
+   --m_queuedCount;
+   return request;
+}
+
+//******************************************************************************
+
+Runnable* WorkStealingDispatcher::steal(Worker& thief) {
+   const std::size_t count = m_workers.size();
+
+   // xorshift32
+   std::uint32_t x = thief.randomState;
+   x ^= x << 13;
+   x ^= x >> 17;
+   x ^= x << 5;
+   thief.randomState = x;
+
+   const std::size_t first = x % count;
+
+   // workers on the thief's own node first, so a request (and the
+   // connection state it touches) only crosses nodes when it would
+   // otherwise wait
+   for (int pass = 0; pass < 2; ++pass) {
+      const bool isSameNode = (pass == 0);
+
+      for (std::size_t i = 0; i < count; ++i) {
+         Worker& victim = *m_workers[(first + i) % count];
+         if ((&victim == &thief) ||
+             ((victim.node == thief.node) != isSameNode) ||
+             (victim.size.load(std::memory_order_relaxed) == 0)) {
+            continue;
+         }
+
+         std::lock_guard<std::mutex> lock(victim.mutex);
+         if (victim.requests.empty()) {
+            continue;
+         }
+
+         // the oldest request - the one its owner would get to last
+         Runnable* request = victim.requests.front();
+         victim.requests.pop_front();
+         victim.size.store(victim.requests.size(), std::memory_order_relaxed);
+         --m_queuedCount;
+         m_stealCount.fetch_add(1, std::memory_order_relaxed);
+         return request;
+      }
+   }
+
+   return nullptr;
+}
+
+//******************************************************************************
+
+bool WorkStealingDispatcher::waitForRequests() {
+   std::unique_lock<std::mutex> lock(m_idleMutex);
+
+   ++m_sleepingCount;
+   while ((m_queuedCount.load() == 0) && !m_isStopping) {
+      m_wakeup.wait(lock);
+   }
+   --m_sleepingCount;
+
+   // a stopping pool still runs what was added before it stopped
+   return (m_queuedCount.load() > 0) || !m_isStopping;
+}
+
+//******************************************************************************
+
+void WorkStealingDispatcher::runRequest(Runnable* request) {
+   try {
+      request->run();
+      request->notifyOnCompletion();
+   } catch (const BasicException& be) {
+      LOG_ERROR("WorkStealingDispatcher request BasicException caught: " +
+                be.whatString())
+   } catch (const std::exception& e) {
+      LOG_ERROR(std::string("WorkStealingDispatcher request exception caught: ") +
+                std::string(e.what()))
+   } catch (...) {
+      LOG_ERROR("WorkStealingDispatcher request unknown exception caught")
+   }
+
+   if (request->isAutoDelete()) {
+      delete request;
+   }
+}
+
+//******************************************************************************
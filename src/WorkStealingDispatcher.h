@@ -0,0 +1,173 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef MISERE_WORKSTEALINGDISPATCHER_H
+#define MISERE_WORKSTEALINGDISPATCHER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Runnable.h"
+#include "ThreadPoolDispatcher.h"
+
+
+namespace misere
+{
+
+/**
+ * WorkStealingDispatcher is a thread pool with a queue per worker instead
+ * of one shared by all of them (threading = work_stealing). A request
+ * added by one of the pool's own workers goes on that worker's queue and
+ * is taken from the same end (last in, first out) while it's still warm
+ * in the worker's cache; a request added from outside the pool (the
+ * accept loop, an event loop) is spread over the workers' queues in
+ * turn. A worker whose queue is empty steals the oldest request from
+ * another worker's, starting with one picked at random, so workers
+ * looking for work don't all line up on the same queue. Only when
+ * there's nothing anywhere does a worker sleep.
+ *
+ * Each queue has a lock of its own, so at most the owner and one thief
+ * (or one outside caller) meet on it - rather than every worker and
+ * every caller on one lock, as with a shared queue.
+ *
+ * Workers can be pinned to CPUs (setWorkerCpus()). A pinned worker
+ * allocates its buffers after it's pinned, so they're on its own NUMA
+ * node (see CpuAffinity); it steals from workers on its own node before
+ * those on others; and a request can be steered to the node its
+ * connection arrived on (addRequest() with the incoming CPU).
+ *
+ * Requests are run as chaudiere's pool workers run them: run(), then
+ * notifyOnCompletion(), then deleted if they're auto-delete.
+ */
+class WorkStealingDispatcher : public chaudiere::ThreadPoolDispatcher
+{
+   public:
+      /**
+       * Constructs a pool (started by start())
+       * @param numberWorkers the number of worker threads
+       */
+      explicit WorkStealingDispatcher(int numberWorkers);
+
+      /**
+       * Destructor. Stops the pool, if still running.
+       */
+      ~WorkStealingDispatcher();
+
+      /**
+       * Starts the worker threads
+       * @return boolean indicating whether the pool was started
+       */
+      virtual bool start();
+
+      /**
+       * Stops the pool. The requests already added are run before the
+       * workers exit; none may be added once it's stopping.
+       * @return boolean indicating whether the pool was stopped
+       */
+      virtual bool stop();
+
+      /**
+       * Adds a request to be run by one of the workers
+       * @param runnableRequest the request
+       * @return boolean indicating whether the request was added (false if
+       *         the pool isn't running)
+       */
+      virtual bool addRequest(chaudiere::Runnable* runnableRequest);
+
+      /**
+       * Adds a request to be run by a worker on the NUMA node of the CPU
+       * its connection arrived on (see CpuAffinity::incomingCpu()) - one
+       * of any worker, if none of them is pinned to that node
+       * @param runnableRequest the request
+       * @param incomingCpu the CPU the connection's packets are processed
+       *        on, or -1 if not known
+       * @return boolean indicating whether the request was added
+       */
+      bool addRequest(chaudiere::Runnable* runnableRequest, int incomingCpu);
+
+      /**
+       * Pins the workers to CPUs: worker i to cpus[i % cpus.size()]. Has
+       * no effect once started.
+       * @param cpus the CPUs to pin to
+       */
+      void setWorkerCpus(const std::vector<int>& cpus);
+
+      /**
+       * Retrieves the number of worker threads
+       * @return the number of workers
+       */
+      virtual int getNumberWorkers() const;
+
+      /**
+       * Sets the number of worker threads. Has no effect once started.
+       * @param numberWorkers the number of workers
+       */
+      virtual void setNumberWorkers(int numberWorkers);
+
+      /**
+       * Retrieves the number of requests taken from another worker's
+       * queue since the pool started
+       * @return the number of stolen requests
+       */
+      std::uint64_t getStealCount() const;
+
+   private:
+      struct alignas(64) Worker
+      {
+         explicit Worker(const WorkStealingDispatcher* pool) :
+            owner(pool),
+            size(0),
+            randomState(0),
+            cpu(-1),
+            node(-1) {
+         }
+
+         const WorkStealingDispatcher* owner;
+         std::mutex mutex;
+         std::deque<chaudiere::Runnable*> requests;   // the owner's end is the back
+         std::atomic<std::size_t> size;   // lets thieves skip empty queues unlocked
+         std::uint32_t randomState;
+         int cpu;    // -1 if not pinned
+         int node;   // -1 if not known
+         std::thread thread;
+      };
+
+      bool push(Worker* worker, chaudiere::Runnable* request);
+      Worker* nextWorker();
+      void runWorker(Worker& worker);
+      chaudiere::Runnable* popLocal(Worker& worker);
+      chaudiere::Runnable* steal(Worker& thief);
+      bool waitForRequests();
+      static void runRequest(chaudiere::Runnable* request);
+
+      static thread_local Worker* s_currentWorker;
+
+      std::vector<std::unique_ptr<Worker>> m_workers;
+      std::vector<int> m_workerCpus;
+      std::vector<int> m_cpuNodes;   // indexed by CPU
+      std::vector<std::vector<Worker*>> m_nodeWorkers;   // indexed by node
+      std::mutex m_idleMutex;
+      std::condition_variable m_wakeup;
+      std::atomic<long> m_queuedCount;
+      std::atomic<int> m_sleepingCount;
+      std::atomic<unsigned int> m_nextWorker;
+      std::atomic<std::uint64_t> m_stealCount;
+      std::atomic<bool> m_isRunning;
+      std::atomic<bool> m_isStopping;
+      int m_numberWorkers;
+
+      // disallow copies
+      WorkStealingDispatcher(const WorkStealingDispatcher&);
+      WorkStealingDispatcher& operator=(const WorkStealingDispatcher&);
+};
+
+}
+
+#endif
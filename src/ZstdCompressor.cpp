@@ -0,0 +1,162 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#if defined(MISERE_WITH_ZSTD)
+#include <zstd.h>
+#endif
+
+#include <fstream>
+#include <iterator>
+
+#include "ZstdCompressor.h"
+#include "Logger.h"
+
+using namespace misere;
+
+//******************************************************************************
+
+bool ZstdCompressor::isSupported() {
+#if defined(MISERE_WITH_ZSTD)
+   return true;
+#else
+   return false;
+#endif
+}
+
+//******************************************************************************
+
+void ZstdCompressor::setLevel(int level) {
+   m_level = level;
+}
+
+//******************************************************************************
+
+#if defined(MISERE_WITH_ZSTD)
+
+ZstdDictionary* ZstdDictionary::load(const std::string& path, int level) {
+   std::ifstream file(path, std::ios::binary);
+   if (!file) {
+      LOG_ERROR("unable to read zstd dictionary " + path)
+      return nullptr;
+   }
+
+   const std::string contents((std::istreambuf_iterator<char>(file)),
+                              std::istreambuf_iterator<char>());
+
+   // copies what it needs - the file contents aren't kept
+   ZSTD_CDict* dictionary =
+      ::ZSTD_createCDict(contents.data(), contents.size(), level);
+   if (dictionary == nullptr) {
+      LOG_ERROR("unable to load zstd dictionary " + path)
+      return nullptr;
+   }
+
+   return new ZstdDictionary(dictionary);
+}
+
+//******************************************************************************
+
+ZstdDictionary::ZstdDictionary(ZSTD_CDict_s* dictionary) :
+   m_dictionary(dictionary) {
+}
+
+//******************************************************************************
+
+ZstdDictionary::~ZstdDictionary() {
+   ::ZSTD_freeCDict(m_dictionary);
+}
+
+//******************************************************************************
+
+ZstdCompressor::ZstdCompressor(int level) :
+   m_context(::ZSTD_createCCtx()),
+   m_level(level) {
+}
+
+//******************************************************************************
+
+ZstdCompressor::~ZstdCompressor() {
+   ::ZSTD_freeCCtx(m_context);
+}
+
+//******************************************************************************
+
+bool ZstdCompressor::compress(const char* data,
+                              std::size_t length,
+                              std::string& output,
+                              const ZstdDictionary* dictionary) {
+   output.clear();
+
+   if (m_context == nullptr) {
+      return false;
+   }
+
+   // sized up front so the whole frame is written in one call
+   const std::size_t bound = ::ZSTD_compressBound(length);
+   output.resize(bound);
+
+   // the context keeps its allocated state from one call to the next
+   const std::size_t rc = (dictionary != nullptr) ?
+      ::ZSTD_compress_usingCDict(m_context,
+                                 output.data(), bound,
+                                 data, length,
+                                 dictionary->m_dictionary) :
+      ::ZSTD_compressCCtx(m_context,
+                          output.data(), bound,
+                          data, length,
+                          m_level);
+
+   if (::ZSTD_isError(rc)) {
+      output.clear();
+      return false;
+   }
+
+   output.resize(rc);
+   return true;
+}
+
+//******************************************************************************
+
+#else
+
+ZstdDictionary* ZstdDictionary::load(const std::string& path, int) {
+   LOG_ERROR("zstd support not built in, can't load dictionary " + path)
+   return nullptr;
+}
+
+//******************************************************************************
+
+ZstdDictionary::ZstdDictionary(ZSTD_CDict_s* dictionary) :
+   m_dictionary(dictionary) {
+}
+
+//******************************************************************************
+
+ZstdDictionary::~ZstdDictionary() {
+}
+
+//******************************************************************************
+
+ZstdCompressor::ZstdCompressor(int level) :
+   m_context(nullptr),
+   m_level(level) {
+}
+
+//******************************************************************************
+
+ZstdCompressor::~ZstdCompressor() {
+}
+
+//******************************************************************************
+
+bool ZstdCompressor::compress(const char*,
+                              std::size_t,
+                              std::string& output,
+                              const ZstdDictionary*) {
+   output.clear();
+   return false;
+}
+
+//******************************************************************************
+
+#endif
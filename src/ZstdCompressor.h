@@ -0,0 +1,133 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef MISERE_ZSTDCOMPRESSOR_H
+#define MISERE_ZSTDCOMPRESSOR_H
+
+#include <cstddef>
+#include <string>
+
+// zstd's own types, kept opaque here so zstd.h isn't needed to use these
+struct ZSTD_CCtx_s;
+struct ZSTD_CDict_s;
+
+
+namespace misere
+{
+
+/**
+ * ZstdDictionary is a dictionary loaded from a file (e.g. one trained on
+ * sample responses with "zstd --train", or simply a typical response)
+ * and digested once for compression at a given level. Small responses
+ * that share most of their structure - JSON with the same keys, say -
+ * compress far better against one. Read-only once loaded, so one
+ * dictionary is shared by every thread's ZstdCompressor.
+ *
+ * Clients have to hold the same dictionary to decode what's compressed
+ * with it, so it's only for clients that are known to.
+ */
+class ZstdDictionary
+{
+   public:
+      /**
+       * Loads a dictionary from a file
+       * @param path the path of the dictionary file
+       * @param level the compression level the dictionary is used at
+       * @return the dictionary (must be freed by caller), or nullptr if
+       *         the file can't be read or zstd support isn't built in
+       */
+      static ZstdDictionary* load(const std::string& path, int level);
+
+      /**
+       * Destructor
+       */
+      ~ZstdDictionary();
+
+   private:
+      explicit ZstdDictionary(ZSTD_CDict_s* dictionary);
+
+      ZSTD_CDict_s* m_dictionary;
+
+      friend class ZstdCompressor;
+
+      // disallow copies
+      ZstdDictionary(const ZstdDictionary&);
+      ZstdDictionary& operator=(const ZstdDictionary&);
+};
+
+/**
+ * ZstdCompressor produces Zstandard (RFC 8878) encoded output with one
+ * zstd compression context that is created once and reused for every
+ * input, rather than allocating zstd's working state per body. Not
+ * thread-safe - each thread compressing needs its own.
+ *
+ * Only available when misere is built with zstd (MISERE_WITH_ZSTD - see
+ * isSupported()); otherwise compress() always fails.
+ */
+class ZstdCompressor
+{
+   public:
+      /**
+       * Default compression level - zstd's own default
+       */
+      static const int DEFAULT_LEVEL = 3;
+
+      /**
+       * Range of valid compression levels (zstd's "ultra" levels above
+       * this need far more memory than a server should spend per thread)
+       */
+      static const int MIN_LEVEL = 1;
+      static const int MAX_LEVEL = 19;
+
+      /**
+       * Determines whether misere was built with zstd support
+       * @return boolean indicating if zstd compression is available
+       */
+      static bool isSupported();
+
+      /**
+       * Constructs a compressor
+       * @param level the compression level (1-19) used without a
+       *        dictionary
+       */
+      explicit ZstdCompressor(int level=DEFAULT_LEVEL);
+
+      /**
+       * Destructor
+       */
+      ~ZstdCompressor();
+
+      /**
+       * Compresses a buffer into zstd format
+       * @param data the bytes to compress
+       * @param length the number of bytes to compress
+       * @param output receives the compressed bytes (replacing its
+       *        contents, but keeping its capacity)
+       * @param dictionary the dictionary to compress against (at its
+       *        own level), or nullptr for none
+       * @return boolean indicating whether compression succeeded
+       */
+      bool compress(const char* data,
+                    std::size_t length,
+                    std::string& output,
+                    const ZstdDictionary* dictionary=nullptr);
+
+      /**
+       * Changes the compression level used without a dictionary for the
+       * inputs that follow
+       * @param level the compression level (1-19)
+       */
+      void setLevel(int level);
+
+   private:
+      ZSTD_CCtx_s* m_context;
+      int m_level;
+
+      // disallow copies
+      ZstdCompressor(const ZstdCompressor&);
+      ZstdCompressor& operator=(const ZstdCompressor&);
+};
+
+}
+
+#endif
@@ -0,0 +1,114 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#if defined(MISERE_WITH_BROTLI)
+#include <brotli/decode.h>
+#endif
+
+#include <string>
+
+#include "TestBrotliCompressor.h"
+#include "BrotliCompressor.h"
+
+using namespace std;
+using namespace misere;
+
+namespace {
+
+string repeated(const string& s, int count) {
+   string result;
+   for (int i = 0; i < count; ++i) {
+      result += s;
+   }
+   return result;
+}
+
+#if defined(MISERE_WITH_BROTLI)
+bool decompress(const string& input, size_t decodedLength, string& output) {
+   output.resize(decodedLength);
+   size_t length = decodedLength;
+   const BrotliDecoderResult rc =
+      ::BrotliDecoderDecompress(input.size(),
+                                (const uint8_t*) input.data(),
+                                &length,
+                                (uint8_t*) output.data());
+   output.resize(length);
+   return rc == BROTLI_DECODER_RESULT_SUCCESS;
+}
+#endif
+
+}
+
+//******************************************************************************
+
+TestBrotliCompressor::TestBrotliCompressor() :
+   poivre::TestSuite("TestBrotliCompressor") {
+}
+
+//******************************************************************************
+
+void TestBrotliCompressor::runTests() {
+   if (!BrotliCompressor::isSupported()) {
+      testUnsupported();
+      return;
+   }
+
+   testRoundTrip();
+   testReuse();
+}
+
+//******************************************************************************
+
+void TestBrotliCompressor::testRoundTrip() {
+#if defined(MISERE_WITH_BROTLI)
+   TEST_CASE("testRoundTrip");
+
+   const string json = repeated("{\"id\":42,\"name\":\"misere\",\"tags\":[\"a\",\"b\"]}\n", 100);
+
+   BrotliCompressor compressor;
+   string compressed;
+   require(compressor.compress(json.data(), json.size(), compressed), "compress");
+   require(compressed.size() < json.size() / 8, "repetitive JSON should shrink well");
+
+   string decompressed;
+   require(decompress(compressed, json.size(), decompressed), "decompress");
+   requireStringEquals(json, decompressed, "round trip");
+#endif
+}
+
+//******************************************************************************
+
+void TestBrotliCompressor::testReuse() {
+#if defined(MISERE_WITH_BROTLI)
+   TEST_CASE("testReuse");
+
+   const string first = repeated("<li>item</li>\n", 200);
+   const string second = repeated("body { margin: 0; }\n", 120);
+
+   BrotliCompressor compressor(9);
+   string compressed;
+   string decompressed;
+
+   require(compressor.compress(first.data(), first.size(), compressed), "compress first");
+   require(decompress(compressed, first.size(), decompressed), "decompress first");
+   requireStringEquals(first, decompressed, "first round trip");
+
+   require(compressor.compress(second.data(), second.size(), compressed), "compress second");
+   require(decompress(compressed, second.size(), decompressed), "decompress second");
+   requireStringEquals(second, decompressed, "second round trip");
+#endif
+}
+
+//******************************************************************************
+
+void TestBrotliCompressor::testUnsupported() {
+   TEST_CASE("testUnsupported");
+
+   BrotliCompressor compressor;
+   string compressed = "stale";
+   requireFalse(compressor.compress("abc", 3, compressed),
+                "compress fails without Brotli built in");
+   require(compressed.empty(), "output is cleared");
+}
+
+//******************************************************************************
@@ -0,0 +1,27 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef MISERE_TESTBROTLICOMPRESSOR_H
+#define MISERE_TESTBROTLICOMPRESSOR_H
+
+#include "TestSuite.h"
+
+namespace misere {
+
+class TestBrotliCompressor : public poivre::TestSuite {
+
+protected:
+   void runTests();
+
+   void testRoundTrip();
+   void testReuse();
+   void testUnsupported();
+
+public:
+   TestBrotliCompressor();
+
+};
+
+}
+
+#endif
@@ -0,0 +1,188 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include "TestCpuAffinity.h"
+#include "CpuAffinity.h"
+
+using namespace std;
+using namespace misere;
+
+//******************************************************************************
+
+TestCpuAffinity::TestCpuAffinity() :
+   poivre::TestSuite("TestCpuAffinity") {
+}
+
+//******************************************************************************
+
+void TestCpuAffinity::runTests() {
+   testParseCpuList();
+   testParseInvalidCpuList();
+   testAllowedCpus();
+   testKeepAllowedCpus();
+   testPinCurrentThread();
+   testNodeOfCpu();
+   testIncomingCpu();
+}
+
+//******************************************************************************
+
+void TestCpuAffinity::testParseCpuList() {
+   TEST_CASE("testParseCpuList");
+
+   vector<int> cpus;
+
+   require(CpuAffinity::parseCpuList("3", cpus), "a single CPU should parse");
+   require(cpus.size() == 1 && cpus[0] == 3, "a single CPU");
+
+   require(CpuAffinity::parseCpuList("0-3,8, 10 - 11", cpus),
+           "ranges and single CPUs should parse");
+   require(cpus == vector<int>({0, 1, 2, 3, 8, 10, 11}),
+           "ranges should be expanded, in the order listed");
+
+   require(CpuAffinity::parseCpuList("4,2", cpus), "an unordered list should parse");
+   require(cpus == vector<int>({4, 2}), "the list's order should be kept");
+}
+
+//******************************************************************************
+
+void TestCpuAffinity::testParseInvalidCpuList() {
+   TEST_CASE("testParseInvalidCpuList");
+
+   vector<int> cpus;
+
+   require(!CpuAffinity::parseCpuList("", cpus), "an empty list is invalid");
+   require(!CpuAffinity::parseCpuList("3-1", cpus), "a descending range is invalid");
+   require(!CpuAffinity::parseCpuList("0-", cpus), "an open range is invalid");
+   require(!CpuAffinity::parseCpuList("-1", cpus), "a negative CPU is invalid");
+   require(!CpuAffinity::parseCpuList("a", cpus), "a name is invalid");
+   require(!CpuAffinity::parseCpuList("99999999", cpus), "an absurd CPU is invalid");
+   require(cpus.empty(), "an invalid list should leave no CPUs");
+}
+
+//******************************************************************************
+
+void TestCpuAffinity::testAllowedCpus() {
+   TEST_CASE("testAllowedCpus");
+
+   vector<int> cpus;
+   if (!CpuAffinity::allowedCpus(cpus)) {
+      require(cpus.empty(), "unknown CPUs should leave no CPUs");
+      return;
+   }
+
+   require(is_sorted(cpus.begin(), cpus.end()), "the CPUs should be in order");
+
+   const int cpu = CpuAffinity::currentCpu();
+   if (cpu > -1) {
+      require(find(cpus.begin(), cpus.end(), cpu) != cpus.end(),
+              "the CPU the thread runs on should be allowed");
+   }
+
+#if defined(__linux__)
+   // a thread limited to one CPU (as a cpuset limits a container) is
+   // allowed only that CPU, whichever it is
+   const int lastCpu = cpus.back();
+   bool isPinned = false;
+   vector<int> pinnedCpus;
+
+   thread pinned([&]() {
+      isPinned = CpuAffinity::pinCurrentThread(lastCpu);
+      CpuAffinity::allowedCpus(pinnedCpus);
+   });
+   pinned.join();
+
+   if (isPinned) {
+      require(pinnedCpus == vector<int>({lastCpu}),
+              "a pinned thread should be allowed only its CPU");
+   }
+#endif
+}
+
+//******************************************************************************
+
+void TestCpuAffinity::testKeepAllowedCpus() {
+   TEST_CASE("testKeepAllowedCpus");
+
+   vector<int> cpus({0, 5, 1, 6, 4});
+   vector<int> removed;
+
+   CpuAffinity::keepAllowedCpus(cpus, vector<int>({4, 5, 6, 7}), removed);
+   require(cpus == vector<int>({5, 6, 4}), "allowed CPUs should be kept, in order");
+   require(removed == vector<int>({0, 1}), "the other CPUs should be reported");
+
+   CpuAffinity::keepAllowedCpus(cpus, vector<int>({0, 1}), removed);
+   require(cpus.empty(), "no allowed CPUs should leave none");
+   require(removed == vector<int>({5, 6, 4}), "every CPU should be reported");
+
+   cpus = {2, 3};
+   CpuAffinity::keepAllowedCpus(cpus, vector<int>(), removed);
+   require(cpus == vector<int>({2, 3}), "unknown allowed CPUs should keep every CPU");
+   require(removed.empty(), "nothing should be reported");
+}
+
+//******************************************************************************
+
+void TestCpuAffinity::testPinCurrentThread() {
+   TEST_CASE("testPinCurrentThread");
+
+   // a CPU this process is allowed to run on
+   const int cpu = CpuAffinity::currentCpu();
+   if (cpu < 0) {
+      return;
+   }
+
+   bool isPinned = false;
+   int cpuAfterPinning = -1;
+
+   // on a thread of its own, so the test runner's thread isn't pinned
+   thread pinned([&]() {
+      isPinned = CpuAffinity::pinCurrentThread(cpu);
+      this_thread::yield();
+      cpuAfterPinning = CpuAffinity::currentCpu();
+   });
+   pinned.join();
+
+   require(isPinned, "the thread should be pinned");
+   require(cpuAfterPinning == cpu, "a pinned thread should run on its CPU");
+   require(!CpuAffinity::pinCurrentThread(-1), "a negative CPU can't be pinned to");
+}
+
+//******************************************************************************
+
+void TestCpuAffinity::testNodeOfCpu() {
+   TEST_CASE("testNodeOfCpu");
+
+   // -1 without NUMA information (not Linux, no sysfs)
+   require(CpuAffinity::nodeOfCpu(0) >= -1, "CPU 0 should have a node, or none known");
+   require(CpuAffinity::nodeOfCpu(-1) == -1, "a negative CPU has no node");
+   require(CpuAffinity::nodeOfCpu(999999) == -1, "a missing CPU has no node");
+}
+
+//******************************************************************************
+
+void TestCpuAffinity::testIncomingCpu() {
+   TEST_CASE("testIncomingCpu");
+
+   require(CpuAffinity::incomingCpu(-1) == -1, "a bad socket has no incoming CPU");
+   require(!CpuAffinity::setIncomingCpu(-1, 0), "a bad socket can't be steered");
+
+   const int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+   if (fd < 0) {
+      return;
+   }
+
+   // a socket nothing has arrived on yet reports no CPU (or isn't
+   // supported)
+   require(CpuAffinity::incomingCpu(fd) >= -1, "an unused socket's incoming CPU");
+   ::close(fd);
+}
+
+//******************************************************************************
@@ -0,0 +1,31 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef MISERE_TESTCPUAFFINITY_H
+#define MISERE_TESTCPUAFFINITY_H
+
+#include "TestSuite.h"
+
+namespace misere {
+
+class TestCpuAffinity : public poivre::TestSuite {
+
+protected:
+   void runTests();
+
+   void testParseCpuList();
+   void testParseInvalidCpuList();
+   void testAllowedCpus();
+   void testKeepAllowedCpus();
+   void testPinCurrentThread();
+   void testNodeOfCpu();
+   void testIncomingCpu();
+
+public:
+   TestCpuAffinity();
+
+};
+
+}
+
+#endif
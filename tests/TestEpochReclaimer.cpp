@@ -0,0 +1,238 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include <atomic>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "TestEpochReclaimer.h"
+#include "EpochReclaimer.h"
+
+using namespace std;
+using namespace misere;
+
+namespace {
+
+const unsigned int LIVE = 0x600D600D;
+const unsigned int FREED = 0xDEADDEAD;
+
+struct Published
+{
+   explicit Published(int publishedValue) :
+      state(LIVE),
+      value(publishedValue) {
+   }
+
+   ~Published() {
+      state = FREED;
+   }
+
+   volatile unsigned int state;
+   int value;
+};
+
+}
+
+//******************************************************************************
+
+TestEpochReclaimer::TestEpochReclaimer() :
+   poivre::TestSuite("TestEpochReclaimer") {
+}
+
+//******************************************************************************
+
+void TestEpochReclaimer::runTests() {
+   testFreedWithoutReaders();
+   testHeldByReader();
+   testLaterReaderDoesntHold();
+   testNestedGuards();
+   testClear();
+   testConcurrentPublishing();
+}
+
+//******************************************************************************
+
+void TestEpochReclaimer::testFreedWithoutReaders() {
+   TEST_CASE("testFreedWithoutReaders");
+
+   EpochReclaimer reclaimer;
+   shared_ptr<Published> object = make_shared<Published>(1);
+   weak_ptr<Published> watch = object;
+
+   reclaimer.retire(std::move(object));
+   require(watch.expired(), "freed at once");
+   requireIntEquals(0, (int) reclaimer.getRetiredCount(), "nothing retired");
+}
+
+//******************************************************************************
+
+void TestEpochReclaimer::testHeldByReader() {
+   TEST_CASE("testHeldByReader");
+
+   EpochReclaimer reclaimer;
+   shared_ptr<Published> object = make_shared<Published>(1);
+   weak_ptr<Published> watch = object;
+
+   {
+      EpochReclaimer::ReadGuard guard;
+      reclaimer.retire(std::move(object));
+      requireFalse(watch.expired(), "kept while a reader may hold it");
+      requireIntEquals(1, (int) reclaimer.getRetiredCount(), "retired");
+
+      reclaimer.reclaim();
+      requireFalse(watch.expired(), "still kept");
+   }
+
+   reclaimer.reclaim();
+   require(watch.expired(), "freed once the reader is done");
+
+   // a reader on another thread holds it just the same
+   object = make_shared<Published>(2);
+   watch = object;
+   promise<void> entered;
+   promise<void> leave;
+   shared_future<void> leaveSignal = leave.get_future().share();
+   thread reader([&entered, leaveSignal]() {
+      EpochReclaimer::ReadGuard guard;
+      entered.set_value();
+      leaveSignal.wait();
+   });
+
+   entered.get_future().wait();
+   reclaimer.retire(std::move(object));
+   requireFalse(watch.expired(), "kept for the other thread");
+
+   leave.set_value();
+   reader.join();
+   reclaimer.reclaim();
+   require(watch.expired(), "freed once the other thread is done");
+}
+
+//******************************************************************************
+
+void TestEpochReclaimer::testLaterReaderDoesntHold() {
+   TEST_CASE("testLaterReaderDoesntHold");
+
+   EpochReclaimer reclaimer;
+   shared_ptr<Published> object = make_shared<Published>(1);
+   weak_ptr<Published> watch = object;
+
+   {
+      EpochReclaimer::ReadGuard guard;
+      reclaimer.retire(std::move(object));
+   }
+
+   // entered after the retire, so it can't have found the object
+   promise<void> entered;
+   promise<void> leave;
+   shared_future<void> leaveSignal = leave.get_future().share();
+   thread reader([&entered, leaveSignal]() {
+      EpochReclaimer::ReadGuard guard;
+      entered.set_value();
+      leaveSignal.wait();
+   });
+
+   entered.get_future().wait();
+   reclaimer.reclaim();
+   require(watch.expired(), "not held by a later reader");
+
+   leave.set_value();
+   reader.join();
+}
+
+//******************************************************************************
+
+void TestEpochReclaimer::testNestedGuards() {
+   TEST_CASE("testNestedGuards");
+
+   EpochReclaimer reclaimer;
+   shared_ptr<Published> object = make_shared<Published>(1);
+   weak_ptr<Published> watch = object;
+
+   {
+      EpochReclaimer::ReadGuard outer;
+      {
+         EpochReclaimer::ReadGuard inner;
+         reclaimer.retire(std::move(object));
+      }
+
+      reclaimer.reclaim();
+      requireFalse(watch.expired(), "the outer guard still reads");
+   }
+
+   reclaimer.reclaim();
+   require(watch.expired(), "freed after the outer guard");
+}
+
+//******************************************************************************
+
+void TestEpochReclaimer::testClear() {
+   TEST_CASE("testClear");
+
+   weak_ptr<Published> watch;
+   {
+      EpochReclaimer reclaimer;
+      EpochReclaimer::ReadGuard guard;
+      shared_ptr<Published> object = make_shared<Published>(1);
+      watch = object;
+      reclaimer.retire(std::move(object));
+      requireFalse(watch.expired(), "kept");
+
+      reclaimer.clear();
+      require(watch.expired(), "clear frees regardless");
+
+      object = make_shared<Published>(2);
+      watch = object;
+      reclaimer.retire(std::move(object));
+   }
+
+   require(watch.expired(), "destructor frees regardless");
+}
+
+//******************************************************************************
+
+void TestEpochReclaimer::testConcurrentPublishing() {
+   TEST_CASE("testConcurrentPublishing");
+
+   const int READER_COUNT = 4;
+   const int PUBLISH_COUNT = 20000;
+
+   EpochReclaimer reclaimer;
+   atomic<const Published*> current(new Published(0));
+   atomic<bool> isDone(false);
+   atomic<int> badReads(0);
+
+   vector<thread> readers;
+   for (int i = 0; i < READER_COUNT; ++i) {
+      readers.emplace_back([&current, &isDone, &badReads]() {
+         while (!isDone.load()) {
+            EpochReclaimer::ReadGuard guard;
+            const Published* published = current.load();
+            // reading twice gives a freeing writer time to get in between
+            const int value = published->value;
+            if ((published->state != LIVE) || (published->value != value)) {
+               ++badReads;
+            }
+         }
+      });
+   }
+
+   for (int i = 1; i <= PUBLISH_COUNT; ++i) {
+      shared_ptr<const Published> previous(current.exchange(new Published(i)));
+      reclaimer.retire(std::move(previous));
+   }
+
+   isDone.store(true);
+   for (thread& reader : readers) {
+      reader.join();
+   }
+
+   reclaimer.reclaim();
+   requireIntEquals(0, badReads.load(), "never read a freed object");
+   requireIntEquals(0, (int) reclaimer.getRetiredCount(), "all freed in the end");
+   delete current.load();
+}
+
+//******************************************************************************
@@ -0,0 +1,30 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef MISERE_TESTEPOCHRECLAIMER_H
+#define MISERE_TESTEPOCHRECLAIMER_H
+
+#include "TestSuite.h"
+
+namespace misere {
+
+class TestEpochReclaimer : public poivre::TestSuite {
+
+protected:
+   void runTests();
+
+   void testFreedWithoutReaders();
+   void testHeldByReader();
+   void testLaterReaderDoesntHold();
+   void testNestedGuards();
+   void testClear();
+   void testConcurrentPublishing();
+
+public:
+   TestEpochReclaimer();
+
+};
+
+}
+
+#endif
@@ -0,0 +1,156 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include <zlib.h>
+
+#include <string>
+
+#include "TestGzipCompressor.h"
+#include "GzipCompressor.h"
+
+using namespace std;
+using namespace misere;
+
+namespace {
+
+// gzip-decodes (window bits 15 + 16) the whole of the input
+bool gunzip(const string& input, string& output) {
+   z_stream stream = {};
+   if (inflateInit2(&stream, 15 + 16) != Z_OK) {
+      return false;
+   }
+
+   stream.next_in = (Bytef*) input.data();
+   stream.avail_in = (uInt) input.size();
+
+   char buffer[4096];
+   int rc = Z_OK;
+   output.clear();
+   while (rc == Z_OK) {
+      stream.next_out = (Bytef*) buffer;
+      stream.avail_out = sizeof(buffer);
+      rc = inflate(&stream, Z_NO_FLUSH);
+      output.append(buffer, sizeof(buffer) - stream.avail_out);
+   }
+
+   inflateEnd(&stream);
+   return (rc == Z_STREAM_END) && (stream.avail_in == 0);
+}
+
+string repeated(const string& s, int count) {
+   string result;
+   for (int i = 0; i < count; ++i) {
+      result += s;
+   }
+   return result;
+}
+
+}
+
+//******************************************************************************
+
+TestGzipCompressor::TestGzipCompressor() :
+   poivre::TestSuite("TestGzipCompressor") {
+}
+
+//******************************************************************************
+
+void TestGzipCompressor::runTests() {
+   testRoundTrip();
+   testReuse();
+   testEmptyInput();
+   testSetLevel();
+}
+
+//******************************************************************************
+
+void TestGzipCompressor::testRoundTrip() {
+   TEST_CASE("testRoundTrip");
+
+   const string text = repeated("<p>The quick brown fox jumps over the lazy dog.</p>\n", 100);
+
+   GzipCompressor compressor;
+   string compressed;
+   require(compressor.compress(text.data(), text.size(), compressed), "compress");
+   require(compressed.size() < text.size(), "repetitive text should shrink");
+   require((compressed.size() > 2) &&
+           ((unsigned char) compressed[0] == 0x1f) &&
+           ((unsigned char) compressed[1] == 0x8b), "gzip magic bytes");
+
+   string decompressed;
+   require(gunzip(compressed, decompressed), "gunzip");
+   requireStringEquals(text, decompressed, "round trip");
+}
+
+//******************************************************************************
+
+void TestGzipCompressor::testReuse() {
+   TEST_CASE("testReuse");
+
+   const string first = repeated("body { margin: 0; padding: 0; }\n", 50);
+   const string second = repeated("{\"id\": 42, \"name\": \"misere\"}\n", 80);
+
+   GzipCompressor compressor(9);
+   string compressed;
+   string decompressed;
+
+   require(compressor.compress(first.data(), first.size(), compressed), "compress first");
+   require(gunzip(compressed, decompressed), "gunzip first");
+   requireStringEquals(first, decompressed, "first round trip");
+
+   // the stream is reset, not carried over into the second output
+   require(compressor.compress(second.data(), second.size(), compressed), "compress second");
+   require(gunzip(compressed, decompressed), "gunzip second");
+   requireStringEquals(second, decompressed, "second round trip");
+}
+
+//******************************************************************************
+
+void TestGzipCompressor::testEmptyInput() {
+   TEST_CASE("testEmptyInput");
+
+   GzipCompressor compressor;
+   string compressed = "stale";
+   require(compressor.compress("", 0, compressed), "compress empty");
+
+   string decompressed = "stale";
+   require(gunzip(compressed, decompressed), "gunzip empty");
+   require(decompressed.empty(), "empty round trip");
+}
+
+//******************************************************************************
+
+void TestGzipCompressor::testSetLevel() {
+   TEST_CASE("testSetLevel");
+
+   string text;
+   for (int i = 0; i < 400; ++i) {
+      text += "<li id=\"item-" + to_string(i * 7919 % 1000) + "\">row " +
+              to_string(i) + "</li>\n";
+   }
+
+   GzipCompressor fastest(GzipCompressor::MIN_LEVEL);
+   GzipCompressor smallest(GzipCompressor::MAX_LEVEL);
+   string expectedFastest;
+   string expectedSmallest;
+   require(fastest.compress(text.data(), text.size(), expectedFastest), "compress fastest");
+   require(smallest.compress(text.data(), text.size(), expectedSmallest), "compress smallest");
+   require(expectedFastest != expectedSmallest, "levels give different output");
+
+   // one compressor switched between levels matches one made at each
+   GzipCompressor compressor(GzipCompressor::MIN_LEVEL);
+   string compressed;
+   require(compressor.setLevel(GzipCompressor::MAX_LEVEL), "raise level");
+   require(compressor.compress(text.data(), text.size(), compressed), "compress at new level");
+   require(compressed == expectedSmallest, "new level used");
+
+   require(compressor.setLevel(GzipCompressor::MIN_LEVEL), "lower level");
+   require(compressor.compress(text.data(), text.size(), compressed), "compress at old level");
+   require(compressed == expectedFastest, "old level used again");
+
+   requireFalse(compressor.setLevel(GzipCompressor::MAX_LEVEL + 1), "invalid level refused");
+   require(compressor.compress(text.data(), text.size(), compressed), "still usable");
+   require(compressed == expectedFastest, "level unchanged");
+}
+
+//******************************************************************************
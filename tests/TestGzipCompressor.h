@@ -0,0 +1,28 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef MISERE_TESTGZIPCOMPRESSOR_H
+#define MISERE_TESTGZIPCOMPRESSOR_H
+
+#include "TestSuite.h"
+
+namespace misere {
+
+class TestGzipCompressor : public poivre::TestSuite {
+
+protected:
+   void runTests();
+
+   void testRoundTrip();
+   void testReuse();
+   void testEmptyInput();
+   void testSetLevel();
+
+public:
+   TestGzipCompressor();
+
+};
+
+}
+
+#endif
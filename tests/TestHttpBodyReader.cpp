@@ -0,0 +1,298 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include <string>
+
+#include "TestHttpBodyReader.h"
+#include "HttpBodyReader.h"
+#include "ByteConnection.h"
+
+using namespace std;
+using namespace misere;
+
+namespace {
+
+// hands out scripted bytes, at most maxRead per read() call
+class ScriptedConnection : public ByteConnection
+{
+   public:
+      ScriptedConnection(const string& bytes, int maxRead) :
+         m_bytes(bytes),
+         m_offset(0),
+         m_maxRead(maxRead) {
+      }
+
+      virtual int read(char* buffer, int bufferSize) {
+         int count = (int) (m_bytes.size() - m_offset);
+         if (count > bufferSize) {
+            count = bufferSize;
+         }
+         if (count > m_maxRead) {
+            count = m_maxRead;
+         }
+         m_bytes.copy(buffer, count, m_offset);
+         m_offset += count;
+         return count;
+      }
+
+      virtual bool write(const char*, std::size_t) {
+         return false;
+      }
+
+      virtual void close() {
+      }
+
+   private:
+      string m_bytes;
+      std::size_t m_offset;
+      int m_maxRead;
+};
+
+string readAll(HttpBodyReader& reader, int readSize, bool& failed) {
+   string body;
+   char buffer[64];
+   int bytesRead;
+   while ((bytesRead = reader.read(buffer, readSize)) > 0) {
+      body.append(buffer, bytesRead);
+   }
+   failed = (bytesRead < 0);
+   return body;
+}
+
+}
+
+//******************************************************************************
+
+TestHttpBodyReader::TestHttpBodyReader() :
+   poivre::TestSuite("TestHttpBodyReader") {
+}
+
+//******************************************************************************
+
+void TestHttpBodyReader::runTests() {
+   testContentLength();
+   testChunked();
+   testChunkedSplitAcrossReads();
+   testChunkExtensionsAndTrailers();
+   testUnconsumedBytesAfterBody();
+   testMalformedChunkSize();
+   testTruncatedBody();
+   testSkipRemaining();
+   testGetChunkedBodyLength();
+   testGetChunkedBodyLengthResumes();
+   testIsBuffered();
+}
+
+//******************************************************************************
+
+void TestHttpBodyReader::testContentLength() {
+   TEST_CASE("testContentLength");
+
+   ScriptedConnection connection("lo, world", 4);
+   HttpBodyReader reader(&connection, 12, "hel");
+   bool failed;
+   requireStringEquals("hello, world", readAll(reader, 64, failed), "buffered bytes then connection");
+   requireFalse(failed, "read should succeed");
+   require(reader.isComplete(), "body complete");
+   requireFalse(reader.isChunked(), "not chunked");
+   require(reader.getBytesRead() == 12, "bytes read");
+
+   HttpBodyReader empty(nullptr, 0, "");
+   require(empty.isComplete(), "zero-length body is complete at once");
+}
+
+//******************************************************************************
+
+void TestHttpBodyReader::testChunked() {
+   TEST_CASE("testChunked");
+
+   HttpBodyReader reader(nullptr, HttpBodyReader::CHUNKED,
+                         "5\r\nhello\r\n7\r\n, world\r\n0\r\n\r\n");
+   bool failed;
+   requireStringEquals("hello, world", readAll(reader, 64, failed), "decoded body");
+   requireFalse(failed, "read should succeed");
+   require(reader.isComplete(), "body complete");
+   require(reader.isChunked(), "chunked");
+   require(reader.getBytesRead() == 12, "framing isn't counted");
+}
+
+//******************************************************************************
+
+void TestHttpBodyReader::testChunkedSplitAcrossReads() {
+   TEST_CASE("testChunkedSplitAcrossReads");
+
+   const string body = "a\r\n0123456789\r\n1A\r\nabcdefghijklmnopqrstuvwxyz\r\n0\r\n\r\n";
+
+   // one byte per read() and small caller buffers
+   ScriptedConnection connection(body.substr(2), 1);
+   HttpBodyReader reader(&connection, HttpBodyReader::CHUNKED, body.substr(0, 2));
+   bool failed;
+   requireStringEquals("0123456789abcdefghijklmnopqrstuvwxyz",
+                       readAll(reader, 3, failed), "decoded body");
+   requireFalse(failed, "read should succeed");
+   require(reader.isComplete(), "body complete");
+}
+
+//******************************************************************************
+
+void TestHttpBodyReader::testChunkExtensionsAndTrailers() {
+   TEST_CASE("testChunkExtensionsAndTrailers");
+
+   HttpBodyReader reader(nullptr, HttpBodyReader::CHUNKED,
+                         "4;name=value\r\nwiki\r\n5 ; x\r\npedia\r\n0\r\n"
+                         "Expires: never\r\nX-Checksum: 1\r\n\r\n");
+   bool failed;
+   requireStringEquals("wikipedia", readAll(reader, 64, failed), "extensions ignored");
+   requireFalse(failed, "read should succeed");
+   require(reader.isComplete(), "trailers read past");
+}
+
+//******************************************************************************
+
+void TestHttpBodyReader::testUnconsumedBytesAfterBody() {
+   TEST_CASE("testUnconsumedBytesAfterBody");
+
+   const string next = "GET /next HTTP/1.1\r\n\r\n";
+   HttpBodyReader reader(nullptr, HttpBodyReader::CHUNKED,
+                         "3\r\nabc\r\n0\r\n\r\n" + next);
+
+   requireStringEquals("", reader.takeUnconsumedBytes(), "nothing before the body is read");
+
+   bool failed;
+   requireStringEquals("abc", readAll(reader, 64, failed), "decoded body");
+   requireStringEquals(next, reader.takeUnconsumedBytes(), "next request handed back");
+   requireStringEquals("", reader.takeUnconsumedBytes(), "taken only once");
+}
+
+//******************************************************************************
+
+void TestHttpBodyReader::testMalformedChunkSize() {
+   TEST_CASE("testMalformedChunkSize");
+
+   bool failed;
+
+   HttpBodyReader notHex(nullptr, HttpBodyReader::CHUNKED, "xyz\r\nabc\r\n0\r\n\r\n");
+   readAll(notHex, 64, failed);
+   require(failed, "non-hex chunk size");
+   require(notHex.hasFailed(), "reader failed");
+
+   HttpBodyReader tooBig(nullptr, HttpBodyReader::CHUNKED, "10000000000000000\r\n");
+   readAll(tooBig, 64, failed);
+   require(failed, "chunk size too large");
+
+   HttpBodyReader missingEol(nullptr, HttpBodyReader::CHUNKED, "3\r\nabcX\r\n0\r\n\r\n");
+   readAll(missingEol, 64, failed);
+   require(failed, "chunk data not followed by CRLF");
+}
+
+//******************************************************************************
+
+void TestHttpBodyReader::testTruncatedBody() {
+   TEST_CASE("testTruncatedBody");
+
+   bool failed;
+
+   ScriptedConnection chunkedConnection("lo", 64);
+   HttpBodyReader chunked(&chunkedConnection, HttpBodyReader::CHUNKED, "5\r\nhel");
+   readAll(chunked, 64, failed);
+   require(failed, "connection closed inside a chunk");
+   requireFalse(chunked.isComplete(), "body not complete");
+
+   ScriptedConnection fixedConnection("abc", 64);
+   HttpBodyReader fixed(&fixedConnection, 10, "");
+   readAll(fixed, 64, failed);
+   require(failed, "connection closed before content length");
+}
+
+//******************************************************************************
+
+void TestHttpBodyReader::testSkipRemaining() {
+   TEST_CASE("testSkipRemaining");
+
+   ScriptedConnection connection("0123456789\r\n0\r\n\r\nNEXT", 64);
+   HttpBodyReader reader(&connection, HttpBodyReader::CHUNKED, "a\r\n");
+
+   char buffer[4];
+   require(reader.read(buffer, sizeof(buffer)) == 4, "partial read");
+   require(reader.skipRemaining(), "rest skipped");
+   require(reader.isComplete(), "body complete");
+   requireStringEquals("NEXT", reader.takeUnconsumedBytes(), "bytes after the body kept");
+}
+
+//******************************************************************************
+
+void TestHttpBodyReader::testGetChunkedBodyLength() {
+   TEST_CASE("testGetChunkedBodyLength");
+
+   const string body = "5\r\nhello\r\n0\r\nTrailer: x\r\n\r\n";
+   const string input = body + "GET / HTTP/1.1\r\n";
+   require(HttpBodyReader::getChunkedBodyLength(input.data(), input.size()) == (long) body.size(),
+           "length of the complete body");
+
+   for (std::size_t length = 0; length < body.size(); ++length) {
+      require(HttpBodyReader::getChunkedBodyLength(body.data(), length) == HttpBodyReader::INCOMPLETE,
+              "every prefix is incomplete");
+   }
+
+   const string malformed = "5\r\nhelloXX0\r\n\r\n";
+   require(HttpBodyReader::getChunkedBodyLength(malformed.data(), malformed.size()) == HttpBodyReader::MALFORMED,
+           "missing CRLF after chunk data");
+
+   const string longLine(HttpBodyReader::MAX_LINE_LENGTH + 1, '1');
+   require(HttpBodyReader::getChunkedBodyLength(longLine.data(), longLine.size()) == HttpBodyReader::MALFORMED,
+           "unterminated size line too long");
+}
+
+//******************************************************************************
+
+void TestHttpBodyReader::testGetChunkedBodyLengthResumes() {
+   TEST_CASE("testGetChunkedBodyLengthResumes");
+
+   const string body = "5\r\nhello\r\n3\r\nabc\r\n0\r\nTrailer: x\r\n\r\n";
+
+   // the body arriving a byte at a time gives the same answers as
+   // scanning each prefix from the start
+   HttpBodyReader::ChunkScan scan;
+   for (std::size_t length = 0; length < body.size(); ++length) {
+      require(HttpBodyReader::getChunkedBodyLength(body.data(), length, scan) == HttpBodyReader::INCOMPLETE,
+              "every prefix is incomplete");
+   }
+   require(HttpBodyReader::getChunkedBodyLength(body.data(), body.size(), scan) == (long) body.size(),
+           "length of the complete body");
+
+   // chunks already scanned aren't looked at again: damaging the first
+   // one after it has been seen doesn't change the result
+   string input = "5\r\nhello\r\n3\r\nab";
+   scan.reset();
+   require(HttpBodyReader::getChunkedBodyLength(input.data(), input.size(), scan) == HttpBodyReader::INCOMPLETE,
+           "second chunk incomplete");
+   input[0] = 'X';
+   input += "c\r\n0\r\n\r\n";
+   require(HttpBodyReader::getChunkedBodyLength(input.data(), input.size(), scan) == (long) input.size(),
+           "scan resumed after the first chunk");
+}
+
+//******************************************************************************
+
+void TestHttpBodyReader::testIsBuffered() {
+   TEST_CASE("testIsBuffered");
+
+   HttpBodyReader partial(nullptr, 10, "hello");
+   requireFalse(partial.isBuffered(), "half of a known length");
+
+   HttpBodyReader whole(nullptr, 5, "helloNEXT");
+   require(whole.isBuffered(), "all of a known length");
+
+   HttpBodyReader chunked(nullptr, HttpBodyReader::CHUNKED, "5\r\nhello\r\n0\r\n\r\n");
+   require(chunked.isBuffered(), "complete chunked body");
+
+   // part way through the first chunk, the rest of it still counts
+   char buffer[2];
+   require(chunked.read(buffer, sizeof(buffer)) == 2, "read part of the chunk");
+   require(chunked.isBuffered(), "rest of the chunked body");
+
+   HttpBodyReader unfinished(nullptr, HttpBodyReader::CHUNKED, "5\r\nhello\r\n3\r\nab");
+   requireFalse(unfinished.isBuffered(), "second chunk incomplete");
+}
+
+//******************************************************************************
@@ -0,0 +1,35 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef MISERE_TESTHTTPBODYREADER_H
+#define MISERE_TESTHTTPBODYREADER_H
+
+#include "TestSuite.h"
+
+namespace misere {
+
+class TestHttpBodyReader : public poivre::TestSuite {
+
+protected:
+   void runTests();
+
+   void testContentLength();
+   void testChunked();
+   void testChunkedSplitAcrossReads();
+   void testChunkExtensionsAndTrailers();
+   void testUnconsumedBytesAfterBody();
+   void testMalformedChunkSize();
+   void testTruncatedBody();
+   void testSkipRemaining();
+   void testGetChunkedBodyLength();
+   void testGetChunkedBodyLengthResumes();
+   void testIsBuffered();
+
+public:
+   TestHttpBodyReader();
+
+};
+
+}
+
+#endif
@@ -0,0 +1,364 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include <string>
+
+#include "TestHttpConditional.h"
+#include "HttpConditional.h"
+#include "AbstractHandler.h"
+#include "ByteConnection.h"
+#include "HttpRequest.h"
+#include "HttpRequestHandler.h"
+#include "HttpResponse.h"
+#include "HttpServer.h"
+#include "SocketConnection.h"
+#include "MockSocket.h"
+#include "KeyValuePairs.h"
+
+using namespace std;
+using namespace misere;
+
+namespace {
+
+// not otherwise used by the tests - the server is never run
+const int PORT = 34581;
+
+// Sun, 06 Nov 1994 08:49:37 GMT (the RFC 9110 example)
+const time_t EXAMPLE_TIME = 784111777;
+
+const string REPORT =
+   "{\"report\":\"quarterly\",\"rows\":["
+   "{\"region\":\"north\",\"total\":1200},{\"region\":\"south\",\"total\":1350},"
+   "{\"region\":\"east\",\"total\":990},{\"region\":\"west\",\"total\":1410},"
+   "{\"region\":\"north\",\"total\":1200},{\"region\":\"south\",\"total\":1350},"
+   "{\"region\":\"east\",\"total\":990},{\"region\":\"west\",\"total\":1410}]}";
+
+class RecordingConnection : public ByteConnection
+{
+   public:
+      virtual int read(char*, int) {
+         return 0;
+      }
+
+      virtual bool write(const char* buffer, std::size_t length) {
+         bytes.append(buffer, length);
+         return true;
+      }
+
+      virtual bool writev(const Segment* segments, std::size_t count) {
+         for (std::size_t i = 0; i < count; ++i) {
+            bytes.append(segments[i].data, segments[i].length);
+         }
+         return true;
+      }
+
+      virtual void close() {
+      }
+
+      string bytes;
+};
+
+class ReportHandler : public AbstractHandler
+{
+   public:
+      virtual void serviceRequest(const HttpRequest& request,
+                                  HttpResponse& response) {
+         response.setContentType("application/json");
+         response.setLastModified(EXAMPLE_TIME);
+         response.setETagFromBody(true);
+         response.setBodyView(REPORT.data(), REPORT.size(), nullptr);
+      }
+};
+
+// a body deflate can't shrink, for a response that's left uncompressed
+// even though the client accepts gzip
+class NoiseHandler : public AbstractHandler
+{
+   public:
+      NoiseHandler() {
+         unsigned int state = 12345;
+         for (int i = 0; i < 512; ++i) {
+            state = state * 1103515245 + 12345;
+            noise += (char) (state >> 16);
+         }
+      }
+
+      virtual void serviceRequest(const HttpRequest& request,
+                                  HttpResponse& response) {
+         response.setContentType("application/json");
+         response.setETagFromBody(true);
+         response.setBodyView(noise.data(), noise.size(), nullptr);
+      }
+
+      string noise;
+};
+
+// serves a GET of the path with extra header lines through the server,
+// returning what was written
+string get(HttpServer& server, const string& path, const string& headerLines) {
+   MockSocket socket("GET " + path + " HTTP/1.1\r\nHost: localhost\r\n" +
+                     headerLines + "\r\n");
+   SocketConnection socketConnection(&socket, false);
+   HttpRequest request(&socketConnection, false);
+   RecordingConnection connection;
+   HttpRequestHandler::processRequest(server, request, connection, 1);
+   return connection.bytes;
+}
+
+bool isNotModified(const string& headerLines,
+                   const string& etag,
+                   const string& lastModified) {
+   MockSocket socket("GET /report HTTP/1.1\r\nHost: localhost\r\n" +
+                     headerLines + "\r\n");
+   SocketConnection socketConnection(&socket, false);
+   HttpRequest request(&socketConnection, false);
+   return HttpConditional::isNotModified(request, etag, lastModified);
+}
+
+// the value of a header field in a written response
+string headerValue(const string& response, const string& name) {
+   const string prefix = "\r\n" + name + ": ";
+   const string::size_type start = response.find(prefix);
+   if (start == string::npos) {
+      return string();
+   }
+   const string::size_type valueStart = start + prefix.size();
+   return response.substr(valueStart, response.find("\r\n", valueStart) - valueStart);
+}
+
+}
+
+//******************************************************************************
+
+TestHttpConditional::TestHttpConditional() :
+   poivre::TestSuite("TestHttpConditional") {
+}
+
+//******************************************************************************
+
+void TestHttpConditional::runTests() {
+   testHash();
+   testHashETag();
+   testWeakETag();
+   testMatchesIfNoneMatch();
+   testParseHttpDate();
+   testIsNotModified();
+   testNotModifiedResponse();
+   testCompressedETagIsWeak();
+   testUncompressedETagStaysStrong();
+}
+
+//******************************************************************************
+
+void TestHttpConditional::testHash() {
+   TEST_CASE("testHash");
+
+   // XXH64 reference values
+   require(HttpConditional::hash("", 0) == 0xEF46DB3751D8E999ULL, "empty");
+   require(HttpConditional::hash("abc", 3) == 0x44BC2CF5AD770999ULL, "short");
+
+   const string text = "0123456789abcdef0123456789abcdef0123";
+   require(HttpConditional::hash(text.data(), text.size()) == 0xC4255BA3D1AF5461ULL,
+           "long enough for the four lanes");
+   require(HttpConditional::hash(text.data(), text.size(), 7) !=
+           HttpConditional::hash(text.data(), text.size()),
+           "seed changes the hash");
+}
+
+//******************************************************************************
+
+void TestHttpConditional::testHashETag() {
+   TEST_CASE("testHashETag");
+
+   const string etag = HttpConditional::hashETag(REPORT.data(), REPORT.size());
+   requireIntEquals(18, (int) etag.size(), "16 hex digits, quoted");
+   require((etag.front() == '"') && (etag.back() == '"'), "quoted");
+   requireStringEquals(etag,
+                       HttpConditional::hashETag(REPORT.data(), REPORT.size()),
+                       "deterministic");
+   require(etag != HttpConditional::hashETag(REPORT.data(), REPORT.size() - 1),
+           "changes with the contents");
+   requireStringEquals("\"ef46db3751d8e999\"",
+                       HttpConditional::hashETag("", 0),
+                       "empty body");
+}
+
+//******************************************************************************
+
+void TestHttpConditional::testWeakETag() {
+   TEST_CASE("testWeakETag");
+
+   requireStringEquals("W/\"abc\"", HttpConditional::weakETag("\"abc\""), "strong");
+   requireStringEquals("W/\"abc\"", HttpConditional::weakETag("W/\"abc\""), "already weak");
+}
+
+//******************************************************************************
+
+void TestHttpConditional::testMatchesIfNoneMatch() {
+   TEST_CASE("testMatchesIfNoneMatch");
+
+   require(HttpConditional::matchesIfNoneMatch("\"abc\"", "\"abc\""), "same");
+   require(HttpConditional::matchesIfNoneMatch("W/\"abc\"", "\"abc\""), "weak request");
+   require(HttpConditional::matchesIfNoneMatch("\"abc\"", "W/\"abc\""), "weak response");
+   require(HttpConditional::matchesIfNoneMatch("\"x\", W/\"y\" ,\"abc\"", "\"abc\""),
+           "in a list");
+   require(HttpConditional::matchesIfNoneMatch("\"a,b\", \"abc\"", "\"abc\""),
+           "comma inside a tag");
+   require(HttpConditional::matchesIfNoneMatch("*", "\"abc\""), "any");
+   requireFalse(HttpConditional::matchesIfNoneMatch("*", ""), "any, but none");
+   requireFalse(HttpConditional::matchesIfNoneMatch("\"abcd\"", "\"abc\""), "different");
+   requireFalse(HttpConditional::matchesIfNoneMatch("abc", "\"abc\""), "unquoted");
+   requireFalse(HttpConditional::matchesIfNoneMatch("\"abc", "\"abc\""), "unterminated");
+   requireFalse(HttpConditional::matchesIfNoneMatch("", "\"abc\""), "empty");
+}
+
+//******************************************************************************
+
+void TestHttpConditional::testParseHttpDate() {
+   TEST_CASE("testParseHttpDate");
+
+   time_t time = 0;
+   require(HttpConditional::parseHttpDate("Sun, 06 Nov 1994 08:49:37 GMT", time),
+           "IMF-fixdate");
+   require(time == EXAMPLE_TIME, "IMF-fixdate time");
+
+   time = 0;
+   require(HttpConditional::parseHttpDate("Sunday, 06-Nov-94 08:49:37 GMT", time),
+           "RFC 850");
+   require(time == EXAMPLE_TIME, "RFC 850 time");
+
+   time = 0;
+   require(HttpConditional::parseHttpDate("Sun Nov  6 08:49:37 1994", time),
+           "asctime");
+   require(time == EXAMPLE_TIME, "asctime time");
+
+   requireFalse(HttpConditional::parseHttpDate("", time), "empty");
+   requireFalse(HttpConditional::parseHttpDate("yesterday", time), "not a date");
+   requireFalse(HttpConditional::parseHttpDate("Sun, 06 Nov 1994 08:49:37 GMT junk", time),
+                "trailing text");
+}
+
+//******************************************************************************
+
+void TestHttpConditional::testIsNotModified() {
+   TEST_CASE("testIsNotModified");
+
+   const string etag = "\"abc\"";
+   const string lastModified = "Sun, 06 Nov 1994 08:49:37 GMT";
+
+   requireFalse(isNotModified("", etag, lastModified), "unconditional");
+   require(isNotModified("If-None-Match: \"abc\"\r\n", etag, lastModified),
+           "ETag matches");
+   requireFalse(isNotModified("If-None-Match: \"xyz\"\r\n", etag, lastModified),
+                "ETag differs");
+   require(isNotModified("If-Modified-Since: Sun, 06 Nov 1994 08:49:37 GMT\r\n",
+                         etag, lastModified),
+           "not modified since");
+   require(isNotModified("If-Modified-Since: Mon, 07 Nov 1994 00:00:00 GMT\r\n",
+                         etag, lastModified),
+           "not modified since a later time");
+   requireFalse(isNotModified("If-Modified-Since: Sat, 05 Nov 1994 00:00:00 GMT\r\n",
+                              etag, lastModified),
+                "modified since");
+   requireFalse(isNotModified("If-Modified-Since: garbage\r\n", etag, lastModified),
+                "unparseable date");
+   requireFalse(isNotModified("If-Modified-Since: Sun, 06 Nov 1994 08:49:37 GMT\r\n",
+                              etag, ""),
+                "no Last-Modified");
+   requireFalse(isNotModified("If-None-Match: \"xyz\"\r\n"
+                              "If-Modified-Since: Sun, 06 Nov 1994 08:49:37 GMT\r\n",
+                              etag, lastModified),
+                "If-None-Match takes precedence");
+}
+
+//******************************************************************************
+
+void TestHttpConditional::testNotModifiedResponse() {
+   TEST_CASE("testNotModifiedResponse");
+
+   HttpServer server(PORT);
+   require(server.addPathHandler("/report", new ReportHandler), "add handler");
+
+   const string full = get(server, "/report", "");
+   require(full.find("200") != string::npos, "status");
+   const string etag = headerValue(full, "ETag");
+   requireStringEquals(HttpConditional::hashETag(REPORT.data(), REPORT.size()),
+                       etag,
+                       "ETag hashed from the body");
+   requireStringEquals("Sun, 06 Nov 1994 08:49:37 GMT",
+                       headerValue(full, "Last-Modified"),
+                       "Last-Modified");
+
+   const string revalidated = get(server, "/report", "If-None-Match: " + etag + "\r\n");
+   require(revalidated.find("304 Not Modified") != string::npos, "304");
+   requireStringEquals(etag, headerValue(revalidated, "ETag"), "304 carries the ETag");
+   require(revalidated.find("Content-Length") == string::npos, "no Content-Length");
+   require(revalidated.find("Content-Type") == string::npos, "no Content-Type");
+   requireStringEquals("\r\n\r\n",
+                       revalidated.substr(revalidated.size() - 4),
+                       "no body");
+
+   const string since = get(server,
+                            "/report",
+                            "If-Modified-Since: Sun, 06 Nov 1994 08:49:37 GMT\r\n");
+   require(since.find("304 Not Modified") != string::npos, "304 by date");
+
+   const string changed = get(server, "/report", "If-None-Match: \"0000\"\r\n");
+   require(changed.find("200") != string::npos, "stale copy gets the body");
+   require(changed.find(REPORT) != string::npos, "body");
+}
+
+//******************************************************************************
+
+void TestHttpConditional::testCompressedETagIsWeak() {
+   TEST_CASE("testCompressedETagIsWeak");
+
+   HttpServer server(PORT);
+   chaudiere::KeyValuePairs kvp;
+   kvp.addPair("compression", "true");
+   kvp.addPair("compression_encodings", "gzip");
+   kvp.addPair("compression_mime_types", "application/json");
+   kvp.addPair("compression_min_size", "32");
+   server.setupCompression(kvp);
+   require(server.addPathHandler("/report", new ReportHandler), "add handler");
+
+   const string compressed = get(server, "/report", "Accept-Encoding: gzip\r\n");
+   requireStringEquals("gzip", headerValue(compressed, "Content-Encoding"), "compressed");
+   const string etag = headerValue(compressed, "ETag");
+   requireStringEquals(HttpConditional::weakETag(
+                          HttpConditional::hashETag(REPORT.data(), REPORT.size())),
+                       etag,
+                       "weak ETag for the compressed body");
+
+   const string revalidated = get(server,
+                                  "/report",
+                                  "Accept-Encoding: gzip\r\nIf-None-Match: " + etag + "\r\n");
+   require(revalidated.find("304 Not Modified") != string::npos, "304");
+   require(revalidated.find("Content-Encoding") == string::npos,
+           "no Content-Encoding on a 304");
+}
+
+//******************************************************************************
+
+void TestHttpConditional::testUncompressedETagStaysStrong() {
+   TEST_CASE("testUncompressedETagStaysStrong");
+
+   HttpServer server(PORT);
+   chaudiere::KeyValuePairs kvp;
+   kvp.addPair("compression", "true");
+   kvp.addPair("compression_encodings", "gzip");
+   kvp.addPair("compression_mime_types", "application/json");
+   kvp.addPair("compression_min_size", "32");
+   server.setupCompression(kvp);
+   NoiseHandler* handler = new NoiseHandler;
+   require(server.addPathHandler("/noise", handler), "add handler");
+
+   // gzip is negotiated, but the body goes out as it is
+   const string response = get(server, "/noise", "Accept-Encoding: gzip\r\n");
+   require(response.find("Content-Encoding") == string::npos, "not compressed");
+   requireStringEquals(HttpConditional::hashETag(handler->noise.data(), handler->noise.size()),
+                       headerValue(response, "ETag"),
+                       "strong ETag for the unchanged body");
+}
+
+//******************************************************************************
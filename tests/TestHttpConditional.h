@@ -0,0 +1,33 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef MISERE_TESTHTTPCONDITIONAL_H
+#define MISERE_TESTHTTPCONDITIONAL_H
+
+#include "TestSuite.h"
+
+namespace misere {
+
+class TestHttpConditional : public poivre::TestSuite {
+
+protected:
+   void runTests();
+
+   void testHash();
+   void testHashETag();
+   void testWeakETag();
+   void testMatchesIfNoneMatch();
+   void testParseHttpDate();
+   void testIsNotModified();
+   void testNotModifiedResponse();
+   void testCompressedETagIsWeak();
+   void testUncompressedETagStaysStrong();
+
+public:
+   TestHttpConditional();
+
+};
+
+}
+
+#endif
@@ -0,0 +1,176 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include <stdexcept>
+#include <string>
+
+#include "TestHttpConnectionArena.h"
+#include "HttpConnectionArena.h"
+#include "HttpHeaderParser.h"
+#include "HttpHeaders.h"
+#include "HttpResponse.h"
+
+using namespace std;
+using namespace misere;
+
+//******************************************************************************
+
+TestHttpConnectionArena::TestHttpConnectionArena() :
+   poivre::TestSuite("TestHttpConnectionArena") {
+}
+
+//******************************************************************************
+
+void TestHttpConnectionArena::runTests() {
+   testResetRewindsResource();
+   testReadBufferReused();
+   testLargeReadBufferNotRetained();
+   testParserAllocatesFromArena();
+   testResponseHeadersAllocateFromArena();
+   testResetGuard();
+}
+
+//******************************************************************************
+
+void TestHttpConnectionArena::testResetRewindsResource() {
+   TEST_CASE("testResetRewindsResource");
+
+   HttpConnectionArena arena;
+   std::pmr::memory_resource* resource = arena.getResource();
+
+   void* first = resource->allocate(64);
+   void* second = resource->allocate(64);
+   require(first != second, "allocations between resets are distinct");
+
+   // more than the initial block holds
+   void* large = resource->allocate(HttpConnectionArena::INITIAL_BLOCK_SIZE * 2);
+   require(large != nullptr, "allocation beyond the initial block");
+
+   arena.reset();
+   void* afterReset = resource->allocate(64);
+   require(afterReset == first, "reset starts over at the initial block");
+}
+
+//******************************************************************************
+
+void TestHttpConnectionArena::testReadBufferReused() {
+   TEST_CASE("testReadBufferReused");
+
+   HttpConnectionArena arena;
+
+   string buffer = arena.takeReadBuffer();
+   require(buffer.empty(), "new buffer is empty");
+   require(buffer.capacity() >= HttpConnectionArena::READ_BUFFER_SIZE,
+           "new buffer has read capacity");
+
+   buffer.assign("GET / HTTP/1.1\r\n\r\n");
+   const char* storage = buffer.data();
+   arena.returnReadBuffer(std::move(buffer));
+
+   string again = arena.takeReadBuffer();
+   require(again.empty(), "reused buffer is empty");
+   require(again.data() == storage, "returned buffer is handed out again");
+
+   // the arena kept nothing back, so the next one is new
+   string other = arena.takeReadBuffer();
+   require(other.data() != storage, "a buffer is only handed out once");
+
+   // reset doesn't discard the spare buffer
+   arena.returnReadBuffer(std::move(again));
+   arena.reset();
+   require(arena.takeReadBuffer().data() == storage, "spare buffer survives reset");
+}
+
+//******************************************************************************
+
+void TestHttpConnectionArena::testLargeReadBufferNotRetained() {
+   TEST_CASE("testLargeReadBufferNotRetained");
+
+   HttpConnectionArena arena;
+
+   string large;
+   large.reserve(HttpConnectionArena::MAX_RETAINED_BUFFER_SIZE + 1);
+   const char* storage = large.data();
+   arena.returnReadBuffer(std::move(large));
+
+   string buffer = arena.takeReadBuffer();
+   require(buffer.data() != storage, "oversized buffer isn't kept");
+   require(buffer.capacity() < HttpConnectionArena::MAX_RETAINED_BUFFER_SIZE,
+           "a normal-sized buffer is handed out instead");
+}
+
+//******************************************************************************
+
+void TestHttpConnectionArena::testParserAllocatesFromArena() {
+   TEST_CASE("testParserAllocatesFromArena");
+
+   HttpConnectionArena arena;
+   const string header =
+      "GET /index.html HTTP/1.1\r\n"
+      "Host: localhost\r\n"
+      "Accept: */*\r\n"
+      "\r\n";
+
+   {
+      HttpHeaderParser parser(arena.getResource());
+      require(parser.parse(header.data(), header.size()), "header parsed");
+      require(parser.getFields().size() == 2, "both fields parsed");
+      require(parser.getFields().get_allocator().resource() == arena.getResource(),
+              "field list allocates from the arena");
+   }
+
+   arena.reset();
+
+   HttpHeaderParser parser(arena.getResource());
+   require(parser.parse(header.data(), header.size()), "header parsed after reset");
+   requireStringEquals("localhost", string(parser.find("host")->value), "field value after reset");
+}
+
+//******************************************************************************
+
+void TestHttpConnectionArena::testResponseHeadersAllocateFromArena() {
+   TEST_CASE("testResponseHeadersAllocateFromArena");
+
+   HttpConnectionArena arena;
+   const string traceId = "00-0af7651916cd43dd8448eb211c80319c-b7ad6b7169203331-01";
+
+   HttpResponse response(arena.getResource());
+   require(response.getMemoryResource() == arena.getResource(),
+           "the response uses the arena's resource");
+   response.setHeaderValue("X-Trace-Id", traceId);
+
+   const std::pmr::string* value = response.getHeaders().find("x-trace-id");
+   require(value != nullptr, "header set");
+   requireStringEquals(traceId, string(*value), "header value");
+   require(value->get_allocator().resource() == arena.getResource(),
+           "header values allocate from the arena");
+
+   // a copy may outlive the arena, so it doesn't allocate from it
+   HttpHeaders copy(response.getHeaders());
+   require(copy.find("x-trace-id")->get_allocator().resource() ==
+              std::pmr::get_default_resource(),
+           "a copy allocates from the default resource");
+}
+
+//******************************************************************************
+
+void TestHttpConnectionArena::testResetGuard() {
+   TEST_CASE("testResetGuard");
+
+   HttpConnectionArena arena;
+   std::pmr::memory_resource* resource = arena.getResource();
+   void* first = nullptr;
+
+   try {
+      HttpConnectionArena::ResetGuard arenaReset(arena);
+      first = resource->allocate(64);
+      resource->allocate(64);
+      throw std::runtime_error("request failed");
+   } catch (const std::runtime_error&) {
+   }
+
+   require(resource->allocate(64) == first,
+           "the arena is reset even when the request throws");
+}
+
+//******************************************************************************
@@ -0,0 +1,30 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef MISERE_TESTHTTPCONNECTIONARENA_H
+#define MISERE_TESTHTTPCONNECTIONARENA_H
+
+#include "TestSuite.h"
+
+namespace misere {
+
+class TestHttpConnectionArena : public poivre::TestSuite {
+
+protected:
+   void runTests();
+
+   void testResetRewindsResource();
+   void testReadBufferReused();
+   void testLargeReadBufferNotRetained();
+   void testParserAllocatesFromArena();
+   void testResponseHeadersAllocateFromArena();
+   void testResetGuard();
+
+public:
+   TestHttpConnectionArena();
+
+};
+
+}
+
+#endif
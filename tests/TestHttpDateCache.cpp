@@ -0,0 +1,130 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include <chrono>
+#include <ctime>
+#include <string>
+#include <thread>
+
+#include "TestHttpDateCache.h"
+#include "HttpDateCache.h"
+
+using namespace std;
+using namespace misere;
+
+namespace {
+
+bool isDigit(char c) {
+   return (c >= '0') && (c <= '9');
+}
+
+// "Sun, 06 Nov 1994 08:49:37 GMT"
+bool looksLikeHttpDate(const string& s) {
+   return (s.size() == HttpDateCache::HTTP_DATE_LENGTH) &&
+          (s[3] == ',') && (s[4] == ' ') &&
+          isDigit(s[5]) && isDigit(s[6]) &&
+          isDigit(s[12]) && isDigit(s[15]) &&
+          (s[19] == ':') && (s[22] == ':') &&
+          (s.compare(25, 4, " GMT") == 0);
+}
+
+// "1994-11-06 03:49:37"
+bool looksLikeLocalDateTime(const string& s) {
+   return (s.size() == 19) && (s[4] == '-') && (s[7] == '-') &&
+          (s[10] == ' ') && (s[13] == ':') && (s[16] == ':');
+}
+
+}
+
+//******************************************************************************
+
+TestHttpDateCache::TestHttpDateCache() :
+   poivre::TestSuite("TestHttpDateCache") {
+}
+
+//******************************************************************************
+
+void TestHttpDateCache::runTests() {
+   testFormats();
+   testCopyHttpDate();
+   testFormatHttpDate();
+   testRefreshedWhenRunning();
+   testRefreshedOnDemandWhenStopped();
+}
+
+//******************************************************************************
+
+void TestHttpDateCache::testFormats() {
+   TEST_CASE("testFormats");
+
+   HttpDateCache cache;
+   const string httpDate = cache.getHttpDate();
+   require(looksLikeHttpDate(httpDate), "HTTP date should be IMF-fixdate: " + httpDate);
+
+   const string localDateTime = cache.getLocalDateTime();
+   require(looksLikeLocalDateTime(localDateTime), "local date/time format: " + localDateTime);
+
+   // same year as the clock says now (unless this runs across New Year)
+   const time_t now = ::time(nullptr);
+   struct tm gmt;
+   ::gmtime_r(&now, &gmt);
+   requireStringEquals(to_string(1900 + gmt.tm_year), httpDate.substr(12, 4), "year");
+}
+
+//******************************************************************************
+
+void TestHttpDateCache::testCopyHttpDate() {
+   TEST_CASE("testCopyHttpDate");
+
+   HttpDateCache cache;
+   char buffer[HttpDateCache::HTTP_DATE_LENGTH];
+   const size_t length = cache.copyHttpDate(buffer);
+   require(length == HttpDateCache::HTTP_DATE_LENGTH, "copy length");
+   require(looksLikeHttpDate(string(buffer, length)), "copied date format");
+}
+
+//******************************************************************************
+
+void TestHttpDateCache::testFormatHttpDate() {
+   TEST_CASE("testFormatHttpDate");
+
+   char buffer[HttpDateCache::HTTP_DATE_LENGTH + 1];
+   const size_t length = HttpDateCache::formatHttpDate(784111777, buffer);
+   require(length == HttpDateCache::HTTP_DATE_LENGTH, "format length");
+   requireStringEquals("Sun, 06 Nov 1994 08:49:37 GMT", string(buffer, length),
+                       "RFC 9110 example date");
+}
+
+//******************************************************************************
+
+void TestHttpDateCache::testRefreshedWhenRunning() {
+   TEST_CASE("testRefreshedWhenRunning");
+
+   HttpDateCache cache;
+   cache.start();
+   cache.start();  // second start is a no-op
+
+   const string first = cache.getHttpDate();
+   string latest = first;
+   for (int i = 0; (i < 30) && (latest == first); ++i) {
+      this_thread::sleep_for(chrono::milliseconds(100));
+      latest = cache.getHttpDate();
+   }
+
+   require(latest != first, "the refresh thread should advance the date within a few seconds");
+   cache.stop();
+}
+
+//******************************************************************************
+
+void TestHttpDateCache::testRefreshedOnDemandWhenStopped() {
+   TEST_CASE("testRefreshedOnDemandWhenStopped");
+
+   // never started - readers refresh it themselves
+   HttpDateCache cache;
+   const string first = cache.getLocalDateTime();
+   this_thread::sleep_for(chrono::milliseconds(1100));
+   require(cache.getLocalDateTime() != first, "a stopped cache should still not go stale");
+}
+
+//******************************************************************************
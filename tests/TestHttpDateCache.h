@@ -0,0 +1,29 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef MISERE_TESTHTTPDATECACHE_H
+#define MISERE_TESTHTTPDATECACHE_H
+
+#include "TestSuite.h"
+
+namespace misere {
+
+class TestHttpDateCache : public poivre::TestSuite {
+
+protected:
+   void runTests();
+
+   void testFormats();
+   void testCopyHttpDate();
+   void testFormatHttpDate();
+   void testRefreshedWhenRunning();
+   void testRefreshedOnDemandWhenStopped();
+
+public:
+   TestHttpDateCache();
+
+};
+
+}
+
+#endif
@@ -0,0 +1,649 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include "TestHttpEventLoop.h"
+#include "HttpServer.h"
+#include "HttpEventLoop.h"
+#include "HttpRequest.h"
+#include "HttpResponse.h"
+#include "HttpBodyReader.h"
+#include "AbstractHandler.h"
+#include "ServerReloadHandler.h"
+#include "ByteBuffer.h"
+#include "Socket.h"
+#include "BasicException.h"
+
+using namespace std;
+using namespace misere;
+using namespace chaudiere;
+
+namespace {
+
+string request(const string& path, bool keepAlive) {
+   return "GET " + path + " HTTP/1.1\r\n"
+      "Host: localhost\r\n"
+      "Connection: " + (keepAlive ? "keep-alive" : "close") + "\r\n"
+      "\r\n";
+}
+
+string uniqueTempPath(const string& name) {
+   static int counter = 0;
+   char buffer[256];
+   ::snprintf(buffer, sizeof(buffer), "/tmp/misere_event_loop_test_%d_%d_%s",
+              (int) ::getpid(), ++counter, name.c_str());
+   return string(buffer);
+}
+
+string writeConfig(int port,
+                   const string& sockets,
+                   const string& threading,
+                   bool keepAlive,
+                   const string& extraSettings) {
+   string cfg;
+   cfg += "[server]\r\n";
+   cfg += "port = " + to_string(port) + "\r\n";
+   cfg += "allow_builtin_handlers = true\r\n";
+   cfg += "threading = " + threading + "\r\n";
+   cfg += "thread_pool_size = 2\r\n";
+   cfg += "sockets = " + sockets + "\r\n";
+   cfg += "reactor_count = 2\r\n";
+   cfg += string("keep_alive = ") + (keepAlive ? "true" : "false") + "\r\n";
+   cfg += extraSettings;
+
+   const string path = uniqueTempPath("misere.ini");
+   ofstream out(path, ios::binary | ios::trunc);
+   out << cfg;
+   return path;
+}
+
+// same retry pattern as TestHttpsIntegration - the loop starts on a
+// background thread with no explicit "ready" signal
+Socket* connectWithRetry(int port, int maxAttempts = 60) {
+   for (int i = 0; i < maxAttempts; ++i) {
+      try {
+         return new Socket("127.0.0.1", port);
+      } catch (const BasicException&) {
+         this_thread::sleep_for(chrono::milliseconds(50));
+      }
+   }
+   return nullptr;
+}
+
+// servers that aren't shut down by the test (as in TestHttpsIntegration)
+// are deliberately leaked, along with their threads, for the life of the
+// test process
+void startServerInBackground(int port,
+                             const string& threading,
+                             bool keepAlive,
+                             const string& sockets = "event_loop",
+                             const string& extraSettings = "") {
+   HttpServer* server =
+      new HttpServer(writeConfig(port, sockets, threading, keepAlive, extraSettings));
+   std::thread serverThread([server]() {
+      server->run();
+   });
+   serverThread.detach();
+}
+
+// Reads exactly one response (headers plus Content-Length bytes of body)
+// from a connection that may stay open afterward. Anything read past the
+// end of that response is left in pending for the next call.
+string readOneResponse(Socket* socket, string& pending) {
+   char chunk[512];
+   const string headerTerminator = "\r\n\r\n";
+
+   for (;;) {
+      const string::size_type headerEnd = pending.find(headerTerminator);
+      if (headerEnd != string::npos) {
+         string headers = pending.substr(0, headerEnd);
+         for (auto& c : headers) {
+            c = (char) ::tolower((unsigned char) c);
+         }
+
+         long contentLength = 0;
+         const string::size_type clPos = headers.find("content-length:");
+         if (clPos != string::npos) {
+            contentLength = ::strtol(headers.c_str() + clPos + strlen("content-length:"), nullptr, 10);
+         }
+
+         const string::size_type totalNeeded =
+            headerEnd + headerTerminator.size() + (string::size_type) contentLength;
+         if (pending.size() >= totalNeeded) {
+            const string response = pending.substr(0, totalNeeded);
+            pending.erase(0, totalNeeded);
+            return response;
+         }
+      }
+
+      const int n = socket->recvAvailable(chunk, sizeof(chunk));
+      if (n <= 0) {
+         const string response = pending;
+         pending.clear();
+         return response;
+      }
+      pending.append(chunk, n);
+   }
+}
+
+bool isOkResponse(const string& response) {
+   return response.compare(0, 12, "HTTP/1.1 200") == 0;
+}
+
+string lowercased(string s) {
+   for (auto& c : s) {
+      c = (char) ::tolower((unsigned char) c);
+   }
+   return s;
+}
+
+// reads the request body itself and answers with how much it read
+class CountingUploadHandler : public AbstractHandler
+{
+   public:
+      explicit CountingUploadHandler(atomic<int>& calls) :
+         m_calls(calls) {
+      }
+
+      virtual bool streamsRequestBody() const {
+         return true;
+      }
+
+      virtual void serviceRequest(const HttpRequest& request,
+                                  HttpResponse& response) {
+         ++m_calls;
+
+         long total = 0;
+         HttpBodyReader* reader = request.getBodyReader();
+         if (reader != nullptr) {
+            char buffer[256];
+            int bytesRead;
+            while ((bytesRead = reader->read(buffer, sizeof(buffer))) > 0) {
+               total += bytesRead;
+            }
+         }
+
+         response.setBody(new ByteBuffer(to_string(total)));
+      }
+
+   private:
+      atomic<int>& m_calls;
+};
+
+string upload(const string& path, std::size_t bodyLength) {
+   return "POST " + path + " HTTP/1.1\r\n"
+          "Host: localhost\r\n"
+          "Connection: keep-alive\r\n"
+          "Content-Length: " + to_string(bodyLength) + "\r\n"
+          "\r\n" +
+          string(bodyLength, 'u');
+}
+
+}
+
+//******************************************************************************
+
+TestHttpEventLoop::TestHttpEventLoop() :
+   poivre::TestSuite("TestHttpEventLoop") {
+}
+
+//******************************************************************************
+
+void TestHttpEventLoop::runTests() {
+   if (!HttpEventLoop::isSupportedPlatform()) {
+      return;
+   }
+
+   testServesRequestAndCloses();
+   testKeepAliveServesSequentialRequests();
+   testPipelinedRequestsInSingleWrite();
+   testRequestSplitAcrossWrites();
+   testChunkedBodyFollowedByPipelinedRequest();
+   testInlineServicingWithoutThreadPool();
+   testReusePortReactorsServeManyConnections();
+   testCompressedResponses();
+   testShutdownDrainsConnections();
+   testPeerThatNeverReadsIsClosed();
+   testConflictingBodyLengthsAreRejected();
+   testStreamingHandlerBodyLimit();
+   testReloadFromLoopback();
+}
+
+//******************************************************************************
+
+void TestHttpEventLoop::testServesRequestAndCloses() {
+   TEST_CASE("testServesRequestAndCloses");
+
+   const int port = 34571;
+   startServerInBackground(port, "pthreads", false);
+
+   unique_ptr<Socket> client(connectWithRetry(port));
+   require(nullptr != client, "client should be able to connect to the event loop");
+   require(client->write(request("/GMTDateTime", false)), "writing the request should succeed");
+
+   string pending;
+   require(isOkResponse(readOneResponse(client.get(), pending)), "the response should report HTTP 200");
+
+   // keep-alive is off, so the loop closes the connection once the
+   // response has been written
+   char buffer[16];
+   require(client->recvAvailable(buffer, sizeof(buffer)) <= 0,
+           "the connection should be closed after the response");
+}
+
+//******************************************************************************
+
+void TestHttpEventLoop::testKeepAliveServesSequentialRequests() {
+   TEST_CASE("testKeepAliveServesSequentialRequests");
+
+   const int port = 34572;
+   startServerInBackground(port, "pthreads", true);
+
+   unique_ptr<Socket> client(connectWithRetry(port));
+   require(nullptr != client, "client should be able to connect to the event loop");
+
+   string pending;
+   for (int i = 0; i < 3; ++i) {
+      require(client->write(request("/GMTDateTime", true)), "writing the request should succeed");
+      const string response = readOneResponse(client.get(), pending);
+      require(isOkResponse(response), "each request on the connection should get HTTP 200");
+      require(response.find("Connection: keep-alive") != string::npos,
+              "the response should keep the connection open");
+   }
+}
+
+//******************************************************************************
+
+void TestHttpEventLoop::testPipelinedRequestsInSingleWrite() {
+   TEST_CASE("testPipelinedRequestsInSingleWrite");
+
+   const int port = 34573;
+   startServerInBackground(port, "pthreads", true);
+
+   unique_ptr<Socket> client(connectWithRetry(port));
+   require(nullptr != client, "client should be able to connect to the event loop");
+
+   require(client->write(request("/GMTDateTime", true) + request("/ServerDateTime", true)),
+           "writing both requests at once should succeed");
+
+   string pending;
+   require(isOkResponse(readOneResponse(client.get(), pending)), "first pipelined request should get HTTP 200");
+   require(isOkResponse(readOneResponse(client.get(), pending)), "second pipelined request should get HTTP 200");
+}
+
+//******************************************************************************
+
+void TestHttpEventLoop::testRequestSplitAcrossWrites() {
+   TEST_CASE("testRequestSplitAcrossWrites");
+
+   const int port = 34574;
+   startServerInBackground(port, "pthreads", true);
+
+   unique_ptr<Socket> client(connectWithRetry(port));
+   require(nullptr != client, "client should be able to connect to the event loop");
+
+   // the loop must hold on to a partial request until the rest arrives
+   const string req = request("/GMTDateTime", true);
+   const string::size_type split = req.size() / 2;
+   require(client->write(req.substr(0, split)), "writing the first half should succeed");
+   this_thread::sleep_for(chrono::milliseconds(100));
+   require(client->write(req.substr(split)), "writing the second half should succeed");
+
+   string pending;
+   require(isOkResponse(readOneResponse(client.get(), pending)), "the reassembled request should get HTTP 200");
+}
+
+//******************************************************************************
+
+void TestHttpEventLoop::testChunkedBodyFollowedByPipelinedRequest() {
+   TEST_CASE("testChunkedBodyFollowedByPipelinedRequest");
+
+   const int port = 34577;
+   startServerInBackground(port, "pthreads", true);
+
+   unique_ptr<Socket> client(connectWithRetry(port));
+   require(nullptr != client, "client should be able to connect to the event loop");
+
+   // the loop must wait for the terminating chunk, and the request that
+   // follows the chunked body must not be mistaken for part of it
+   const string head =
+      "POST /GMTDateTime HTTP/1.1\r\n"
+      "Host: localhost\r\n"
+      "Transfer-Encoding: chunked\r\n"
+      "\r\n"
+      "5\r\nhello\r\n";
+   require(client->write(head), "writing the headers and first chunk should succeed");
+   this_thread::sleep_for(chrono::milliseconds(100));
+   require(client->write("6\r\n world\r\n0\r\n\r\n" + request("/ServerDateTime", true)),
+           "writing the rest of the body and the next request should succeed");
+
+   string pending;
+   require(isOkResponse(readOneResponse(client.get(), pending)), "the chunked request should get HTTP 200");
+   require(isOkResponse(readOneResponse(client.get(), pending)), "the request after it should get HTTP 200");
+}
+
+//******************************************************************************
+
+void TestHttpEventLoop::testInlineServicingWithoutThreadPool() {
+   TEST_CASE("testInlineServicingWithoutThreadPool");
+
+   const int port = 34575;
+   startServerInBackground(port, "none", true);
+
+   unique_ptr<Socket> client(connectWithRetry(port));
+   require(nullptr != client, "client should be able to connect to the event loop");
+
+   string pending;
+   for (int i = 0; i < 2; ++i) {
+      require(client->write(request("/GMTDateTime", true)), "writing the request should succeed");
+      require(isOkResponse(readOneResponse(client.get(), pending)),
+              "requests serviced on the loop thread should get HTTP 200");
+   }
+}
+
+//******************************************************************************
+
+void TestHttpEventLoop::testReusePortReactorsServeManyConnections() {
+   TEST_CASE("testReusePortReactorsServeManyConnections");
+
+   const int port = 34576;
+   startServerInBackground(port, "pthreads", true, "reuseport_reactors");
+
+   // enough concurrent connections that the kernel spreads them across
+   // both reactors' listeners
+   const int connectionCount = 8;
+   vector<unique_ptr<Socket>> clients;
+   for (int i = 0; i < connectionCount; ++i) {
+      clients.emplace_back(connectWithRetry(port));
+      require(nullptr != clients.back(), "client should be able to connect to a reactor");
+   }
+
+   for (int round = 0; round < 2; ++round) {
+      for (auto& client : clients) {
+         require(client->write(request("/GMTDateTime", true)), "writing the request should succeed");
+      }
+
+      for (auto& client : clients) {
+         string pending;
+         require(isOkResponse(readOneResponse(client.get(), pending)),
+                 "every connection should be served by its reactor");
+      }
+   }
+}
+
+//******************************************************************************
+
+void TestHttpEventLoop::testCompressedResponses() {
+   TEST_CASE("testCompressedResponses");
+
+   const int port = 34578;
+   startServerInBackground(port, "pthreads", true, "event_loop",
+                           "compression = true\r\n"
+                           "compression_min_size = 100\r\n"
+                           "compression_mime_types = text/plain, text/html\r\n");
+
+   unique_ptr<Socket> client(connectWithRetry(port));
+   require(nullptr != client, "client should be able to connect to the event loop");
+
+   // /Echo repeats the headers back, so this makes a large, very
+   // compressible body
+   const string padding = "X-Padding: " + string(2000, 'a') + "\r\n";
+   const string echo = "GET /Echo HTTP/1.1\r\n"
+                       "Host: localhost\r\n"
+                       "Connection: keep-alive\r\n" + padding;
+
+   string pending;
+   require(client->write(echo + "Accept-Encoding: br, gzip;q=0.8\r\n\r\n"),
+           "writing the request should succeed");
+   string response = lowercased(readOneResponse(client.get(), pending));
+   require(response.compare(0, 12, "http/1.1 200") == 0,
+           "compressed request should get HTTP 200");
+   require(response.find("content-encoding: gzip\r\n") != string::npos,
+           "a client accepting gzip should get a gzip body");
+   require(response.find("vary: accept-encoding\r\n") != string::npos,
+           "a compressed response should vary on Accept-Encoding");
+   require(response.find(string(2000, 'a')) == string::npos,
+           "the body should not be sent as is");
+
+   // the same worker's reused stream and buffer serve the next response
+   require(client->write(echo + "Accept-Encoding: gzip\r\n\r\n"),
+           "writing the request should succeed");
+   response = lowercased(readOneResponse(client.get(), pending));
+   require(response.find("content-encoding: gzip\r\n") != string::npos,
+           "a second response should be compressed too");
+
+   require(client->write(echo + "Accept-Encoding: gzip;q=0\r\n\r\n"),
+           "writing the request should succeed");
+   response = lowercased(readOneResponse(client.get(), pending));
+   require(response.find("content-encoding:") == string::npos,
+           "gzip;q=0 should get an uncompressed body");
+   require(response.find("vary: accept-encoding\r\n") != string::npos,
+           "an uncompressed response of a compressible type still varies");
+   require(response.find(string(2000, 'a')) != string::npos,
+           "the uncompressed body should be sent as is");
+}
+
+//******************************************************************************
+
+void TestHttpEventLoop::testShutdownDrainsConnections() {
+   TEST_CASE("testShutdownDrainsConnections");
+
+   const string modes[] = { "event_loop", "socket_server" };
+   int port = 34586;
+
+   for (const string& sockets : modes) {
+      // an idle socket_server connection is only closed when its read
+      // for the next request times out
+      HttpServer* server =
+         new HttpServer(writeConfig(port, sockets, "pthreads", true,
+                                    "keep_alive_timeout = 1\r\n"
+                                    "shutdown_timeout = 10\r\n"));
+      atomic<bool> isStopped(false);
+      std::thread serverThread([server, &isStopped]() {
+         server->run();
+         isStopped = true;
+      });
+
+      unique_ptr<Socket> client(connectWithRetry(port));
+      require(nullptr != client, "client should be able to connect to " + sockets);
+      require(client->write(request("/GMTDateTime", true)), "writing the request should succeed");
+
+      string pending;
+      require(isOkResponse(readOneResponse(client.get(), pending)),
+              "the request should get HTTP 200");
+
+      server->shutdown();
+      require(server->isDraining(), "the server should be draining");
+
+      char buffer[16];
+      require(client->recvAvailable(buffer, sizeof(buffer)) <= 0,
+              "the idle keep-alive connection should be closed");
+
+      for (int i = 0; (i < 200) && !isStopped; ++i) {
+         this_thread::sleep_for(chrono::milliseconds(50));
+      }
+
+      require(isStopped, sockets + " should stop once its connections are closed");
+      serverThread.detach();
+
+      ++port;
+   }
+}
+
+//******************************************************************************
+
+void TestHttpEventLoop::testPeerThatNeverReadsIsClosed() {
+   TEST_CASE("testPeerThatNeverReadsIsClosed");
+
+   const int port = 34588;
+   startServerInBackground(port, "pthreads", true, "event_loop",
+                           "keep_alive_timeout = 1\r\n"
+                           "socket_send_buffer_size = 4096\r\n");
+
+   unique_ptr<Socket> client(connectWithRetry(port));
+   require(nullptr != client, "client should be able to connect to the event loop");
+
+   // a small, fixed receive window, so the responses back up in the
+   // server's output buffer instead of in the kernel
+   const int receiveBufferSize = 4096;
+   ::setsockopt(client->getFileDescriptor(), SOL_SOCKET, SO_RCVBUF,
+                &receiveBufferSize, sizeof(receiveBufferSize));
+
+   // /Echo repeats the headers back - far more output than the socket
+   // buffers hold, but not enough for a worker to block on it
+   const int requestCount = 40;
+   const string echo = "GET /Echo HTTP/1.1\r\n"
+                       "Host: localhost\r\n"
+                       "Connection: keep-alive\r\n"
+                       "X-Padding: " + string(2000, 'a') + "\r\n\r\n";
+   string requests;
+   for (int i = 0; i < requestCount; ++i) {
+      requests += echo;
+   }
+   require(client->write(requests), "writing the requests should succeed");
+
+   // no progress for longer than keep_alive_timeout
+   this_thread::sleep_for(chrono::seconds(4));
+
+   string pending;
+   int responseCount = 0;
+   for (;;) {
+      const string response = readOneResponse(client.get(), pending);
+      if (!isOkResponse(response)) {
+         break;
+      }
+      ++responseCount;
+   }
+
+   require(responseCount < requestCount,
+           "a connection whose peer stopped reading should have been closed");
+}
+
+//******************************************************************************
+
+void TestHttpEventLoop::testConflictingBodyLengthsAreRejected() {
+   TEST_CASE("testConflictingBodyLengthsAreRejected");
+
+   const int port = 34589;
+   startServerInBackground(port, "pthreads", true);
+
+   unique_ptr<Socket> client(connectWithRetry(port));
+   require(nullptr != client, "client should be able to connect to the event loop");
+
+   // a front end honouring Content-Length and one honouring the chunked
+   // coding would disagree about where the smuggled request begins
+   const string ambiguous = "POST /Echo HTTP/1.1\r\n"
+                            "Host: localhost\r\n"
+                            "Connection: keep-alive\r\n"
+                            "Content-Length: 4\r\n"
+                            "Transfer-Encoding: chunked\r\n"
+                            "\r\n"
+                            "0\r\n\r\n" +
+                            request("/GMTDateTime", true);
+   require(client->write(ambiguous), "writing the request should succeed");
+
+   string pending;
+   const string response = readOneResponse(client.get(), pending);
+   require(response.compare(0, 12, "HTTP/1.1 400") == 0,
+           "a request framed by both Content-Length and Transfer-Encoding should get HTTP 400");
+   require(lowercased(response).find("connection: close") != string::npos,
+           "the connection should not be reused after a framing error");
+   require(readOneResponse(client.get(), pending).empty(),
+           "the request following the ambiguous one should not be served");
+}
+
+//******************************************************************************
+
+void TestHttpEventLoop::testStreamingHandlerBodyLimit() {
+   TEST_CASE("testStreamingHandlerBodyLimit");
+
+   const int port = 34590;
+   static atomic<int> calls(0);
+
+   HttpServer* server =
+      new HttpServer(writeConfig(port, "event_loop", "pthreads", true,
+                                 "max_request_body_size = 1024\r\n"));
+   require(server->addPathHandler("/upload", new CountingUploadHandler(calls)),
+           "add streaming handler");
+   std::thread serverThread([server]() {
+      server->run();
+   });
+   serverThread.detach();
+
+   unique_ptr<Socket> client(connectWithRetry(port));
+   require(nullptr != client, "client should be able to connect to the event loop");
+
+   // within the limit, the handler reads the whole (buffered) body
+   string pending;
+   require(client->write(upload("/upload", 1000)), "writing the upload should succeed");
+   string response = readOneResponse(client.get(), pending);
+   require(isOkResponse(response), "a body within the limit should be accepted");
+   require(response.size() >= 4 && response.compare(response.size() - 4, 4, "1000") == 0,
+           "the streaming handler should read the whole body");
+   require(calls == 1, "the handler should have been called once");
+
+   // over the limit, it's refused instead of being handed over truncated
+   require(client->write(upload("/upload", 4096)), "writing the upload should succeed");
+   response = readOneResponse(client.get(), pending);
+   require(response.compare(0, 12, "HTTP/1.1 413") == 0,
+           "a body over the limit should get HTTP 413 even for a streaming handler");
+   require(calls == 1, "the handler shouldn't be called for a body over the limit");
+}
+
+//******************************************************************************
+
+void TestHttpEventLoop::testReloadFromLoopback() {
+   TEST_CASE("testReloadFromLoopback");
+
+   const int port = 34592;
+
+   // without a secret the reload path isn't registered at all
+   HttpServer unprotected(writeConfig(port, "event_loop", "pthreads", true,
+                                      "reload_path = /admin/reload\r\n"));
+   require(unprotected.getPathHandler("/admin/reload") == nullptr,
+           "reload_path without reload_secret shouldn't be registered");
+
+   HttpServer* server =
+      new HttpServer(writeConfig(port, "event_loop", "pthreads", true, ""));
+   require(server->addPathHandler("/admin/reload",
+                                  new ServerReloadHandler(*server, "", true)),
+           "add reload handler trusting loopback");
+   require(server->addPathHandler("/admin/strict",
+                                  new ServerReloadHandler(*server, "s3cret", false)),
+           "add reload handler requiring the secret");
+   std::thread serverThread([server]() {
+      server->run();
+   });
+   serverThread.detach();
+
+   unique_ptr<Socket> client(connectWithRetry(port));
+   require(nullptr != client, "client should be able to connect to the event loop");
+
+   // no secret is configured, but the client is on the same host
+   string pending;
+   require(client->write(upload("/admin/reload", 0)), "writing the POST should succeed");
+   string response = readOneResponse(client.get(), pending);
+   require(isOkResponse(response), "a reload from trusted loopback should be accepted");
+
+   // loopback alone isn't enough unless it's trusted - behind a local
+   // proxy every client is on loopback
+   require(client->write(upload("/admin/strict", 0)), "writing the POST should succeed");
+   response = readOneResponse(client.get(), pending);
+   require(response.compare(0, 12, "HTTP/1.1 403") == 0,
+           "a reload from untrusted loopback without the secret should get 403");
+}
+
+//******************************************************************************
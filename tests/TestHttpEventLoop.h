@@ -0,0 +1,37 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef MISERE_TESTHTTPEVENTLOOP_H
+#define MISERE_TESTHTTPEVENTLOOP_H
+
+#include "TestSuite.h"
+
+namespace misere {
+
+class TestHttpEventLoop : public poivre::TestSuite {
+
+protected:
+   void runTests();
+
+   void testServesRequestAndCloses();
+   void testKeepAliveServesSequentialRequests();
+   void testPipelinedRequestsInSingleWrite();
+   void testRequestSplitAcrossWrites();
+   void testChunkedBodyFollowedByPipelinedRequest();
+   void testInlineServicingWithoutThreadPool();
+   void testReusePortReactorsServeManyConnections();
+   void testCompressedResponses();
+   void testShutdownDrainsConnections();
+   void testPeerThatNeverReadsIsClosed();
+   void testConflictingBodyLengthsAreRejected();
+   void testStreamingHandlerBodyLimit();
+   void testReloadFromLoopback();
+
+public:
+   TestHttpEventLoop();
+
+};
+
+}
+
+#endif
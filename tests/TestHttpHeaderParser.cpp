@@ -0,0 +1,279 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include <string>
+
+#include "TestHttpHeaderParser.h"
+#include "HttpHeaderParser.h"
+
+using namespace std;
+using namespace misere;
+
+static const string EOL = "\r\n";
+
+//******************************************************************************
+
+TestHttpHeaderParser::TestHttpHeaderParser() :
+   poivre::TestSuite("TestHttpHeaderParser") {
+}
+
+//******************************************************************************
+
+void TestHttpHeaderParser::runTests() {
+   testParseCompleteRequest();
+   testParseResumesAcrossReads();
+   testStatusLineWithMultiWordReason();
+   testFindIsCaseInsensitiveAndLastWins();
+   testContentLength();
+   testIsChunked();
+   testInvalidFraming();
+   testReset();
+}
+
+//******************************************************************************
+
+void TestHttpHeaderParser::testParseCompleteRequest() {
+   TEST_CASE("testParseCompleteRequest");
+
+   const string headers = "GET /doc/test.html HTTP/1.1" + EOL +
+      "Host: www.acme.com" + EOL +
+      "Accept:   text/html  " + EOL +
+      "NoColonHere" + EOL +
+      "Empty-Value:" + EOL + EOL;
+   const string buffer = headers + "leftover";
+
+   HttpHeaderParser parser;
+   require(parser.parse(buffer.data(), buffer.size()), "header block should be complete");
+   require(parser.isComplete(), "isComplete after parse");
+   require(parser.getHeaderLength() == headers.size(), "header length should include the blank line");
+
+   requireStringEquals("GET /doc/test.html HTTP/1.1", string(parser.getFirstLine()), "first line");
+   require(parser.getFirstLineTokenCount() == 3, "request line has 3 tokens");
+   requireStringEquals("GET", string(parser.getFirstLineToken(0)), "method");
+   requireStringEquals("/doc/test.html", string(parser.getFirstLineToken(1)), "path");
+   requireStringEquals("HTTP/1.1", string(parser.getFirstLineToken(2)), "protocol");
+
+   // lines without a colon or a value are skipped, as before
+   require(parser.getFields().size() == 2, "only well-formed header lines are kept");
+   requireStringEquals("text/html", string(parser.find("Accept")->value), "value is trimmed");
+
+   // views point into the caller's buffer rather than copies
+   const char* hostValue = parser.find("Host")->value.data();
+   require((hostValue >= buffer.data()) && (hostValue < buffer.data() + buffer.size()),
+           "values should be views into the parsed buffer");
+}
+
+//******************************************************************************
+
+void TestHttpHeaderParser::testParseResumesAcrossReads() {
+   TEST_CASE("testParseResumesAcrossReads");
+
+   const string full = "GET / HTTP/1.1" + EOL + "Host: a" + EOL + EOL;
+   HttpHeaderParser parser;
+   string buffer;
+
+   // feed one byte at a time, so the terminator is split across "reads"
+   for (std::size_t i = 0; i < full.size() - 1; ++i) {
+      buffer += full[i];
+      requireFalse(parser.parse(buffer.data(), buffer.size()), "incomplete until the final byte");
+   }
+
+   buffer += full.back();
+   require(parser.parse(buffer.data(), buffer.size()), "complete once the blank line arrives");
+   requireStringEquals("a", string(parser.find("host")->value), "host value");
+}
+
+//******************************************************************************
+
+void TestHttpHeaderParser::testStatusLineWithMultiWordReason() {
+   TEST_CASE("testStatusLineWithMultiWordReason");
+
+   const string buffer = "HTTP/1.1 500 Internal Server Error" + EOL + EOL;
+   HttpHeaderParser parser;
+   require(parser.parse(buffer.data(), buffer.size()), "status line parses");
+   require(parser.getFirstLineTokenCount() == 3, "status line has 3 tokens");
+   requireStringEquals("500", string(parser.getFirstLineToken(1)), "status code");
+   requireStringEquals("Internal Server Error", string(parser.getFirstLineToken(2)), "reason phrase kept whole");
+}
+
+//******************************************************************************
+
+void TestHttpHeaderParser::testFindIsCaseInsensitiveAndLastWins() {
+   TEST_CASE("testFindIsCaseInsensitiveAndLastWins");
+
+   const string buffer = "GET / HTTP/1.1" + EOL +
+      "X-Thing: first" + EOL +
+      "x-THING: second" + EOL + EOL;
+   HttpHeaderParser parser;
+   require(parser.parse(buffer.data(), buffer.size()), "headers parse");
+   require(nullptr != parser.find("X-THING"), "find ignores case");
+   requireStringEquals("second", string(parser.find("x-thing")->value), "last occurrence wins");
+   require(nullptr == parser.find("X-Other"), "missing header not found");
+}
+
+//******************************************************************************
+
+void TestHttpHeaderParser::testContentLength() {
+   TEST_CASE("testContentLength");
+
+   HttpHeaderParser parser;
+   string buffer = "POST / HTTP/1.1" + EOL + "Content-Length: 42" + EOL + EOL;
+   require(parser.parse(buffer.data(), buffer.size()), "headers parse");
+   require(parser.getContentLength() == 42, "content length parsed");
+
+   // still available after the buffer grows and the views go stale
+   buffer.append(4096, 'x');
+   require(parser.getContentLength() == 42, "content length survives buffer growth");
+
+   HttpHeaderParser invalid;
+   const string bad = "POST / HTTP/1.1" + EOL + "Content-Length: 12abc" + EOL + EOL;
+   require(invalid.parse(bad.data(), bad.size()), "headers parse");
+   require(invalid.getContentLength() == -1, "malformed content length is rejected");
+
+   HttpHeaderParser absent;
+   const string none = "GET / HTTP/1.1" + EOL + EOL;
+   require(absent.parse(none.data(), none.size()), "headers parse");
+   require(absent.getContentLength() == -1, "absent content length is -1");
+}
+
+//******************************************************************************
+
+void TestHttpHeaderParser::testIsChunked() {
+   TEST_CASE("testIsChunked");
+
+   HttpHeaderParser parser;
+   const string chunked = "POST / HTTP/1.1" + EOL + "Transfer-Encoding: Chunked" + EOL + EOL;
+   require(parser.parse(chunked.data(), chunked.size()), "headers parse");
+   require(parser.isChunked(), "chunked (case-insensitive)");
+
+   HttpHeaderParser listed;
+   const string gzipChunked = "POST / HTTP/1.1" + EOL + "Transfer-Encoding: gzip, chunked" + EOL + EOL;
+   require(listed.parse(gzipChunked.data(), gzipChunked.size()), "headers parse");
+   require(listed.isChunked(), "chunked as the final coding");
+
+   HttpHeaderParser notLast;
+   const string chunkedGzip = "POST / HTTP/1.1" + EOL + "Transfer-Encoding: chunked, gzip" + EOL + EOL;
+   require(notLast.parse(chunkedGzip.data(), chunkedGzip.size()), "headers parse");
+   requireFalse(notLast.isChunked(), "chunked but not the final coding");
+   require(notLast.hasInvalidFraming(), "chunked but not the final coding is invalid");
+
+   HttpHeaderParser absent;
+   const string none = "POST / HTTP/1.1" + EOL + "Content-Length: 3" + EOL + EOL;
+   require(absent.parse(none.data(), none.size()), "headers parse");
+   requireFalse(absent.isChunked(), "no transfer coding");
+}
+
+//******************************************************************************
+
+void TestHttpHeaderParser::testInvalidFraming() {
+   TEST_CASE("testInvalidFraming");
+
+   const string request = "POST / HTTP/1.1" + EOL;
+
+   HttpHeaderParser valid;
+   string buffer = request + "Content-Length: 5" + EOL +
+                   "content-length: 5" + EOL + EOL;
+   require(valid.parse(buffer.data(), buffer.size()), "headers parse");
+   requireFalse(valid.hasInvalidFraming(), "repeated identical content lengths are valid");
+   require(valid.getContentLength() == 5, "repeated content length");
+
+   HttpHeaderParser negative;
+   buffer = request + "Content-Length: -5" + EOL + EOL;
+   require(negative.parse(buffer.data(), buffer.size()), "headers parse");
+   require(negative.hasInvalidFraming(), "negative content length is invalid");
+   require(negative.getContentLength() == -1, "negative content length isn't used");
+
+   HttpHeaderParser malformed;
+   buffer = request + "Content-Length: 12abc" + EOL + EOL;
+   require(malformed.parse(buffer.data(), buffer.size()), "headers parse");
+   require(malformed.hasInvalidFraming(), "malformed content length is invalid");
+
+   HttpHeaderParser conflicting;
+   buffer = request + "Content-Length: 5" + EOL +
+            "Content-Length: 6" + EOL + EOL;
+   require(conflicting.parse(buffer.data(), buffer.size()), "headers parse");
+   require(conflicting.hasInvalidFraming(), "conflicting content lengths are invalid");
+   require(conflicting.getContentLength() == -1, "neither content length is used");
+
+   HttpHeaderParser both;
+   buffer = request + "Content-Length: 5" + EOL +
+            "Transfer-Encoding: chunked" + EOL + EOL;
+   require(both.parse(buffer.data(), buffer.size()), "headers parse");
+   require(both.hasInvalidFraming(), "content length with transfer coding is invalid");
+
+   HttpHeaderParser spaceBeforeColon;
+   buffer = request + "Content-Length : 5" + EOL + EOL;
+   require(spaceBeforeColon.parse(buffer.data(), buffer.size()), "headers parse");
+   require(spaceBeforeColon.hasInvalidFraming(), "whitespace before the colon is invalid");
+   require(spaceBeforeColon.find("Content-Length") == nullptr, "the line isn't kept");
+
+   HttpHeaderParser tabBeforeColon;
+   buffer = request + "Transfer-Encoding\t: chunked" + EOL + EOL;
+   require(tabBeforeColon.parse(buffer.data(), buffer.size()), "headers parse");
+   require(tabBeforeColon.hasInvalidFraming(), "a tab before the colon is invalid");
+
+   HttpHeaderParser folded;
+   buffer = request + "Host: a" + EOL + " X-Folded: b" + EOL + EOL;
+   require(folded.parse(buffer.data(), buffer.size()), "headers parse");
+   require(folded.hasInvalidFraming(), "a folded line is invalid");
+
+   HttpHeaderParser gzipOnly;
+   buffer = request + "Transfer-Encoding: gzip" + EOL + EOL;
+   require(gzipOnly.parse(buffer.data(), buffer.size()), "headers parse");
+   require(gzipOnly.hasInvalidFraming(), "a transfer coding without chunked is invalid");
+
+   HttpHeaderParser lookalike;
+   buffer = request + "Transfer-Encoding: xchunked" + EOL + EOL;
+   require(lookalike.parse(buffer.data(), buffer.size()), "headers parse");
+   require(lookalike.hasInvalidFraming(), "only chunked itself counts");
+
+   HttpHeaderParser chunkedFirst;
+   buffer = request + "Transfer-Encoding: chunked, identity" + EOL + EOL;
+   require(chunkedFirst.parse(buffer.data(), buffer.size()), "headers parse");
+   requireFalse(chunkedFirst.isChunked(), "identity is the final coding");
+   require(chunkedFirst.hasInvalidFraming(), "chunked before the final coding is invalid");
+
+   HttpHeaderParser chunkedTwice;
+   buffer = request + "Transfer-Encoding: chunked, chunked" + EOL + EOL;
+   require(chunkedTwice.parse(buffer.data(), buffer.size()), "headers parse");
+   require(chunkedTwice.hasInvalidFraming(), "chunked applied twice is invalid");
+
+   // separate fields are taken together, in order, as one list
+   HttpHeaderParser twoFields;
+   buffer = request + "Transfer-Encoding: chunked" + EOL +
+            "Transfer-Encoding: identity" + EOL + EOL;
+   require(twoFields.parse(buffer.data(), buffer.size()), "headers parse");
+   requireFalse(twoFields.isChunked(), "the last field's coding is final");
+   require(twoFields.hasInvalidFraming(), "chunked in an earlier field is invalid");
+
+   HttpHeaderParser twoFieldsChunked;
+   buffer = request + "Transfer-Encoding: gzip" + EOL +
+            "Transfer-Encoding: chunked" + EOL + EOL;
+   require(twoFieldsChunked.parse(buffer.data(), buffer.size()), "headers parse");
+   require(twoFieldsChunked.isChunked(), "chunked in the last field");
+   requireFalse(twoFieldsChunked.hasInvalidFraming(), "gzip then chunked is valid");
+
+   both.reset();
+   buffer = request + "Transfer-Encoding: chunked" + EOL + EOL;
+   require(both.parse(buffer.data(), buffer.size()), "headers parse after reset");
+   requireFalse(both.hasInvalidFraming(), "reset clears invalid framing");
+}
+
+//******************************************************************************
+
+void TestHttpHeaderParser::testReset() {
+   TEST_CASE("testReset");
+
+   const string first = "GET /first HTTP/1.1" + EOL + "Host: a" + EOL + EOL;
+   const string second = "GET /second HTTP/1.1" + EOL + EOL;
+
+   HttpHeaderParser parser;
+   require(parser.parse(first.data(), first.size()), "first parses");
+   parser.reset();
+   requireFalse(parser.isComplete(), "reset clears completion");
+   require(parser.parse(second.data(), second.size()), "second parses after reset");
+   requireStringEquals("/second", string(parser.getFirstLineToken(1)), "second path");
+   require(parser.getFields().empty(), "no headers carried over from the first parse");
+}
+
+//******************************************************************************
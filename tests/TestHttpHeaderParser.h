@@ -0,0 +1,32 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef MISERE_TESTHTTPHEADERPARSER_H
+#define MISERE_TESTHTTPHEADERPARSER_H
+
+#include "TestSuite.h"
+
+namespace misere {
+
+class TestHttpHeaderParser : public poivre::TestSuite {
+
+protected:
+   void runTests();
+
+   void testParseCompleteRequest();
+   void testParseResumesAcrossReads();
+   void testStatusLineWithMultiWordReason();
+   void testFindIsCaseInsensitiveAndLastWins();
+   void testContentLength();
+   void testIsChunked();
+   void testInvalidFraming();
+   void testReset();
+
+public:
+   TestHttpHeaderParser();
+
+};
+
+}
+
+#endif
@@ -0,0 +1,91 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include <string>
+
+#include "TestHttpHeaderPrefixes.h"
+#include "HttpHeaderPrefixes.h"
+
+using namespace std;
+using namespace misere;
+
+//******************************************************************************
+
+TestHttpHeaderPrefixes::TestHttpHeaderPrefixes() :
+   poivre::TestSuite("TestHttpHeaderPrefixes") {
+}
+
+//******************************************************************************
+
+void TestHttpHeaderPrefixes::runTests() {
+   testCommonStatusCodes();
+   testEmptyServerString();
+   testUncommonStatusCode();
+}
+
+//******************************************************************************
+
+void TestHttpHeaderPrefixes::testCommonStatusCodes() {
+   TEST_CASE("testCommonStatusCodes");
+
+   HttpHeaderPrefixes prefixes;
+   prefixes.build("misere 0.1");
+
+   string output;
+   prefixes.append(output, 200, true);
+   requireStringEquals("HTTP/1.1 200 OK\r\n"
+                       "Server: misere 0.1\r\n"
+                       "Connection: keep-alive\r\n",
+                       output,
+                       "200 keep-alive prefix");
+
+   output = "existing";
+   prefixes.append(output, 404, false);
+   requireStringEquals("existing"
+                       "HTTP/1.1 404 Not Found\r\n"
+                       "Server: misere 0.1\r\n"
+                       "Connection: close\r\n",
+                       output,
+                       "prefix should be appended, not assigned");
+}
+
+//******************************************************************************
+
+void TestHttpHeaderPrefixes::testEmptyServerString() {
+   TEST_CASE("testEmptyServerString");
+
+   HttpHeaderPrefixes prefixes;
+   prefixes.build("");
+
+   string output;
+   prefixes.append(output, 200, false);
+   requireStringEquals("HTTP/1.1 200 OK\r\nConnection: close\r\n",
+                       output,
+                       "no Server header when the server string is empty");
+}
+
+//******************************************************************************
+
+void TestHttpHeaderPrefixes::testUncommonStatusCode() {
+   TEST_CASE("testUncommonStatusCode");
+
+   HttpHeaderPrefixes prefixes;
+   prefixes.build("misere");
+
+   // not pre-rendered - built on the spot in the same shape
+   string output;
+   prefixes.append(output, 418, true);
+   requireStringEquals("HTTP/1.1 418\r\nServer: misere\r\nConnection: keep-alive\r\n",
+                       output,
+                       "uncommon status code");
+
+   // never built at all
+   HttpHeaderPrefixes unbuilt;
+   output.clear();
+   unbuilt.append(output, 200, true);
+   requireStringEquals("HTTP/1.1 200 OK\r\nConnection: keep-alive\r\n",
+                       output,
+                       "unbuilt prefixes still render");
+}
+
+//******************************************************************************
@@ -0,0 +1,27 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef MISERE_TESTHTTPHEADERPREFIXES_H
+#define MISERE_TESTHTTPHEADERPREFIXES_H
+
+#include "TestSuite.h"
+
+namespace misere {
+
+class TestHttpHeaderPrefixes : public poivre::TestSuite {
+
+protected:
+   void runTests();
+
+   void testCommonStatusCodes();
+   void testEmptyServerString();
+   void testUncommonStatusCode();
+
+public:
+   TestHttpHeaderPrefixes();
+
+};
+
+}
+
+#endif
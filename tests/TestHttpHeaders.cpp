@@ -0,0 +1,139 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include <string>
+
+#include "TestHttpHeaders.h"
+#include "HttpHeaders.h"
+
+using namespace std;
+using namespace misere;
+
+//******************************************************************************
+
+TestHttpHeaders::TestHttpHeaders() :
+   poivre::TestSuite("TestHttpHeaders") {
+}
+
+//******************************************************************************
+
+void TestHttpHeaders::runTests() {
+   testSetAndFindIgnoreCase();
+   testWellKnownIds();
+   testOverflowKeepsOrder();
+   testRemove();
+   testCopy();
+}
+
+//******************************************************************************
+
+void TestHttpHeaders::testSetAndFindIgnoreCase() {
+   TEST_CASE("testSetAndFindIgnoreCase");
+
+   HttpHeaders headers;
+   require(headers.empty(), "new headers should be empty");
+
+   headers.set("X-Request-Id", "abc");
+   require(headers.has("x-request-id"), "lookup should ignore case");
+   requireStringEquals("abc", string(*headers.find("X-REQUEST-ID")), "value");
+
+   // same name in another case replaces rather than appends
+   headers.set("x-request-id", "def");
+   require(headers.size() == 1, "replacing should not add an entry");
+   requireStringEquals("def", string(*headers.find("X-Request-Id")), "replaced value");
+   requireStringEquals("X-Request-Id", string(headers.begin()->name), "name keeps its original case");
+
+   require(nullptr == headers.find("X-Other"), "missing header should not be found");
+}
+
+//******************************************************************************
+
+void TestHttpHeaders::testWellKnownIds() {
+   TEST_CASE("testWellKnownIds");
+
+   require(HttpHeaders::idForName("content-length") == HttpHeaders::CONTENT_LENGTH,
+           "well-known name should resolve to its ID");
+   require(HttpHeaders::idForName("X-Custom") == HttpHeaders::UNKNOWN,
+           "other names should be UNKNOWN");
+   requireStringEquals("Content-Length", string(HttpHeaders::nameForId(HttpHeaders::CONTENT_LENGTH)),
+                       "canonical name");
+
+   HttpHeaders headers;
+   headers.set("CONTENT-LENGTH", "10");
+   require(headers.has(HttpHeaders::CONTENT_LENGTH), "set by name should be found by ID");
+   requireStringEquals("10", string(*headers.find(HttpHeaders::CONTENT_LENGTH)), "value by ID");
+
+   headers.set(HttpHeaders::CONTENT_LENGTH, "20");
+   require(headers.size() == 1, "set by ID should replace the entry set by name");
+   requireStringEquals("20", string(*headers.find("content-length")), "value by name");
+
+   headers.set(HttpHeaders::CONNECTION, "close");
+   requireStringEquals("Connection", string((headers.begin() + 1)->name), "set by ID uses the canonical name");
+}
+
+//******************************************************************************
+
+void TestHttpHeaders::testOverflowKeepsOrder() {
+   TEST_CASE("testOverflowKeepsOrder");
+
+   // more than fit inline
+   HttpHeaders headers;
+   for (int i = 0; i < 20; ++i) {
+      headers.set("X-Header-" + to_string(i), to_string(i));
+   }
+
+   require(headers.size() == 20, "all headers should be kept");
+
+   int i = 0;
+   for (const HttpHeaders::Entry& entry : headers) {
+      requireStringEquals("X-Header-" + to_string(i), string(entry.name), "insertion order");
+      ++i;
+   }
+
+   requireStringEquals("7", string(*headers.find("x-header-7")), "lookup after overflow");
+   headers.set("x-header-7", "seven");
+   require(headers.size() == 20, "replace after overflow should not add an entry");
+   requireStringEquals("seven", string(*headers.find("X-Header-7")), "replaced after overflow");
+
+   headers.clear();
+   require(headers.empty(), "clear should remove everything");
+   headers.set("Host", "a");
+   require(headers.size() == 1, "usable again after clear");
+}
+
+//******************************************************************************
+
+void TestHttpHeaders::testRemove() {
+   TEST_CASE("testRemove");
+
+   HttpHeaders headers;
+   headers.set("A", "1");
+   headers.set("Host", "2");
+   headers.set("C", "3");
+
+   require(headers.remove("host"), "remove should ignore case");
+   requireFalse(headers.remove("host"), "second remove should find nothing");
+   require(headers.size() == 2, "one entry removed");
+   requireStringEquals("A", string(headers.begin()->name), "first entry kept");
+   requireStringEquals("C", string((headers.begin() + 1)->name), "order kept after remove");
+}
+
+//******************************************************************************
+
+void TestHttpHeaders::testCopy() {
+   TEST_CASE("testCopy");
+
+   HttpHeaders original;
+   original.set("Host", "a");
+   for (int i = 0; i < 10; ++i) {
+      original.set("X-" + to_string(i), "v");
+   }
+
+   HttpHeaders copy(original);
+   original.set("Host", "b");
+
+   requireStringEquals("a", string(*copy.find(HttpHeaders::HOST)), "copy is independent of original");
+   require(copy.size() == original.size(), "copy has every entry");
+}
+
+//******************************************************************************
@@ -0,0 +1,29 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef MISERE_TESTHTTPHEADERS_H
+#define MISERE_TESTHTTPHEADERS_H
+
+#include "TestSuite.h"
+
+namespace misere {
+
+class TestHttpHeaders : public poivre::TestSuite {
+
+protected:
+   void runTests();
+
+   void testSetAndFindIgnoreCase();
+   void testWellKnownIds();
+   void testOverflowKeepsOrder();
+   void testRemove();
+   void testCopy();
+
+public:
+   TestHttpHeaders();
+
+};
+
+}
+
+#endif
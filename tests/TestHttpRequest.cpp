@@ -8,6 +8,8 @@
 #include "SocketConnection.h"
 #include "MockSocket.h"
 #include "ByteBuffer.h"
+#include "HttpHeaderParser.h"
+#include "BasicException.h"
 
 // Modeled after tests from:
 // http://subversion.assembla.com/svn/opencats/trunk/cats-0.9.2/lib/simpletest/test/http_test.php
@@ -65,6 +67,10 @@ void TestHttpRequest::runTests() {
    testGetArgumentKeys();
    testTwoRequestsInSingleRead();
    testRequestWithBodyFollowedByNextRequest();
+   testNoBodyWithoutContentLength();
+   testHeaderBlockTooLarge();
+   testAcceptsEncoding();
+   testAcceptEncodingQuality();
 }
 
 //******************************************************************************
@@ -132,12 +138,12 @@ void TestHttpRequest::testGetMethod() {
    MockSocket socketGet(DEFAULT_GET);
    SocketConnection connectionGet(&socketGet, false);
    HttpRequest requestGet(&connectionGet, false);
-   requireStringEquals("GET", requestGet.getMethod(), "method is GET");
+   requireStringEquals("GET", std::string(requestGet.getMethod()), "method is GET");
 
    MockSocket socketPost(DEFAULT_POST);
    SocketConnection connectionPost(&socketPost, false);
    HttpRequest requestPost(&connectionPost, false);
-   requireStringEquals("POST", requestPost.getMethod(), "method is POST");
+   requireStringEquals("POST", std::string(requestPost.getMethod()), "method is POST");
 }
 
 //******************************************************************************
@@ -148,12 +154,12 @@ void TestHttpRequest::testGetPath() {
    MockSocket socketGet(DEFAULT_GET);
    SocketConnection connectionGet(&socketGet, false);
    HttpRequest requestGet(&connectionGet, false);
-   requireStringEquals(GET_PATH, requestGet.getPath(), "path should be GET path");
+   requireStringEquals(GET_PATH, std::string(requestGet.getPath()), "path should be GET path");
 
    MockSocket socketPost(DEFAULT_POST);
    SocketConnection connectionPost(&socketPost, false);
    HttpRequest requestPost(&connectionPost, false);
-   requireStringEquals(POST_PATH, requestPost.getPath(), "path should be POST path");
+   requireStringEquals(POST_PATH, std::string(requestPost.getPath()), "path should be POST path");
 }
 
 //******************************************************************************
@@ -204,13 +210,13 @@ void TestHttpRequest::testTwoRequestsInSingleRead() {
    SocketConnection connection(&socket, false);
 
    HttpRequest request1(&connection, false);
-   requireStringEquals(std::string("/first"), request1.getPath(), "first request path");
+   requireStringEquals(std::string("/first"), std::string(request1.getPath()), "first request path");
 
    const std::string leftover = request1.takeUnconsumedBytes();
    requireFalse(leftover.empty(), "bytes belonging to the second request should have been retained");
 
    HttpRequest request2(&connection, false, leftover);
-   requireStringEquals(std::string("/second"), request2.getPath(), "second request path");
+   requireStringEquals(std::string("/second"), std::string(request2.getPath()), "second request path");
    require(request2.takeUnconsumedBytes().empty(), "nothing should remain after the second request is fully consumed");
 }
 
@@ -234,8 +240,9 @@ void TestHttpRequest::testRequestWithBodyFollowedByNextRequest() {
    SocketConnection connection(&socket, false);
 
    HttpRequest request1(&connection, false);
-   requireStringEquals(std::string("/submit"), request1.getPath(), "first request path");
+   requireStringEquals(std::string("/submit"), std::string(request1.getPath()), "first request path");
 
+   require(request1.bufferBody(1024), "first request body should be read");
    const chaudiere::ByteBuffer* body = request1.getBody();
    require(nullptr != body, "first request body should be present");
    requireStringEquals(bodyText, std::string(body->const_data(), body->size()), "first request body content");
@@ -244,8 +251,109 @@ void TestHttpRequest::testRequestWithBodyFollowedByNextRequest() {
    requireFalse(leftover.empty(), "bytes belonging to the second request should have been retained");
 
    HttpRequest request2(&connection, false, leftover);
-   requireStringEquals(std::string("/second"), request2.getPath(), "second request path");
+   requireStringEquals(std::string("/second"), std::string(request2.getPath()), "second request path");
 }
 
 //******************************************************************************
 
+void TestHttpRequest::testNoBodyWithoutContentLength() {
+   TEST_CASE("testNoBodyWithoutContentLength");
+
+   MockSocket socket("GET /first HTTP/1.1\r\nHost: host\r\n\r\n"
+                     "GET /second HTTP/1.1\r\nHost: host\r\n\r\n");
+   SocketConnection connection(&socket, false);
+   HttpRequest request(&connection, false);
+
+   require(request.getBodyReader() == nullptr, "no body reader");
+   requireFalse(request.hasPendingBody(), "no pending body");
+   require(request.bufferBody(0), "nothing to buffer");
+   requireStringEquals("GET /second HTTP/1.1\r\nHost: host\r\n\r\n",
+                       request.takeUnconsumedBytes(),
+                       "next request left unconsumed");
+}
+
+//******************************************************************************
+
+void TestHttpRequest::testHeaderBlockTooLarge() {
+   TEST_CASE("testHeaderBlockTooLarge");
+
+   // headers that never end are refused once past the limit, rather
+   // than read for as long as the peer keeps sending
+   std::string headers = "GET / HTTP/1.1\r\n";
+   while (headers.size() <= HttpHeaderParser::MAX_HEADER_LENGTH + 8192) {
+      headers += "X-Filler: " + std::string(100, 'x') + "\r\n";
+   }
+
+   MockSocket socket(headers + "\r\n");
+   SocketConnection connection(&socket, false);
+
+   bool isRefused = false;
+   try {
+      HttpRequest request(&connection, false);
+   } catch (const chaudiere::BasicException&) {
+      isRefused = true;
+   }
+
+   require(isRefused, "an oversized header block should be refused");
+}
+
+//******************************************************************************
+
+
+static int acceptEncodingQuality(const std::string& acceptEncoding,
+                                 const std::string& coding,
+                                 bool matchWildcard=true) {
+   std::string req = "GET / HTTP/1.1\r\nHost: host\r\n";
+   if (!acceptEncoding.empty()) {
+      req += "Accept-Encoding: " + acceptEncoding + "\r\n";
+   }
+   req += "\r\n";
+
+   MockSocket socket(req);
+   SocketConnection connection(&socket, false);
+   HttpRequest request(&connection, false);
+   return request.getAcceptEncodingQuality(coding, matchWildcard);
+}
+
+static bool acceptsEncoding(const std::string& acceptEncoding,
+                            const std::string& coding) {
+   return acceptEncodingQuality(acceptEncoding, coding) > 0;
+}
+
+void TestHttpRequest::testAcceptsEncoding() {
+   TEST_CASE("testAcceptsEncoding");
+
+   requireFalse(acceptsEncoding("", "gzip"), "no Accept-Encoding header");
+   require(acceptsEncoding("gzip", "gzip"), "single coding");
+   require(acceptsEncoding("deflate, GZIP", "gzip"), "listed coding, case-insensitive");
+   require(acceptsEncoding("br;q=1.0, gzip;q=0.5", "gzip"), "non-zero q-value");
+   require(acceptsEncoding("*", "gzip"), "wildcard");
+   requireFalse(acceptsEncoding("gzip;q=0", "gzip"), "zero q-value");
+   requireFalse(acceptsEncoding("gzip ; q=0.000, br", "gzip"), "zero q-value with spaces");
+   requireFalse(acceptsEncoding("deflate, br", "gzip"), "coding not listed");
+   requireFalse(acceptsEncoding("x-gzip", "gzip"), "coding only as a substring");
+}
+
+//******************************************************************************
+
+void TestHttpRequest::testAcceptEncodingQuality() {
+   TEST_CASE("testAcceptEncodingQuality");
+
+   requireIntEquals(-1, acceptEncodingQuality("", "br"), "no Accept-Encoding header");
+   requireIntEquals(1000, acceptEncodingQuality("gzip, br", "br"), "no q-value");
+   requireIntEquals(800, acceptEncodingQuality("br;q=0.8, gzip", "br"), "q-value");
+   requireIntEquals(125, acceptEncodingQuality("zstd; Q=0.125", "zstd"), "three decimals");
+   requireIntEquals(1000, acceptEncodingQuality("zstd;q=1.000", "zstd"), "q of one");
+   requireIntEquals(0, acceptEncodingQuality("br;q=0", "br"), "q of zero");
+   requireIntEquals(-1, acceptEncodingQuality("br;q=1.5", "br"), "q above one");
+   requireIntEquals(-1, acceptEncodingQuality("br;q=0.1234", "br"), "too many decimals");
+   requireIntEquals(-1, acceptEncodingQuality("br;q=", "br"), "empty q-value");
+   requireIntEquals(300, acceptEncodingQuality("*;q=0.3", "br"), "wildcard");
+   requireIntEquals(700, acceptEncodingQuality("*;q=0.3, br;q=0.7", "br"), "coding wins over wildcard");
+   requireIntEquals(0, acceptEncodingQuality("br;q=0, *", "br"), "coding refused despite wildcard");
+   requireIntEquals(-1, acceptEncodingQuality("*", "x-zstd-dictionary", false), "wildcard not matched");
+   requireIntEquals(1000, acceptEncodingQuality("x-zstd-dictionary, *", "x-zstd-dictionary", false),
+                    "named coding without wildcard");
+}
+
+//******************************************************************************
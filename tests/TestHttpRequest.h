@@ -29,6 +29,10 @@ protected:
    void testGetArgumentKeys();
    void testTwoRequestsInSingleRead();
    void testRequestWithBodyFollowedByNextRequest();
+   void testNoBodyWithoutContentLength();
+   void testHeaderBlockTooLarge();
+   void testAcceptsEncoding();
+   void testAcceptEncodingQuality();
 
 public:
    TestHttpRequest();
@@ -0,0 +1,403 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include "TestHttpResponseCache.h"
+#include "HttpResponseCache.h"
+#include "HttpConditional.h"
+#include "AbstractHandler.h"
+#include "ByteConnection.h"
+#include "HttpRequest.h"
+#include "HttpRequestHandler.h"
+#include "HttpResponse.h"
+#include "HttpServer.h"
+#include "SocketConnection.h"
+#include "MockSocket.h"
+#include "KeyValuePairs.h"
+
+using namespace std;
+using namespace misere;
+
+namespace {
+
+// not otherwise used by the tests - the server is never run
+const int PORT = 34579;
+
+const string CATALOG = "{\"items\":[\"alpha\",\"beta\",\"gamma\"]}";
+const string REVISED_CATALOG = "{\"items\":[\"delta\"]}";
+
+shared_ptr<HttpResponseCache::Entry> makeEntry(const string& body,
+                                               unsigned long generation=0,
+                                               int ttlSeconds=60) {
+   auto entry = make_shared<HttpResponseCache::Entry>();
+   entry->statusCode = 200;
+   entry->headerFields = "Content-Type: application/json\r\n";
+   entry->body = body;
+   entry->generation = generation;
+   entry->expires = chrono::steady_clock::now() + chrono::seconds(ttlSeconds);
+   return entry;
+}
+
+class RecordingConnection : public ByteConnection
+{
+   public:
+      virtual int read(char*, int) {
+         return 0;
+      }
+
+      virtual bool write(const char* buffer, std::size_t length) {
+         bytes.append(buffer, length);
+         return true;
+      }
+
+      virtual bool writev(const Segment* segments, std::size_t count) {
+         for (std::size_t i = 0; i < count; ++i) {
+            bytes.append(segments[i].data, segments[i].length);
+         }
+         return true;
+      }
+
+      virtual void close() {
+      }
+
+      string bytes;
+};
+
+class CatalogHandler : public AbstractHandler
+{
+   public:
+      CatalogHandler() :
+         callCount(0) {
+      }
+
+      virtual void serviceRequest(const HttpRequest& request,
+                                  HttpResponse& response) {
+         ++callCount;
+         response.setContentType("application/json");
+         response.setETagFromBody(true);
+         response.setBodyView(CATALOG.data(), CATALOG.size(), nullptr);
+      }
+
+      virtual int responseCacheTtl() const {
+         return 60;
+      }
+
+      int callCount;
+};
+
+// takes over a path from a CatalogHandler, serving something else
+class RevisedCatalogHandler : public CatalogHandler
+{
+   public:
+      virtual void serviceRequest(const HttpRequest& request,
+                                  HttpResponse& response) {
+         ++callCount;
+         response.setContentType("application/json");
+         response.setBodyView(REVISED_CATALOG.data(), REVISED_CATALOG.size(), nullptr);
+      }
+};
+
+// serves the paths below its own too
+class ShopHandler : public CatalogHandler
+{
+   public:
+      virtual bool handlesSubpaths() const {
+         return true;
+      }
+};
+
+// serves a GET of the path through the server, returning what was written
+string get(HttpServer& server,
+           const string& path,
+           const string& headerLines=string()) {
+   MockSocket socket("GET " + path + " HTTP/1.1\r\nHost: localhost\r\n" +
+                     headerLines + "\r\n");
+   SocketConnection socketConnection(&socket, false);
+   HttpRequest request(&socketConnection, false);
+   RecordingConnection connection;
+   HttpRequestHandler::processRequest(server, request, connection, 1);
+   return connection.bytes;
+}
+
+}
+
+//******************************************************************************
+
+TestHttpResponseCache::TestHttpResponseCache() :
+   poivre::TestSuite("TestHttpResponseCache") {
+}
+
+//******************************************************************************
+
+void TestHttpResponseCache::runTests() {
+   testMakeKey();
+   testInsertAndFind();
+   testExpiry();
+   testGeneration();
+   testEviction();
+   testRemoveAndClear();
+   testHandlerSkippedOnHit();
+   testNotModifiedOnHit();
+   testReplacedHandler();
+   testAddedHandlerKeepsCache();
+}
+
+//******************************************************************************
+
+void TestHttpResponseCache::testMakeKey() {
+   TEST_CASE("testMakeKey");
+
+   string key = "stale";
+   HttpResponseCache::makeKey(key, "/catalog?page=2", "br");
+   requireStringEquals("/catalog?page=2\nbr", key, "target and coding");
+
+   HttpResponseCache::makeKey(key, "/catalog", "");
+   requireStringEquals("/catalog\n", key, "no coding");
+}
+
+//******************************************************************************
+
+void TestHttpResponseCache::testInsertAndFind() {
+   TEST_CASE("testInsertAndFind");
+
+   HttpResponseCache cache;
+   string identityKey;
+   string gzipKey;
+   HttpResponseCache::makeKey(identityKey, "/catalog", "");
+   HttpResponseCache::makeKey(gzipKey, "/catalog", "gzip");
+
+   require(cache.find(identityKey, 0) == nullptr, "empty cache");
+   require(cache.insert(identityKey, makeEntry(CATALOG)), "insert");
+   require(cache.insert(gzipKey, makeEntry("compressed")), "insert second representation");
+   requireIntEquals(2, (int) cache.getEntryCount(), "entry count");
+
+   shared_ptr<const HttpResponseCache::Entry> entry = cache.find(identityKey, 0);
+   require(entry != nullptr, "found");
+   requireStringEquals(CATALOG, entry->body, "identity body");
+   entry = cache.find(gzipKey, 0);
+   require(entry != nullptr, "found representation");
+   requireStringEquals("compressed", entry->body, "compressed body");
+
+   require(cache.insert(identityKey, makeEntry("replacement")), "replace");
+   requireIntEquals(2, (int) cache.getEntryCount(), "replacing doesn't add");
+   requireStringEquals("replacement", cache.find(identityKey, 0)->body, "replaced body");
+   requireIntEquals((int) (identityKey.size() + gzipKey.size() +
+                           2 * makeEntry("")->headerFields.size() +
+                           string("replacement").size() + string("compressed").size()),
+                    (int) cache.getSize(),
+                    "size accounts for keys, headers and bodies");
+}
+
+//******************************************************************************
+
+void TestHttpResponseCache::testExpiry() {
+   TEST_CASE("testExpiry");
+
+   HttpResponseCache cache;
+   string key;
+   HttpResponseCache::makeKey(key, "/catalog", "");
+
+   require(cache.insert(key, makeEntry(CATALOG, 0, -1)), "insert");
+   require(cache.find(key, 0) == nullptr, "expired entry isn't served");
+}
+
+//******************************************************************************
+
+void TestHttpResponseCache::testGeneration() {
+   TEST_CASE("testGeneration");
+
+   HttpResponseCache cache;
+   string key;
+   HttpResponseCache::makeKey(key, "/catalog", "");
+
+   require(cache.insert(key, makeEntry(CATALOG, 3)), "insert");
+   require(cache.find(key, 3) != nullptr, "current generation");
+   require(cache.find(key, 4) == nullptr, "invalidated by a later generation");
+}
+
+//******************************************************************************
+
+void TestHttpResponseCache::testEviction() {
+   TEST_CASE("testEviction");
+
+   // 16 shards of 1000 bytes each
+   HttpResponseCache cache(16000);
+   const string body(400, 'x');
+
+   string key;
+   HttpResponseCache::makeKey(key, "/large", "");
+   requireFalse(cache.insert(key, makeEntry(string(2000, 'x'))),
+                "larger than a shard");
+   require(cache.find(key, 0) == nullptr, "not cached");
+
+   for (int i = 0; i < 200; ++i) {
+      HttpResponseCache::makeKey(key, "/item/" + to_string(i), "");
+      require(cache.insert(key, makeEntry(body)), "insert");
+   }
+
+   require(cache.getSize() <= 16000, "within the size limit");
+   require(cache.getEntryCount() < 200, "oldest entries evicted");
+   HttpResponseCache::makeKey(key, "/item/199", "");
+   require(cache.find(key, 0) != nullptr, "newest entry kept");
+}
+
+//******************************************************************************
+
+void TestHttpResponseCache::testRemoveAndClear() {
+   TEST_CASE("testRemoveAndClear");
+
+   HttpResponseCache cache;
+   string first;
+   string second;
+   HttpResponseCache::makeKey(first, "/first", "");
+   HttpResponseCache::makeKey(second, "/second", "");
+   cache.insert(first, makeEntry(CATALOG));
+   cache.insert(second, makeEntry(CATALOG));
+
+   require(cache.remove(first), "remove");
+   requireFalse(cache.remove(first), "already removed");
+   require(cache.find(first, 0) == nullptr, "removed entry");
+   require(cache.find(second, 0) != nullptr, "other entry kept");
+
+   cache.clear();
+   requireIntEquals(0, (int) cache.getEntryCount(), "cleared");
+   requireIntEquals(0, (int) cache.getSize(), "no size after clear");
+}
+
+//******************************************************************************
+
+void TestHttpResponseCache::testHandlerSkippedOnHit() {
+   TEST_CASE("testHandlerSkippedOnHit");
+
+   HttpServer server(PORT);
+   chaudiere::KeyValuePairs kvp;
+   kvp.addPair("response_cache", "true");
+   server.setupResponseCache(kvp);
+   require(server.responseCache() != nullptr, "cache enabled");
+
+   CatalogHandler* handler = new CatalogHandler;
+   require(server.addPathHandler("/catalog", handler), "add handler");
+
+   const string first = get(server, "/catalog");
+   requireIntEquals(1, handler->callCount, "miss calls the handler");
+   require(first.find("200") != string::npos, "status");
+
+   const string second = get(server, "/catalog");
+   requireIntEquals(1, handler->callCount, "hit doesn't call the handler");
+   requireStringEquals(first.substr(first.find("\r\n\r\n")),
+                       second.substr(second.find("\r\n\r\n")),
+                       "same body");
+   require(second.find("Content-Type: application/json\r\n") != string::npos,
+           "cached header fields");
+
+   get(server, "/catalog?page=2");
+   requireIntEquals(2, handler->callCount, "query is part of the key");
+
+   handler->invalidateCachedResponses();
+   get(server, "/catalog");
+   requireIntEquals(3, handler->callCount, "invalidated");
+   get(server, "/catalog");
+   requireIntEquals(3, handler->callCount, "cached again");
+}
+
+//******************************************************************************
+
+void TestHttpResponseCache::testNotModifiedOnHit() {
+   TEST_CASE("testNotModifiedOnHit");
+
+   HttpServer server(PORT);
+   chaudiere::KeyValuePairs kvp;
+   kvp.addPair("response_cache", "true");
+   server.setupResponseCache(kvp);
+
+   CatalogHandler* handler = new CatalogHandler;
+   require(server.addPathHandler("/catalog", handler), "add handler");
+
+   get(server, "/catalog");
+   requireIntEquals(1, handler->callCount, "miss calls the handler");
+
+   const string etag = HttpConditional::hashETag(CATALOG.data(), CATALOG.size());
+   const string revalidated = get(server, "/catalog", "If-None-Match: " + etag + "\r\n");
+   requireIntEquals(1, handler->callCount, "hit doesn't call the handler");
+   require(revalidated.find("304 Not Modified") != string::npos, "304 from the cache");
+   require(revalidated.find("ETag: " + etag + "\r\n") != string::npos, "ETag");
+   require(revalidated.find("Content-Type") == string::npos, "no Content-Type");
+   require(revalidated.find("Content-Length") == string::npos, "no Content-Length");
+   requireStringEquals("\r\n\r\n",
+                       revalidated.substr(revalidated.size() - 4),
+                       "no body");
+
+   const string stale = get(server, "/catalog", "If-None-Match: \"0000\"\r\n");
+   require(stale.find(CATALOG) != string::npos, "stale copy gets the body");
+}
+
+//******************************************************************************
+
+void TestHttpResponseCache::testReplacedHandler() {
+   TEST_CASE("testReplacedHandler");
+
+   HttpServer server(PORT);
+   chaudiere::KeyValuePairs kvp;
+   kvp.addPair("response_cache", "true");
+   server.setupResponseCache(kvp);
+
+   CatalogHandler* handler = new CatalogHandler;
+   require(server.addPathHandler("/catalog", handler), "add handler");
+   require(get(server, "/catalog").find(CATALOG) != string::npos, "original");
+   require(get(server, "/catalog").find(CATALOG) != string::npos, "cached");
+   requireIntEquals(1, handler->callCount, "served from the cache");
+
+   // as a reload does - a new instance of the handler takes over the path
+   require(server.removePathHandler("/catalog"), "remove handler");
+   RevisedCatalogHandler* revised = new RevisedCatalogHandler;
+   require(server.addPathHandler("/catalog", revised), "add replacement");
+
+   require(get(server, "/catalog").find(REVISED_CATALOG) != string::npos,
+           "replacement's response");
+   requireIntEquals(1, revised->callCount, "replacement called");
+
+   // a generation is never reused by another handler, so an entry
+   // cached by the old one can't pass for the new one's
+   CatalogHandler other;
+   require(other.responseCacheGeneration() != revised->responseCacheGeneration(),
+           "distinct generations");
+}
+
+//******************************************************************************
+
+void TestHttpResponseCache::testAddedHandlerKeepsCache() {
+   TEST_CASE("testAddedHandlerKeepsCache");
+
+   HttpServer server(PORT);
+   chaudiere::KeyValuePairs kvp;
+   kvp.addPair("response_cache", "true");
+   server.setupResponseCache(kvp);
+
+   CatalogHandler* handler = new CatalogHandler;
+   require(server.addPathHandler("/catalog", handler), "add handler");
+   get(server, "/catalog");
+   requireIntEquals(1, handler->callCount, "handler called");
+
+   // a path nothing answered before can't have anything cached
+   require(server.addPathHandler("/other", new CatalogHandler), "add other handler");
+   get(server, "/catalog");
+   requireIntEquals(1, handler->callCount, "still served from the cache");
+
+   // but one that another handler answered (as a subpath) may
+   ShopHandler* shop = new ShopHandler;
+   require(server.addPathHandler("/shop", shop), "add subpath handler");
+   get(server, "/shop/basket");
+   requireIntEquals(1, shop->callCount, "subpath served");
+
+   CatalogHandler* basket = new CatalogHandler;
+   require(server.addPathHandler("/shop/basket", basket), "add handler for the subpath");
+   get(server, "/shop/basket");
+   requireIntEquals(1, basket->callCount, "new handler serves the subpath");
+   get(server, "/catalog");
+   requireIntEquals(2, handler->callCount, "the cache was cleared");
+}
+
+//******************************************************************************
@@ -0,0 +1,34 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef MISERE_TESTHTTPRESPONSECACHE_H
+#define MISERE_TESTHTTPRESPONSECACHE_H
+
+#include "TestSuite.h"
+
+namespace misere {
+
+class TestHttpResponseCache : public poivre::TestSuite {
+
+protected:
+   void runTests();
+
+   void testMakeKey();
+   void testInsertAndFind();
+   void testExpiry();
+   void testGeneration();
+   void testEviction();
+   void testRemoveAndClear();
+   void testHandlerSkippedOnHit();
+   void testNotModifiedOnHit();
+   void testReplacedHandler();
+   void testAddedHandlerKeepsCache();
+
+public:
+   TestHttpResponseCache();
+
+};
+
+}
+
+#endif
@@ -0,0 +1,238 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include <string>
+
+#include "TestHttpResponseWriter.h"
+#include "HttpResponseWriter.h"
+#include "HttpResponse.h"
+#include "HttpServer.h"
+#include "ByteConnection.h"
+
+using namespace std;
+using namespace misere;
+
+namespace {
+
+// not otherwise used by the tests - the server is only needed for its
+// header prefixes and date cache
+const int PORT = 34578;
+
+class RecordingConnection : public ByteConnection
+{
+   public:
+      RecordingConnection() :
+         writeCount(0) {
+      }
+
+      virtual int read(char*, int) {
+         return 0;
+      }
+
+      virtual bool write(const char* buffer, std::size_t length) {
+         ++writeCount;
+         bytes.append(buffer, length);
+         return true;
+      }
+
+      virtual bool writev(const Segment* segments, std::size_t count) {
+         ++writeCount;
+         for (std::size_t i = 0; i < count; ++i) {
+            bytes.append(segments[i].data, segments[i].length);
+         }
+         return true;
+      }
+
+      virtual void close() {
+      }
+
+      string headers() const {
+         return bytes.substr(0, bytes.find("\r\n\r\n") + 4);
+      }
+
+      string body() const {
+         return bytes.substr(bytes.find("\r\n\r\n") + 4);
+      }
+
+      string bytes;
+      int writeCount;
+};
+
+bool contains(const string& s, const string& part) {
+   return s.find(part) != string::npos;
+}
+
+}
+
+//******************************************************************************
+
+TestHttpResponseWriter::TestHttpResponseWriter() :
+   poivre::TestSuite("TestHttpResponseWriter") {
+}
+
+//******************************************************************************
+
+void TestHttpResponseWriter::runTests() {
+   HttpServer server(PORT);
+
+   testChunkedWhenNoLength(server);
+   testDeclaredContentLength(server);
+   testShortOrLongDeclaredLength(server);
+   testCloseDelimitedForHttp10(server);
+   testFinishWithoutWrites(server);
+   testHeadersSentOnce(server);
+   testHeadersOnlyForHead(server);
+}
+
+//******************************************************************************
+
+void TestHttpResponseWriter::testChunkedWhenNoLength(HttpServer& server) {
+   TEST_CASE("testChunkedWhenNoLength");
+
+   RecordingConnection connection;
+   HttpResponse response;
+   HttpResponseWriter writer(server, connection, response, true, true, false);
+
+   require(writer.write("hello", 5), "first chunk");
+   require(writer.isStarted(), "headers sent with the first chunk");
+   require(connection.writeCount == 1, "headers and first chunk in one write");
+   require(writer.write(" world, again", 13), "second chunk");
+   require(writer.finish(), "finish");
+
+   const string headers = connection.headers();
+   require(headers.compare(0, 12, "HTTP/1.1 200") == 0, "status line");
+   require(contains(headers, "Transfer-Encoding: chunked\r\n"), "chunked");
+   requireFalse(contains(headers, "Content-Length"), "no content length");
+   require(contains(headers, "Connection: keep-alive"), "keep-alive");
+   requireStringEquals("5\r\nhello\r\nd\r\n world, again\r\n0\r\n\r\n", connection.body(), "chunked body");
+   require(writer.isChunked(), "isChunked");
+   require(writer.isKeepAlive(), "connection reusable");
+   require(writer.getBytesWritten() == 18, "body bytes counted without framing");
+}
+
+//******************************************************************************
+
+void TestHttpResponseWriter::testDeclaredContentLength(HttpServer& server) {
+   TEST_CASE("testDeclaredContentLength");
+
+   RecordingConnection connection;
+   HttpResponse response;
+   response.setContentLength(5);
+   HttpResponseWriter writer(server, connection, response, true, true, false);
+
+   require(writer.write("hel", 3), "first piece");
+   require(writer.write("lo", 2), "second piece");
+   require(writer.finish(), "finish");
+
+   require(contains(connection.headers(), "Content-Length: 5\r\n"), "declared length sent");
+   requireFalse(contains(connection.headers(), "Transfer-Encoding"), "not chunked");
+   requireStringEquals("hello", connection.body(), "unframed body");
+   require(writer.isKeepAlive(), "connection reusable");
+}
+
+//******************************************************************************
+
+void TestHttpResponseWriter::testShortOrLongDeclaredLength(HttpServer& server) {
+   TEST_CASE("testShortOrLongDeclaredLength");
+
+   RecordingConnection connection;
+   HttpResponse response;
+   response.setContentLength(4);
+   HttpResponseWriter writer(server, connection, response, true, true, false);
+
+   require(writer.write("abc", 3), "within the declared length");
+   requireFalse(writer.write("de", 2), "past the declared length");
+   requireFalse(writer.finish(), "short of the declared length");
+   require(writer.hasFailed(), "failed");
+   requireFalse(writer.isKeepAlive(), "connection can't be reused");
+}
+
+//******************************************************************************
+
+void TestHttpResponseWriter::testCloseDelimitedForHttp10(HttpServer& server) {
+   TEST_CASE("testCloseDelimitedForHttp10");
+
+   RecordingConnection connection;
+   HttpResponse response;
+   HttpResponseWriter writer(server, connection, response, true, false, false);
+
+   require(writer.write("abc", 3), "write");
+   require(writer.finish(), "finish");
+
+   const string headers = connection.headers();
+   requireFalse(contains(headers, "Transfer-Encoding"), "HTTP/1.0 can't be sent chunked");
+   requireFalse(contains(headers, "Content-Length"), "length unknown");
+   require(contains(headers, "Connection: close"), "body ends with the connection");
+   requireStringEquals("abc", connection.body(), "unframed body");
+   requireFalse(writer.isKeepAlive(), "connection closes");
+}
+
+//******************************************************************************
+
+void TestHttpResponseWriter::testFinishWithoutWrites(HttpServer& server) {
+   TEST_CASE("testFinishWithoutWrites");
+
+   RecordingConnection connection;
+   HttpResponse response;
+   response.setStatusCode(204);
+   HttpResponseWriter writer(server, connection, response, true, true, false);
+
+   require(writer.finish(), "finish");
+   require(connection.headers().compare(0, 12, "HTTP/1.1 204") == 0, "status line");
+   require(contains(connection.headers(), "Content-Length: 0\r\n"), "empty body has a length");
+   requireStringEquals("", connection.body(), "no body");
+   require(writer.isKeepAlive(), "connection reusable");
+}
+
+//******************************************************************************
+
+void TestHttpResponseWriter::testHeadersSentOnce(HttpServer& server) {
+   TEST_CASE("testHeadersSentOnce");
+
+   RecordingConnection connection;
+   HttpResponse response;
+   response.setHeaderValue("X-Before", "1");
+   HttpResponseWriter writer(server, connection, response, true, true, false);
+
+   require(writer.flush(), "headers flushed");
+   response.setHeaderValue("X-After", "2");
+   require(writer.write("x", 1), "write");
+   require(writer.finish(), "finish");
+   requireFalse(writer.write("y", 1), "nothing after finish");
+
+   const string headers = connection.headers();
+   require(contains(headers, "X-Before: 1\r\n"), "header set before the first write");
+   requireFalse(contains(connection.bytes, "X-After"), "header set after the first write");
+   requireStringEquals("1\r\nx\r\n0\r\n\r\n", connection.body(), "chunked body");
+}
+
+//******************************************************************************
+
+void TestHttpResponseWriter::testHeadersOnlyForHead(HttpServer& server) {
+   TEST_CASE("testHeadersOnlyForHead");
+
+   RecordingConnection connection;
+   HttpResponse response;
+   response.setContentLength(5);
+   HttpResponseWriter writer(server, connection, response, true, true, true);
+
+   require(writer.write("hel", 3), "first piece");
+   require(writer.write("lo", 2), "second piece");
+   require(writer.finish(), "finish");
+
+   require(contains(connection.headers(), "Content-Length: 5\r\n"), "declared length sent");
+   require(connection.body().empty(), "no body");
+   require(writer.getBytesWritten() == 5, "body bytes still counted");
+   require(writer.isKeepAlive(), "connection reusable");
+
+   // with no declared length the headers are all there is, chunked or not
+   RecordingConnection chunkedConnection;
+   HttpResponse chunkedResponse;
+   HttpResponseWriter chunkedWriter(server, chunkedConnection, chunkedResponse, true, true, true);
+   require(chunkedWriter.write("hello", 5), "first chunk");
+   require(chunkedWriter.finish(), "finish");
+   require(chunkedConnection.body().empty(), "no chunks and no last chunk");
+   require(chunkedWriter.isKeepAlive(), "connection reusable");
+}
+
+//******************************************************************************
@@ -0,0 +1,33 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef MISERE_TESTHTTPRESPONSEWRITER_H
+#define MISERE_TESTHTTPRESPONSEWRITER_H
+
+#include "TestSuite.h"
+
+namespace misere {
+
+class HttpServer;
+
+class TestHttpResponseWriter : public poivre::TestSuite {
+
+protected:
+   void runTests();
+
+   void testChunkedWhenNoLength(HttpServer& server);
+   void testDeclaredContentLength(HttpServer& server);
+   void testShortOrLongDeclaredLength(HttpServer& server);
+   void testCloseDelimitedForHttp10(HttpServer& server);
+   void testFinishWithoutWrites(HttpServer& server);
+   void testHeadersSentOnce(HttpServer& server);
+   void testHeadersOnlyForHead(HttpServer& server);
+
+public:
+   TestHttpResponseWriter();
+
+};
+
+}
+
+#endif
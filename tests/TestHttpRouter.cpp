@@ -0,0 +1,405 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "TestHttpRouter.h"
+#include "HttpRouter.h"
+#include "EpochReclaimer.h"
+#include "AbstractHandler.h"
+#include "ByteBuffer.h"
+#include "ByteConnection.h"
+#include "HttpRequest.h"
+#include "HttpRequestHandler.h"
+#include "HttpResponse.h"
+#include "HttpServer.h"
+#include "SocketConnection.h"
+#include "MockSocket.h"
+
+using namespace std;
+using namespace misere;
+
+namespace {
+
+// not otherwise used by the tests - the server is never run
+const int PORT = 34583;
+
+class NamedHandler : public AbstractHandler
+{
+   public:
+      explicit NamedHandler(const string& handlerName) :
+         name(handlerName) {
+      }
+
+      virtual void serviceRequest(const HttpRequest& request,
+                                  HttpResponse& response) {
+         // the captured parameters, as name=value lines
+         string body;
+         const HttpRouteParameters& parameters = request.getRouteParameters();
+         for (size_t i = 0; i < parameters.size(); ++i) {
+            body.append(parameters.getName(i));
+            body += '=';
+            body.append(parameters.getValue(i));
+            body += '\n';
+         }
+         response.setContentType("text/plain");
+         response.setBody(new chaudiere::ByteBuffer(body));
+      }
+
+      string name;
+};
+
+class MountHandler : public NamedHandler
+{
+   public:
+      explicit MountHandler(const string& handlerName) :
+         NamedHandler(handlerName) {
+      }
+
+      virtual bool handlesSubpaths() const {
+         return true;
+      }
+};
+
+class RecordingConnection : public ByteConnection
+{
+   public:
+      virtual int read(char*, int) {
+         return 0;
+      }
+
+      virtual bool write(const char* buffer, std::size_t length) {
+         bytes.append(buffer, length);
+         return true;
+      }
+
+      virtual bool writev(const Segment* segments, std::size_t count) {
+         for (std::size_t i = 0; i < count; ++i) {
+            bytes.append(segments[i].data, segments[i].length);
+         }
+         return true;
+      }
+
+      virtual void close() {
+      }
+
+      string bytes;
+};
+
+// the name of the handler the router picks for a path ("" for none)
+string route(const HttpRouter& router, const string& path) {
+   HttpRouteParameters parameters;
+   const NamedHandler* handler =
+      static_cast<const NamedHandler*>(router.find(path, parameters));
+   return (handler != nullptr) ? handler->name : string();
+}
+
+}
+
+//******************************************************************************
+
+TestHttpRouter::TestHttpRouter() :
+   poivre::TestSuite("TestHttpRouter") {
+}
+
+//******************************************************************************
+
+void TestHttpRouter::runTests() {
+   testExactRoutes();
+   testSharedPrefixes();
+   testParameters();
+   testCatchAll();
+   testPrecedence();
+   testMounts();
+   testRejectedRoutes();
+   testRemove();
+   testParametersReachHandler();
+   testRoutesChangedWhileRouting();
+}
+
+//******************************************************************************
+
+void TestHttpRouter::testExactRoutes() {
+   TEST_CASE("testExactRoutes");
+
+   NamedHandler echo("echo");
+   NamedHandler status("status");
+   HttpRouter router;
+   require(router.add("/Echo", &echo, false), "add /Echo");
+   require(router.add("/ServerStatus", &status, false), "add /ServerStatus");
+   requireIntEquals(2, (int) router.size(), "size");
+
+   requireStringEquals("echo", route(router, "/Echo"), "exact");
+   requireStringEquals("status", route(router, "/ServerStatus"), "exact");
+   requireStringEquals("", route(router, "/Ech"), "prefix of a route");
+   requireStringEquals("", route(router, "/Echo/more"), "below a route");
+   requireStringEquals("", route(router, "/echo"), "case matters");
+   requireStringEquals("", route(router, ""), "empty path");
+}
+
+//******************************************************************************
+
+void TestHttpRouter::testSharedPrefixes() {
+   TEST_CASE("testSharedPrefixes");
+
+   NamedHandler users("users");
+   NamedHandler user("user");
+   NamedHandler usage("usage");
+   NamedHandler root("root");
+   HttpRouter router;
+   require(router.add("/users", &users, false), "add /users");
+   require(router.add("/user", &user, false), "add /user (splits an edge)");
+   require(router.add("/usage", &usage, false), "add /usage (splits again)");
+   require(router.add("/", &root, false), "add /");
+
+   requireStringEquals("users", route(router, "/users"), "/users");
+   requireStringEquals("user", route(router, "/user"), "/user");
+   requireStringEquals("usage", route(router, "/usage"), "/usage");
+   requireStringEquals("root", route(router, "/"), "/");
+   requireStringEquals("", route(router, "/us"), "split point has no route");
+}
+
+//******************************************************************************
+
+void TestHttpRouter::testParameters() {
+   TEST_CASE("testParameters");
+
+   NamedHandler user("user");
+   NamedHandler post("post");
+   HttpRouter router;
+   require(router.add("/users/:id", &user, false), "add /users/:id");
+   require(router.add("/users/:id/posts/:postId", &post, false), "add posts");
+
+   HttpRouteParameters parameters;
+   require(router.find("/users/42", parameters) == &user, "one parameter");
+   requireIntEquals(1, (int) parameters.size(), "one captured");
+   requireStringEquals("42", string(parameters.get("id")), "id");
+
+   require(router.find("/users/42/posts/7", parameters) == &post, "two parameters");
+   requireStringEquals("42", string(parameters.get("id")), "id");
+   requireStringEquals("7", string(parameters.get("postId")), "postId");
+   require(parameters.has("postId"), "has postId");
+   requireFalse(parameters.has("other"), "no other");
+
+   require(router.find("/users/", parameters) == nullptr, "empty segment");
+   require(router.find("/users/42/posts", parameters) == nullptr, "incomplete");
+   require(router.find("/users/42/", parameters) == nullptr, "trailing slash");
+}
+
+//******************************************************************************
+
+void TestHttpRouter::testCatchAll() {
+   TEST_CASE("testCatchAll");
+
+   NamedHandler files("files");
+   HttpRouter router;
+   require(router.add("/files/*path", &files, false), "add catch-all");
+
+   HttpRouteParameters parameters;
+   require(router.find("/files/css/site.css", parameters) == &files, "nested");
+   requireStringEquals("css/site.css", string(parameters.get("path")), "rest of path");
+
+   require(router.find("/files/", parameters) == &files, "nothing after it");
+   requireStringEquals("", string(parameters.get("path")), "empty rest");
+   require(parameters.has("path"), "captured though empty");
+
+   require(router.find("/files", parameters) == nullptr, "without the slash");
+}
+
+//******************************************************************************
+
+void TestHttpRouter::testPrecedence() {
+   TEST_CASE("testPrecedence");
+
+   NamedHandler me("me");
+   NamedHandler user("user");
+   NamedHandler settings("settings");
+   NamedHandler other("other");
+   HttpRouter router;
+   require(router.add("/users/me", &me, false), "add literal");
+   require(router.add("/users/:id", &user, false), "add parameter");
+   require(router.add("/users/me/settings", &settings, false), "add deeper literal");
+   require(router.add("/users/*rest", &other, false), "add catch-all");
+
+   requireStringEquals("me", route(router, "/users/me"), "literal first");
+   requireStringEquals("user", route(router, "/users/mel"), "then parameter");
+   requireStringEquals("settings", route(router, "/users/me/settings"), "literal");
+   requireStringEquals("other", route(router, "/users/me/photos"), "then catch-all");
+
+   HttpRouteParameters parameters;
+   require(router.find("/users/mel", parameters) == &user, "backs out of /users/me");
+   requireStringEquals("mel", string(parameters.get("id")), "whole segment");
+   require(router.find("/users/42/photos", parameters) == &other, "backs out of :id");
+   requireIntEquals(1, (int) parameters.size(), "abandoned capture dropped");
+   requireStringEquals("42/photos", string(parameters.get("rest")), "rest");
+}
+
+//******************************************************************************
+
+void TestHttpRouter::testMounts() {
+   TEST_CASE("testMounts");
+
+   MountHandler staticFiles("static");
+   MountHandler images("images");
+   NamedHandler logo("logo");
+   MountHandler root("root");
+   HttpRouter router;
+   require(router.add("/static", &staticFiles, true), "mount /static");
+   require(router.add("/static/images", &images, true), "mount /static/images");
+   require(router.add("/static/images/logo.png", &logo, false), "exact route");
+
+   requireStringEquals("static", route(router, "/static"), "the mount itself");
+   requireStringEquals("static", route(router, "/static/"), "trailing slash");
+   requireStringEquals("static", route(router, "/static/css/site.css"), "below it");
+   requireStringEquals("images", route(router, "/static/images/a.png"), "nearest mount");
+   requireStringEquals("images", route(router, "/static/images/logo.png.bak"),
+                       "mount when the exact route doesn't match");
+   requireStringEquals("logo", route(router, "/static/images/logo.png"), "exact wins");
+   requireStringEquals("", route(router, "/staticx"), "segment boundary");
+   requireStringEquals("", route(router, "/other"), "outside the mount");
+
+   require(router.add("/", &root, true), "mount /");
+   requireStringEquals("root", route(router, "/other"), "root mount");
+   requireStringEquals("static", route(router, "/static/x"), "still the nearest");
+
+   MountHandler user("user");
+   require(router.add("/users/:id", &user, true), "mount with a parameter");
+   HttpRouteParameters parameters;
+   require(router.find("/users/7/avatar", parameters) == &user, "below it");
+   requireStringEquals("7", string(parameters.get("id")), "captured for a mount");
+}
+
+//******************************************************************************
+
+void TestHttpRouter::testRejectedRoutes() {
+   TEST_CASE("testRejectedRoutes");
+
+   NamedHandler a("a");
+   NamedHandler b("b");
+   HttpRouter router;
+   require(router.add("/users/:id", &a, false), "add");
+   requireFalse(router.add("/users/:id", &b, false), "already taken");
+   requireFalse(router.add("/users/:name/posts", &b, false), "parameter renamed");
+   requireFalse(router.add("users", &b, false), "not absolute");
+   requireFalse(router.add("", &b, false), "empty");
+   requireFalse(router.add("/x", nullptr, false), "no handler");
+   requireFalse(router.add("/files/*path/more", &b, false), "catch-all not last");
+   requireFalse(router.add("/users/:", &b, false), "unnamed parameter");
+   requireIntEquals(1, (int) router.size(), "only the first was added");
+
+   require(router.add("/a:b/*c*d", &b, false), "markers only start segments");
+   HttpRouteParameters parameters;
+   require(router.find("/a:b/x/y", parameters) == &b, "literal colon");
+   requireStringEquals("x/y", string(parameters.get("c*d")), "name");
+}
+
+//******************************************************************************
+
+void TestHttpRouter::testRemove() {
+   TEST_CASE("testRemove");
+
+   NamedHandler users("users");
+   NamedHandler user("user");
+   HttpRouter router;
+   require(router.add("/users", &users, false), "add /users");
+   require(router.add("/users/:id", &user, false), "add /users/:id");
+
+   require(router.remove("/users"), "remove /users");
+   requireFalse(router.remove("/users"), "already removed");
+   requireFalse(router.remove("/use"), "never added");
+   requireFalse(router.remove("/users/:other"), "different name");
+   requireIntEquals(1, (int) router.size(), "one left");
+
+   requireStringEquals("", route(router, "/users"), "removed");
+   requireStringEquals("user", route(router, "/users/3"), "the other still routes");
+
+   require(router.add("/users", &users, false), "added again");
+   requireStringEquals("users", route(router, "/users"), "routes again");
+}
+
+//******************************************************************************
+
+void TestHttpRouter::testParametersReachHandler() {
+   TEST_CASE("testParametersReachHandler");
+
+   HttpServer server(PORT);
+   require(server.addPathHandler("/orders/:orderId/items/:item",
+                                 new NamedHandler("items")),
+           "add route");
+   requireFalse(server.addPathHandler("/orders/:orderId/items/:item",
+                                      new NamedHandler("duplicate")),
+                "duplicate refused");
+
+   MockSocket socket("GET /orders/1001/items/3?expand=true HTTP/1.1\r\n"
+                     "Host: localhost\r\n\r\n");
+   SocketConnection socketConnection(&socket, false);
+   HttpRequest request(&socketConnection, false);
+   RecordingConnection connection;
+   HttpRequestHandler::processRequest(server, request, connection, 1);
+
+   require(connection.bytes.find("200 OK") != string::npos, "routed");
+   require(connection.bytes.find("\r\n\r\norderId=1001\nitem=3\n") != string::npos,
+           "parameters, without the query");
+   requireStringEquals("1001", string(request.getRouteParameter("orderId")),
+                       "on the request");
+}
+
+//******************************************************************************
+
+void TestHttpRouter::testRoutesChangedWhileRouting() {
+   TEST_CASE("testRoutesChangedWhileRouting");
+
+   const int READER_COUNT = 4;
+   const int CHANGE_COUNT = 2000;
+
+   HttpServer server(PORT);
+   require(server.addPathHandler("/stable", new NamedHandler("stable")), "add /stable");
+
+   atomic<bool> isDone(false);
+   atomic<int> badRoutes(0);
+
+   vector<thread> readers;
+   for (int i = 0; i < READER_COUNT; ++i) {
+      readers.emplace_back([&server, &isDone, &badRoutes]() {
+         while (!isDone.load()) {
+            EpochReclaimer::ReadGuard guard;
+            HttpRouteParameters parameters;
+            const NamedHandler* stable =
+               static_cast<const NamedHandler*>(server.getPathHandler("/stable"));
+            if ((stable == nullptr) || (stable->name != "stable")) {
+               ++badRoutes;
+            }
+
+            // there or not, but whole if it's there
+            const NamedHandler* churn = static_cast<const NamedHandler*>(
+               server.getPathHandler("/churn/7", parameters));
+            if ((churn != nullptr) &&
+                ((churn->name != "churn") || (parameters.get("id") != "7"))) {
+               ++badRoutes;
+            }
+         }
+      });
+   }
+
+   int failedChanges = 0;
+   for (int i = 0; i < CHANGE_COUNT; ++i) {
+      if (!server.addPathHandler("/churn/:id", new NamedHandler("churn")) ||
+          !server.removePathHandler("/churn/:id")) {
+         ++failedChanges;
+      }
+   }
+
+   isDone.store(true);
+   for (thread& reader : readers) {
+      reader.join();
+   }
+
+   requireIntEquals(0, failedChanges, "every change applied");
+   requireIntEquals(0, badRoutes.load(), "lookups only saw whole tables");
+   require(server.getPathHandler("/churn/7") == nullptr, "removed in the end");
+}
+
+//******************************************************************************
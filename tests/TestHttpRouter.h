@@ -0,0 +1,34 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef MISERE_TESTHTTPROUTER_H
+#define MISERE_TESTHTTPROUTER_H
+
+#include "TestSuite.h"
+
+namespace misere {
+
+class TestHttpRouter : public poivre::TestSuite {
+
+protected:
+   void runTests();
+
+   void testExactRoutes();
+   void testSharedPrefixes();
+   void testParameters();
+   void testCatchAll();
+   void testPrecedence();
+   void testMounts();
+   void testRejectedRoutes();
+   void testRemove();
+   void testParametersReachHandler();
+   void testRoutesChangedWhileRouting();
+
+public:
+   TestHttpRouter();
+
+};
+
+}
+
+#endif
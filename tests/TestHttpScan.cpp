@@ -0,0 +1,168 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include <string>
+#include <vector>
+
+#include "TestHttpScan.h"
+#include "HttpScan.h"
+
+using namespace std;
+using namespace misere;
+
+namespace {
+
+// runs check once per implementation this CPU supports, restoring the
+// original selection afterward
+template <typename Check>
+void forEachImplementation(Check check) {
+   const string original = HttpScan::getImplementationName();
+   for (const string& name : HttpScan::getAvailableImplementations()) {
+      HttpScan::selectImplementation(name);
+      check(name);
+   }
+   HttpScan::selectImplementation(original);
+}
+
+// positions chosen to land on and either side of the 16 and 32 byte
+// boundaries the vector kernels step by
+const vector<size_t> POSITIONS = { 0, 1, 14, 15, 16, 17, 28, 29, 31, 32, 33, 63, 64, 100 };
+
+}
+
+//******************************************************************************
+
+TestHttpScan::TestHttpScan() :
+   poivre::TestSuite("TestHttpScan") {
+}
+
+//******************************************************************************
+
+void TestHttpScan::runTests() {
+   testFindByte();
+   testFindEol();
+   testFindHeaderTerminator();
+   testImplementationsAgree();
+}
+
+//******************************************************************************
+
+void TestHttpScan::testFindByte() {
+   TEST_CASE("testFindByte");
+
+   forEachImplementation([this](const string& name) {
+      for (size_t pos : POSITIONS) {
+         string buffer(pos + 40, 'a');
+         buffer[pos] = ':';
+         buffer[pos + 5] = ':';
+         const char* begin = buffer.data();
+         const char* end = begin + buffer.size();
+         require(HttpScan::findByte(begin, end, ':') == begin + pos,
+                 name + ": first occurrence should be found");
+         require(HttpScan::findByte(begin, begin + pos, ':') == begin + pos,
+                 name + ": byte past the end of the range should not be found");
+      }
+
+      const string empty;
+      require(HttpScan::findByte(empty.data(), empty.data(), ':') == empty.data(),
+              name + ": empty range should return end");
+   });
+}
+
+//******************************************************************************
+
+void TestHttpScan::testFindEol() {
+   TEST_CASE("testFindEol");
+
+   forEachImplementation([this](const string& name) {
+      for (size_t pos : POSITIONS) {
+         // a lone CR before the real line ending must be skipped
+         string buffer(pos + 40, 'x');
+         buffer[pos] = '\r';
+         buffer[pos + 3] = '\r';
+         buffer[pos + 4] = '\n';
+         const char* begin = buffer.data();
+         const char* end = begin + buffer.size();
+         require(HttpScan::findEol(begin, end) == begin + pos + 3,
+                 name + ": CRLF should be found past a lone CR");
+      }
+
+      // a CR as the last byte of the range isn't a line ending
+      const string trailingCr = "abc\r";
+      const char* end = trailingCr.data() + trailingCr.size();
+      require(HttpScan::findEol(trailingCr.data(), end) == end,
+              name + ": trailing CR should not match");
+   });
+}
+
+//******************************************************************************
+
+void TestHttpScan::testFindHeaderTerminator() {
+   TEST_CASE("testFindHeaderTerminator");
+
+   forEachImplementation([this](const string& name) {
+      for (size_t pos : POSITIONS) {
+         // partial terminators first, then the real one
+         string buffer(pos + 48, 'h');
+         buffer.replace(0, 3, "\r\n\r");
+         buffer.replace(pos + 4, 4, "\r\n\r\n");
+         const char* begin = buffer.data();
+         const char* end = begin + buffer.size();
+         require(HttpScan::findHeaderTerminator(begin, end) == begin + pos + 4,
+                 name + ": terminator should be found");
+
+         // cut off the last LF - no match
+         require(HttpScan::findHeaderTerminator(begin, begin + pos + 7) == begin + pos + 7,
+                 name + ": incomplete terminator should not match");
+      }
+   });
+}
+
+//******************************************************************************
+
+void TestHttpScan::testImplementationsAgree() {
+   TEST_CASE("testImplementationsAgree");
+
+   // pseudo-random buffers heavy in the bytes the kernels look for
+   const char alphabet[] = { '\r', '\n', ':', ' ', 'a' };
+   unsigned int seed = 12345;
+   vector<string> buffers;
+   for (int i = 0; i < 200; ++i) {
+      string buffer;
+      const size_t length = i % 97;
+      for (size_t j = 0; j < length; ++j) {
+         seed = seed * 1103515245 + 12345;
+         buffer += alphabet[(seed >> 16) % sizeof(alphabet)];
+      }
+      buffers.push_back(buffer);
+   }
+
+   const string original = HttpScan::getImplementationName();
+   HttpScan::selectImplementation("scalar");
+   vector<size_t> expected;
+   for (const string& buffer : buffers) {
+      const char* begin = buffer.data();
+      const char* end = begin + buffer.size();
+      expected.push_back(HttpScan::findByte(begin, end, ':') - begin);
+      expected.push_back(HttpScan::findEol(begin, end) - begin);
+      expected.push_back(HttpScan::findHeaderTerminator(begin, end) - begin);
+   }
+
+   forEachImplementation([&](const string& name) {
+      size_t i = 0;
+      for (const string& buffer : buffers) {
+         const char* begin = buffer.data();
+         const char* end = begin + buffer.size();
+         require((size_t) (HttpScan::findByte(begin, end, ':') - begin) == expected[i++],
+                 name + ": findByte should match scalar");
+         require((size_t) (HttpScan::findEol(begin, end) - begin) == expected[i++],
+                 name + ": findEol should match scalar");
+         require((size_t) (HttpScan::findHeaderTerminator(begin, end) - begin) == expected[i++],
+                 name + ": findHeaderTerminator should match scalar");
+      }
+   });
+
+   HttpScan::selectImplementation(original);
+}
+
+//******************************************************************************
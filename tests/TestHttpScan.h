@@ -0,0 +1,28 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef MISERE_TESTHTTPSCAN_H
+#define MISERE_TESTHTTPSCAN_H
+
+#include "TestSuite.h"
+
+namespace misere {
+
+class TestHttpScan : public poivre::TestSuite {
+
+protected:
+   void runTests();
+
+   void testFindByte();
+   void testFindEol();
+   void testFindHeaderTerminator();
+   void testImplementationsAgree();
+
+public:
+   TestHttpScan();
+
+};
+
+}
+
+#endif
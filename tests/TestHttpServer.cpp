@@ -1,10 +1,96 @@
 // Copyright Paul Dardeau, SwampBits LLC 2014
 // BSD License
 
-#include "TestHttpServer.h"
+#include <map>
+#include <string>
 
+#include "TestHttpServer.h"
+#include "AbstractHandler.h"
+#include "ByteConnection.h"
+#include "HttpRequest.h"
+#include "HttpRequestHandler.h"
+#include "HttpServer.h"
+#include "ServerReloadHandler.h"
+#include "SocketConnection.h"
+#include "MockSocket.h"
+#include "SectionedConfigDataSource.h"
+
+using namespace std;
 using namespace misere;
 
+namespace {
+
+// not otherwise used by the tests - the server is never run
+const int PORT = 34584;
+
+// a configuration held in memory rather than read from a file
+class ConfigSections : public chaudiere::SectionedConfigDataSource
+{
+   public:
+      void add(const string& section, const string& key, const string& value) {
+         sections[section][key] = value;
+      }
+
+      virtual bool hasSection(const string& section) const {
+         return sections.find(section) != sections.end();
+      }
+
+      virtual bool readSection(const string& section,
+                               chaudiere::KeyValuePairs& kvp) const {
+         auto it = sections.find(section);
+         if (it == sections.end()) {
+            return false;
+         }
+
+         for (const auto& pair : it->second) {
+            kvp.addPair(pair.first, pair.second);
+         }
+         return true;
+      }
+
+   private:
+      map<string, map<string, string>> sections;
+};
+
+class RecordingConnection : public ByteConnection
+{
+   public:
+      virtual int read(char*, int) {
+         return 0;
+      }
+
+      virtual bool write(const char* buffer, std::size_t length) {
+         bytes.append(buffer, length);
+         return true;
+      }
+
+      virtual bool writev(const Segment* segments, std::size_t count) {
+         for (std::size_t i = 0; i < count; ++i) {
+            bytes.append(segments[i].data, segments[i].length);
+         }
+         return true;
+      }
+
+      virtual void close() {
+      }
+
+      string bytes;
+};
+
+// serves a POST of the path through the server, returning what was written.
+// the request comes over a mock socket, so never from loopback
+string post(HttpServer& server, const string& path, const string& headerLines) {
+   MockSocket socket("POST " + path + " HTTP/1.1\r\nHost: localhost\r\n" +
+                     "Content-Length: 0\r\n" + headerLines + "\r\n");
+   SocketConnection socketConnection(&socket, false);
+   HttpRequest request(&socketConnection, false);
+   RecordingConnection connection;
+   HttpRequestHandler::processRequest(server, request, connection, 1);
+   return connection.bytes;
+}
+
+}
+
 //******************************************************************************
 
 TestHttpServer::TestHttpServer() :
@@ -32,6 +118,9 @@ void TestHttpServer::runTests() {
    testGetSocketReceiveBufferSize();
    testGetServerId();
    testPlatformPointerSizeBits();
+   testReloadWithoutConfigFile();
+   testReloadHandlers();
+   testReloadRequiresAuthorization();
 }
 
 //******************************************************************************
@@ -162,3 +251,81 @@ void TestHttpServer::testPlatformPointerSizeBits() {
 
 //******************************************************************************
 
+
+void TestHttpServer::testReloadWithoutConfigFile() {
+   TEST_CASE("testReloadWithoutConfigFile");
+
+   HttpServer server(PORT);
+   requireFalse(server.reload(), "nothing to re-read");
+}
+
+//******************************************************************************
+
+void TestHttpServer::testReloadHandlers() {
+   TEST_CASE("testReloadHandlers");
+
+   HttpServer server(PORT);
+   AbstractHandler* kept = new AbstractHandler;
+   require(server.addPathHandler("/kept", kept), "add /kept");
+
+   // a module that can't be loaded fails the whole reload
+   ConfigSections broken;
+   broken.add("handlers", "/reports", "reports_module");
+   broken.add("reports_module", "dll", "/nonexistent/libreports_module.so");
+   requireFalse(server.reloadHandlers(broken), "missing library");
+
+   // a bare name is looked up on the library search path, not copied
+   // from (or quietly loaded in place of) the working directory
+   ConfigSections bare;
+   bare.add("handlers", "/reports", "reports_module");
+   bare.add("reports_module", "dll", "libmisere_no_such_module.so");
+   requireFalse(server.reloadHandlers(bare), "missing library by name");
+
+   ConfigSections unconfigured;
+   unconfigured.add("handlers", "/reports", "reports_module");
+   requireFalse(server.reloadHandlers(unconfigured), "missing module section");
+
+   require(server.getPathHandler("/reports") == nullptr, "nothing added");
+   require(server.getPathHandler("/kept") == kept, "routes unchanged");
+
+   // handlers that weren't loaded from modules outlast a reload
+   ConfigSections empty;
+   empty.add("handlers", "/unused", "");
+   require(server.reloadHandlers(empty), "reload with no modules");
+   require(server.getPathHandler("/kept") == kept, "registered handler kept");
+}
+
+//******************************************************************************
+
+void TestHttpServer::testReloadRequiresAuthorization() {
+   TEST_CASE("testReloadRequiresAuthorization");
+
+   HttpServer server(PORT);
+   require(server.addPathHandler("/open",
+                                 new ServerReloadHandler(server, "", true)),
+           "add /open");
+   require(server.addPathHandler("/admin/reload",
+                                 new ServerReloadHandler(server, "s3cret", false)),
+           "add /admin/reload");
+
+   // without a secret only a (trusted) loopback client may reload
+   require(post(server, "/open", "Authorization: Bearer \r\n")
+              .find("403") != string::npos, "no secret configured");
+
+   require(post(server, "/admin/reload", "").find("403") != string::npos,
+           "no credentials");
+   require(post(server, "/admin/reload", "Authorization: Bearer s3cre\r\n")
+              .find("403") != string::npos, "short secret");
+   require(post(server, "/admin/reload", "Authorization: Bearer s3creT\r\n")
+              .find("403") != string::npos, "wrong secret");
+   require(post(server, "/admin/reload", "Authorization: Basic s3cret\r\n")
+              .find("403") != string::npos, "not a bearer token");
+
+   // allowed through - the reload itself fails with no config file to read
+   const string reloaded =
+      post(server, "/admin/reload", "Authorization: Bearer s3cret\r\n");
+   require(reloaded.find("403") == string::npos, "right secret");
+   require(reloaded.find("500") != string::npos, "reload attempted");
+}
+
+//******************************************************************************
@@ -31,6 +31,9 @@ protected:
    void testGetSocketReceiveBufferSize();
    void testGetServerId();
    void testPlatformPointerSizeBits();
+   void testReloadWithoutConfigFile();
+   void testReloadHandlers();
+   void testReloadRequiresAuthorization();
 
 public:
    TestHttpServer();
@@ -68,6 +68,8 @@ void TestHttpTransaction::runTests() {
    testAssignmentMove();
    testStreamFromSocket();
    testStreamFromSocketWithBody();
+   testStreamedBody();
+   testBodyOverLimit();
    testStreamFromSocketSequentialRequests();
    testGetRawHeader();
    testGetBody();
@@ -206,30 +208,30 @@ void TestHttpTransaction::testStreamFromSocket() {
    require(txn.streamFromConnection(), "streamFromConnection");
 
    // request line
-   requireStringEquals(verb, txn.getRequestMethod(), "http verb");
-   requireStringEquals(resource, txn.getRequestPath(), "request path");
-   requireStringEquals(protocol, txn.getProtocol(), "protocol");
-   requireStringEquals(request_line, txn.getFirstHeaderLine(), "request line");
+   requireStringEquals(verb, string(txn.getRequestMethod()), "http verb");
+   requireStringEquals(resource, string(txn.getRequestPath()), "request path");
+   requireStringEquals(protocol, string(txn.getProtocol()), "protocol");
+   requireStringEquals(request_line, string(txn.getFirstHeaderLine()), "request line");
 
    // host
    require(txn.hasHeaderValue(key_host), "host header exists");
-   requireStringEquals(host, txn.getHeaderValue(key_host), "host");
+   requireStringEquals(host, string(txn.getHeaderValue(key_host)), "host");
 
    // accept
    require(txn.hasHeaderValue(key_accept), "accept header exists");
-   requireStringEquals(accept, txn.getHeaderValue(key_accept), "accept");
+   requireStringEquals(accept, string(txn.getHeaderValue(key_accept)), "accept");
 
    // accept language
    require(txn.hasHeaderValue(key_accept_language), "accept language exists");
-   requireStringEquals(accept_language, txn.getHeaderValue(key_accept_language), "accept language");
+   requireStringEquals(accept_language, string(txn.getHeaderValue(key_accept_language)), "accept language");
 
    // accept encoding
    require(txn.hasHeaderValue(key_accept_encoding), "accept encoding exists");
-   requireStringEquals(accept_encoding, txn.getHeaderValue(key_accept_encoding), "accept encoding");
+   requireStringEquals(accept_encoding, string(txn.getHeaderValue(key_accept_encoding)), "accept encoding");
 
    // user agent
    require(txn.hasHeaderValue(key_user_agent), "user agent exists");
-   requireStringEquals(user_agent, txn.getHeaderValue(key_user_agent), "user agent");
+   requireStringEquals(user_agent, string(txn.getHeaderValue(key_user_agent)), "user agent");
 }
 
 //*****************************************************************************
@@ -258,7 +260,9 @@ void TestHttpTransaction::testStreamFromSocketWithBody() {
    TestableHttpTransaction txn(&connection, false);
 
    require(txn.streamFromConnection(), "streamFromConnection with body");
+   require(nullptr == txn.getBody(), "body shouldn't be read until asked for");
 
+   require(txn.bufferBody((long) bodyText.size()), "bufferBody");
    const chaudiere::ByteBuffer* body = txn.getBody();
    require(nullptr != body, "body should be present");
    require((int) bodyText.size() == body->size(), "body size should match Content-Length");
@@ -267,6 +271,83 @@ void TestHttpTransaction::testStreamFromSocketWithBody() {
 
 //*****************************************************************************
 
+void TestHttpTransaction::testStreamedBody() {
+   TEST_CASE("testStreamedBody");
+
+   const string bodyText = "name=value&other=thing";
+   const string req1 = "POST /upload HTTP/1.1" + EOL +
+      "Host: www.acme.com" + EOL +
+      "Content-Length: " + std::to_string(bodyText.size()) + EOL + EOL +
+      bodyText;
+   const string req2 = "GET /next HTTP/1.1" + EOL +
+      "Host: www.acme.com" + EOL + EOL;
+
+   MockSocket mock_socket(req1 + req2);
+   SocketConnection connection(&mock_socket, false);
+   TestableHttpTransaction txn(&connection, false);
+
+   require(txn.streamFromConnection(), "streamFromConnection with body");
+   require(txn.hasPendingBody(), "body should be pending");
+   require(txn.takeUnconsumedBytes().empty(), "next request isn't known before the body is read");
+
+   HttpBodyReader* reader = txn.getBodyReader();
+   require(nullptr != reader, "body reader should be present");
+
+   // a piece at a time, through a small caller-owned buffer
+   string body;
+   char buffer[5];
+   int bytesRead;
+   while ((bytesRead = reader->read(std::span<char>(buffer))) > 0) {
+      require(bytesRead <= (int) sizeof(buffer), "read stays within the span");
+      body.append(buffer, bytesRead);
+   }
+
+   require(0 == bytesRead, "end of body");
+   requireStringEquals(bodyText, body, "streamed body content");
+   require(nullptr == txn.getBody(), "streamed body is never buffered");
+   requireFalse(txn.hasPendingBody(), "body should be complete");
+   requireStringEquals(req2, txn.takeUnconsumedBytes(), "next request follows the body");
+}
+
+//*****************************************************************************
+
+void TestHttpTransaction::testBodyOverLimit() {
+   TEST_CASE("testBodyOverLimit");
+
+   const string req = "POST /upload HTTP/1.1" + EOL +
+      "Host: www.acme.com" + EOL +
+      "Content-Length: 100" + EOL + EOL +
+      "0123456789";
+
+   MockSocket mock_socket(req);
+   SocketConnection connection(&mock_socket, false);
+   TestableHttpTransaction txn(&connection, false);
+
+   require(txn.streamFromConnection(), "streamFromConnection with body");
+   requireFalse(txn.bufferBody(99), "declared length over the limit");
+   require(nullptr == txn.getBody(), "nothing buffered");
+   requireFalse(txn.getBodyReader()->hasFailed(), "refused, not failed");
+   require(0 == txn.getBodyReader()->getBytesRead(), "nothing read");
+
+   const string chunked = "POST /upload HTTP/1.1" + EOL +
+      "Host: www.acme.com" + EOL +
+      "Transfer-Encoding: chunked" + EOL + EOL +
+      "a" + EOL + "0123456789" + EOL +
+      "a" + EOL + "0123456789" + EOL +
+      "0" + EOL + EOL;
+
+   MockSocket chunked_socket(chunked);
+   SocketConnection chunkedConnection(&chunked_socket, false);
+   TestableHttpTransaction chunkedTxn(&chunkedConnection, false);
+
+   require(chunkedTxn.streamFromConnection(), "streamFromConnection with chunked body");
+   requireFalse(chunkedTxn.bufferBody(15), "chunked body over the limit");
+   require(nullptr == chunkedTxn.getBody(), "nothing buffered");
+   requireFalse(chunkedTxn.getBodyReader()->hasFailed(), "refused, not failed");
+}
+
+//*****************************************************************************
+
 void TestHttpTransaction::testStreamFromSocketSequentialRequests() {
    TEST_CASE("testStreamFromSocketSequentialRequests");
 
@@ -283,7 +364,7 @@ void TestHttpTransaction::testStreamFromSocketSequentialRequests() {
 
    TestableHttpTransaction txn1(&connection, false);
    require(txn1.streamFromConnection(), "first request should parse");
-   requireStringEquals(string("GET /first HTTP/1.1"), txn1.getFirstHeaderLine(), "first request line");
+   requireStringEquals(string("GET /first HTTP/1.1"), string(txn1.getFirstHeaderLine()), "first request line");
 
    // simulate the second request arriving only after the first was fully
    // consumed
@@ -291,7 +372,7 @@ void TestHttpTransaction::testStreamFromSocketSequentialRequests() {
 
    TestableHttpTransaction txn2(&connection, false);
    require(txn2.streamFromConnection(), "second request on the same connection should parse");
-   requireStringEquals(string("GET /second HTTP/1.1"), txn2.getFirstHeaderLine(), "second request line");
+   requireStringEquals(string("GET /second HTTP/1.1"), string(txn2.getFirstHeaderLine()), "second request line");
 }
 
 //*****************************************************************************
@@ -20,6 +20,8 @@ protected:
    void testAssignmentMove();
    void testStreamFromSocket();
    void testStreamFromSocketWithBody();
+   void testStreamedBody();
+   void testBodyOverLimit();
    void testStreamFromSocketSequentialRequests();
    void testGetRawHeader();
    void testGetBody();
@@ -0,0 +1,122 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include <cstdio>
+#include <future>
+#include <memory>
+#include <string>
+
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+
+#include "TestListenerHandoff.h"
+#include "ListenerHandoff.h"
+#include "ListeningSocket.h"
+#include "Socket.h"
+
+using namespace std;
+using namespace misere;
+using namespace chaudiere;
+
+namespace {
+
+const int PORT = 34585;
+
+string uniqueSocketPath(const string& name) {
+   static int counter = 0;
+   char buffer[256];
+   ::snprintf(buffer, sizeof(buffer), "/tmp/misere_handoff_test_%d_%d_%s",
+              (int) ::getpid(), ++counter, name.c_str());
+   return string(buffer);
+}
+
+bool pathExists(const string& path) {
+   struct stat info;
+   return ::stat(path.c_str(), &info) == 0;
+}
+
+}
+
+//******************************************************************************
+
+TestListenerHandoff::TestListenerHandoff() :
+   poivre::TestSuite("TestListenerHandoff") {
+}
+
+//******************************************************************************
+
+void TestListenerHandoff::runTests() {
+   testReceiveWithoutOffer();
+   testHandsOverListeningSocket();
+   testCloseLeavesReplacedFile();
+}
+
+//******************************************************************************
+
+void TestListenerHandoff::testReceiveWithoutOffer() {
+   TEST_CASE("testReceiveWithoutOffer");
+
+   require(ListenerHandoff::receiveListener(uniqueSocketPath("none.sock")) == -1,
+           "nothing should be received when no process offers a listener");
+}
+
+//******************************************************************************
+
+void TestListenerHandoff::testHandsOverListeningSocket() {
+   TEST_CASE("testHandsOverListeningSocket");
+
+   ListeningSocket listener;
+   require(listener.open(PORT, false, false), "listener should open");
+
+   const string path = uniqueSocketPath("offer.sock");
+   ListenerHandoff handoff;
+   require(handoff.offer(path), "listener should be offered");
+
+   future<int> received = async(launch::async, [path]() {
+      return ListenerHandoff::receiveListener(path);
+   });
+
+   struct pollfd pfd;
+   pfd.fd = handoff.getFileDescriptor();
+   pfd.events = POLLIN;
+   pfd.revents = 0;
+   require(::poll(&pfd, 1, 5000) == 1, "the new process should ask for the listener");
+   require(handoff.handOver(listener.getFileDescriptor()), "listener should be handed over");
+
+   const int receivedFD = received.get();
+   require(receivedFD > -1, "the new process should receive the listener");
+
+   // the port stays open once the original descriptor is gone
+   listener.close();
+
+   unique_ptr<Socket> client(new Socket("127.0.0.1", PORT));
+   const int accepted = ::accept(receivedFD, nullptr, nullptr);
+   require(accepted > -1, "the received listener should accept connections");
+
+   ::close(accepted);
+   ::close(receivedFD);
+}
+
+//******************************************************************************
+
+void TestListenerHandoff::testCloseLeavesReplacedFile() {
+   TEST_CASE("testCloseLeavesReplacedFile");
+
+   const string path = uniqueSocketPath("replaced.sock");
+
+   ListenerHandoff previous;
+   require(previous.offer(path), "first process should offer");
+
+   ListenerHandoff current;
+   require(current.offer(path), "second process should replace the socket file");
+
+   previous.close();
+   require(pathExists(path), "closing should leave another process's socket file");
+
+   current.close();
+   require(!pathExists(path), "closing should remove its own socket file");
+}
+
+//******************************************************************************
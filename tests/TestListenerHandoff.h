@@ -0,0 +1,27 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef MISERE_TESTLISTENERHANDOFF_H
+#define MISERE_TESTLISTENERHANDOFF_H
+
+#include "TestSuite.h"
+
+namespace misere {
+
+class TestListenerHandoff : public poivre::TestSuite {
+
+protected:
+   void runTests();
+
+   void testReceiveWithoutOffer();
+   void testHandsOverListeningSocket();
+   void testCloseLeavesReplacedFile();
+
+public:
+   TestListenerHandoff();
+
+};
+
+}
+
+#endif
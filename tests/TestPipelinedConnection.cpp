@@ -0,0 +1,177 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include <stdio.h>
+#include <unistd.h>
+#include <string>
+
+#include "TestPipelinedConnection.h"
+#include "PipelinedConnection.h"
+
+using namespace std;
+using namespace misere;
+
+namespace {
+
+// records what reaches the wrapped connection, one entry per call
+class RecordingConnection : public ByteConnection
+{
+   public:
+      RecordingConnection() :
+         writeCount(0),
+         closed(false) {
+      }
+
+      virtual int read(char*, int) {
+         return 0;
+      }
+
+      virtual bool write(const char* buffer, std::size_t length) {
+         ++writeCount;
+         bytes.append(buffer, length);
+         return true;
+      }
+
+      virtual bool writev(const Segment* segments, std::size_t count) {
+         ++writeCount;
+         for (std::size_t i = 0; i < count; ++i) {
+            bytes.append(segments[i].data, segments[i].length);
+         }
+         return true;
+      }
+
+      virtual void close() {
+         closed = true;
+      }
+
+      string bytes;
+      int writeCount;
+      bool closed;
+};
+
+void writeResponse(ByteConnection& connection, const string& header, const string& body) {
+   const ByteConnection::Segment segments[2] = {
+      { header.data(), header.size() },
+      { body.data(), body.size() }
+   };
+   connection.writev(segments, 2);
+}
+
+}
+
+//******************************************************************************
+
+TestPipelinedConnection::TestPipelinedConnection() :
+   poivre::TestSuite("TestPipelinedConnection") {
+}
+
+//******************************************************************************
+
+void TestPipelinedConnection::runTests() {
+   testPassesThroughWhenNotHolding();
+   testHeldResponsesWrittenWithNext();
+   testFlushOnDestruction();
+   testHeldSizeBounded();
+   testSendFileWritesHeldFirst();
+}
+
+//******************************************************************************
+
+void TestPipelinedConnection::testPassesThroughWhenNotHolding() {
+   TEST_CASE("testPassesThroughWhenNotHolding");
+
+   RecordingConnection connection;
+   PipelinedConnection pipeline(connection);
+
+   writeResponse(pipeline, "H1", "B1");
+   require(connection.writeCount == 1, "response written immediately");
+   requireStringEquals("H1B1", connection.bytes, "response bytes");
+   require(pipeline.getHeldSize() == 0, "nothing held");
+}
+
+//******************************************************************************
+
+void TestPipelinedConnection::testHeldResponsesWrittenWithNext() {
+   TEST_CASE("testHeldResponsesWrittenWithNext");
+
+   RecordingConnection connection;
+   PipelinedConnection pipeline(connection);
+
+   pipeline.setHolding(true);
+   writeResponse(pipeline, "H1", "B1");
+   writeResponse(pipeline, "H2", "B2");
+   require(connection.writeCount == 0, "held responses aren't written");
+   require(pipeline.getHeldSize() == 8, "held bytes");
+
+   pipeline.setHolding(false);
+   writeResponse(pipeline, "H3", "B3");
+   require(connection.writeCount == 1, "all three responses in one write");
+   requireStringEquals("H1B1H2B2H3B3", connection.bytes, "responses in request order");
+   require(pipeline.getHeldSize() == 0, "nothing held after the write");
+}
+
+//******************************************************************************
+
+void TestPipelinedConnection::testFlushOnDestruction() {
+   TEST_CASE("testFlushOnDestruction");
+
+   RecordingConnection connection;
+   {
+      PipelinedConnection pipeline(connection);
+      pipeline.setHolding(true);
+      writeResponse(pipeline, "H1", "B1");
+      require(connection.writeCount == 0, "response held");
+   }
+   requireStringEquals("H1B1", connection.bytes, "held response written on destruction");
+
+   RecordingConnection closing;
+   PipelinedConnection pipeline(closing);
+   pipeline.setHolding(true);
+   writeResponse(pipeline, "H1", "B1");
+   pipeline.close();
+   requireStringEquals("H1B1", closing.bytes, "held response written before close");
+   require(closing.closed, "close passed through");
+}
+
+//******************************************************************************
+
+void TestPipelinedConnection::testHeldSizeBounded() {
+   TEST_CASE("testHeldSizeBounded");
+
+   RecordingConnection connection;
+   PipelinedConnection pipeline(connection);
+   pipeline.setHolding(true);
+
+   const string body(PipelinedConnection::MAX_HELD_BYTES, 'x');
+   writeResponse(pipeline, "H1", body);
+   require(connection.writeCount == 1, "oversized held output written anyway");
+   require(pipeline.getHeldSize() == 0, "nothing held after the write");
+   require(pipeline.isHolding(), "still holding for later responses");
+}
+
+//******************************************************************************
+
+void TestPipelinedConnection::testSendFileWritesHeldFirst() {
+   TEST_CASE("testSendFileWritesHeldFirst");
+
+   FILE* file = ::tmpfile();
+   require(file != nullptr, "temporary file");
+   const string contents = "0123456789abcdef";
+   ::fwrite(contents.data(), 1, contents.size(), file);
+   ::fflush(file);
+
+   RecordingConnection connection;
+   PipelinedConnection pipeline(connection);
+   pipeline.setHolding(true);
+   writeResponse(pipeline, "H1", "B1");
+
+   // ByteConnection's default sendFile() copies the range through write()
+   require(pipeline.sendFile(::fileno(file), 4, 8), "sendFile");
+   requireStringEquals("H1B1456789ab", connection.bytes, "held response, then the file range");
+   require(pipeline.getHeldSize() == 0, "nothing held after the file");
+
+   requireFalse(pipeline.sendFile(::fileno(file), 10, 100), "file ends before the range does");
+   ::fclose(file);
+}
+
+//******************************************************************************
@@ -0,0 +1,29 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef MISERE_TESTPIPELINEDCONNECTION_H
+#define MISERE_TESTPIPELINEDCONNECTION_H
+
+#include "TestSuite.h"
+
+namespace misere {
+
+class TestPipelinedConnection : public poivre::TestSuite {
+
+protected:
+   void runTests();
+
+   void testPassesThroughWhenNotHolding();
+   void testHeldResponsesWrittenWithNext();
+   void testFlushOnDestruction();
+   void testHeldSizeBounded();
+   void testSendFileWritesHeldFirst();
+
+public:
+   TestPipelinedConnection();
+
+};
+
+}
+
+#endif
@@ -1,12 +1,18 @@
 // Copyright Paul Dardeau, SwampBits LLC 2014
 // BSD License
 
+#include <stdio.h>
 #include <unistd.h>
 #include <sys/socket.h>
 #include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include "TestSocketConnection.h"
 #include "SocketConnection.h"
+#include "HttpFileBody.h"
 #include "Socket.h"
 
 using namespace std;
@@ -51,6 +57,8 @@ void TestSocketConnection::runTests() {
    testRead();
    testReadPartial();
    testWrite();
+   testWritev();
+   testSendFile();
    testWriteAfterPeerClosed();
    testClose();
    testUnownedSocketNotDeleted();
@@ -123,6 +131,109 @@ void TestSocketConnection::testWrite() {
 
 //******************************************************************************
 
+void TestSocketConnection::testWritev() {
+   TEST_CASE("testWritev");
+
+   SocketPair pair;
+   Socket* socket = new Socket(pair.fds[0]);
+   SocketConnection connection(socket, true);
+
+   // more segments than one writev() call takes, and one large enough to
+   // force short writes against the socket buffer
+   vector<string> pieces;
+   pieces.push_back("HTTP/1.1 200 OK\r\nContent-Length: 262144\r\n\r\n");
+   pieces.push_back(string(256 * 1024, 'b'));
+   for (int i = 0; i < 20; ++i) {
+      pieces.push_back("piece" + to_string(i));
+   }
+
+   string expected;
+   vector<ByteConnection::Segment> segments;
+   for (const string& piece : pieces) {
+      segments.push_back({ piece.data(), piece.size() });
+      expected += piece;
+   }
+
+   // drain the peer concurrently so the large write can complete
+   string received;
+   const int peerFD = pair.fds[1];
+   std::thread reader([&received, &expected, peerFD]() {
+      char buffer[16384];
+      while (received.size() < expected.size()) {
+         const ssize_t n = ::read(peerFD, buffer, sizeof(buffer));
+         if (n <= 0) {
+            break;
+         }
+         received.append(buffer, n);
+      }
+   });
+
+   const bool success = connection.writev(segments.data(), segments.size());
+   reader.join();
+
+   require(success, "writev should succeed");
+   require(received.size() == expected.size(), "peer should receive every byte of every segment");
+   require(received == expected, "peer should receive the segments in order");
+}
+
+//******************************************************************************
+
+void TestSocketConnection::testSendFile() {
+   TEST_CASE("testSendFile");
+
+   // larger than the socket buffer, so sendfile() returns short
+   string contents;
+   contents.reserve(300 * 1024);
+   while (contents.size() < 300 * 1024) {
+      contents += to_string(contents.size()) + ",";
+   }
+
+   char path[] = "/tmp/misere_sendfile_XXXXXX";
+   const int fd = ::mkstemp(path);
+   require(fd > -1, "temporary file");
+   require(::write(fd, contents.data(), contents.size()) == (ssize_t) contents.size(),
+           "writing the temporary file should succeed");
+   ::close(fd);
+
+   std::unique_ptr<HttpFileBody> fileBody(HttpFileBody::open(path));
+   ::unlink(path);
+   require(fileBody != nullptr, "file body should open");
+   require(fileBody->getLength() == contents.size(), "file body covers the whole file");
+   require(nullptr == HttpFileBody::open("/tmp"), "a directory isn't a file body");
+
+   SocketPair pair;
+   Socket* socket = new Socket(pair.fds[0]);
+   SocketConnection connection(socket, true);
+
+   const std::size_t offset = 10;
+   const string expected = contents.substr(offset);
+
+   string received;
+   const int peerFD = pair.fds[1];
+   std::thread reader([&received, &expected, peerFD]() {
+      char buffer[16384];
+      while (received.size() < expected.size()) {
+         const ssize_t n = ::read(peerFD, buffer, sizeof(buffer));
+         if (n <= 0) {
+            break;
+         }
+         received.append(buffer, n);
+      }
+   });
+
+   const bool success = connection.sendFile(fileBody->getFileDescriptor(),
+                                            offset,
+                                            expected.size());
+   reader.join();
+
+   require(success, "sendFile should succeed");
+   require(received == expected, "peer should receive the file range");
+   require(::lseek(fileBody->getFileDescriptor(), 0, SEEK_CUR) == 0,
+           "the descriptor's own offset is untouched");
+}
+
+//******************************************************************************
+
 void TestSocketConnection::testWriteAfterPeerClosed() {
    TEST_CASE("testWriteAfterPeerClosed");
 
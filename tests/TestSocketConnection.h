@@ -16,6 +16,8 @@ protected:
    void testRead();
    void testReadPartial();
    void testWrite();
+   void testWritev();
+   void testSendFile();
    void testWriteAfterPeerClosed();
    void testClose();
    void testUnownedSocketNotDeleted();
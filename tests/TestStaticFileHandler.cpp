@@ -0,0 +1,379 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include <stdlib.h>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "TestStaticFileHandler.h"
+#include "StaticFileHandler.h"
+#include "HttpRequest.h"
+#include "HttpResponse.h"
+#include "HttpRequestHandler.h"
+#include "HttpServer.h"
+#include "ByteConnection.h"
+#include "SocketConnection.h"
+#include "MockSocket.h"
+#include "KeyValuePairs.h"
+
+using namespace std;
+using namespace misere;
+
+static const string INDEX_HTML = "<html><body>index</body></html>\n";
+static const string SITE_CSS_RULE = "body { margin: 0; padding: 0; font-family: sans-serif; }\n";
+
+// not otherwise used by the tests - the server is never run
+static const int PORT = 34591;
+
+namespace {
+
+/**
+ * A directory of files to serve, removed again when the test is done
+ */
+class TestDirectory
+{
+public:
+   TestDirectory() {
+      char pattern[] = "/tmp/misere-static-XXXXXX";
+      const char* created = ::mkdtemp(pattern);
+      m_path = (created != nullptr) ? created : "";
+   }
+
+   ~TestDirectory() {
+      if (!m_path.empty()) {
+         std::error_code ec;
+         filesystem::remove_all(m_path, ec);
+      }
+   }
+
+   void write(const string& relativePath, const string& contents) {
+      const filesystem::path path = filesystem::path(m_path) / relativePath;
+      filesystem::create_directories(path.parent_path());
+      ofstream file(path, ios::binary);
+      file << contents;
+   }
+
+   const string& path() const {
+      return m_path;
+   }
+
+private:
+   string m_path;
+};
+
+string siteCss() {
+   string css;
+   for (int i = 0; i < 40; ++i) {
+      css += SITE_CSS_RULE;
+   }
+   return css;
+}
+
+void populate(TestDirectory& directory) {
+   directory.write("index.html", INDEX_HTML);
+   directory.write("css/site.css", siteCss());
+   directory.write("docs/index.html", INDEX_HTML);
+   directory.write(".hidden", "secret");
+   directory.write(".git/config", "secret");
+}
+
+// services a GET of the path, with any extra header lines
+void get(StaticFileHandler& handler,
+         const string& path,
+         HttpResponse& response,
+         const string& extraHeaders = "") {
+   MockSocket socket("GET " + path + " HTTP/1.1\r\nHost: localhost\r\n" +
+                     extraHeaders + "\r\n");
+   SocketConnection connection(&socket, false);
+   HttpRequest request(&connection, false);
+   handler.serviceRequest(request, response);
+}
+
+class RecordingConnection : public ByteConnection
+{
+public:
+   virtual int read(char*, int) {
+      return 0;
+   }
+
+   virtual bool write(const char* buffer, std::size_t length) {
+      bytes.append(buffer, length);
+      return true;
+   }
+
+   virtual void close() {
+   }
+
+   string bytes;
+};
+
+// serves a request for the path through the server, returning what was
+// written (the file body included, copied by the default sendFile())
+string serve(HttpServer& server, const string& method, const string& path) {
+   MockSocket socket(method + " " + path + " HTTP/1.1\r\nHost: localhost\r\n\r\n");
+   SocketConnection socketConnection(&socket, false);
+   HttpRequest request(&socketConnection, false);
+   RecordingConnection connection;
+   HttpRequestHandler::processRequest(server, request, connection, 1);
+   return connection.bytes;
+}
+
+}
+
+//******************************************************************************
+
+TestStaticFileHandler::TestStaticFileHandler() :
+   poivre::TestSuite("TestStaticFileHandler") {
+}
+
+//******************************************************************************
+
+void TestStaticFileHandler::runTests() {
+   testLoad();
+   testServeFile();
+   testGzipVariant();
+   testNotFound();
+   testDirectoryIndex();
+   testReload();
+   testFileTruncatedInPlace();
+   testHeadRequest();
+}
+
+//******************************************************************************
+
+void TestStaticFileHandler::testLoad() {
+   TEST_CASE("testLoad");
+
+   TestDirectory directory;
+   populate(directory);
+
+   StaticFileHandler handler(directory.path());
+   chaudiere::KeyValuePairs kvp;
+   require(handler.init("/static", kvp), "init");
+   requireIntEquals(3, (int) handler.getFileCount(), "hidden files are skipped");
+   require(handler.handlesSubpaths(), "serves the paths below its own");
+
+   StaticFileHandler missing(directory.path() + "/no-such-directory");
+   requireFalse(missing.init("/static", kvp), "init of a missing directory");
+}
+
+//******************************************************************************
+
+void TestStaticFileHandler::testServeFile() {
+   TEST_CASE("testServeFile");
+
+   TestDirectory directory;
+   populate(directory);
+
+   StaticFileHandler handler(directory.path());
+   chaudiere::KeyValuePairs kvp;
+   require(handler.init("/static", kvp), "init");
+
+   HttpResponse response;
+   get(handler, "/static/css/site.css?v=3", response);
+   requireIntEquals(200, response.getStatusCode(), "status");
+   requireStringEquals(siteCss(), string(response.getBodyView()), "body");
+   requireStringEquals("text/css", string(response.getContentType()), "content type");
+   require(response.hasHeaderValue("Last-Modified"), "Last-Modified");
+   require(response.hasHeaderValue("Vary"), "Vary for a compressible file");
+   requireFalse(response.hasHeaderValue("Content-Encoding"), "no gzip without Accept-Encoding");
+
+   const string etag(response.getHeaderValue("ETag"));
+   require((etag.size() > 2) && (etag.front() == '"') && (etag.back() == '"'),
+           "strong, quoted ETag: " + etag);
+
+   // the same contents always get the same tag
+   HttpResponse again;
+   get(handler, "/static/css/site.css", again);
+   requireStringEquals(etag, string(again.getHeaderValue("ETag")), "stable ETag");
+}
+
+//******************************************************************************
+
+void TestStaticFileHandler::testFileTruncatedInPlace() {
+   TEST_CASE("testFileTruncatedInPlace");
+
+   TestDirectory directory;
+   populate(directory);
+
+   StaticFileHandler handler(directory.path());
+   chaudiere::KeyValuePairs kvp;
+   require(handler.init("/static", kvp), "init");
+
+   HttpResponse response;
+   get(handler, "/static/css/site.css", response);
+
+   // as "cp new.css site.css" would, before the reload picks it up
+   directory.write("css/site.css", "");
+   requireStringEquals(siteCss(), string(response.getBodyView()),
+                       "a response already under way keeps its body");
+
+   HttpResponse later;
+   get(handler, "/static/css/site.css", later);
+   requireStringEquals(siteCss(), string(later.getBodyView()),
+                       "served from the handler's copy until reloaded");
+}
+
+//******************************************************************************
+
+void TestStaticFileHandler::testGzipVariant() {
+   TEST_CASE("testGzipVariant");
+
+   TestDirectory directory;
+   populate(directory);
+
+   StaticFileHandler handler(directory.path());
+   chaudiere::KeyValuePairs kvp;
+   require(handler.init("/static", kvp), "init");
+
+   HttpResponse plain;
+   get(handler, "/static/css/site.css", plain);
+
+   HttpResponse gzipped;
+   get(handler, "/static/css/site.css", gzipped, "Accept-Encoding: deflate, gzip\r\n");
+   requireStringEquals("gzip", string(gzipped.getContentEncoding()), "Content-Encoding");
+   require(gzipped.getBodyView().size() < siteCss().size(), "compressed body is smaller");
+   require((unsigned char) gzipped.getBodyView()[0] == 0x1f, "gzip magic byte");
+   require(string(gzipped.getHeaderValue("ETag")) != string(plain.getHeaderValue("ETag")),
+           "the variant has its own ETag");
+
+   HttpResponse refused;
+   get(handler, "/static/css/site.css", refused, "Accept-Encoding: gzip;q=0\r\n");
+   requireFalse(refused.hasHeaderValue("Content-Encoding"), "gzip;q=0 refuses gzip");
+   requireStringEquals(siteCss(), string(refused.getBodyView()), "identity body");
+
+   // too small to be worth compressing
+   HttpResponse small;
+   get(handler, "/static/index.html", small, "Accept-Encoding: gzip\r\n");
+   requireFalse(small.hasHeaderValue("Content-Encoding"), "small file sent as is");
+   requireStringEquals(INDEX_HTML, string(small.getBodyView()), "small body");
+}
+
+//******************************************************************************
+
+void TestStaticFileHandler::testNotFound() {
+   TEST_CASE("testNotFound");
+
+   TestDirectory directory;
+   populate(directory);
+
+   StaticFileHandler handler(directory.path());
+   chaudiere::KeyValuePairs kvp;
+   require(handler.init("/static", kvp), "init");
+
+   HttpResponse missing;
+   get(handler, "/static/missing.css", missing);
+   requireIntEquals(404, missing.getStatusCode(), "missing file");
+
+   HttpResponse hidden;
+   get(handler, "/static/.hidden", hidden);
+   requireIntEquals(404, hidden.getStatusCode(), "hidden file");
+
+   HttpResponse hiddenDirectory;
+   get(handler, "/static/.git/config", hiddenDirectory);
+   requireIntEquals(404, hiddenDirectory.getStatusCode(), "file in hidden directory");
+
+   HttpResponse traversal;
+   get(handler, "/static/../index.html", traversal);
+   requireIntEquals(404, traversal.getStatusCode(), "path outside the directory");
+}
+
+//******************************************************************************
+
+void TestStaticFileHandler::testDirectoryIndex() {
+   TEST_CASE("testDirectoryIndex");
+
+   TestDirectory directory;
+   populate(directory);
+
+   StaticFileHandler handler(directory.path());
+   chaudiere::KeyValuePairs kvp;
+   require(handler.init("/static", kvp), "init");
+
+   HttpResponse root;
+   get(handler, "/static/", root);
+   requireIntEquals(200, root.getStatusCode(), "root status");
+   requireStringEquals(INDEX_HTML, string(root.getBodyView()), "root index");
+
+   HttpResponse rootNoSlash;
+   get(handler, "/static", rootNoSlash);
+   requireStringEquals(INDEX_HTML, string(rootNoSlash.getBodyView()), "root index without slash");
+
+   HttpResponse docs;
+   get(handler, "/static/docs/", docs);
+   requireStringEquals(INDEX_HTML, string(docs.getBodyView()), "subdirectory index");
+   requireStringEquals("text/html", string(docs.getContentType()), "index content type");
+}
+
+//******************************************************************************
+
+void TestStaticFileHandler::testReload() {
+   TEST_CASE("testReload");
+
+   TestDirectory directory;
+   populate(directory);
+
+   StaticFileHandler handler(directory.path());
+   chaudiere::KeyValuePairs kvp;
+   require(handler.init("/static", kvp), "init");
+
+   // a response holds on to the generation of files it was served from
+   HttpResponse before;
+   get(handler, "/static/index.html", before);
+
+   directory.write("new.txt", "new file\n");
+   directory.write("index.html.tmp", "<html>replaced</html>\n");
+   filesystem::rename(filesystem::path(directory.path()) / "index.html.tmp",
+                      filesystem::path(directory.path()) / "index.html");
+
+   require(handler.reload(), "reload");
+   requireIntEquals(4, (int) handler.getFileCount(), "new file loaded");
+
+   HttpResponse added;
+   get(handler, "/static/new.txt", added);
+   requireStringEquals("new file\n", string(added.getBodyView()), "new file served");
+
+   HttpResponse after;
+   get(handler, "/static/index.html", after);
+   requireStringEquals("<html>replaced</html>\n", string(after.getBodyView()), "replaced file served");
+   requireStringEquals(INDEX_HTML, string(before.getBodyView()), "earlier response unaffected");
+
+   handler.destroy();
+}
+
+//******************************************************************************
+
+void TestStaticFileHandler::testHeadRequest() {
+   TEST_CASE("testHeadRequest");
+
+   TestDirectory directory;
+   populate(directory);
+
+   StaticFileHandler* handler = new StaticFileHandler(directory.path());
+   chaudiere::KeyValuePairs kvp;
+   require(handler->init("/static", kvp), "init");
+
+   HttpServer server(PORT);
+   require(server.addPathHandler("/static", handler), "add handler");
+
+   const string css = siteCss();
+   const string contentLength = "Content-Length: " + to_string(css.size()) + "\r\n";
+
+   const string getResponse = serve(server, "GET", "/static/css/site.css");
+   require(getResponse.find(contentLength) != string::npos, "GET Content-Length");
+   require(getResponse.size() > css.size() &&
+           getResponse.compare(getResponse.size() - css.size(), css.size(), css) == 0,
+           "GET ends with the file");
+
+   // the same headers, but the response ends with them
+   const string headResponse = serve(server, "HEAD", "/static/css/site.css");
+   require(headResponse.compare(0, 12, "HTTP/1.1 200") == 0, "HEAD status");
+   require(headResponse.find(contentLength) != string::npos,
+           "HEAD has the Content-Length a GET would get");
+   require(headResponse.find("\r\n\r\n") == headResponse.size() - 4,
+           "HEAD has no body");
+}
+
+//******************************************************************************
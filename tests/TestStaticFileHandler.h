@@ -0,0 +1,32 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef MISERE_TESTSTATICFILEHANDLER_H
+#define MISERE_TESTSTATICFILEHANDLER_H
+
+#include "TestSuite.h"
+
+namespace misere {
+
+class TestStaticFileHandler : public poivre::TestSuite {
+
+protected:
+   void runTests();
+
+   void testLoad();
+   void testServeFile();
+   void testGzipVariant();
+   void testNotFound();
+   void testDirectoryIndex();
+   void testReload();
+   void testFileTruncatedInPlace();
+   void testHeadRequest();
+
+public:
+   TestStaticFileHandler();
+
+};
+
+}
+
+#endif
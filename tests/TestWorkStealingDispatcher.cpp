@@ -0,0 +1,243 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include "TestWorkStealingDispatcher.h"
+#include "WorkStealingDispatcher.h"
+#include "CpuAffinity.h"
+
+using namespace std;
+using namespace misere;
+
+namespace {
+
+// runs a function, counting the requests run and deleted
+class CountedRequest : public chaudiere::Runnable
+{
+   public:
+      CountedRequest(atomic<int>& runCount,
+                     atomic<int>& deleteCount,
+                     function<void()> body = nullptr) :
+         m_runCount(runCount),
+         m_deleteCount(deleteCount),
+         m_body(body) {
+         setAutoDelete();
+      }
+
+      ~CountedRequest() {
+         ++m_deleteCount;
+      }
+
+      virtual void run() {
+         if (m_body) {
+            m_body();
+         }
+         ++m_runCount;
+      }
+
+   private:
+      atomic<int>& m_runCount;
+      atomic<int>& m_deleteCount;
+      function<void()> m_body;
+};
+
+bool waitFor(const atomic<int>& count, int expected) {
+   for (int i = 0; (i < 500) && (count.load() < expected); ++i) {
+      this_thread::sleep_for(chrono::milliseconds(10));
+   }
+   return count.load() >= expected;
+}
+
+}
+
+//******************************************************************************
+
+TestWorkStealingDispatcher::TestWorkStealingDispatcher() :
+   poivre::TestSuite("TestWorkStealingDispatcher") {
+}
+
+//******************************************************************************
+
+void TestWorkStealingDispatcher::runTests() {
+   testRunsEveryRequest();
+   testRequestsAddedByWorkers();
+   testIdleWorkersSteal();
+   testNotRunning();
+   testStopRunsQueuedRequests();
+   testPinnedWorkers();
+}
+
+//******************************************************************************
+
+void TestWorkStealingDispatcher::testRunsEveryRequest() {
+   TEST_CASE("testRunsEveryRequest");
+
+   atomic<int> runCount(0);
+   atomic<int> deleteCount(0);
+   const int requestCount = 1000;
+
+   WorkStealingDispatcher dispatcher(4);
+   require(dispatcher.start(), "pool should start");
+   require(dispatcher.getNumberWorkers() == 4, "pool should have 4 workers");
+
+   // added from several threads at once, as the accept loop and event
+   // loops would
+   thread adders[4];
+   for (thread& adder : adders) {
+      adder = thread([&]() {
+         for (int i = 0; i < requestCount / 4; ++i) {
+            dispatcher.addRequest(new CountedRequest(runCount, deleteCount));
+         }
+      });
+   }
+
+   for (thread& adder : adders) {
+      adder.join();
+   }
+
+   require(waitFor(runCount, requestCount), "every request should be run");
+   require(dispatcher.stop(), "pool should stop");
+   require(deleteCount == requestCount, "every auto-delete request should be deleted");
+}
+
+//******************************************************************************
+
+void TestWorkStealingDispatcher::testRequestsAddedByWorkers() {
+   TEST_CASE("testRequestsAddedByWorkers");
+
+   atomic<int> runCount(0);
+   atomic<int> deleteCount(0);
+   const int childCount = 100;
+
+   WorkStealingDispatcher dispatcher(2);
+   dispatcher.start();
+
+   dispatcher.addRequest(new CountedRequest(runCount, deleteCount, [&]() {
+      for (int i = 0; i < childCount; ++i) {
+         dispatcher.addRequest(new CountedRequest(runCount, deleteCount));
+      }
+   }));
+
+   require(waitFor(runCount, childCount + 1),
+           "requests added by a worker should be run");
+   dispatcher.stop();
+}
+
+//******************************************************************************
+
+void TestWorkStealingDispatcher::testIdleWorkersSteal() {
+   TEST_CASE("testIdleWorkersSteal");
+
+   atomic<int> runCount(0);
+   atomic<int> deleteCount(0);
+   atomic<int> childRunCount(0);
+   atomic<int> unusedCount(0);
+   const int childCount = 50;
+   bool isStolen = false;
+
+   WorkStealingDispatcher dispatcher(4);
+   dispatcher.start();
+
+   // the children go on the parent's own queue, and the parent doesn't
+   // return until they've run - so only other workers can run them
+   dispatcher.addRequest(new CountedRequest(runCount, deleteCount, [&]() {
+      for (int i = 0; i < childCount; ++i) {
+         dispatcher.addRequest(new CountedRequest(childRunCount, unusedCount));
+      }
+      isStolen = waitFor(childRunCount, childCount);
+   }));
+
+   require(waitFor(runCount, 1), "the parent request should finish");
+   require(isStolen, "other workers should steal the blocked worker's requests");
+   require(dispatcher.getStealCount() >= (uint64_t) childCount,
+           "every child request should have been stolen");
+   dispatcher.stop();
+}
+
+//******************************************************************************
+
+void TestWorkStealingDispatcher::testNotRunning() {
+   TEST_CASE("testNotRunning");
+
+   atomic<int> runCount(0);
+   atomic<int> deleteCount(0);
+
+   WorkStealingDispatcher dispatcher(2);
+   CountedRequest request(runCount, deleteCount);
+
+   require(!dispatcher.addRequest(&request), "a pool not started should refuse requests");
+   require(!dispatcher.stop(), "a pool not started shouldn't stop");
+
+   dispatcher.start();
+   require(!dispatcher.start(), "a running pool shouldn't start again");
+   dispatcher.stop();
+
+   require(!dispatcher.addRequest(&request), "a stopped pool should refuse requests");
+   require(runCount == 0, "a refused request shouldn't be run");
+}
+
+//******************************************************************************
+
+void TestWorkStealingDispatcher::testStopRunsQueuedRequests() {
+   TEST_CASE("testStopRunsQueuedRequests");
+
+   atomic<int> runCount(0);
+   atomic<int> deleteCount(0);
+   const int queuedCount = 10;
+
+   WorkStealingDispatcher dispatcher(1);
+   dispatcher.start();
+
+   dispatcher.addRequest(new CountedRequest(runCount, deleteCount, []() {
+      this_thread::sleep_for(chrono::milliseconds(50));
+   }));
+
+   for (int i = 0; i < queuedCount; ++i) {
+      dispatcher.addRequest(new CountedRequest(runCount, deleteCount));
+   }
+
+   dispatcher.stop();
+   require(runCount == queuedCount + 1, "requests added before stop() should be run");
+   require(deleteCount == queuedCount + 1, "and deleted");
+}
+
+//******************************************************************************
+
+void TestWorkStealingDispatcher::testPinnedWorkers() {
+   TEST_CASE("testPinnedWorkers");
+
+   // a CPU this process is allowed to run on
+   const int cpu = CpuAffinity::currentCpu();
+   if (cpu < 0) {
+      return;
+   }
+
+   atomic<int> runCount(0);
+   atomic<int> deleteCount(0);
+   atomic<int> elsewhereCount(0);
+   const int requestCount = 20;
+
+   WorkStealingDispatcher dispatcher(2);
+   dispatcher.setWorkerCpus(vector<int>(1, cpu));
+   dispatcher.start();
+
+   for (int i = 0; i < requestCount; ++i) {
+      // steered to the CPU's node, or (no node known) to any worker
+      dispatcher.addRequest(new CountedRequest(runCount, deleteCount, [&]() {
+         if (CpuAffinity::currentCpu() != cpu) {
+            ++elsewhereCount;
+         }
+      }), (i % 2) ? cpu : -1);
+   }
+
+   require(waitFor(runCount, requestCount), "steered requests should be run");
+   require(elsewhereCount == 0, "pinned workers should only run on their CPU");
+   dispatcher.stop();
+}
+
+//******************************************************************************
@@ -0,0 +1,30 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef MISERE_TESTWORKSTEALINGDISPATCHER_H
+#define MISERE_TESTWORKSTEALINGDISPATCHER_H
+
+#include "TestSuite.h"
+
+namespace misere {
+
+class TestWorkStealingDispatcher : public poivre::TestSuite {
+
+protected:
+   void runTests();
+
+   void testRunsEveryRequest();
+   void testRequestsAddedByWorkers();
+   void testIdleWorkersSteal();
+   void testNotRunning();
+   void testStopRunsQueuedRequests();
+   void testPinnedWorkers();
+
+public:
+   TestWorkStealingDispatcher();
+
+};
+
+}
+
+#endif
@@ -0,0 +1,184 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#if defined(MISERE_WITH_ZSTD)
+#include <zstd.h>
+#endif
+
+#include <stdio.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <memory>
+#include <string>
+
+#include "TestZstdCompressor.h"
+#include "ZstdCompressor.h"
+
+using namespace std;
+using namespace misere;
+
+namespace {
+
+string repeated(const string& s, int count) {
+   string result;
+   for (int i = 0; i < count; ++i) {
+      result += s;
+   }
+   return result;
+}
+
+#if defined(MISERE_WITH_ZSTD)
+bool decompress(const string& input,
+                size_t decodedLength,
+                string& output,
+                const string& dictionary = string()) {
+   output.resize(decodedLength);
+   ZSTD_DCtx* context = ::ZSTD_createDCtx();
+   const size_t rc = ::ZSTD_decompress_usingDict(context,
+                                                 output.data(), output.size(),
+                                                 input.data(), input.size(),
+                                                 dictionary.data(),
+                                                 dictionary.size());
+   ::ZSTD_freeDCtx(context);
+
+   if (::ZSTD_isError(rc)) {
+      return false;
+   }
+
+   output.resize(rc);
+   return true;
+}
+#endif
+
+}
+
+//******************************************************************************
+
+TestZstdCompressor::TestZstdCompressor() :
+   poivre::TestSuite("TestZstdCompressor") {
+}
+
+//******************************************************************************
+
+void TestZstdCompressor::runTests() {
+   if (!ZstdCompressor::isSupported()) {
+      testUnsupported();
+      return;
+   }
+
+   testRoundTrip();
+   testReuse();
+   testDictionary();
+}
+
+//******************************************************************************
+
+void TestZstdCompressor::testRoundTrip() {
+#if defined(MISERE_WITH_ZSTD)
+   TEST_CASE("testRoundTrip");
+
+   const string json = repeated("{\"id\":42,\"name\":\"misere\",\"tags\":[\"a\",\"b\"]}\n", 100);
+
+   ZstdCompressor compressor;
+   string compressed;
+   require(compressor.compress(json.data(), json.size(), compressed), "compress");
+   require(compressed.size() < json.size() / 8, "repetitive JSON should shrink well");
+
+   string decompressed;
+   require(decompress(compressed, json.size(), decompressed), "decompress");
+   requireStringEquals(json, decompressed, "round trip");
+#endif
+}
+
+//******************************************************************************
+
+void TestZstdCompressor::testReuse() {
+#if defined(MISERE_WITH_ZSTD)
+   TEST_CASE("testReuse");
+
+   const string first = repeated("<li>item</li>\n", 200);
+   const string second = repeated("body { margin: 0; }\n", 120);
+
+   ZstdCompressor compressor(9);
+   string compressed;
+   string decompressed;
+
+   require(compressor.compress(first.data(), first.size(), compressed), "compress first");
+   require(decompress(compressed, first.size(), decompressed), "decompress first");
+   requireStringEquals(first, decompressed, "first round trip");
+
+   // the context carries nothing over into the second frame
+   require(compressor.compress(second.data(), second.size(), compressed), "compress second");
+   require(decompress(compressed, second.size(), decompressed), "decompress second");
+   requireStringEquals(second, decompressed, "second round trip");
+#endif
+}
+
+//******************************************************************************
+
+void TestZstdCompressor::testDictionary() {
+#if defined(MISERE_WITH_ZSTD)
+   TEST_CASE("testDictionary");
+
+   // a raw content dictionary - a typical response - is enough for a
+   // small response much like it to compress to a fraction of its size
+   const string dictionary =
+      "{\"account\":{\"id\":\"\",\"status\":\"active\",\"plan\":\"standard\","
+      "\"created\":\"2024-01-01T00:00:00Z\",\"owner\":{\"name\":\"\","
+      "\"email\":\"\"},\"limits\":{\"requests\":1000,\"storage\":5000}}}";
+   const string response =
+      "{\"account\":{\"id\":\"a81f\",\"status\":\"active\",\"plan\":\"standard\","
+      "\"created\":\"2024-03-02T10:11:12Z\",\"owner\":{\"name\":\"pat\","
+      "\"email\":\"pat@example.com\"},\"limits\":{\"requests\":1000,\"storage\":5000}}}";
+
+   char path[] = "/tmp/misere-zstd-dictionary-XXXXXX";
+   const int fd = ::mkstemp(path);
+   require(fd > -1, "create dictionary file");
+   ::close(fd);
+   {
+      ofstream file(path, ios::binary);
+      file << dictionary;
+   }
+
+   unique_ptr<ZstdDictionary> loaded(ZstdDictionary::load(path, ZstdCompressor::DEFAULT_LEVEL));
+   ::unlink(path);
+   require(loaded != nullptr, "load dictionary");
+
+   ZstdCompressor compressor;
+   string plain;
+   string withDictionary;
+   require(compressor.compress(response.data(), response.size(), plain), "compress without dictionary");
+   require(compressor.compress(response.data(), response.size(), withDictionary, loaded.get()),
+           "compress with dictionary");
+   require(withDictionary.size() < plain.size() / 2,
+           "the dictionary should make a small response much smaller");
+
+   string decompressed;
+   require(decompress(withDictionary, response.size(), decompressed, dictionary),
+           "decompress with dictionary");
+   requireStringEquals(response, decompressed, "dictionary round trip");
+
+   requireFalse(decompress(withDictionary, response.size(), decompressed),
+                "can't be decoded without the dictionary");
+
+   require(ZstdDictionary::load("/no/such/dictionary", 3) == nullptr,
+           "missing dictionary file");
+#endif
+}
+
+//******************************************************************************
+
+void TestZstdCompressor::testUnsupported() {
+   TEST_CASE("testUnsupported");
+
+   ZstdCompressor compressor;
+   string compressed = "stale";
+   requireFalse(compressor.compress("abc", 3, compressed),
+                "compress fails without zstd built in");
+   require(compressed.empty(), "output is cleared");
+   require(ZstdDictionary::load("/no/such/dictionary", 3) == nullptr,
+           "no dictionaries without zstd built in");
+}
+
+//******************************************************************************
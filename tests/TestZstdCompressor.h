@@ -0,0 +1,28 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef MISERE_TESTZSTDCOMPRESSOR_H
+#define MISERE_TESTZSTDCOMPRESSOR_H
+
+#include "TestSuite.h"
+
+namespace misere {
+
+class TestZstdCompressor : public poivre::TestSuite {
+
+protected:
+   void runTests();
+
+   void testRoundTrip();
+   void testReuse();
+   void testDictionary();
+   void testUnsupported();
+
+public:
+   TestZstdCompressor();
+
+};
+
+}
+
+#endif
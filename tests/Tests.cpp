@@ -5,18 +5,39 @@
 
 #include "Tests.h"
 
+#include "TestBrotliCompressor.h"
+#include "TestCpuAffinity.h"
+#include "TestEpochReclaimer.h"
+#include "TestGzipCompressor.h"
 #include "TestHTTP.h"
+#include "TestHttpBodyReader.h"
 #include "TestHttpClient.h"
+#include "TestHttpConditional.h"
+#include "TestHttpConnectionArena.h"
+#include "TestHttpDateCache.h"
+#include "TestHttpEventLoop.h"
 #include "TestHttpException.h"
+#include "TestHttpHeaderParser.h"
+#include "TestHttpHeaderPrefixes.h"
+#include "TestHttpHeaders.h"
 #include "TestHttpRequest.h"
 #include "TestHttpResponse.h"
+#include "TestHttpResponseCache.h"
+#include "TestHttpResponseWriter.h"
+#include "TestHttpRouter.h"
+#include "TestHttpScan.h"
 #include "TestHttpServer.h"
 #include "TestHttpsIntegration.h"
 #include "TestHttpTransaction.h"
+#include "TestListenerHandoff.h"
+#include "TestPipelinedConnection.h"
 #include "TestSocketConnection.h"
 #include "TestSocketTransport.h"
+#include "TestStaticFileHandler.h"
 #include "TestTlsConnection.h"
 #include "TestUrl.h"
+#include "TestWorkStealingDispatcher.h"
+#include "TestZstdCompressor.h"
 
 using namespace misere;
 
@@ -24,38 +45,101 @@ void Tests::run() {
    TestHTTP testHTTP;
    testHTTP.run();
 
+   TestGzipCompressor testGzipCompressor;
+   testGzipCompressor.run();
+
+   TestBrotliCompressor testBrotliCompressor;
+   testBrotliCompressor.run();
+
+   TestCpuAffinity testCpuAffinity;
+   testCpuAffinity.run();
+
+   TestEpochReclaimer testEpochReclaimer;
+   testEpochReclaimer.run();
+
+   TestZstdCompressor testZstdCompressor;
+   testZstdCompressor.run();
+
+   TestHttpBodyReader testHttpBodyReader;
+   testHttpBodyReader.run();
+
    TestHttpClient testHttpClient;
    testHttpClient.run();
 
+   TestHttpConditional testHttpConditional;
+   testHttpConditional.run();
+
+   TestHttpConnectionArena testHttpConnectionArena;
+   testHttpConnectionArena.run();
+
+   TestHttpDateCache testHttpDateCache;
+   testHttpDateCache.run();
+
    TestHttpException testHttpException;
    testHttpException.run();
 
+   TestHttpHeaderParser testHttpHeaderParser;
+   testHttpHeaderParser.run();
+
+   TestHttpHeaderPrefixes testHttpHeaderPrefixes;
+   testHttpHeaderPrefixes.run();
+
+   TestHttpHeaders testHttpHeaders;
+   testHttpHeaders.run();
+
    TestHttpRequest testHttpRequest;
    testHttpRequest.run();
 
    TestHttpResponse testHttpResponse;
    testHttpResponse.run();
 
+   TestHttpResponseCache testHttpResponseCache;
+   testHttpResponseCache.run();
+
+   TestHttpResponseWriter testHttpResponseWriter;
+   testHttpResponseWriter.run();
+
+   TestHttpRouter testHttpRouter;
+   testHttpRouter.run();
+
+   TestHttpScan testHttpScan;
+   testHttpScan.run();
+
    TestHttpServer testHttpServer;
    testHttpServer.run();
 
    TestHttpTransaction testHttpTransaction;
    testHttpTransaction.run();
 
+   TestPipelinedConnection testPipelinedConnection;
+   testPipelinedConnection.run();
+
    TestSocketConnection testSocketConnection;
    testSocketConnection.run();
 
    TestSocketTransport testSocketTransport;
    testSocketTransport.run();
 
+   TestStaticFileHandler testStaticFileHandler;
+   testStaticFileHandler.run();
+
    TestTlsConnection testTlsConnection;
    testTlsConnection.run();
 
    TestHttpsIntegration testHttpsIntegration;
    testHttpsIntegration.run();
 
+   TestHttpEventLoop testHttpEventLoop;
+   testHttpEventLoop.run();
+
+   TestListenerHandoff testListenerHandoff;
+   testListenerHandoff.run();
+
    TestUrl testUrl;
    testUrl.run();
+
+   TestWorkStealingDispatcher testWorkStealingDispatcher;
+   testWorkStealingDispatcher.run();
 }
 
 int main(int argc, char* argv[]) {